@@ -0,0 +1,89 @@
+#include "bootstrap_amortized.hpp"
+#include "bootstrap_multi_bit.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+// Latency of the bootstrap of a single ciphertext, the one seen by a
+// request, and time per ciphertext of a batch filling the thread pool, for
+// the amortized engine and the multi-bit one with each grouping factor.
+// Keys and ciphertexts are random, only the timings are meaningful.
+//
+// Usage: benchmark_cpu_bootstrap [input_lwe_dimension polynomial_size
+//                                 base_log l_gadget]
+
+template <typename F> double time_ns(F &&f, int repetitions) {
+  f();
+  auto start = std::chrono::steady_clock::now();
+  for (int r = 0; r < repetitions; r++)
+    f();
+  auto stop = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(stop - start).count() /
+         repetitions;
+}
+
+int main(int argc, char **argv) {
+  uint32_t input_lwe_dimension = 750, polynomial_size = 2048;
+  uint32_t base_log = 15, l_gadget = 2;
+  if (argc == 5) {
+    input_lwe_dimension = atoi(argv[1]);
+    polynomial_size = atoi(argv[2]);
+    base_log = atoi(argv[3]);
+    l_gadget = atoi(argv[4]);
+  }
+
+  std::mt19937_64 rng(0);
+  auto &pool = ThreadPool::global();
+  uint32_t batch = pool.num_threads();
+  size_t ggsw_size = (size_t)l_gadget * 4 * polynomial_size / 2;
+  std::vector<uint64_t> lut_vector(2 * polynomial_size);
+  for (auto &element : lut_vector)
+    element = rng();
+  std::vector<uint32_t> lut_vector_indexes(batch, 0);
+  std::vector<uint64_t> lwe_in((size_t)batch * (input_lwe_dimension + 1));
+  for (auto &element : lwe_in)
+    element = rng();
+  std::vector<uint64_t> lwe_out((size_t)batch * (polynomial_size + 1));
+  std::uniform_real_distribution<double> uniform(-0.5, 0.5);
+
+  printf("n=%u N=%u base_log=%u l_gadget=%u threads=%u\n",
+         input_lwe_dimension, polynomial_size, base_log, l_gadget, batch);
+  printf("%-20s %10s %14s %14s\n", "engine", "BSK MB", "latency ms",
+         "batch ms/ct");
+  for (uint32_t grouping_factor = 0; grouping_factor <= MAX_GROUPING_FACTOR;
+       grouping_factor++) {
+    // grouping_factor = 0 stands for the amortized engine
+    uint32_t ggsw_count =
+        grouping_factor == 0
+            ? input_lwe_dimension
+            : get_multi_bit_ggsw_count(input_lwe_dimension, grouping_factor);
+    std::vector<double2> bsk(ggsw_count * ggsw_size);
+    for (auto &element : bsk)
+      element = {uniform(rng), uniform(rng)};
+    auto run = [&](uint32_t num_samples) {
+      if (grouping_factor == 0)
+        cpu_bootstrap_amortized_lwe_ciphertext_vector(
+            lwe_out.data(), lut_vector.data(), lut_vector_indexes.data(),
+            lwe_in.data(), bsk.data(), input_lwe_dimension, polynomial_size,
+            base_log, l_gadget, num_samples, 0);
+      else
+        cpu_bootstrap_multi_bit_lwe_ciphertext_vector(
+            lwe_out.data(), lut_vector.data(), lut_vector_indexes.data(),
+            lwe_in.data(), bsk.data(), input_lwe_dimension, polynomial_size,
+            base_log, l_gadget, grouping_factor, num_samples, 0);
+    };
+    double latency = time_ns([&] { run(1); }, 3);
+    double batch_time = time_ns([&] { run(batch); }, 2) / batch;
+    char name[32];
+    if (grouping_factor == 0)
+      snprintf(name, sizeof(name), "amortized");
+    else
+      snprintf(name, sizeof(name), "multi_bit g=%u", grouping_factor);
+    printf("%-20s %10.1f %14.2f %14.2f\n", name,
+           bsk.size() * sizeof(double2) / 1e6, latency / 1e6,
+           batch_time / 1e6);
+  }
+  return 0;
+}
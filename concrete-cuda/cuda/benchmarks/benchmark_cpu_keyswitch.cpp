@@ -0,0 +1,119 @@
+#include "keyswitch.hpp"
+#include "keyswitch_coefficient_major.hpp"
+#include "keyswitch_gemm.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+// Compares the per ciphertext keyswitch with the tiled one, the digit
+// matrix product one and the seeded KSK one on growing batches. For each
+// batch size it prints the time per ciphertext and the number of KSK bytes
+// streamed from memory per ciphertext: once per ciphertext for the per
+// ciphertext engine, once per group of sample_tile ciphertexts for the tiled
+// one. The seeded engine only streams the KSK bodies but regenerates the
+// masks once per group, the truncated one streams half of the tiled bytes.
+// The coefficient-major engine is timed without the layout conversions.
+//
+// Usage: benchmark_cpu_keyswitch [lwe_dimension_before lwe_dimension_after
+//                                 base_log l_gadget]
+
+template <typename F> double time_ns(F &&f, int repetitions) {
+  f();
+  auto start = std::chrono::steady_clock::now();
+  for (int r = 0; r < repetitions; r++)
+    f();
+  auto stop = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(stop - start).count() /
+         repetitions;
+}
+
+int main(int argc, char **argv) {
+  uint32_t lwe_dimension_before = 2048, lwe_dimension_after = 750;
+  uint32_t base_log = 3, l_gadget = 5;
+  if (argc == 5) {
+    lwe_dimension_before = atoi(argv[1]);
+    lwe_dimension_after = atoi(argv[2]);
+    base_log = atoi(argv[3]);
+    l_gadget = atoi(argv[4]);
+  }
+
+  std::mt19937_64 rng(0);
+  size_t ksk_size = (size_t)lwe_dimension_before * l_gadget * (lwe_dimension_after + 1);
+  std::vector<uint64_t> ksk(ksk_size);
+  for (auto &element : ksk)
+    element = rng();
+  size_t ksk_bytes = ksk_size * sizeof(uint64_t);
+  std::vector<uint64_t> ksk_bodies((size_t)lwe_dimension_before * l_gadget);
+  for (auto &element : ksk_bodies)
+    element = rng();
+  uint8_t seed[16] = {0};
+  std::vector<uint32_t> truncated_ksk(ksk_size);
+  cpu_truncate_lwe_keyswitch_key(truncated_ksk.data(), ksk.data(),
+                                 lwe_dimension_before, lwe_dimension_after,
+                                 l_gadget);
+
+  auto &pool = ThreadPool::global();
+  printf("n_before=%u n_after=%u base_log=%u l_gadget=%u threads=%u KSK=%.1f MB\n",
+         lwe_dimension_before, lwe_dimension_after, base_log, l_gadget,
+         pool.num_threads(), ksk_bytes / 1e6);
+  printf("%8s %14s %14s %14s %14s %14s %14s %16s %16s %12s\n", "batch", "ns/ct",
+         "tiled ns/ct", "gemm ns/ct", "seeded ns/ct", "trunc ns/ct",
+         "cm ns/ct", "KSK B/ct", "tiled KSK B/ct", "sample_tile");
+
+  for (uint32_t num_samples = 1; num_samples <= 1024; num_samples *= 4) {
+    std::vector<uint64_t> lwe_in((size_t)num_samples * (lwe_dimension_before + 1));
+    std::vector<uint64_t> lwe_out((size_t)num_samples * (lwe_dimension_after + 1));
+    for (auto &element : lwe_in)
+      element = rng();
+    int repetitions = std::max(1u, 64 / num_samples);
+
+    double untiled = time_ns([&] {
+      cpu_keyswitch_lwe_ciphertext_vector<uint64_t>(
+          lwe_out.data(), lwe_in.data(), ksk.data(), lwe_dimension_before,
+          lwe_dimension_after, base_log, l_gadget, num_samples);
+    }, repetitions);
+
+    auto tiling = get_keyswitch_tiling<uint64_t>(
+        lwe_dimension_before, lwe_dimension_after, l_gadget, num_samples,
+        pool.num_threads());
+    double tiled = time_ns([&] {
+      cpu_keyswitch_tiled_lwe_ciphertext_vector<uint64_t>(
+          lwe_out.data(), lwe_in.data(), ksk.data(), lwe_dimension_before,
+          lwe_dimension_after, base_log, l_gadget, num_samples, tiling);
+    }, repetitions);
+    double gemm = time_ns([&] {
+      cpu_keyswitch_gemm_lwe_ciphertext_vector<uint64_t>(
+          lwe_out.data(), lwe_in.data(), ksk.data(), lwe_dimension_before,
+          lwe_dimension_after, base_log, l_gadget, num_samples);
+    }, repetitions);
+    double seeded = time_ns([&] {
+      cpu_keyswitch_seeded_lwe_ciphertext_vector<uint64_t>(
+          lwe_out.data(), lwe_in.data(), ksk_bodies.data(), seed,
+          lwe_dimension_before, lwe_dimension_after, base_log, l_gadget,
+          num_samples);
+    }, repetitions);
+    double truncated = time_ns([&] {
+      cpu_keyswitch_truncated_lwe_ciphertext_vector(
+          lwe_out.data(), lwe_in.data(), truncated_ksk.data(),
+          lwe_dimension_before, lwe_dimension_after, base_log, l_gadget,
+          num_samples);
+    }, repetitions);
+    double coefficient_major = time_ns([&] {
+      cpu_keyswitch_coefficient_major_lwe_ciphertext_vector<uint64_t>(
+          lwe_out.data(), lwe_in.data(), ksk.data(), lwe_dimension_before,
+          lwe_dimension_after, base_log, l_gadget, num_samples);
+    }, repetitions);
+    size_t tiled_bytes = get_keyswitch_tiled_ksk_bytes<uint64_t>(
+        tiling, lwe_dimension_before, lwe_dimension_after, l_gadget,
+        num_samples);
+
+    printf("%8u %14.0f %14.0f %14.0f %14.0f %14.0f %14.0f %16zu %16zu %12u\n",
+           num_samples, untiled / num_samples, tiled / num_samples,
+           gemm / num_samples, seeded / num_samples, truncated / num_samples,
+           coefficient_major / num_samples, ksk_bytes,
+           tiled_bytes / num_samples, tiling.sample_tile);
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,189 @@
+#include "keyswitch.hpp"
+#include "parameters.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <random>
+#include <tuple>
+#include <vector>
+
+// Roofline report of the host keyswitch over the parameter table
+//
+// For every (norm, p) entry of get_parameters, keyswitches batches of 64
+// bits ciphertexts from dimension k * N to nSmall with ksLevel levels of
+// base 2^ksLogBase, with the per ciphertext engine and the tiled one. For
+// each batch size it prints the time per ciphertext, the KSK bytes streamed
+// from memory per ciphertext, and the bandwidth this amounts to, also as a
+// percentage of the peak bandwidth measured by a STREAM triad on the same
+// threads. An engine close to the peak is bandwidth bound: only moving
+// fewer KSK bytes (tiling, truncation, seeding) makes it faster. Far below
+// the peak it is bound by the decomposition and the multiply-adds.
+//
+// The caches are evicted before each timed keyswitch, as the bootstrap that
+// follows a keyswitch in a circuit would, so that small KSKs are not served
+// from the last level cache. The KSK bytes are those of all the rows, rows
+// multiplied by a zero digit are skipped by the engines so the bandwidth is
+// an upper bound. Within a batch the per ciphertext engine reads the KSK
+// again for each ciphertext, from the caches when it fits there: a bandwidth
+// above the peak means the KSK was not streamed from memory. Entries with
+// the same keyswitch parameters share their measures.
+//
+// Usage: benchmark_cpu_keyswitch_parameters [norm p]
+
+template <typename F> double time_ns(F &&f, int repetitions) {
+  f();
+  auto start = std::chrono::steady_clock::now();
+  for (int r = 0; r < repetitions; r++)
+    f();
+  auto stop = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(stop - start).count() /
+         repetitions;
+}
+
+/// Average time of f with caches evicted by writing to evict before each run
+template <typename F>
+double time_cold_ns(F &&f, int repetitions, std::vector<uint64_t> &evict) {
+  double total_ns = 0;
+  for (int r = 0; r < repetitions; r++) {
+    for (size_t k = 0; k < evict.size(); k++)
+      evict[k] += k;
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto stop = std::chrono::steady_clock::now();
+    total_ns += std::chrono::duration<double, std::nano>(stop - start).count();
+  }
+  return total_ns / repetitions;
+}
+
+/// Best bandwidth in GB/s of the STREAM triad a = b + s * c on arrays much
+/// larger than the caches, counting 3 words of traffic per element as
+/// STREAM does
+double get_stream_triad_bandwidth(ThreadPool &pool) {
+  size_t size = (size_t)1 << 23;
+  std::vector<double> a(size, 0.), b(size, 1.), c(size, 2.);
+  uint32_t num_chunks = pool.num_threads();
+  size_t chunk_size = (size + num_chunks - 1) / num_chunks;
+  double best_ns = 1e300;
+  for (int trial = 0; trial < 5; trial++) {
+    double ns = time_ns([&] {
+      pool.parallel_for(0, num_chunks, [&](uint32_t chunk) {
+        size_t first = chunk * chunk_size;
+        size_t last = std::min(first + chunk_size, size);
+        for (size_t k = first; k < last; k++)
+          a[k] = b[k] + 3. * c[k];
+      });
+    }, 1);
+    best_ns = std::min(best_ns, ns);
+  }
+  return 3. * sizeof(double) * size / best_ns;
+}
+
+struct KeyswitchMeasure {
+  double ns_per_ct;
+  double ksk_bytes_per_ct;
+  double tiled_ns_per_ct;
+  double tiled_ksk_bytes_per_ct;
+};
+
+int main(int argc, char **argv) {
+  int first_norm = 1, last_norm = NORM2_MAX, first_p = 1, last_p = P_MAX;
+  if (argc == 3) {
+    first_norm = last_norm = atoi(argv[1]);
+    first_p = last_p = atoi(argv[2]);
+  }
+  const uint32_t batch_sizes[] = {1, 16, 128};
+
+  auto &pool = ThreadPool::global();
+  double peak = get_stream_triad_bandwidth(pool);
+  printf("threads=%u STREAM triad peak=%.1f GB/s\n", pool.num_threads(), peak);
+  printf("%4s %2s %8s %7s %2s %8s %6s %10s %12s %8s %6s %12s %12s %8s %6s\n",
+         "norm", "p", "n_before", "n_after", "l", "base_log", "batch", "ns/ct",
+         "KSK B/ct", "GB/s", "%peak", "tiled ns/ct", "tiled B/ct",
+         "GB/s", "%peak");
+
+  // Large enough for every entry, the content does not matter for the time
+  size_t max_ksk_size = 0;
+  uint32_t max_n_before = 0;
+  for (int norm = first_norm; norm <= last_norm; norm++) {
+    for (int p = first_p; p <= last_p; p++) {
+      auto params = get_parameters(norm, p);
+      uint32_t n_before = params->k << params->polynomialSize;
+      max_ksk_size = std::max<size_t>(max_ksk_size, (size_t)n_before *
+                                                        params->ksLevel *
+                                                        (params->nSmall + 1));
+      max_n_before = std::max(max_n_before, n_before);
+    }
+  }
+  std::mt19937_64 rng(0);
+  std::vector<uint64_t> ksk(max_ksk_size);
+  for (auto &element : ksk)
+    element = rng();
+  std::vector<uint64_t> lwe_in((size_t)batch_sizes[2] * (max_n_before + 1));
+  for (auto &element : lwe_in)
+    element = rng();
+  std::vector<uint64_t> lwe_out;
+  std::vector<uint64_t> evict((size_t)1 << 24);
+
+  std::map<std::tuple<uint32_t, uint32_t, uint32_t, uint32_t, uint32_t>,
+           KeyswitchMeasure>
+      measures;
+  for (int norm = first_norm; norm <= last_norm; norm++) {
+    for (int p = first_p; p <= last_p; p++) {
+      auto params = get_parameters(norm, p);
+      if (params->k == 0)
+        continue;
+      uint32_t lwe_dimension_before = params->k << params->polynomialSize;
+      uint32_t lwe_dimension_after = params->nSmall;
+      uint32_t base_log = params->ksLogBase, l_gadget = params->ksLevel;
+
+      for (uint32_t num_samples : batch_sizes) {
+        auto key = std::make_tuple(lwe_dimension_before, lwe_dimension_after,
+                                   base_log, l_gadget, num_samples);
+        if (measures.find(key) == measures.end()) {
+          lwe_out.resize((size_t)num_samples * (lwe_dimension_after + 1));
+          int repetitions = std::max(1u, 16 / num_samples);
+          KeyswitchMeasure measure;
+          measure.ns_per_ct = time_cold_ns([&] {
+            cpu_keyswitch_lwe_ciphertext_vector<uint64_t>(
+                lwe_out.data(), lwe_in.data(), ksk.data(), lwe_dimension_before,
+                lwe_dimension_after, base_log, l_gadget, num_samples);
+          }, repetitions, evict) / num_samples;
+          measure.ksk_bytes_per_ct = sizeof(uint64_t) *
+                                     (double)lwe_dimension_before * l_gadget *
+                                     (lwe_dimension_after + 1);
+
+          auto tiling = get_keyswitch_tiling<uint64_t>(
+              lwe_dimension_before, lwe_dimension_after, l_gadget, num_samples,
+              pool.num_threads());
+          measure.tiled_ns_per_ct = time_cold_ns([&] {
+            cpu_keyswitch_tiled_lwe_ciphertext_vector<uint64_t>(
+                lwe_out.data(), lwe_in.data(), ksk.data(), lwe_dimension_before,
+                lwe_dimension_after, base_log, l_gadget, num_samples, tiling);
+          }, repetitions, evict) / num_samples;
+          measure.tiled_ksk_bytes_per_ct =
+              (double)get_keyswitch_tiled_ksk_bytes<uint64_t>(
+                  tiling, lwe_dimension_before, lwe_dimension_after, l_gadget,
+                  num_samples) /
+              num_samples;
+          measures[key] = measure;
+        }
+
+        auto &measure = measures[key];
+        double bandwidth = measure.ksk_bytes_per_ct / measure.ns_per_ct;
+        double tiled_bandwidth =
+            measure.tiled_ksk_bytes_per_ct / measure.tiled_ns_per_ct;
+        printf("%4d %2d %8u %7u %2u %8u %6u %10.0f %12.0f %8.2f %6.1f %12.0f "
+               "%12.0f %8.2f %6.1f\n",
+               norm, p, lwe_dimension_before, lwe_dimension_after, l_gadget,
+               base_log, num_samples, measure.ns_per_ct,
+               measure.ksk_bytes_per_ct, bandwidth, 100. * bandwidth / peak,
+               measure.tiled_ns_per_ct, measure.tiled_ksk_bytes_per_ct,
+               tiled_bandwidth, 100. * tiled_bandwidth / peak);
+        fflush(stdout);
+      }
+    }
+  }
+  return EXIT_SUCCESS;
+}
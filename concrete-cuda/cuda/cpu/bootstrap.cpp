@@ -0,0 +1,47 @@
+#include "bootstrap.h"
+#include "crypto/bootstrapping_key.hpp"
+#include "fft/bnsmfft.hpp"
+
+#include <cstdint>
+
+/* Build the tables of the negacyclic FFT of the given polynomial size on the
+ * CPU
+ *
+ * Counterpart of cuda_initialize_twiddles, gpu_index is not used. Calling it
+ * is optional: the tables are otherwise built on the first bootstrap or key
+ * conversion with this polynomial size.
+ */
+void cpu_initialize_twiddles(uint32_t polynomial_size, uint32_t /*gpu_index*/) {
+  NegacyclicFFT::get(polynomial_size);
+}
+
+/* Convert a bootstrapping key of 32 bits to the Fourier domain on the CPU
+ *
+ * Same arguments and same layout of dest as cuda_convert_lwe_bootstrap_key_32,
+ * but src and dest live in host memory. v_stream and gpu_index are not used.
+ */
+void cpu_convert_lwe_bootstrap_key_32(void *dest, void *src,
+                                      void * /*v_stream*/,
+                                      uint32_t /*gpu_index*/,
+                                      uint32_t input_lwe_dim, uint32_t glwe_dim,
+                                      uint32_t l_gadget,
+                                      uint32_t polynomial_size) {
+  cpu_convert_lwe_bootstrap_key<uint32_t, int32_t>(
+      (double2 *)dest, (int32_t *)src, input_lwe_dim, glwe_dim, l_gadget,
+      polynomial_size);
+}
+
+/* Convert a bootstrapping key of 64 bits to the Fourier domain on the CPU
+ *
+ * See cpu_convert_lwe_bootstrap_key_32
+ */
+void cpu_convert_lwe_bootstrap_key_64(void *dest, void *src,
+                                      void * /*v_stream*/,
+                                      uint32_t /*gpu_index*/,
+                                      uint32_t input_lwe_dim, uint32_t glwe_dim,
+                                      uint32_t l_gadget,
+                                      uint32_t polynomial_size) {
+  cpu_convert_lwe_bootstrap_key<uint64_t, int64_t>(
+      (double2 *)dest, (int64_t *)src, input_lwe_dim, glwe_dim, l_gadget,
+      polynomial_size);
+}
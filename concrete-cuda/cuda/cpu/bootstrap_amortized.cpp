@@ -0,0 +1,352 @@
+#include "bootstrap_amortized.hpp"
+#include "bootstrap.h"
+
+#include <cstdint>
+
+/* Perform the amortized bootstrap on a batch of input LWE ciphertexts for 32
+ * bits on the CPU
+ *
+ * Same arguments and same layouts as
+ * cuda_bootstrap_amortized_lwe_ciphertext_vector_32, with the bootstrapping
+ * key converted by cpu_convert_lwe_bootstrap_key_32, but all the buffers live
+ * in host memory. v_stream and max_shared_memory are not used, the function
+ * returns once the batch is bootstrapped. As on the GPU, nothing is done for
+ * polynomial sizes other than 512, 1024, 2048, 4096 and 8192.
+ *
+ * Each ciphertext is bootstrapped by one thread of the global pool, the FFTs
+ * and the products in the Fourier domain are vectorized with AVX2/AVX-512
+ * when the CPU supports it
+ */
+void cpu_bootstrap_amortized_lwe_ciphertext_vector_32(
+    void * /*v_stream*/, void *lwe_out, void *lut_vector,
+    void *lut_vector_indexes, void *lwe_in, void *bootstrapping_key,
+    uint32_t input_lwe_dimension, uint32_t polynomial_size, uint32_t base_log,
+    uint32_t l_gadget, uint32_t num_samples, uint32_t /*num_lut_vectors*/,
+    uint32_t lwe_idx, uint32_t /*max_shared_memory*/) {
+  if (!is_supported_polynomial_size(polynomial_size))
+    return;
+  cpu_bootstrap_amortized_lwe_ciphertext_vector(
+      (uint32_t *)lwe_out, (uint32_t *)lut_vector,
+      (uint32_t *)lut_vector_indexes, (uint32_t *)lwe_in,
+      (double2 *)bootstrapping_key, input_lwe_dimension, polynomial_size,
+      base_log, l_gadget, num_samples, lwe_idx);
+}
+
+/* Perform the amortized bootstrap on a batch of input LWE ciphertexts for 64
+ * bits on the CPU
+ *
+ * See cpu_bootstrap_amortized_lwe_ciphertext_vector_32
+ */
+void cpu_bootstrap_amortized_lwe_ciphertext_vector_64(
+    void * /*v_stream*/, void *lwe_out, void *lut_vector,
+    void *lut_vector_indexes, void *lwe_in, void *bootstrapping_key,
+    uint32_t input_lwe_dimension, uint32_t polynomial_size, uint32_t base_log,
+    uint32_t l_gadget, uint32_t num_samples, uint32_t /*num_lut_vectors*/,
+    uint32_t lwe_idx, uint32_t /*max_shared_memory*/) {
+  if (!is_supported_polynomial_size(polynomial_size))
+    return;
+  cpu_bootstrap_amortized_lwe_ciphertext_vector(
+      (uint64_t *)lwe_out, (uint64_t *)lut_vector,
+      (uint32_t *)lut_vector_indexes, (uint64_t *)lwe_in,
+      (double2 *)bootstrapping_key, input_lwe_dimension, polynomial_size,
+      base_log, l_gadget, num_samples, lwe_idx);
+}
+
+/* Modulus switch a batch of LWE ciphertexts of 32 bits to [0, 2N[ in 16 bits
+ * words on the CPU, the input format of
+ * cpu_bootstrap_amortized_modulus_switched_lwe_ciphertext_vector_32
+ *
+ * Each element x becomes the exact rounding of x * 2N / 2^32 modulo 2N,
+ * computed with integer shifts and vectorized with AVX2/AVX-512. v_stream
+ * is not used.
+ */
+void cpu_modulus_switch_lwe_ciphertext_vector_32(
+    void * /*v_stream*/, void *lwe_out, void *lwe_in, uint32_t lwe_dimension,
+    uint32_t polynomial_size, uint32_t num_samples) {
+  cpu_modulus_switch_lwe_ciphertext_vector((uint16_t *)lwe_out,
+                                           (uint32_t *)lwe_in, lwe_dimension,
+                                           polynomial_size, num_samples);
+}
+
+/* Modulus switch a batch of LWE ciphertexts of 64 bits to [0, 2N[ in 16 bits
+ * words on the CPU
+ *
+ * See cpu_modulus_switch_lwe_ciphertext_vector_32
+ */
+void cpu_modulus_switch_lwe_ciphertext_vector_64(
+    void * /*v_stream*/, void *lwe_out, void *lwe_in, uint32_t lwe_dimension,
+    uint32_t polynomial_size, uint32_t num_samples) {
+  cpu_modulus_switch_lwe_ciphertext_vector((uint16_t *)lwe_out,
+                                           (uint64_t *)lwe_in, lwe_dimension,
+                                           polynomial_size, num_samples);
+}
+
+/* Perform the amortized bootstrap for 32 bits on the CPU on a batch of LWE
+ * ciphertexts already modulus switched to [0, 2N[ in 16 bits words, as
+ * written by cpu_keyswitch_modulus_switched_lwe_ciphertext_vector_32
+ *
+ * See cpu_bootstrap_amortized_lwe_ciphertext_vector_32
+ */
+void cpu_bootstrap_amortized_modulus_switched_lwe_ciphertext_vector_32(
+    void * /*v_stream*/, void *lwe_out, void *lut_vector,
+    void *lut_vector_indexes, void *lwe_in, void *bootstrapping_key,
+    uint32_t input_lwe_dimension, uint32_t polynomial_size, uint32_t base_log,
+    uint32_t l_gadget, uint32_t num_samples, uint32_t /*num_lut_vectors*/,
+    uint32_t lwe_idx, uint32_t /*max_shared_memory*/) {
+  if (!is_supported_polynomial_size(polynomial_size))
+    return;
+  cpu_bootstrap_amortized_lwe_ciphertext_vector<uint32_t, uint16_t>(
+      (uint32_t *)lwe_out, (uint32_t *)lut_vector,
+      (uint32_t *)lut_vector_indexes, (uint16_t *)lwe_in,
+      (double2 *)bootstrapping_key, input_lwe_dimension, polynomial_size,
+      base_log, l_gadget, num_samples, lwe_idx);
+}
+
+/* Perform the amortized bootstrap for 64 bits on the CPU on a batch of LWE
+ * ciphertexts already modulus switched to [0, 2N[ in 16 bits words
+ *
+ * See cpu_bootstrap_amortized_modulus_switched_lwe_ciphertext_vector_32
+ */
+void cpu_bootstrap_amortized_modulus_switched_lwe_ciphertext_vector_64(
+    void * /*v_stream*/, void *lwe_out, void *lut_vector,
+    void *lut_vector_indexes, void *lwe_in, void *bootstrapping_key,
+    uint32_t input_lwe_dimension, uint32_t polynomial_size, uint32_t base_log,
+    uint32_t l_gadget, uint32_t num_samples, uint32_t /*num_lut_vectors*/,
+    uint32_t lwe_idx, uint32_t /*max_shared_memory*/) {
+  if (!is_supported_polynomial_size(polynomial_size))
+    return;
+  cpu_bootstrap_amortized_lwe_ciphertext_vector<uint64_t, uint16_t>(
+      (uint64_t *)lwe_out, (uint64_t *)lut_vector,
+      (uint32_t *)lut_vector_indexes, (uint16_t *)lwe_in,
+      (double2 *)bootstrapping_key, input_lwe_dimension, polynomial_size,
+      base_log, l_gadget, num_samples, lwe_idx);
+}
+
+/* Perform the amortized bootstrap on a batch of input LWE ciphertexts for 32
+ * bits on the CPU, with a GLWE accumulator of any dimension
+ *
+ * Same arguments and layouts as
+ * cuda_bootstrap_amortized_lwe_ciphertext_vector_with_glwe_dimension_32: the
+ * bootstrapping key is converted with the same glwe_dimension, each test
+ * vector holds glwe_dimension + 1 polynomials and the output ciphertexts are
+ * of dimension glwe_dimension * polynomial_size.
+ */
+void cpu_bootstrap_amortized_lwe_ciphertext_vector_with_glwe_dimension_32(
+    void * /*v_stream*/, void *lwe_out, void *lut_vector,
+    void *lut_vector_indexes, void *lwe_in, void *bootstrapping_key,
+    uint32_t input_lwe_dimension, uint32_t glwe_dimension,
+    uint32_t polynomial_size, uint32_t base_log, uint32_t l_gadget,
+    uint32_t num_samples, uint32_t /*num_lut_vectors*/, uint32_t lwe_idx,
+    uint32_t /*max_shared_memory*/) {
+  if (!is_supported_polynomial_size(polynomial_size) || glwe_dimension == 0)
+    return;
+  cpu_bootstrap_amortized_lwe_ciphertext_vector(
+      (uint32_t *)lwe_out, (uint32_t *)lut_vector,
+      (uint32_t *)lut_vector_indexes, (uint32_t *)lwe_in,
+      (double2 *)bootstrapping_key, input_lwe_dimension, polynomial_size,
+      base_log, l_gadget, num_samples, lwe_idx, glwe_dimension);
+}
+
+/* Perform the amortized bootstrap on a batch of input LWE ciphertexts for 64
+ * bits on the CPU, with a GLWE accumulator of any dimension
+ *
+ * See cpu_bootstrap_amortized_lwe_ciphertext_vector_with_glwe_dimension_32
+ */
+void cpu_bootstrap_amortized_lwe_ciphertext_vector_with_glwe_dimension_64(
+    void * /*v_stream*/, void *lwe_out, void *lut_vector,
+    void *lut_vector_indexes, void *lwe_in, void *bootstrapping_key,
+    uint32_t input_lwe_dimension, uint32_t glwe_dimension,
+    uint32_t polynomial_size, uint32_t base_log, uint32_t l_gadget,
+    uint32_t num_samples, uint32_t /*num_lut_vectors*/, uint32_t lwe_idx,
+    uint32_t /*max_shared_memory*/) {
+  if (!is_supported_polynomial_size(polynomial_size) || glwe_dimension == 0)
+    return;
+  cpu_bootstrap_amortized_lwe_ciphertext_vector(
+      (uint64_t *)lwe_out, (uint64_t *)lut_vector,
+      (uint32_t *)lut_vector_indexes, (uint64_t *)lwe_in,
+      (double2 *)bootstrapping_key, input_lwe_dimension, polynomial_size,
+      base_log, l_gadget, num_samples, lwe_idx, glwe_dimension);
+}
+
+/* Evaluate lut_count functions of each input LWE ciphertext of 32 bits with
+ * one blind rotation on the CPU
+ *
+ * Same arguments as
+ * cpu_bootstrap_amortized_lwe_ciphertext_vector_with_glwe_dimension_32, plus:
+ *  - lut_vector: test vectors packed by cpu_pack_many_lut_test_vector_32
+ *  - lut_count: number of functions packed in each test vector, a power of
+ *    two with half a box of the test vectors spanning at least lut_count
+ *    coefficients
+ *  - lwe_out: num_samples * lut_count ciphertexts, the lut_count outputs of
+ *    each input being contiguous
+ * Nothing is done if lut_count is not a power of two or is larger than
+ * polynomial_size.
+ */
+void cpu_bootstrap_amortized_many_lut_lwe_ciphertext_vector_32(
+    void * /*v_stream*/, void *lwe_out, void *lut_vector,
+    void *lut_vector_indexes, void *lwe_in, void *bootstrapping_key,
+    uint32_t input_lwe_dimension, uint32_t glwe_dimension,
+    uint32_t polynomial_size, uint32_t base_log, uint32_t l_gadget,
+    uint32_t num_samples, uint32_t /*num_lut_vectors*/, uint32_t lwe_idx,
+    uint32_t lut_count, uint32_t /*max_shared_memory*/) {
+  if (!is_supported_polynomial_size(polynomial_size) || glwe_dimension == 0 ||
+      lut_count == 0 || (lut_count & (lut_count - 1)) != 0 ||
+      lut_count > polynomial_size)
+    return;
+  cpu_bootstrap_amortized_many_lut_lwe_ciphertext_vector(
+      (uint32_t *)lwe_out, (uint32_t *)lut_vector,
+      (uint32_t *)lut_vector_indexes, (uint32_t *)lwe_in,
+      (double2 *)bootstrapping_key, input_lwe_dimension, polynomial_size,
+      base_log, l_gadget, num_samples, lwe_idx, lut_count, glwe_dimension);
+}
+
+/* Evaluate lut_count functions of each input LWE ciphertext of 64 bits with
+ * one blind rotation on the CPU
+ *
+ * See cpu_bootstrap_amortized_many_lut_lwe_ciphertext_vector_32
+ */
+void cpu_bootstrap_amortized_many_lut_lwe_ciphertext_vector_64(
+    void * /*v_stream*/, void *lwe_out, void *lut_vector,
+    void *lut_vector_indexes, void *lwe_in, void *bootstrapping_key,
+    uint32_t input_lwe_dimension, uint32_t glwe_dimension,
+    uint32_t polynomial_size, uint32_t base_log, uint32_t l_gadget,
+    uint32_t num_samples, uint32_t /*num_lut_vectors*/, uint32_t lwe_idx,
+    uint32_t lut_count, uint32_t /*max_shared_memory*/) {
+  if (!is_supported_polynomial_size(polynomial_size) || glwe_dimension == 0 ||
+      lut_count == 0 || (lut_count & (lut_count - 1)) != 0 ||
+      lut_count > polynomial_size)
+    return;
+  cpu_bootstrap_amortized_many_lut_lwe_ciphertext_vector(
+      (uint64_t *)lwe_out, (uint64_t *)lut_vector,
+      (uint32_t *)lut_vector_indexes, (uint64_t *)lwe_in,
+      (double2 *)bootstrapping_key, input_lwe_dimension, polynomial_size,
+      base_log, l_gadget, num_samples, lwe_idx, lut_count, glwe_dimension);
+}
+
+/* Pack lut_count test vectors of 32 bits, each glwe_dimension mask
+ * polynomials followed by a body polynomial, into the test vector lut_out of
+ * the many-LUT bootstrap of the CPU or the GPU
+ */
+void cpu_pack_many_lut_test_vector_32(void *lut_out, void *luts,
+                                      uint32_t lut_count,
+                                      uint32_t glwe_dimension,
+                                      uint32_t polynomial_size) {
+  pack_many_lut_test_vector((uint32_t *)lut_out, (uint32_t *)luts, lut_count,
+                            glwe_dimension, polynomial_size);
+}
+
+/* Pack lut_count test vectors of 64 bits into the test vector lut_out of the
+ * many-LUT bootstrap
+ *
+ * See cpu_pack_many_lut_test_vector_32
+ */
+void cpu_pack_many_lut_test_vector_64(void *lut_out, void *luts,
+                                      uint32_t lut_count,
+                                      uint32_t glwe_dimension,
+                                      uint32_t polynomial_size) {
+  pack_many_lut_test_vector((uint64_t *)lut_out, (uint64_t *)luts, lut_count,
+                            glwe_dimension, polynomial_size);
+}
+
+/* Perform the amortized bootstrap on a batch of input LWE ciphertexts for 32
+ * bits on the CPU, writing the GLWE accumulators instead of the extracted
+ * LWE ciphertexts
+ *
+ *  - glwe_out: num_samples GLWE ciphertexts of glwe_dimension + 1
+ *    polynomials, as uint32_t coefficients if fourier_output is 0, or as
+ *    polynomial_size / 2 double2 per polynomial in the Fourier domain of
+ *    the bootstrapping keys otherwise
+ *
+ * The other arguments are the ones of
+ * cpu_bootstrap_amortized_lwe_ciphertext_vector_with_glwe_dimension_32.
+ * Extracting coefficient 0 of the accumulators gives the output of that
+ * function. Host counterpart of
+ * cuda_bootstrap_amortized_glwe_output_lwe_ciphertext_vector_32.
+ */
+void cpu_bootstrap_amortized_glwe_output_lwe_ciphertext_vector_32(
+    void * /*v_stream*/, void *glwe_out, void *lut_vector,
+    void *lut_vector_indexes, void *lwe_in, void *bootstrapping_key,
+    uint32_t input_lwe_dimension, uint32_t glwe_dimension,
+    uint32_t polynomial_size, uint32_t base_log, uint32_t l_gadget,
+    uint32_t num_samples, uint32_t /*num_lut_vectors*/, uint32_t lwe_idx,
+    uint32_t fourier_output, uint32_t /*max_shared_memory*/) {
+  if (!is_supported_polynomial_size(polynomial_size) || glwe_dimension == 0)
+    return;
+  if (fourier_output)
+    cpu_bootstrap_amortized_glwe_output_lwe_ciphertext_vector<uint32_t, double2>(
+        (double2 *)glwe_out, (uint32_t *)lut_vector,
+        (uint32_t *)lut_vector_indexes, (uint32_t *)lwe_in,
+        (double2 *)bootstrapping_key, input_lwe_dimension, polynomial_size,
+        base_log, l_gadget, num_samples, lwe_idx, glwe_dimension);
+  else
+    cpu_bootstrap_amortized_glwe_output_lwe_ciphertext_vector<uint32_t>(
+        (uint32_t *)glwe_out, (uint32_t *)lut_vector,
+        (uint32_t *)lut_vector_indexes, (uint32_t *)lwe_in,
+        (double2 *)bootstrapping_key, input_lwe_dimension, polynomial_size,
+        base_log, l_gadget, num_samples, lwe_idx, glwe_dimension);
+}
+
+/* Perform the amortized bootstrap on a batch of input LWE ciphertexts for 64
+ * bits on the CPU, writing the GLWE accumulators instead of the extracted
+ * LWE ciphertexts
+ *
+ * See cpu_bootstrap_amortized_glwe_output_lwe_ciphertext_vector_32
+ */
+void cpu_bootstrap_amortized_glwe_output_lwe_ciphertext_vector_64(
+    void * /*v_stream*/, void *glwe_out, void *lut_vector,
+    void *lut_vector_indexes, void *lwe_in, void *bootstrapping_key,
+    uint32_t input_lwe_dimension, uint32_t glwe_dimension,
+    uint32_t polynomial_size, uint32_t base_log, uint32_t l_gadget,
+    uint32_t num_samples, uint32_t /*num_lut_vectors*/, uint32_t lwe_idx,
+    uint32_t fourier_output, uint32_t /*max_shared_memory*/) {
+  if (!is_supported_polynomial_size(polynomial_size) || glwe_dimension == 0)
+    return;
+  if (fourier_output)
+    cpu_bootstrap_amortized_glwe_output_lwe_ciphertext_vector<uint64_t, double2>(
+        (double2 *)glwe_out, (uint64_t *)lut_vector,
+        (uint32_t *)lut_vector_indexes, (uint64_t *)lwe_in,
+        (double2 *)bootstrapping_key, input_lwe_dimension, polynomial_size,
+        base_log, l_gadget, num_samples, lwe_idx, glwe_dimension);
+  else
+    cpu_bootstrap_amortized_glwe_output_lwe_ciphertext_vector<uint64_t>(
+        (uint64_t *)glwe_out, (uint64_t *)lut_vector,
+        (uint32_t *)lut_vector_indexes, (uint64_t *)lwe_in,
+        (double2 *)bootstrapping_key, input_lwe_dimension, polynomial_size,
+        base_log, l_gadget, num_samples, lwe_idx, glwe_dimension);
+}
+
+/* Perform the amortized bootstrap on a batch of input LWE ciphertexts for 32
+ * bits that all use the same test vector on the CPU
+ *
+ * Same arguments as cuda_bootstrap_amortized_shared_lut_lwe_ciphertext_vector_32
+ * and same results as cpu_bootstrap_amortized_lwe_ciphertext_vector_32 with
+ * all the indexes at 0: every thread reads the single test vector of
+ * lut_vector, which stays in cache. The other CPU amortized engines also
+ * accept a null lut_vector_indexes for this mode.
+ */
+void cpu_bootstrap_amortized_shared_lut_lwe_ciphertext_vector_32(
+    void *v_stream, void *lwe_out, void *lut_vector, void *lwe_in,
+    void *bootstrapping_key, uint32_t input_lwe_dimension,
+    uint32_t polynomial_size, uint32_t base_log, uint32_t l_gadget,
+    uint32_t num_samples, uint32_t max_shared_memory) {
+  cpu_bootstrap_amortized_lwe_ciphertext_vector_32(
+      v_stream, lwe_out, lut_vector, nullptr, lwe_in, bootstrapping_key,
+      input_lwe_dimension, polynomial_size, base_log, l_gadget, num_samples, 1,
+      0, max_shared_memory);
+}
+
+/* Perform the amortized bootstrap on a batch of input LWE ciphertexts for 64
+ * bits that all use the same test vector on the CPU
+ *
+ * See cpu_bootstrap_amortized_shared_lut_lwe_ciphertext_vector_32
+ */
+void cpu_bootstrap_amortized_shared_lut_lwe_ciphertext_vector_64(
+    void *v_stream, void *lwe_out, void *lut_vector, void *lwe_in,
+    void *bootstrapping_key, uint32_t input_lwe_dimension,
+    uint32_t polynomial_size, uint32_t base_log, uint32_t l_gadget,
+    uint32_t num_samples, uint32_t max_shared_memory) {
+  cpu_bootstrap_amortized_lwe_ciphertext_vector_64(
+      v_stream, lwe_out, lut_vector, nullptr, lwe_in, bootstrapping_key,
+      input_lwe_dimension, polynomial_size, base_log, l_gadget, num_samples, 1,
+      0, max_shared_memory);
+}
@@ -0,0 +1,504 @@
+#ifndef CNCRT_CPU_PBS_H
+#define CNCRT_CPU_PBS_H
+
+#include "complex/operations.hpp"
+#include "crypto/bootstrapping_key.hpp"
+#include "crypto/gadget.hpp"
+#include "crypto/torus.hpp"
+#include "fft/bnsmfft.hpp"
+#include "polynomial/functions.hpp"
+#include "polynomial/polynomial_math.hpp"
+#include "sample_extract.hpp"
+#include "utils/simd.hpp"
+#include "utils/thread_pool.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+/// Scratch of the bootstrap of one ciphertext, the counterpart of the
+/// shared or global memory of a block of device_bootstrap_amortized. The
+/// rotated accumulator and the products in the Fourier domain hold the
+/// glwe_dimension + 1 polynomials of a GLWE ciphertext, masks first.
+template <typename Torus> struct BootstrapBuffers {
+  std::vector<int16_t> accumulator_decomposed;
+  std::vector<Torus> accumulator_rotated;
+  std::vector<double2> accumulator_fft;
+  std::vector<double2> res_fft;
+  /// All the decomposed polynomials of an external product in the Fourier
+  /// domain, only used by add_external_product_batched
+  std::vector<double2> decomposed_fft;
+
+  BootstrapBuffers(uint32_t glwe_dimension, uint32_t polynomial_size)
+      : accumulator_decomposed(polynomial_size),
+        accumulator_rotated((glwe_dimension + 1) * polynomial_size),
+        accumulator_fft(polynomial_size / 2),
+        res_fft((glwe_dimension + 1) * polynomial_size / 2) {}
+};
+
+/// Test vector of the ciphertext sample of a batch, of glwe_size
+/// coefficients: lut_vector[lut_vector_indexes[lwe_idx + sample]], or the
+/// single test vector of lut_vector shared by the whole batch when
+/// lut_vector_indexes is null. A shared test vector is read by all the
+/// threads and stays in their caches, and the caller needs no index array.
+template <typename Torus>
+inline const Torus *select_lut(const Torus *lut_vector,
+                               const uint32_t *lut_vector_indexes,
+                               uint32_t lwe_idx, uint32_t sample,
+                               size_t glwe_size) {
+  if (lut_vector_indexes == nullptr)
+    return lut_vector;
+  return &lut_vector[(size_t)lut_vector_indexes[lwe_idx + sample] *
+                     glwe_size];
+}
+
+/// Runs func(first_sample, last_sample) on the chunks of a batch of
+/// num_samples ciphertexts, one chunk per thread of the pool, so that each
+/// task allocates the scratch of its bootstraps once for its whole chunk
+template <typename F>
+void parallel_for_sample_chunks(ThreadPool &pool, uint32_t num_samples,
+                                F &&func) {
+  uint32_t num_chunks = std::min(num_samples, pool.num_threads());
+  pool.parallel_for(0, num_chunks, [&](uint32_t chunk) {
+    func((uint32_t)((uint64_t)num_samples * chunk / num_chunks),
+         (uint32_t)((uint64_t)num_samples * (chunk + 1) / num_chunks));
+  });
+}
+
+/*
+ * External product of the GGSW ggsw of the Fourier bootstrapping key with
+ * the GLWE ciphertext in buffers.accumulator_rotated, added to accumulator
+ *
+ * Each polynomial k of the input is decomposed, each level is switched to
+ * the Fourier domain and multiplied with the row k of the GGSW, whose
+ * column c accumulates into the polynomial c of the result. The result is
+ * then switched back and added to accumulator with add_to_torus.
+ */
+template <typename Torus>
+void add_external_product(Torus *accumulator, const double2 *ggsw,
+                          uint32_t glwe_dimension, uint32_t polynomial_size,
+                          const GadgetMatrix<Torus> &gadget,
+                          uint32_t l_gadget, const NegacyclicFFT &fft,
+                          BootstrapBuffers<Torus> &buffers, SimdLevel level) {
+  uint32_t fft_size = polynomial_size / 2;
+  std::fill(buffers.res_fft.begin(), buffers.res_fft.end(), double2{0., 0.});
+  for (uint32_t decomp_level = 0; decomp_level < l_gadget; decomp_level++) {
+    for (uint32_t k = 0; k <= glwe_dimension; k++) {
+      gadget.decompose_one_level(
+          buffers.accumulator_decomposed.data(),
+          &buffers.accumulator_rotated[k * polynomial_size], decomp_level,
+          polynomial_size);
+      real_to_complex_compressed(buffers.accumulator_fft.data(),
+                                 buffers.accumulator_decomposed.data(),
+                                 polynomial_size);
+      fft.forward(buffers.accumulator_fft.data(), level);
+
+      const double2 *row =
+          get_ith_mask_kth_block(ggsw, 0, k, decomp_level, polynomial_size,
+                                 glwe_dimension, l_gadget);
+      for (uint32_t c = 0; c <= glwe_dimension; c++)
+        polynomial_product_accumulate_in_fourier_domain(
+            &buffers.res_fft[c * fft_size], buffers.accumulator_fft.data(),
+            &row[c * fft_size], fft_size, level);
+    }
+  }
+
+  // Come back to the coefficient representation
+  for (uint32_t c = 0; c <= glwe_dimension; c++) {
+    fft.inverse(&buffers.res_fft[c * fft_size], level);
+    add_to_torus(&buffers.res_fft[c * fft_size],
+                 &accumulator[c * polynomial_size], polynomial_size);
+  }
+}
+
+/*
+ * External product of add_external_product with its forward FFTs batched
+ *
+ * The l_gadget * (glwe_dimension + 1) decomposed polynomials are switched
+ * to the Fourier domain by a single NegacyclicFFT::forward_batch, in the
+ * order of the rows of the GGSW, then multiplied with the whole GGSW by one
+ * polynomial_vector_matrix_product_in_fourier_domain, instead of one FFT
+ * and glwe_dimension + 1 products with a round trip of the result through
+ * memory per decomposed polynomial. The result is bit-identical to the one
+ * of add_external_product. This is the host counterpart of
+ * device_bootstrap_amortized_batched_fft.
+ */
+template <typename Torus>
+void add_external_product_batched(Torus *accumulator, const double2 *ggsw,
+                                  uint32_t glwe_dimension,
+                                  uint32_t polynomial_size,
+                                  const GadgetMatrix<Torus> &gadget,
+                                  uint32_t l_gadget, const NegacyclicFFT &fft,
+                                  BootstrapBuffers<Torus> &buffers,
+                                  SimdLevel level) {
+  uint32_t fft_size = polynomial_size / 2;
+  uint32_t num_rows = l_gadget * (glwe_dimension + 1);
+  buffers.decomposed_fft.resize((size_t)num_rows * fft_size);
+  for (uint32_t decomp_level = 0; decomp_level < l_gadget; decomp_level++) {
+    for (uint32_t k = 0; k <= glwe_dimension; k++) {
+      gadget.decompose_one_level(
+          buffers.accumulator_decomposed.data(),
+          &buffers.accumulator_rotated[k * polynomial_size], decomp_level,
+          polynomial_size);
+      real_to_complex_compressed(
+          &buffers.decomposed_fft[(size_t)(decomp_level *
+                                               (glwe_dimension + 1) +
+                                           k) *
+                                  fft_size],
+          buffers.accumulator_decomposed.data(), polynomial_size);
+    }
+  }
+  fft.forward_batch(buffers.decomposed_fft.data(), num_rows, level);
+  polynomial_vector_matrix_product_in_fourier_domain(
+      buffers.res_fft.data(), buffers.decomposed_fft.data(), ggsw, num_rows,
+      glwe_dimension + 1, fft_size, level);
+
+  // Come back to the coefficient representation
+  for (uint32_t c = 0; c <= glwe_dimension; c++) {
+    fft.inverse(&buffers.res_fft[c * fft_size], level);
+    add_to_torus(&buffers.res_fft[c * fft_size],
+                 &accumulator[c * polynomial_size], polynomial_size);
+  }
+}
+
+/*
+ * Blind rotation of the test vector lut by the phase of one LWE ciphertext,
+ * host counterpart of the loop of device_bootstrap_amortized with the same
+ * steps: the GLWE accumulator, glwe_dimension mask polynomials followed by
+ * the body, is initialized to lut / X^b_hat, then for each mask element a_i
+ * it gets the external product of the i-th GGSW of the Fourier
+ * bootstrapping key with the rounded ACC * (X^a_hat - 1). Mask elements
+ * switched to 0 leave the accumulator unchanged and are skipped.
+ *
+ * With InputTorus = uint16_t the elements of lwe_in are already modulus
+ * switched to [0, 2N[. With batched_fft, the external products are
+ * computed by add_external_product_batched.
+ */
+template <typename Torus, typename InputTorus = Torus>
+void blind_rotate_one_sample(Torus *accumulator, const Torus *lut,
+                             const InputTorus *lwe_in,
+                             const double2 *bootstrapping_key,
+                             uint32_t lwe_mask_size, uint32_t glwe_dimension,
+                             uint32_t polynomial_size, uint32_t base_log,
+                             uint32_t l_gadget, const NegacyclicFFT &fft,
+                             BootstrapBuffers<Torus> &buffers,
+                             SimdLevel level, bool batched_fft = false) {
+  GadgetMatrix<Torus> gadget(base_log, l_gadget);
+
+  // Put "b", the body, in [0, 2N[
+  Torus b_hat = rescale_input_element<Torus>(lwe_in[lwe_mask_size],
+                                             2 * polynomial_size);
+  for (uint32_t c = 0; c <= glwe_dimension; c++)
+    divide_by_monomial_negacyclic(&accumulator[c * polynomial_size],
+                                  &lut[c * polynomial_size], b_hat,
+                                  polynomial_size);
+
+  for (uint32_t iteration = 0; iteration < lwe_mask_size; iteration++) {
+    // Put "a" in [0, 2N[ instead of Zq
+    Torus a_hat = rescale_input_element<Torus>(lwe_in[iteration],
+                                               2 * polynomial_size);
+    if (a_hat % (2 * polynomial_size) == 0)
+      continue;
+
+    // Perform ACC * (X^ä - 1), rounded to the precision of the decomposition
+    for (uint32_t c = 0; c <= glwe_dimension; c++) {
+      Torus *rotated = &buffers.accumulator_rotated[c * polynomial_size];
+      multiply_by_monomial_negacyclic_and_sub_polynomial(
+          &accumulator[c * polynomial_size], rotated, a_hat, polynomial_size);
+      round_to_closest_multiple_inplace(rotated, base_log, l_gadget,
+                                        polynomial_size);
+    }
+
+    const double2 *ggsw =
+        &bootstrapping_key[get_start_ith_ggsw(iteration, polynomial_size,
+                                              glwe_dimension, l_gadget)];
+    if (batched_fft)
+      add_external_product_batched(accumulator, ggsw, glwe_dimension,
+                                   polynomial_size, gadget, l_gadget, fft,
+                                   buffers, level);
+    else
+      add_external_product(accumulator, ggsw, glwe_dimension,
+                           polynomial_size, gadget, l_gadget, fft, buffers,
+                           level);
+  }
+}
+
+/// Logarithm of the modulus 2N the bootstrap switches its input to
+inline uint32_t get_bootstrap_log_modulus(uint32_t polynomial_size) {
+  return __builtin_ctz(2 * polynomial_size);
+}
+
+/*
+ * Integer modulus switch of a batch of LWE ciphertexts to the input domain
+ * of the bootstrap, [0, 2N[, into 16 bits elements: the pre-pass of the
+ * amortized bootstrap, or the input of the bootstraps of already switched
+ * ciphertexts. The batch is cut in chunks of whole ciphertexts spread over
+ * the threads of the pool and each chunk is switched with
+ * modulus_switch_vector.
+ *
+ * With lut_count > 1, a power of two, the elements are switched to
+ * multiples of lut_count in [0, 2N[ for the many-LUT bootstrap: they are
+ * switched to 2N / lut_count and scaled back up, the host counterpart of
+ * device_modulus_switch_lwe_ciphertext_vector.
+ */
+template <typename Torus>
+void cpu_modulus_switch_lwe_ciphertext_vector(
+    uint16_t *lwe_out, const Torus *lwe_in, uint32_t lwe_dimension,
+    uint32_t polynomial_size, uint32_t num_samples,
+    ThreadPool &pool = ThreadPool::global(),
+    SimdLevel level = get_simd_level(), uint32_t lut_count = 1) {
+  uint32_t log_lut_count = __builtin_ctz(lut_count);
+  uint32_t log_modulus =
+      get_bootstrap_log_modulus(polynomial_size) - log_lut_count;
+  size_t lwe_size = lwe_dimension + 1;
+  uint32_t num_chunks = std::min(num_samples, pool.num_threads());
+  pool.parallel_for(0, num_chunks, [&](uint32_t chunk) {
+    size_t first_sample = (size_t)num_samples * chunk / num_chunks;
+    size_t last_sample = (size_t)num_samples * (chunk + 1) / num_chunks;
+    size_t chunk_size = (last_sample - first_sample) * lwe_size;
+    uint16_t *chunk_out = &lwe_out[first_sample * lwe_size];
+    modulus_switch_vector(chunk_out, &lwe_in[first_sample * lwe_size],
+                          chunk_size, log_modulus, level);
+    if (log_lut_count != 0)
+      for (size_t i = 0; i < chunk_size; i++)
+        chunk_out[i] <<= log_lut_count;
+  });
+}
+
+/*
+ * Host amortized bootstrap of a batch of LWE ciphertexts, counterpart of
+ * host_bootstrap_amortized with the same arguments and layouts:
+ *  - lwe_out: num_samples LWE ciphertexts of dimension
+ *    glwe_dimension * polynomial_size
+ *  - lut_vector: test vectors of glwe_dimension + 1 polynomials each, the
+ *    masks followed by the body
+ *  - lut_vector_indexes: ciphertext s uses the test vector
+ *    lut_vector_indexes[lwe_idx + s], or the single test vector of
+ *    lut_vector if it is null (see select_lut)
+ *  - lwe_in: num_samples LWE ciphertexts of dimension input_lwe_dimension
+ *  - bootstrapping_key: Fourier bootstrapping key, as converted by
+ *    cpu_convert_lwe_bootstrap_key or cuda_convert_lwe_bootstrap_key with
+ *    the same glwe_dimension
+ *
+ * The input ciphertexts are first modulus switched to [0, 2N[ by
+ * cpu_modulus_switch_lwe_ciphertext_vector, so that the blind rotation
+ * loop reads precomputed 16 bits elements instead of rescaling each of them
+ * in double precision. The ciphertexts are then cut in one chunk per thread
+ * of the pool (see parallel_for_sample_chunks), each thread reusing its
+ * scratch for all the ciphertexts of its chunk and running the
+ * FFTs and the products in the Fourier domain with the best SIMD level of
+ * the CPU, by add_external_product or, with batched_fft,
+ * add_external_product_batched.
+ */
+template <typename Torus, typename InputTorus = Torus>
+void cpu_bootstrap_amortized_lwe_ciphertext_vector(
+    Torus *lwe_out, const Torus *lut_vector, const uint32_t *lut_vector_indexes,
+    const InputTorus *lwe_in, const double2 *bootstrapping_key,
+    uint32_t input_lwe_dimension, uint32_t polynomial_size, uint32_t base_log,
+    uint32_t l_gadget, uint32_t num_samples, uint32_t lwe_idx,
+    uint32_t glwe_dimension = 1, ThreadPool &pool = ThreadPool::global(),
+    SimdLevel level = get_simd_level(), bool batched_fft = false) {
+  if constexpr (!std::is_same<InputTorus, uint16_t>::value) {
+    std::vector<uint16_t> lwe_in_switched((size_t)num_samples *
+                                          (input_lwe_dimension + 1));
+    cpu_modulus_switch_lwe_ciphertext_vector(
+        lwe_in_switched.data(), lwe_in, input_lwe_dimension, polynomial_size,
+        num_samples, pool, level);
+    return cpu_bootstrap_amortized_lwe_ciphertext_vector<Torus, uint16_t>(
+        lwe_out, lut_vector, lut_vector_indexes, lwe_in_switched.data(),
+        bootstrapping_key, input_lwe_dimension, polynomial_size, base_log,
+        l_gadget, num_samples, lwe_idx, glwe_dimension, pool, level,
+        batched_fft);
+  }
+
+  auto &fft = NegacyclicFFT::get(polynomial_size);
+  size_t glwe_size = (size_t)(glwe_dimension + 1) * polynomial_size;
+  parallel_for_sample_chunks(pool, num_samples, [&](uint32_t first_sample,
+                                                    uint32_t last_sample) {
+    BootstrapBuffers<Torus> buffers(glwe_dimension, polynomial_size);
+    std::vector<Torus> accumulator(glwe_size);
+    for (uint32_t sample = first_sample; sample < last_sample; sample++) {
+      const Torus *lut = select_lut(lut_vector, lut_vector_indexes, lwe_idx,
+                                    sample, glwe_size);
+      blind_rotate_one_sample<Torus, InputTorus>(
+          accumulator.data(), lut,
+          &lwe_in[(size_t)sample * (input_lwe_dimension + 1)],
+          bootstrapping_key, input_lwe_dimension, glwe_dimension,
+          polynomial_size, base_log, l_gadget, fft, buffers, level,
+          batched_fft);
+
+      // The blind rotation result is a GLWE ciphertext, extract the LWE
+      // ciphertext of its constant coefficient
+      sample_extract(
+          &lwe_out[(size_t)sample * (glwe_dimension * polynomial_size + 1)],
+          accumulator.data(), glwe_dimension, polynomial_size);
+    }
+  });
+}
+
+/*
+ * Amortized bootstrap of a batch of LWE ciphertexts stopping before the
+ * sample extraction: the GLWE accumulator of each ciphertext, its
+ * glwe_dimension + 1 polynomials after the blind rotation, is written to
+ * glwe_out[s * (glwe_dimension + 1) * polynomial_size] for the ciphertext
+ * s. Its coefficient j holds the function of the input read j coefficients
+ * further in the test vector, so it can feed GLWE-level linear operations,
+ * CMUX trees or the extraction of several coefficients.
+ *
+ * With OutputT = double2 each polynomial is written in the Fourier domain
+ * of the bootstrapping keys instead, polynomial_size / 2 complex numbers
+ * as converted by convert_polynomial_to_fourier, so that
+ * glwe_out[s * (glwe_dimension + 1) * polynomial_size / 2] is ready for a
+ * product with a converted key. NegacyclicFFT::inverse followed by
+ * add_to_torus on a zeroed polynomial gives the coefficients back, up to
+ * the rounding of the FFT.
+ *
+ * The other arguments are the ones of
+ * cpu_bootstrap_amortized_lwe_ciphertext_vector.
+ */
+template <typename Torus, typename OutputT = Torus>
+void cpu_bootstrap_amortized_glwe_output_lwe_ciphertext_vector(
+    OutputT *glwe_out, const Torus *lut_vector,
+    const uint32_t *lut_vector_indexes, const Torus *lwe_in,
+    const double2 *bootstrapping_key, uint32_t input_lwe_dimension,
+    uint32_t polynomial_size, uint32_t base_log, uint32_t l_gadget,
+    uint32_t num_samples, uint32_t lwe_idx, uint32_t glwe_dimension = 1,
+    ThreadPool &pool = ThreadPool::global(),
+    SimdLevel level = get_simd_level()) {
+  std::vector<uint16_t> lwe_in_switched((size_t)num_samples *
+                                        (input_lwe_dimension + 1));
+  cpu_modulus_switch_lwe_ciphertext_vector(lwe_in_switched.data(), lwe_in,
+                                           input_lwe_dimension,
+                                           polynomial_size, num_samples, pool,
+                                           level);
+  auto &fft = NegacyclicFFT::get(polynomial_size);
+  size_t glwe_size = (size_t)(glwe_dimension + 1) * polynomial_size;
+  parallel_for_sample_chunks(pool, num_samples, [&](uint32_t first_sample,
+                                                    uint32_t last_sample) {
+    BootstrapBuffers<Torus> buffers(glwe_dimension, polynomial_size);
+    std::vector<Torus> accumulator;
+    if constexpr (std::is_same<OutputT, double2>::value)
+      accumulator.resize(glwe_size);
+    for (uint32_t sample = first_sample; sample < last_sample; sample++) {
+      const Torus *lut = select_lut(lut_vector, lut_vector_indexes, lwe_idx,
+                                    sample, glwe_size);
+      const uint16_t *block_lwe_in =
+          &lwe_in_switched[(size_t)sample * (input_lwe_dimension + 1)];
+      if constexpr (std::is_same<OutputT, double2>::value) {
+        blind_rotate_one_sample<Torus, uint16_t>(
+            accumulator.data(), lut, block_lwe_in, bootstrapping_key,
+            input_lwe_dimension, glwe_dimension, polynomial_size, base_log,
+            l_gadget, fft, buffers, level);
+        double2 *block_glwe_out = &glwe_out[sample * glwe_size / 2];
+        for (uint32_t c = 0; c <= glwe_dimension; c++)
+          convert_polynomial_to_fourier<Torus, std::make_signed_t<Torus>>(
+              &block_glwe_out[c * polynomial_size / 2],
+              (std::make_signed_t<Torus> *)&accumulator[c * polynomial_size],
+              polynomial_size, fft, level);
+      } else {
+        // The accumulator is rotated in place in the output
+        blind_rotate_one_sample<Torus, uint16_t>(
+            &glwe_out[sample * glwe_size], lut, block_lwe_in,
+            bootstrapping_key, input_lwe_dimension, glwe_dimension,
+            polynomial_size, base_log, l_gadget, fft, buffers, level);
+      }
+    }
+  });
+}
+
+/*
+ * Packs lut_count test vectors of glwe_dimension + 1 polynomials into one
+ * for the many-LUT bootstrap: the coefficient j of each polynomial of
+ * lut_out is taken from the test vector j % lut_count. Each test vector
+ * must be constant over runs of lut_count coefficients aligned on
+ * lut_count, which holds for the usual test vectors as long as half a box
+ * spans at least lut_count coefficients.
+ */
+template <typename Torus>
+void pack_many_lut_test_vector(Torus *lut_out, const Torus *luts,
+                               uint32_t lut_count, uint32_t glwe_dimension,
+                               uint32_t polynomial_size) {
+  size_t glwe_size = (size_t)(glwe_dimension + 1) * polynomial_size;
+  for (size_t p = 0; p < glwe_size; p += polynomial_size)
+    for (uint32_t j = 0; j < polynomial_size; j++)
+      lut_out[p + j] = luts[(size_t)(j % lut_count) * glwe_size + p + j];
+}
+
+/*
+ * Many-LUT amortized bootstrap: lut_count functions of each input are
+ * evaluated with a single blind rotation, following Chillotti et al.,
+ * "Improved programmable bootstrapping with larger precision and efficient
+ * arithmetic circuits for TFHE".
+ *
+ * The elements of the input ciphertexts are switched to multiples of
+ * lut_count in [0, 2N[ by cpu_modulus_switch_lwe_ciphertext_vector, so
+ * that the blind rotation brings a coefficient lut_count * m of the test
+ * vector to the constant coefficient and the coefficient i to the
+ * coefficient i - lut_count * m. With test vectors packed by
+ * pack_many_lut_test_vector, the coefficient i of the rotated accumulator
+ * holds the function i of the input, for i < lut_count, and is extracted
+ * into lwe_out[(s * lut_count + i) * (glwe_dimension * polynomial_size + 1)]
+ * for the ciphertext s. The other arguments are the ones of
+ * cpu_bootstrap_amortized_lwe_ciphertext_vector, and this is the reference
+ * of the device_bootstrap_amortized extraction of lut_count coefficients.
+ *
+ * lut_count must be a power of two. The coarser modulus switch multiplies
+ * its contribution to the output noise variance by lut_count^2, which has
+ * to be accounted for in the parameters.
+ */
+template <typename Torus>
+void cpu_bootstrap_amortized_many_lut_lwe_ciphertext_vector(
+    Torus *lwe_out, const Torus *lut_vector, const uint32_t *lut_vector_indexes,
+    const Torus *lwe_in, const double2 *bootstrapping_key,
+    uint32_t input_lwe_dimension, uint32_t polynomial_size, uint32_t base_log,
+    uint32_t l_gadget, uint32_t num_samples, uint32_t lwe_idx,
+    uint32_t lut_count, uint32_t glwe_dimension = 1,
+    ThreadPool &pool = ThreadPool::global(),
+    SimdLevel level = get_simd_level()) {
+  // Switch the ciphertexts to multiples of lut_count in [0, 2N[ and let the
+  // blind rotation take them as already switched
+  std::vector<uint16_t> lwe_in_switched((size_t)num_samples *
+                                        (input_lwe_dimension + 1));
+  cpu_modulus_switch_lwe_ciphertext_vector(
+      lwe_in_switched.data(), lwe_in, input_lwe_dimension, polynomial_size,
+      num_samples, pool, level, lut_count);
+
+  auto &fft = NegacyclicFFT::get(polynomial_size);
+  size_t glwe_size = (size_t)(glwe_dimension + 1) * polynomial_size;
+  parallel_for_sample_chunks(pool, num_samples, [&](uint32_t first_sample,
+                                                    uint32_t last_sample) {
+    BootstrapBuffers<Torus> buffers(glwe_dimension, polynomial_size);
+    std::vector<Torus> accumulator(glwe_size);
+    for (uint32_t sample = first_sample; sample < last_sample; sample++) {
+      const Torus *lut = select_lut(lut_vector, lut_vector_indexes, lwe_idx,
+                                    sample, glwe_size);
+      blind_rotate_one_sample<Torus, uint16_t>(
+          accumulator.data(), lut,
+          &lwe_in_switched[(size_t)sample * (input_lwe_dimension + 1)],
+          bootstrapping_key, input_lwe_dimension, glwe_dimension,
+          polynomial_size, base_log, l_gadget, fft, buffers, level);
+
+      for (uint32_t i = 0; i < lut_count; i++)
+        sample_extract(&lwe_out[((size_t)sample * lut_count + i) *
+                                (glwe_dimension * polynomial_size + 1)],
+                       accumulator.data(), glwe_dimension, polynomial_size,
+                       i);
+    }
+  });
+}
+
+/// Polynomial sizes supported by the bootstrap engines
+inline bool is_supported_polynomial_size(uint32_t polynomial_size) {
+  switch (polynomial_size) {
+  case 512:
+  case 1024:
+  case 2048:
+  case 4096:
+  case 8192:
+    return true;
+  default:
+    return false;
+  }
+}
+
+#endif // CNCRT_CPU_PBS_H
@@ -0,0 +1,182 @@
+#include "bootstrap_low_latency.hpp"
+#include "bootstrap.h"
+
+#include <cstdint>
+
+/* Perform the low latency bootstrap on a batch of input LWE ciphertexts for
+ * 32 bits on the CPU
+ *
+ * Same arguments and same layouts as
+ * cuda_bootstrap_low_latency_lwe_ciphertext_vector_32, with the
+ * bootstrapping key converted by cpu_convert_lwe_bootstrap_key_32, but all
+ * the buffers live in host memory. As on the GPU, ciphertext s uses the test
+ * vector s and lut_vector_indexes, num_lut_vectors and lwe_idx are not used.
+ * v_stream and max_shared_memory are not used either, the function returns
+ * once the batch is bootstrapped. Nothing is done for polynomial sizes other
+ * than 512, 1024, 2048, 4096 and 8192.
+ *
+ * Each ciphertext is split over up to 2 * l_gadget threads of the global
+ * pool synchronized by spin barriers (see blind_rotate_one_sample_split).
+ * The inputs go through the same integer modulus switch as the amortized
+ * bootstrap, and the results are bit-identical to the ones of
+ * cpu_bootstrap_amortized_lwe_ciphertext_vector_32 with the same test
+ * vectors
+ */
+void cpu_bootstrap_low_latency_lwe_ciphertext_vector_32(
+    void * /*v_stream*/, void *lwe_out, void *lut_vector,
+    void * /*lut_vector_indexes*/, void *lwe_in, void *bootstrapping_key,
+    uint32_t input_lwe_dimension, uint32_t polynomial_size, uint32_t base_log,
+    uint32_t l_gadget, uint32_t num_samples, uint32_t /*num_lut_vectors*/,
+    uint32_t /*lwe_idx*/, uint32_t /*max_shared_memory*/) {
+  if (!is_supported_polynomial_size(polynomial_size))
+    return;
+  cpu_bootstrap_low_latency_lwe_ciphertext_vector(
+      (uint32_t *)lwe_out, (uint32_t *)lut_vector, (uint32_t *)lwe_in,
+      (double2 *)bootstrapping_key, input_lwe_dimension, polynomial_size,
+      base_log, l_gadget, num_samples);
+}
+
+/* Perform the low latency bootstrap on a batch of input LWE ciphertexts for
+ * 64 bits on the CPU
+ *
+ * See cpu_bootstrap_low_latency_lwe_ciphertext_vector_32
+ */
+void cpu_bootstrap_low_latency_lwe_ciphertext_vector_64(
+    void * /*v_stream*/, void *lwe_out, void *lut_vector,
+    void * /*lut_vector_indexes*/, void *lwe_in, void *bootstrapping_key,
+    uint32_t input_lwe_dimension, uint32_t polynomial_size, uint32_t base_log,
+    uint32_t l_gadget, uint32_t num_samples, uint32_t /*num_lut_vectors*/,
+    uint32_t /*lwe_idx*/, uint32_t /*max_shared_memory*/) {
+  if (!is_supported_polynomial_size(polynomial_size))
+    return;
+  cpu_bootstrap_low_latency_lwe_ciphertext_vector(
+      (uint64_t *)lwe_out, (uint64_t *)lut_vector, (uint64_t *)lwe_in,
+      (double2 *)bootstrapping_key, input_lwe_dimension, polynomial_size,
+      base_log, l_gadget, num_samples);
+}
+
+/* Perform the low latency bootstrap on a batch of input LWE ciphertexts for
+ * 32 bits on the CPU with a GLWE accumulator of any dimension
+ *
+ * Same arguments and layouts as
+ * cuda_bootstrap_low_latency_lwe_ciphertext_vector_with_glwe_dimension_32,
+ * each ciphertext being split over up to l_gadget * (glwe_dimension + 1)
+ * threads. The results are bit-identical to the ones of
+ * cpu_bootstrap_amortized_lwe_ciphertext_vector_with_glwe_dimension_32 with
+ * the same test vectors.
+ */
+void cpu_bootstrap_low_latency_lwe_ciphertext_vector_with_glwe_dimension_32(
+    void * /*v_stream*/, void *lwe_out, void *lut_vector,
+    void * /*lut_vector_indexes*/, void *lwe_in, void *bootstrapping_key,
+    uint32_t input_lwe_dimension, uint32_t glwe_dimension,
+    uint32_t polynomial_size, uint32_t base_log, uint32_t l_gadget,
+    uint32_t num_samples, uint32_t /*num_lut_vectors*/, uint32_t /*lwe_idx*/,
+    uint32_t /*max_shared_memory*/) {
+  if (!is_supported_polynomial_size(polynomial_size) || glwe_dimension == 0)
+    return;
+  cpu_bootstrap_low_latency_lwe_ciphertext_vector(
+      (uint32_t *)lwe_out, (uint32_t *)lut_vector, (uint32_t *)lwe_in,
+      (double2 *)bootstrapping_key, input_lwe_dimension, polynomial_size,
+      base_log, l_gadget, num_samples, glwe_dimension);
+}
+
+/* Perform the low latency bootstrap on a batch of input LWE ciphertexts for
+ * 64 bits on the CPU with a GLWE accumulator of any dimension
+ *
+ * See cpu_bootstrap_low_latency_lwe_ciphertext_vector_with_glwe_dimension_32
+ */
+void cpu_bootstrap_low_latency_lwe_ciphertext_vector_with_glwe_dimension_64(
+    void * /*v_stream*/, void *lwe_out, void *lut_vector,
+    void * /*lut_vector_indexes*/, void *lwe_in, void *bootstrapping_key,
+    uint32_t input_lwe_dimension, uint32_t glwe_dimension,
+    uint32_t polynomial_size, uint32_t base_log, uint32_t l_gadget,
+    uint32_t num_samples, uint32_t /*num_lut_vectors*/, uint32_t /*lwe_idx*/,
+    uint32_t /*max_shared_memory*/) {
+  if (!is_supported_polynomial_size(polynomial_size) || glwe_dimension == 0)
+    return;
+  cpu_bootstrap_low_latency_lwe_ciphertext_vector(
+      (uint64_t *)lwe_out, (uint64_t *)lut_vector, (uint64_t *)lwe_in,
+      (double2 *)bootstrapping_key, input_lwe_dimension, polynomial_size,
+      base_log, l_gadget, num_samples, glwe_dimension);
+}
+
+/* Create the context of the low latency bootstrap of 32 bits ciphertexts on
+ * the CPU
+ *
+ * Same arguments as cuda_create_bootstrap_low_latency_context_32, the join
+ * buffers being allocated in host memory. gpu_index and max_num_samples are
+ * not used, the ciphertexts being bootstrapped one at a time. Returns a null
+ * pointer for unsupported polynomial sizes.
+ */
+void *cpu_create_bootstrap_low_latency_context_32(
+    uint32_t /*gpu_index*/, uint32_t polynomial_size, uint32_t l_gadget,
+    uint32_t /*max_num_samples*/) {
+  if (!is_supported_polynomial_size(polynomial_size))
+    return nullptr;
+  return cpu_create_bootstrap_low_latency_context<uint32_t>(polynomial_size,
+                                                            l_gadget);
+}
+
+/* Create the context of the low latency bootstrap of 64 bits ciphertexts on
+ * the CPU
+ *
+ * See cpu_create_bootstrap_low_latency_context_32
+ */
+void *cpu_create_bootstrap_low_latency_context_64(
+    uint32_t /*gpu_index*/, uint32_t polynomial_size, uint32_t l_gadget,
+    uint32_t /*max_num_samples*/) {
+  if (!is_supported_polynomial_size(polynomial_size))
+    return nullptr;
+  return cpu_create_bootstrap_low_latency_context<uint64_t>(polynomial_size,
+                                                            l_gadget);
+}
+
+/* Perform the low latency bootstrap on a batch of input LWE ciphertexts for
+ * 32 bits on the CPU with the join buffers of a context
+ *
+ * Same arguments and layouts as
+ * cuda_bootstrap_low_latency_with_context_lwe_ciphertext_vector_32, the
+ * context coming from cpu_create_bootstrap_low_latency_context_32. Nothing
+ * is done if it is null, from a failed creation, or was created for other
+ * parameters. The results are the ones of
+ * cpu_bootstrap_low_latency_lwe_ciphertext_vector_32.
+ */
+void cpu_bootstrap_low_latency_with_context_lwe_ciphertext_vector_32(
+    void * /*v_stream*/, void *context, void *lwe_out, void *lut_vector,
+    void *lwe_in, void *bootstrapping_key, uint32_t input_lwe_dimension,
+    uint32_t polynomial_size, uint32_t base_log, uint32_t l_gadget,
+    uint32_t num_samples) {
+  if (context == nullptr)
+    return;
+  cpu_bootstrap_low_latency_with_context_lwe_ciphertext_vector(
+      *static_cast<LowLatencyPbsContext<HostMemory> *>(context),
+      (uint32_t *)lwe_out, (uint32_t *)lut_vector, (uint32_t *)lwe_in,
+      (double2 *)bootstrapping_key, input_lwe_dimension, polynomial_size,
+      base_log, l_gadget, num_samples);
+}
+
+/* Perform the low latency bootstrap on a batch of input LWE ciphertexts for
+ * 64 bits on the CPU with the join buffers of a context
+ *
+ * See cpu_bootstrap_low_latency_with_context_lwe_ciphertext_vector_32
+ */
+void cpu_bootstrap_low_latency_with_context_lwe_ciphertext_vector_64(
+    void * /*v_stream*/, void *context, void *lwe_out, void *lut_vector,
+    void *lwe_in, void *bootstrapping_key, uint32_t input_lwe_dimension,
+    uint32_t polynomial_size, uint32_t base_log, uint32_t l_gadget,
+    uint32_t num_samples) {
+  if (context == nullptr)
+    return;
+  cpu_bootstrap_low_latency_with_context_lwe_ciphertext_vector(
+      *static_cast<LowLatencyPbsContext<HostMemory> *>(context),
+      (uint64_t *)lwe_out, (uint64_t *)lut_vector, (uint64_t *)lwe_in,
+      (double2 *)bootstrapping_key, input_lwe_dimension, polynomial_size,
+      base_log, l_gadget, num_samples);
+}
+
+/// Destroy a context of the low latency bootstrap on the CPU
+int cpu_destroy_bootstrap_low_latency_context(void *context,
+                                              uint32_t /*gpu_index*/) {
+  delete static_cast<LowLatencyPbsContext<HostMemory> *>(context);
+  return 0;
+}
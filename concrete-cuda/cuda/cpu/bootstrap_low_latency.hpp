@@ -0,0 +1,271 @@
+#ifndef CNCRT_CPU_LOWLAT_PBS_H
+#define CNCRT_CPU_LOWLAT_PBS_H
+
+#include "bootstrap_amortized.hpp"
+#include "bootstrap_context.h"
+#include "utils/spin_barrier.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+/*
+ * Scratch of the low latency bootstrap of one ciphertext split over
+ * num_threads threads, the counterpart of the shared memory of the blocks
+ * of device_bootstrap_low_latency, carved out of a buffer of get_bytes
+ * bytes aligned on 16 bytes: the products in the Fourier domain, the
+ * accumulator, the rotated and decomposed polynomials of each thread and
+ * the modulus switched ciphertext.
+ */
+template <typename Torus> struct LowLatencyBootstrapBuffers {
+  double2 *res_fft;
+  Torus *accumulator;
+  Torus *accumulator_rotated;
+  int16_t *accumulator_decomposed;
+  uint16_t *lwe_in_switched;
+
+  static size_t get_bytes(uint32_t input_lwe_dimension,
+                          uint32_t glwe_dimension, uint32_t polynomial_size,
+                          uint32_t num_threads) {
+    size_t glwe_size = (size_t)(glwe_dimension + 1) * polynomial_size;
+    return glwe_size / 2 * sizeof(double2) + glwe_size * sizeof(Torus) +
+           (size_t)num_threads * polynomial_size *
+               (sizeof(Torus) + sizeof(int16_t)) +
+           (input_lwe_dimension + 1) * sizeof(uint16_t);
+  }
+
+  LowLatencyBootstrapBuffers(void *scratch, uint32_t glwe_dimension,
+                             uint32_t polynomial_size, uint32_t num_threads) {
+    size_t glwe_size = (size_t)(glwe_dimension + 1) * polynomial_size;
+    res_fft = static_cast<double2 *>(scratch);
+    accumulator = reinterpret_cast<Torus *>(&res_fft[glwe_size / 2]);
+    accumulator_rotated = &accumulator[glwe_size];
+    accumulator_decomposed = reinterpret_cast<int16_t *>(
+        &accumulator_rotated[(size_t)num_threads * polynomial_size]);
+    lwe_in_switched = reinterpret_cast<uint16_t *>(
+        &accumulator_decomposed[(size_t)num_threads * polynomial_size]);
+  }
+};
+
+/// Number of threads of the pool a ciphertext is split over: one per
+/// decomposed polynomial at most, and 1 from a task of the pool
+inline uint32_t get_low_latency_num_threads(const ThreadPool &pool,
+                                            uint32_t glwe_dimension,
+                                            uint32_t l_gadget) {
+  if (pool.in_task())
+    return 1;
+  return std::min(l_gadget * (glwe_dimension + 1), pool.num_threads());
+}
+
+/*
+ * Blind rotation of one LWE ciphertext split over num_threads threads of
+ * the pool, the host counterpart of the blocks of device_bootstrap_low_latency
+ *
+ * Each iteration runs in three phases separated by barriers:
+ *  - the l_gadget * (glwe_dimension + 1) decomposed polynomials of the
+ *    external product are handed out round-robin to the threads: each one
+ *    rotates and rounds the polynomial k of the accumulator, decomposes its
+ *    level and switches it to the Fourier domain in its slot of join_fft
+ *  - the glwe_dimension + 1 columns of res_fft are cut in num_threads
+ *    ranges of frequencies, each thread multiplying all the slots with the
+ *    GGSW over its range
+ *  - the thread c (modulo num_threads) switches the column c back into the
+ *    polynomial c of the accumulator
+ *
+ * Every frequency accumulates the products in the order of
+ * add_external_product, on ranges aligned on the SIMD width, so the result
+ * is bit-identical to blind_rotate_one_sample.
+ *
+ * lwe_in is already modulus switched to [0, 2N[ (see
+ * cpu_modulus_switch_lwe_ciphertext_vector). The num_threads tasks spin on
+ * each other, so they must all run at once: num_threads is at most the
+ * size of the pool, and 1 when the caller is itself a task of the pool
+ * (see ThreadPool::in_task), whose parallel_for then runs inline.
+ */
+template <typename Torus>
+void blind_rotate_one_sample_split(
+    Torus *accumulator, const Torus *lut, const uint16_t *lwe_in,
+    const double2 *bootstrapping_key, uint32_t lwe_mask_size,
+    uint32_t glwe_dimension, uint32_t polynomial_size, uint32_t base_log,
+    uint32_t l_gadget, const NegacyclicFFT &fft, uint32_t num_threads,
+    double2 *join_fft, const LowLatencyBootstrapBuffers<Torus> &buffers,
+    ThreadPool &pool, SimdLevel level) {
+  GadgetMatrix<Torus> gadget(base_log, l_gadget);
+  uint32_t fft_size = polynomial_size / 2;
+  uint32_t num_polynomials = l_gadget * (glwe_dimension + 1);
+  size_t num_frequencies = (size_t)(glwe_dimension + 1) * fft_size;
+  double2 *res_fft = buffers.res_fft;
+  // Start of the range of frequencies of a thread, a multiple of 4 so that
+  // the SIMD products never run on a scalar tail
+  auto range_start = [&](uint32_t thread) {
+    return (num_frequencies * thread / num_threads) & ~(size_t)3;
+  };
+
+  Torus b_hat = lwe_in[lwe_mask_size];
+  for (uint32_t c = 0; c <= glwe_dimension; c++)
+    divide_by_monomial_negacyclic(&accumulator[c * polynomial_size],
+                                  &lut[c * polynomial_size], b_hat,
+                                  polynomial_size);
+
+  SpinBarrier barrier(num_threads);
+  pool.parallel_for(0, num_threads, [&](uint32_t thread) {
+    Torus *rotated = &buffers.accumulator_rotated[(size_t)thread *
+                                                  polynomial_size];
+    int16_t *decomposed =
+        &buffers.accumulator_decomposed[(size_t)thread * polynomial_size];
+    for (uint32_t iteration = 0; iteration < lwe_mask_size; iteration++) {
+      Torus a_hat = lwe_in[iteration];
+      if (a_hat == 0)
+        continue;
+
+      // Slot p holds the level p / (glwe_dimension + 1) of the polynomial
+      // p % (glwe_dimension + 1), the order of add_external_product
+      for (uint32_t p = thread; p < num_polynomials; p += num_threads) {
+        uint32_t decomp_level = p / (glwe_dimension + 1);
+        uint32_t k = p % (glwe_dimension + 1);
+        multiply_by_monomial_negacyclic_and_sub_polynomial(
+            &accumulator[k * polynomial_size], rotated, a_hat,
+            polynomial_size);
+        round_to_closest_multiple_inplace(rotated, base_log, l_gadget,
+                                          polynomial_size);
+        gadget.decompose_one_level(decomposed, rotated, decomp_level,
+                                   polynomial_size);
+        double2 *slot = &join_fft[(size_t)p * fft_size];
+        real_to_complex_compressed(slot, decomposed, polynomial_size);
+        fft.forward(slot, level);
+      }
+      barrier.arrive_and_wait();
+
+      const double2 *ggsw =
+          &bootstrapping_key[get_start_ith_ggsw(iteration, polynomial_size,
+                                                glwe_dimension, l_gadget)];
+      size_t last = range_start(thread + 1);
+      for (size_t first = range_start(thread); first < last;) {
+        uint32_t c = first / fft_size;
+        uint32_t j = first % fft_size;
+        uint32_t size = std::min<size_t>(fft_size - j, last - first);
+        std::fill(&res_fft[first], &res_fft[first] + size, double2{0., 0.});
+        for (uint32_t p = 0; p < num_polynomials; p++) {
+          const double2 *row = get_ith_mask_kth_block(
+              ggsw, 0, p % (glwe_dimension + 1), p / (glwe_dimension + 1),
+              polynomial_size, glwe_dimension, l_gadget);
+          polynomial_product_accumulate_in_fourier_domain(
+              &res_fft[first], &join_fft[(size_t)p * fft_size + j],
+              &row[c * fft_size + j], size, level);
+        }
+        first += size;
+      }
+      barrier.arrive_and_wait();
+
+      for (uint32_t c = thread; c <= glwe_dimension; c += num_threads) {
+        fft.inverse(&res_fft[c * fft_size], level);
+        add_to_torus(&res_fft[c * fft_size], &accumulator[c * polynomial_size],
+                     polynomial_size);
+      }
+      barrier.arrive_and_wait();
+    }
+  });
+}
+
+/// Low latency bootstrap of a batch with join_fft as join buffer, of
+/// l_gadget * (glwe_dimension + 1) polynomials in the Fourier domain, and
+/// scratch as buffers, of LowLatencyBootstrapBuffers::get_bytes bytes for
+/// get_low_latency_num_threads threads
+template <typename Torus>
+void bootstrap_low_latency_with_buffers(
+    Torus *lwe_out, const Torus *lut_vector, const Torus *lwe_in,
+    const double2 *bootstrapping_key, double2 *join_fft, void *scratch,
+    uint32_t input_lwe_dimension, uint32_t polynomial_size, uint32_t base_log,
+    uint32_t l_gadget, uint32_t num_samples, uint32_t glwe_dimension,
+    ThreadPool &pool, SimdLevel level) {
+  auto &fft = NegacyclicFFT::get(polynomial_size);
+  size_t glwe_size = (size_t)(glwe_dimension + 1) * polynomial_size;
+  uint32_t num_threads =
+      get_low_latency_num_threads(pool, glwe_dimension, l_gadget);
+  LowLatencyBootstrapBuffers<Torus> buffers(scratch, glwe_dimension,
+                                            polynomial_size, num_threads);
+
+  for (uint32_t sample = 0; sample < num_samples; sample++) {
+    cpu_modulus_switch_lwe_ciphertext_vector(
+        buffers.lwe_in_switched,
+        &lwe_in[(size_t)sample * (input_lwe_dimension + 1)],
+        input_lwe_dimension, polynomial_size, 1, pool, level);
+    blind_rotate_one_sample_split<Torus>(
+        buffers.accumulator, &lut_vector[sample * glwe_size],
+        buffers.lwe_in_switched, bootstrapping_key, input_lwe_dimension,
+        glwe_dimension, polynomial_size, base_log, l_gadget, fft, num_threads,
+        join_fft, buffers, pool, level);
+    sample_extract(
+        &lwe_out[(size_t)sample * (glwe_dimension * polynomial_size + 1)],
+        buffers.accumulator, glwe_dimension, polynomial_size, 0, level);
+  }
+}
+
+/*
+ * Host low latency bootstrap of a batch of LWE ciphertexts, counterpart of
+ * host_bootstrap_low_latency with the same arguments and layouts: as on the
+ * GPU, ciphertext s is bootstrapped with the test vector s of lut_vector and
+ * lut_vector_indexes is not read.
+ *
+ * The ciphertexts are bootstrapped one after the other, each of them split
+ * over up to l_gadget * (glwe_dimension + 1) threads of the pool by
+ * blind_rotate_one_sample_split, so that the latency of a single bootstrap
+ * goes down with the number of cores. For batches of more ciphertexts than
+ * cores, the amortized bootstrap has the higher throughput.
+ */
+template <typename Torus>
+void cpu_bootstrap_low_latency_lwe_ciphertext_vector(
+    Torus *lwe_out, const Torus *lut_vector, const Torus *lwe_in,
+    const double2 *bootstrapping_key, uint32_t input_lwe_dimension,
+    uint32_t polynomial_size, uint32_t base_log, uint32_t l_gadget,
+    uint32_t num_samples, uint32_t glwe_dimension = 1,
+    ThreadPool &pool = ThreadPool::global(),
+    SimdLevel level = get_simd_level()) {
+  std::vector<double2> join_fft((size_t)l_gadget * (glwe_dimension + 1) *
+                                polynomial_size / 2);
+  size_t scratch_bytes = LowLatencyBootstrapBuffers<Torus>::get_bytes(
+      input_lwe_dimension, glwe_dimension, polynomial_size,
+      get_low_latency_num_threads(pool, glwe_dimension, l_gadget));
+  std::vector<double2> scratch((scratch_bytes + 15) / 16);
+  bootstrap_low_latency_with_buffers(
+      lwe_out, lut_vector, lwe_in, bootstrapping_key, join_fft.data(),
+      scratch.data(), input_lwe_dimension, polynomial_size, base_log,
+      l_gadget, num_samples, glwe_dimension, pool, level);
+}
+
+/// Context of the host low latency bootstrap: the ciphertexts being
+/// bootstrapped one at a time, its join buffers of one ciphertext hold the
+/// l_gadget * (glwe_dimension + 1) polynomials of join_fft
+template <typename Torus>
+LowLatencyPbsContext<HostMemory> *
+cpu_create_bootstrap_low_latency_context(uint32_t polynomial_size,
+                                         uint32_t l_gadget) {
+  return new LowLatencyPbsContext<HostMemory>(sizeof(Torus), polynomial_size,
+                                              l_gadget, 1, 1);
+}
+
+/// Low latency bootstrap with the join buffers and the scratch of a context
+/// created by cpu_create_bootstrap_low_latency_context for the same
+/// parameters: only the first call, or one with more threads or a larger
+/// input dimension than the previous ones, allocates its scratch
+template <typename Torus>
+void cpu_bootstrap_low_latency_with_context_lwe_ciphertext_vector(
+    LowLatencyPbsContext<HostMemory> &context, Torus *lwe_out,
+    const Torus *lut_vector, const Torus *lwe_in,
+    const double2 *bootstrapping_key, uint32_t input_lwe_dimension,
+    uint32_t polynomial_size, uint32_t base_log, uint32_t l_gadget,
+    uint32_t num_samples, ThreadPool &pool = ThreadPool::global(),
+    SimdLevel level = get_simd_level()) {
+  if (!context.is_compatible(sizeof(Torus), polynomial_size, l_gadget))
+    return;
+  uint32_t glwe_dimension = context.glwe_dimension();
+  void *scratch = context.scratch(LowLatencyBootstrapBuffers<Torus>::get_bytes(
+      input_lwe_dimension, glwe_dimension, polynomial_size,
+      get_low_latency_num_threads(pool, glwe_dimension, l_gadget)));
+  bootstrap_low_latency_with_buffers(
+      lwe_out, lut_vector, lwe_in, bootstrapping_key,
+      (double2 *)context.mask_join_buffer(), scratch, input_lwe_dimension,
+      polynomial_size, base_log, l_gadget, num_samples, glwe_dimension, pool,
+      level);
+}
+
+#endif // CNCRT_CPU_LOWLAT_PBS_H
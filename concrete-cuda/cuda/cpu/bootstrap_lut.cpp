@@ -0,0 +1,43 @@
+#include "bootstrap.h"
+#include "bootstrap_lut.h"
+
+/* Encode and expand a batch of lookup tables into test vectors of 32 bits
+ *
+ *  - lut_vector: host array receiving the test vectors, room for num_luts
+ *    of (glwe_dimension + 1) * polynomial_size coefficients
+ *  - lut_vector_indexes: host array of num_luts indexes receiving the test
+ *    vector of each table, or null
+ *  - luts: host array of num_luts tables of lut_size uint64_t entries,
+ *    messages of message_bits bits
+ *  - deduplicate: if not 0, equal tables share a test vector
+ *
+ * Gives the lut_vector, num_lut_vectors and lut_vector_indexes of the
+ * cpu_bootstrap_* functions, and of the cuda_bootstrap_* ones once uploaded
+ * with cuda_memcpy_async_to_gpu: the tables are small and are expanded on
+ * the host in both cases. Returns the number of test vectors written, 0 if
+ * lut_size is not a power of 2 dividing polynomial_size / 2 or if
+ * message_bits leaves no room for the padding bit.
+ */
+uint32_t cpu_encode_and_expand_lut_vector_32(
+    void *lut_vector, void *lut_vector_indexes, void *luts, uint32_t lut_size,
+    uint32_t num_luts, uint32_t message_bits, uint32_t glwe_dimension,
+    uint32_t polynomial_size, uint32_t deduplicate) {
+  return encode_and_expand_lut_vector<uint32_t>(
+      (uint32_t *)lut_vector, (uint32_t *)lut_vector_indexes,
+      (uint64_t *)luts, lut_size, num_luts, message_bits, glwe_dimension,
+      polynomial_size, deduplicate != 0);
+}
+
+/* Encode and expand a batch of lookup tables into test vectors of 64 bits
+ *
+ * See cpu_encode_and_expand_lut_vector_32
+ */
+uint32_t cpu_encode_and_expand_lut_vector_64(
+    void *lut_vector, void *lut_vector_indexes, void *luts, uint32_t lut_size,
+    uint32_t num_luts, uint32_t message_bits, uint32_t glwe_dimension,
+    uint32_t polynomial_size, uint32_t deduplicate) {
+  return encode_and_expand_lut_vector<uint64_t>(
+      (uint64_t *)lut_vector, (uint32_t *)lut_vector_indexes,
+      (uint64_t *)luts, lut_size, num_luts, message_bits, glwe_dimension,
+      polynomial_size, deduplicate != 0);
+}
@@ -0,0 +1,97 @@
+#include "bootstrap_multi_bit.hpp"
+#include "bootstrap.h"
+
+#include <cstdint>
+
+/* Convert a multi-bit bootstrapping key of 32 bits to the Fourier domain on
+ * the CPU
+ *
+ * src holds get_multi_bit_ggsw_count(input_lwe_dim, grouping_factor) GGSWs
+ * with the layout of the GGSWs of a regular bootstrapping key: for each
+ * group of grouping_factor mask elements, the last group possibly smaller,
+ * one GGSW per non-empty subset b of the group, b = 1 .. 2^g - 1 with the
+ * bit i of b selecting the element i, encrypting
+ * prod_{i in b} s_i * prod_{i not in b} (1 - s_i). With grouping_factor = 1
+ * this is the regular key. The result has the layout of
+ * cuda_convert_lwe_multi_bit_bootstrap_key_32. Nothing is done for grouping
+ * factors outside of [1, MAX_GROUPING_FACTOR], which the bootstrap rejects.
+ */
+void cpu_convert_lwe_multi_bit_bootstrap_key_32(
+    void *dest, void *src, void * /*v_stream*/, uint32_t /*gpu_index*/,
+    uint32_t input_lwe_dim, uint32_t glwe_dim, uint32_t l_gadget,
+    uint32_t polynomial_size, uint32_t grouping_factor) {
+  if (grouping_factor == 0 || grouping_factor > MAX_GROUPING_FACTOR)
+    return;
+  cpu_convert_lwe_bootstrap_key<uint32_t, int32_t>(
+      (double2 *)dest, (int32_t *)src,
+      get_multi_bit_ggsw_count(input_lwe_dim, grouping_factor), glwe_dim,
+      l_gadget, polynomial_size);
+}
+
+/* Convert a multi-bit bootstrapping key of 64 bits to the Fourier domain on
+ * the CPU
+ *
+ * See cpu_convert_lwe_multi_bit_bootstrap_key_32
+ */
+void cpu_convert_lwe_multi_bit_bootstrap_key_64(
+    void *dest, void *src, void * /*v_stream*/, uint32_t /*gpu_index*/,
+    uint32_t input_lwe_dim, uint32_t glwe_dim, uint32_t l_gadget,
+    uint32_t polynomial_size, uint32_t grouping_factor) {
+  if (grouping_factor == 0 || grouping_factor > MAX_GROUPING_FACTOR)
+    return;
+  cpu_convert_lwe_bootstrap_key<uint64_t, int64_t>(
+      (double2 *)dest, (int64_t *)src,
+      get_multi_bit_ggsw_count(input_lwe_dim, grouping_factor), glwe_dim,
+      l_gadget, polynomial_size);
+}
+
+/* Perform the bootstrap on a batch of input LWE ciphertexts for 32 bits on
+ * the CPU, processing the mask elements by groups of grouping_factor
+ *
+ * Same arguments as cpu_bootstrap_amortized_lwe_ciphertext_vector_32, with
+ * a bootstrapping key converted by cpu_convert_lwe_multi_bit_bootstrap_key_32
+ * for the same grouping_factor, in [1, 3]. Grouping by 2 halves the number
+ * of sequential iterations and of FFTs of each bootstrap, for a key 3/2
+ * times larger. Nothing is done for other grouping factors or polynomial
+ * sizes than those of cpu_bootstrap_amortized_lwe_ciphertext_vector_32.
+ * This is the host reference of
+ * cuda_bootstrap_multi_bit_lwe_ciphertext_vector_32.
+ */
+void cpu_bootstrap_multi_bit_lwe_ciphertext_vector_32(
+    void * /*v_stream*/, void *lwe_out, void *lut_vector,
+    void *lut_vector_indexes, void *lwe_in, void *bootstrapping_key,
+    uint32_t input_lwe_dimension, uint32_t polynomial_size, uint32_t base_log,
+    uint32_t l_gadget, uint32_t grouping_factor, uint32_t num_samples,
+    uint32_t /*num_lut_vectors*/, uint32_t lwe_idx,
+    uint32_t /*max_shared_memory*/) {
+  if (!is_supported_polynomial_size(polynomial_size) || grouping_factor == 0 ||
+      grouping_factor > MAX_GROUPING_FACTOR)
+    return;
+  cpu_bootstrap_multi_bit_lwe_ciphertext_vector(
+      (uint32_t *)lwe_out, (uint32_t *)lut_vector,
+      (uint32_t *)lut_vector_indexes, (uint32_t *)lwe_in,
+      (double2 *)bootstrapping_key, input_lwe_dimension, polynomial_size,
+      base_log, l_gadget, grouping_factor, num_samples, lwe_idx);
+}
+
+/* Perform the bootstrap on a batch of input LWE ciphertexts for 64 bits on
+ * the CPU, processing the mask elements by groups of grouping_factor
+ *
+ * See cpu_bootstrap_multi_bit_lwe_ciphertext_vector_32
+ */
+void cpu_bootstrap_multi_bit_lwe_ciphertext_vector_64(
+    void * /*v_stream*/, void *lwe_out, void *lut_vector,
+    void *lut_vector_indexes, void *lwe_in, void *bootstrapping_key,
+    uint32_t input_lwe_dimension, uint32_t polynomial_size, uint32_t base_log,
+    uint32_t l_gadget, uint32_t grouping_factor, uint32_t num_samples,
+    uint32_t /*num_lut_vectors*/, uint32_t lwe_idx,
+    uint32_t /*max_shared_memory*/) {
+  if (!is_supported_polynomial_size(polynomial_size) || grouping_factor == 0 ||
+      grouping_factor > MAX_GROUPING_FACTOR)
+    return;
+  cpu_bootstrap_multi_bit_lwe_ciphertext_vector(
+      (uint64_t *)lwe_out, (uint64_t *)lut_vector,
+      (uint32_t *)lut_vector_indexes, (uint64_t *)lwe_in,
+      (double2 *)bootstrapping_key, input_lwe_dimension, polynomial_size,
+      base_log, l_gadget, grouping_factor, num_samples, lwe_idx);
+}
@@ -0,0 +1,195 @@
+#ifndef CNCRT_CPU_MULTI_BIT_PBS_H
+#define CNCRT_CPU_MULTI_BIT_PBS_H
+
+#include "bootstrap_amortized.hpp"
+#include "complex/operations.hpp"
+#include "crypto/bootstrapping_key.hpp"
+#include "crypto/gadget.hpp"
+#include "crypto/torus.hpp"
+#include "fft/bnsmfft.hpp"
+#include "polynomial/functions.hpp"
+#include "polynomial/polynomial_math.hpp"
+#include "utils/simd.hpp"
+#include "utils/thread_pool.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+/// Largest group of mask elements handled by one iteration of the multi-bit
+/// blind rotation
+constexpr uint32_t MAX_GROUPING_FACTOR = 3;
+
+/*
+ * Multi-bit blind rotation of the test vector lut by the phase of one LWE
+ * ciphertext
+ *
+ * The mask elements are processed by groups of grouping_factor (a_0, ..,
+ * a_g-1) with one external product per group instead of one per element.
+ * For each non-empty subset b of the group, the key holds a GGSW G_b of
+ * prod_{i in b} s_i * prod_{i not in b} (1 - s_i). Exactly one of these
+ * indicators, or none when all the s_i of the group are 0, is 1, so that
+ *   X^(sum a_i s_i) = 1 + sum_b (X^(sum_{i in b} a_i) - 1) * G_b
+ * and the accumulator is updated as
+ *   ACC += sum_b (X^e_b - 1) * (ACC x G_b)
+ * where the products by the monomials X^e_b - 1 are pointwise in the
+ * Fourier domain. The decomposition and the FFTs of the accumulator, which
+ * dominate the cost, are shared by the 2^g - 1 GGSWs of a group.
+ *
+ * The GGSWs of a group are consecutive in the Fourier bootstrapping key,
+ * in the order of the subsets b = 1 .. 2^g - 1 where the bit i of b
+ * selects a_i, each with the layout of a GGSW of the regular key.
+ *
+ * lwe_in is already modulus switched to [0, 2N[ (see
+ * cpu_modulus_switch_lwe_ciphertext_vector).
+ */
+template <typename Torus>
+void blind_rotate_multi_bit_one_sample(
+    Torus *accumulator, const Torus *lut, const uint16_t *lwe_in,
+    const double2 *bootstrapping_key, uint32_t lwe_mask_size,
+    uint32_t glwe_dimension, uint32_t polynomial_size, uint32_t base_log,
+    uint32_t l_gadget, uint32_t grouping_factor, const NegacyclicFFT &fft,
+    BootstrapBuffers<Torus> &buffers, std::vector<double2> &subset_res_fft,
+    SimdLevel level) {
+  GadgetMatrix<Torus> gadget(base_log, l_gadget);
+  uint32_t fft_size = polynomial_size / 2;
+  uint32_t modulus = 2 * polynomial_size;
+  size_t glwe_fft_size = (size_t)(glwe_dimension + 1) * fft_size;
+  size_t ggsw_size = glwe_fft_size * (glwe_dimension + 1) * l_gadget;
+
+  Torus b_hat = lwe_in[lwe_mask_size];
+  for (uint32_t c = 0; c <= glwe_dimension; c++)
+    divide_by_monomial_negacyclic(&accumulator[c * polynomial_size],
+                                  &lut[c * polynomial_size], b_hat,
+                                  polynomial_size);
+
+  const double2 *group_key = bootstrapping_key;
+  for (uint32_t group_start = 0; group_start < lwe_mask_size;
+       group_start += grouping_factor) {
+    uint32_t group_size = std::min(grouping_factor, lwe_mask_size - group_start);
+    uint32_t subset_count = (1u << group_size) - 1;
+    const double2 *current_key = group_key;
+    group_key += subset_count * ggsw_size;
+
+    // Degrees of the monomials of the subsets, in [0, 2N[
+    uint32_t a_hat[MAX_GROUPING_FACTOR];
+    uint32_t subset_degree[1 << MAX_GROUPING_FACTOR] = {0};
+    bool rotates = false;
+    for (uint32_t i = 0; i < group_size; i++) {
+      a_hat[i] = lwe_in[group_start + i];
+      rotates |= a_hat[i] != 0;
+    }
+    if (!rotates)
+      continue;
+    for (uint32_t b = 1; b <= subset_count; b++)
+      for (uint32_t i = 0; i < group_size; i++)
+        if (b & (1u << i))
+          subset_degree[b] = (subset_degree[b] + a_hat[i]) % modulus;
+
+    std::copy(accumulator,
+              accumulator + (glwe_dimension + 1) * polynomial_size,
+              buffers.accumulator_rotated.begin());
+    round_to_closest_multiple_inplace(buffers.accumulator_rotated.data(),
+                                      base_log, l_gadget,
+                                      (glwe_dimension + 1) * polynomial_size);
+    std::fill(subset_res_fft.begin(), subset_res_fft.end(), double2{0., 0.});
+
+    // ACC x G_b for every subset b, sharing the decomposition and the FFTs
+    for (uint32_t decomp_level = 0; decomp_level < l_gadget; decomp_level++) {
+      for (uint32_t k = 0; k <= glwe_dimension; k++) {
+        gadget.decompose_one_level(
+            buffers.accumulator_decomposed.data(),
+            &buffers.accumulator_rotated[k * polynomial_size], decomp_level,
+            polynomial_size);
+        real_to_complex_compressed(buffers.accumulator_fft.data(),
+                                   buffers.accumulator_decomposed.data(),
+                                   polynomial_size);
+        fft.forward(buffers.accumulator_fft.data(), level);
+        for (uint32_t b = 1; b <= subset_count; b++) {
+          const double2 *row = get_ith_mask_kth_block(
+              &current_key[(b - 1) * ggsw_size], 0, k, decomp_level,
+              polynomial_size, glwe_dimension, l_gadget);
+          double2 *subset_res = &subset_res_fft[(b - 1) * glwe_fft_size];
+          for (uint32_t c = 0; c <= glwe_dimension; c++)
+            polynomial_product_accumulate_in_fourier_domain(
+                &subset_res[c * fft_size], buffers.accumulator_fft.data(),
+                &row[c * fft_size], fft_size, level);
+        }
+      }
+    }
+
+    // Sum of the products scaled by X^e_b - 1, pointwise
+    for (uint32_t c = 0; c <= glwe_dimension; c++) {
+      double2 *res_fft = &buffers.res_fft[c * fft_size];
+      std::fill(res_fft, res_fft + fft_size, double2{0., 0.});
+      for (uint32_t b = 1; b <= subset_count; b++) {
+        if (subset_degree[b] == 0)
+          continue;
+        const double2 *subset_res =
+            &subset_res_fft[(b - 1) * glwe_fft_size + c * fft_size];
+        for (uint32_t j = 0; j < fft_size; j++) {
+          double2 monomial = fft.monomial(j, subset_degree[b]);
+          monomial.x -= 1.;
+          res_fft[j] += monomial * subset_res[j];
+        }
+      }
+      fft.inverse(res_fft, level);
+      add_to_torus(res_fft, &accumulator[c * polynomial_size],
+                   polynomial_size);
+    }
+  }
+}
+
+/*
+ * Host amortized bootstrap of a batch of LWE ciphertexts with the multi-bit
+ * blind rotation
+ *
+ * Same arguments and layouts as
+ * cpu_bootstrap_amortized_lwe_ciphertext_vector, glwe_dimension included,
+ * except that the Fourier bootstrapping key is a multi-bit key for
+ * grouping_factor in [1, MAX_GROUPING_FACTOR] (see
+ * blind_rotate_multi_bit_one_sample). A group of
+ * g elements costs the FFTs of one external product and 2^g - 1 products in
+ * the Fourier domain: grouping by 2 halves the sequential iterations and the
+ * FFTs of a bootstrap for 3/2 times the products and the key size.
+ */
+template <typename Torus>
+void cpu_bootstrap_multi_bit_lwe_ciphertext_vector(
+    Torus *lwe_out, const Torus *lut_vector, const uint32_t *lut_vector_indexes,
+    const Torus *lwe_in, const double2 *bootstrapping_key,
+    uint32_t input_lwe_dimension, uint32_t polynomial_size, uint32_t base_log,
+    uint32_t l_gadget, uint32_t grouping_factor, uint32_t num_samples,
+    uint32_t lwe_idx, uint32_t glwe_dimension = 1,
+    ThreadPool &pool = ThreadPool::global(),
+    SimdLevel level = get_simd_level()) {
+  auto &fft = NegacyclicFFT::get(polynomial_size);
+  size_t glwe_size = (size_t)(glwe_dimension + 1) * polynomial_size;
+  std::vector<uint16_t> lwe_in_switched((size_t)num_samples *
+                                        (input_lwe_dimension + 1));
+  cpu_modulus_switch_lwe_ciphertext_vector(lwe_in_switched.data(), lwe_in,
+                                           input_lwe_dimension,
+                                           polynomial_size, num_samples, pool,
+                                           level);
+  parallel_for_sample_chunks(pool, num_samples, [&](uint32_t first_sample,
+                                                    uint32_t last_sample) {
+    BootstrapBuffers<Torus> buffers(glwe_dimension, polynomial_size);
+    std::vector<double2> subset_res_fft(((1u << grouping_factor) - 1) *
+                                        glwe_size / 2);
+    std::vector<Torus> accumulator(glwe_size);
+    for (uint32_t sample = first_sample; sample < last_sample; sample++) {
+      const Torus *lut = select_lut(lut_vector, lut_vector_indexes, lwe_idx,
+                                    sample, glwe_size);
+      blind_rotate_multi_bit_one_sample(
+          accumulator.data(), lut,
+          &lwe_in_switched[(size_t)sample * (input_lwe_dimension + 1)],
+          bootstrapping_key, input_lwe_dimension, glwe_dimension,
+          polynomial_size, base_log, l_gadget, grouping_factor, fft, buffers,
+          subset_res_fft, level);
+
+      sample_extract(
+          &lwe_out[(size_t)sample * (glwe_dimension * polynomial_size + 1)],
+          accumulator.data(), glwe_dimension, polynomial_size);
+    }
+  });
+}
+
+#endif // CNCRT_CPU_MULTI_BIT_PBS_H
@@ -0,0 +1,62 @@
+#ifndef CNCRT_CPU_COMPLEX_OPERATIONS_H
+#define CNCRT_CPU_COMPLEX_OPERATIONS_H
+
+#include "utils/simd.hpp"
+
+/*
+ * Host counterpart of the CUDA double2 vector type and of the operations of
+ * src/complex/operations.cuh. The layout is the one of the CUDA type, two
+ * doubles aligned on 16 bytes, so that the Fourier bootstrapping keys are
+ * exchanged as double2 arrays by both engines.
+ */
+struct alignas(16) double2 {
+  double x;
+  double y;
+};
+
+inline double2 conjugate(const double2 num) { return {num.x, -num.y}; }
+
+inline void operator+=(double2 &lh, const double2 rh) {
+  lh.x += rh.x;
+  lh.y += rh.y;
+}
+
+inline double2 operator+(const double2 a, const double2 b) {
+  return {a.x + b.x, a.y + b.y};
+}
+
+inline double2 operator-(const double2 a, const double2 b) {
+  return {a.x - b.x, a.y - b.y};
+}
+
+inline double2 operator*(const double2 a, const double2 b) {
+  return {a.x * b.x - a.y * b.y, a.x * b.y + a.y * b.x};
+}
+
+inline double2 operator*(const double2 a, double b) {
+  return {a.x * b, a.y * b};
+}
+
+#ifdef CNCRT_CPU_X86
+// Products of 2 (resp. 4) pairs of interleaved complex numbers: the real
+// parts of b are duplicated on both lanes of each complex, and the swapped
+// a multiplied by the imaginary parts of b is subtracted on the real lanes
+// and added on the imaginary ones
+__attribute__((target("avx2,fma"))) inline __m256d complex_mul_avx2(__m256d a,
+                                                                    __m256d b) {
+  __m256d b_re = _mm256_movedup_pd(b);
+  __m256d b_im = _mm256_permute_pd(b, 0xf);
+  __m256d a_swap = _mm256_permute_pd(a, 0x5);
+  return _mm256_fmaddsub_pd(a, b_re, _mm256_mul_pd(a_swap, b_im));
+}
+
+__attribute__((target("avx512f"))) inline __m512d
+complex_mul_avx512(__m512d a, __m512d b) {
+  __m512d b_re = _mm512_maskz_movedup_pd(0xff, b);
+  __m512d b_im = _mm512_maskz_permute_pd(0xff, b, 0xff);
+  __m512d a_swap = _mm512_maskz_permute_pd(0xff, a, 0x55);
+  return _mm512_fmaddsub_pd(a, b_re, _mm512_mul_pd(a_swap, b_im));
+}
+#endif
+
+#endif // CNCRT_CPU_COMPLEX_OPERATIONS_H
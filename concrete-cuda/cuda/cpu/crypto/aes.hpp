@@ -0,0 +1,208 @@
+#ifndef CNCRT_CPU_AES_H
+#define CNCRT_CPU_AES_H
+
+#include "utils/simd.hpp"
+#include <cstdint>
+#include <cstring>
+
+/*
+ * AES-128 in counter mode, used to regenerate the uniformly random masks of
+ * seeded keys
+ *
+ * This is the generator of concrete-csprng (SoftwareRandomGenerator and
+ * AesniRandomGenerator): the key is the seed, i.e. the 16 little endian
+ * bytes of the u128 of a concrete-core Seed, block number c of the
+ * keystream is AES_seed(c) where the counter c is written as a 128 bits
+ * little endian integer, and random words are read as little endian from
+ * the keystream starting at its second byte. Blocks are encrypted with
+ * AES-NI when the CPU supports it and with a byte oriented software
+ * implementation otherwise, both give the same keystream.
+ */
+class AesCtr128 {
+public:
+  static constexpr int rounds = 10;
+
+  explicit AesCtr128(const uint8_t seed[16], bool use_aesni = has_aesni()) {
+    expand_key(seed);
+    m_use_aesni = use_aesni;
+  }
+
+  static bool has_aesni() {
+#ifdef CNCRT_CPU_X86
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("aes") && __builtin_cpu_supports("sse4.1");
+#else
+    return false;
+#endif
+  }
+
+  /// Encrypts a single block
+  void encrypt_block(uint8_t out[16], const uint8_t in[16]) const {
+#ifdef CNCRT_CPU_X86
+    if (m_use_aesni)
+      return encrypt_blocks_aesni(out, in, 1);
+#endif
+    encrypt_block_software(out, in);
+  }
+
+  /// Writes the words [first_word, first_word + num_words[ of the random
+  /// stream to out, Word being 32 or 64 bits wide
+  ///
+  /// Like concrete-csprng's AES generator, the stream starts at the second
+  /// byte of the keystream: word w is made of the keystream bytes
+  /// [1 + w * sizeof(Word), 1 + (w + 1) * sizeof(Word)[, so words straddle
+  /// two blocks.
+  template <typename Word>
+  void fill_keystream(Word *out, uint64_t first_word, size_t num_words) const {
+    constexpr size_t batch = 8;
+    uint8_t counters[batch * 16];
+    uint8_t blocks[batch * 16];
+
+    uint8_t *bytes = reinterpret_cast<uint8_t *>(out);
+    size_t num_bytes = num_words * sizeof(Word);
+    uint64_t first_byte = 1 + first_word * sizeof(Word);
+    uint64_t block = first_byte / 16;
+    size_t skip = first_byte % 16;
+    size_t written = 0;
+    while (written < num_bytes) {
+      size_t bytes_left = num_bytes - written + skip;
+      size_t num_blocks = (bytes_left + 15) / 16;
+      if (num_blocks > batch)
+        num_blocks = batch;
+      memset(counters, 0, num_blocks * 16);
+      for (size_t b = 0; b < num_blocks; b++) {
+        uint64_t counter = block + b;
+        memcpy(&counters[b * 16], &counter, sizeof(counter));
+      }
+      encrypt_blocks(blocks, counters, num_blocks);
+
+      size_t available = num_blocks * 16 - skip;
+      size_t to_copy = available < num_bytes - written ? available
+                                                       : num_bytes - written;
+      memcpy(&bytes[written], &blocks[skip], to_copy);
+      written += to_copy;
+      block += num_blocks;
+      skip = 0;
+    }
+  }
+
+private:
+  uint8_t m_round_keys[(rounds + 1) * 16];
+  bool m_use_aesni;
+
+  static uint8_t sbox(uint8_t x) {
+    static const uint8_t table[256] = {
+        0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5, 0x30, 0x01, 0x67, 0x2b,
+        0xfe, 0xd7, 0xab, 0x76, 0xca, 0x82, 0xc9, 0x7d, 0xfa, 0x59, 0x47, 0xf0,
+        0xad, 0xd4, 0xa2, 0xaf, 0x9c, 0xa4, 0x72, 0xc0, 0xb7, 0xfd, 0x93, 0x26,
+        0x36, 0x3f, 0xf7, 0xcc, 0x34, 0xa5, 0xe5, 0xf1, 0x71, 0xd8, 0x31, 0x15,
+        0x04, 0xc7, 0x23, 0xc3, 0x18, 0x96, 0x05, 0x9a, 0x07, 0x12, 0x80, 0xe2,
+        0xeb, 0x27, 0xb2, 0x75, 0x09, 0x83, 0x2c, 0x1a, 0x1b, 0x6e, 0x5a, 0xa0,
+        0x52, 0x3b, 0xd6, 0xb3, 0x29, 0xe3, 0x2f, 0x84, 0x53, 0xd1, 0x00, 0xed,
+        0x20, 0xfc, 0xb1, 0x5b, 0x6a, 0xcb, 0xbe, 0x39, 0x4a, 0x4c, 0x58, 0xcf,
+        0xd0, 0xef, 0xaa, 0xfb, 0x43, 0x4d, 0x33, 0x85, 0x45, 0xf9, 0x02, 0x7f,
+        0x50, 0x3c, 0x9f, 0xa8, 0x51, 0xa3, 0x40, 0x8f, 0x92, 0x9d, 0x38, 0xf5,
+        0xbc, 0xb6, 0xda, 0x21, 0x10, 0xff, 0xf3, 0xd2, 0xcd, 0x0c, 0x13, 0xec,
+        0x5f, 0x97, 0x44, 0x17, 0xc4, 0xa7, 0x7e, 0x3d, 0x64, 0x5d, 0x19, 0x73,
+        0x60, 0x81, 0x4f, 0xdc, 0x22, 0x2a, 0x90, 0x88, 0x46, 0xee, 0xb8, 0x14,
+        0xde, 0x5e, 0x0b, 0xdb, 0xe0, 0x32, 0x3a, 0x0a, 0x49, 0x06, 0x24, 0x5c,
+        0xc2, 0xd3, 0xac, 0x62, 0x91, 0x95, 0xe4, 0x79, 0xe7, 0xc8, 0x37, 0x6d,
+        0x8d, 0xd5, 0x4e, 0xa9, 0x6c, 0x56, 0xf4, 0xea, 0x65, 0x7a, 0xae, 0x08,
+        0xba, 0x78, 0x25, 0x2e, 0x1c, 0xa6, 0xb4, 0xc6, 0xe8, 0xdd, 0x74, 0x1f,
+        0x4b, 0xbd, 0x8b, 0x8a, 0x70, 0x3e, 0xb5, 0x66, 0x48, 0x03, 0xf6, 0x0e,
+        0x61, 0x35, 0x57, 0xb9, 0x86, 0xc1, 0x1d, 0x9e, 0xe1, 0xf8, 0x98, 0x11,
+        0x69, 0xd9, 0x8e, 0x94, 0x9b, 0x1e, 0x87, 0xe9, 0xce, 0x55, 0x28, 0xdf,
+        0x8c, 0xa1, 0x89, 0x0d, 0xbf, 0xe6, 0x42, 0x68, 0x41, 0x99, 0x2d, 0x0f,
+        0xb0, 0x54, 0xbb, 0x16};
+    return table[x];
+  }
+
+  static uint8_t xtime(uint8_t x) {
+    return (uint8_t)((x << 1) ^ ((x >> 7) * 0x1b));
+  }
+
+  void expand_key(const uint8_t seed[16]) {
+    memcpy(m_round_keys, seed, 16);
+    uint8_t rcon = 1;
+    for (int i = 4; i < 4 * (rounds + 1); i++) {
+      uint8_t temp[4];
+      memcpy(temp, &m_round_keys[(i - 1) * 4], 4);
+      if (i % 4 == 0) {
+        uint8_t first = temp[0];
+        temp[0] = sbox(temp[1]) ^ rcon;
+        temp[1] = sbox(temp[2]);
+        temp[2] = sbox(temp[3]);
+        temp[3] = sbox(first);
+        rcon = xtime(rcon);
+      }
+      for (int j = 0; j < 4; j++)
+        m_round_keys[i * 4 + j] = m_round_keys[(i - 4) * 4 + j] ^ temp[j];
+    }
+  }
+
+  void encrypt_block_software(uint8_t out[16], const uint8_t in[16]) const {
+    uint8_t state[16];
+    for (int i = 0; i < 16; i++)
+      state[i] = in[i] ^ m_round_keys[i];
+    for (int round = 1; round <= rounds; round++) {
+      // SubBytes and ShiftRows, the state is stored column by column
+      uint8_t shifted[16];
+      for (int col = 0; col < 4; col++)
+        for (int row = 0; row < 4; row++)
+          shifted[col * 4 + row] = sbox(state[((col + row) % 4) * 4 + row]);
+      // MixColumns, skipped in the last round
+      if (round != rounds) {
+        for (int col = 0; col < 4; col++) {
+          uint8_t *c = &shifted[col * 4];
+          uint8_t all = c[0] ^ c[1] ^ c[2] ^ c[3];
+          uint8_t first = c[0];
+          c[0] ^= all ^ xtime(c[0] ^ c[1]);
+          c[1] ^= all ^ xtime(c[1] ^ c[2]);
+          c[2] ^= all ^ xtime(c[2] ^ c[3]);
+          c[3] ^= all ^ xtime(c[3] ^ first);
+        }
+      }
+      for (int i = 0; i < 16; i++)
+        state[i] = shifted[i] ^ m_round_keys[round * 16 + i];
+    }
+    memcpy(out, state, 16);
+  }
+
+#ifdef CNCRT_CPU_X86
+  __attribute__((target("aes,sse4.1"))) void
+  encrypt_blocks_aesni(uint8_t *out, const uint8_t *in,
+                       size_t num_blocks) const {
+    __m128i keys[rounds + 1];
+    for (int r = 0; r <= rounds; r++)
+      keys[r] = _mm_loadu_si128((const __m128i *)&m_round_keys[r * 16]);
+    // The blocks are interleaved round by round to hide the latency of the
+    // AES instructions
+    constexpr size_t interleave = 8;
+    for (size_t first = 0; first < num_blocks; first += interleave) {
+      size_t count = num_blocks - first < interleave ? num_blocks - first
+                                                     : interleave;
+      __m128i state[interleave];
+      for (size_t b = 0; b < count; b++)
+        state[b] = _mm_xor_si128(
+            _mm_loadu_si128((const __m128i *)&in[(first + b) * 16]), keys[0]);
+      for (int r = 1; r < rounds; r++)
+        for (size_t b = 0; b < count; b++)
+          state[b] = _mm_aesenc_si128(state[b], keys[r]);
+      for (size_t b = 0; b < count; b++)
+        _mm_storeu_si128((__m128i *)&out[(first + b) * 16],
+                         _mm_aesenclast_si128(state[b], keys[rounds]));
+    }
+  }
+#endif
+
+  void encrypt_blocks(uint8_t *out, const uint8_t *in, size_t num_blocks) const {
+#ifdef CNCRT_CPU_X86
+    if (m_use_aesni)
+      return encrypt_blocks_aesni(out, in, num_blocks);
+#endif
+    for (size_t b = 0; b < num_blocks; b++)
+      encrypt_block_software(&out[b * 16], &in[b * 16]);
+  }
+};
+
+#endif // CNCRT_CPU_AES_H
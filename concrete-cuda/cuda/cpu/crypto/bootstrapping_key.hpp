@@ -0,0 +1,93 @@
+#ifndef CNCRT_CPU_BSK_H
+#define CNCRT_CPU_BSK_H
+
+#include "complex/operations.hpp"
+#include "fft/bnsmfft.hpp"
+#include "utils/thread_pool.hpp"
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+// Host counterparts of src/crypto/bootstrapping_key.cuh, same layouts
+
+inline size_t get_start_ith_ggsw(int i, uint32_t polynomial_size,
+                                 int glwe_dimension, uint32_t l_gadget) {
+  return (size_t)i * polynomial_size / 2 * (glwe_dimension + 1) *
+         (glwe_dimension + 1) * l_gadget;
+}
+
+template <typename T>
+T *get_ith_mask_kth_block(T *ptr, int i, int k, int level,
+                          uint32_t polynomial_size, int glwe_dimension,
+                          uint32_t l_gadget) {
+  return &ptr[get_start_ith_ggsw(i, polynomial_size, glwe_dimension,
+                                 l_gadget) +
+              (size_t)level * polynomial_size / 2 * (glwe_dimension + 1) *
+                  (glwe_dimension + 1) +
+              (size_t)k * polynomial_size / 2 * (glwe_dimension + 1)];
+}
+
+template <typename T>
+T *get_ith_body_kth_block(T *ptr, int i, int k, int level,
+                          uint32_t polynomial_size, int glwe_dimension,
+                          uint32_t l_gadget) {
+  return &ptr[get_start_ith_ggsw(i, polynomial_size, glwe_dimension,
+                                 l_gadget) +
+              (size_t)level * polynomial_size / 2 * (glwe_dimension + 1) *
+                  (glwe_dimension + 1) +
+              (size_t)k * polynomial_size / 2 * (glwe_dimension + 1) +
+              polynomial_size / 2];
+}
+
+/// Number of GGSWs of a multi-bit bootstrapping key: the mask elements are
+/// grouped by grouping_factor, the last group possibly smaller, and each
+/// group has one GGSW per non-empty subset of its elements
+inline uint32_t get_multi_bit_ggsw_count(uint32_t input_lwe_dim,
+                                         uint32_t grouping_factor) {
+  uint32_t full_groups = input_lwe_dim / grouping_factor;
+  uint32_t last_group_size = input_lwe_dim % grouping_factor;
+  return full_groups * ((1u << grouping_factor) - 1) +
+         ((1u << last_group_size) - 1);
+}
+
+/// Polynomial src of torus elements seen as signed, compressed into
+/// polynomial_size / 2 complex numbers, divided by the maximum of T and
+/// transformed with the negacyclic FFT into dest: the Fourier domain of the
+/// bootstrapping keys
+template <typename T, typename ST>
+inline void convert_polynomial_to_fourier(double2 *dest, const ST *src,
+                                          uint32_t polynomial_size,
+                                          const NegacyclicFFT &fft,
+                                          SimdLevel level = get_simd_level()) {
+  for (uint32_t j = 0; j < polynomial_size / 2; j++) {
+    dest[j].x = src[2 * j];
+    dest[j].y = src[2 * j + 1];
+    dest[j].x /= (double)std::numeric_limits<T>::max();
+    dest[j].y /= (double)std::numeric_limits<T>::max();
+  }
+  fft.forward(dest, level);
+}
+
+/*
+ * Converts a bootstrapping key from the standard domain to the Fourier one,
+ * as cuda_convert_lwe_bootstrap_key: each polynomial is compressed into
+ * polynomial_size / 2 complex numbers, divided by the maximum of T and
+ * transformed with the negacyclic FFT. The polynomials are spread over the
+ * threads of the pool.
+ */
+template <typename T, typename ST>
+void cpu_convert_lwe_bootstrap_key(double2 *dest, const ST *src,
+                                   uint32_t input_lwe_dim, uint32_t glwe_dim,
+                                   uint32_t l_gadget, uint32_t polynomial_size,
+                                   ThreadPool &pool = ThreadPool::global()) {
+  uint32_t total_polynomials =
+      input_lwe_dim * (glwe_dim + 1) * (glwe_dim + 1) * l_gadget;
+  auto &fft = NegacyclicFFT::get(polynomial_size);
+  pool.parallel_for(0, total_polynomials, [&](uint32_t i) {
+    convert_polynomial_to_fourier<T, ST>(&dest[(size_t)i * polynomial_size / 2],
+                                         &src[(size_t)i * polynomial_size],
+                                         polynomial_size, fft);
+  });
+}
+
+#endif // CNCRT_CPU_BSK_H
@@ -0,0 +1,73 @@
+#ifndef CNCRT_CPU_GADGET_H
+#define CNCRT_CPU_GADGET_H
+
+#include <cstdint>
+
+// Host counterpart of GadgetMatrix in src/crypto/gadget.cuh, decomposes
+// whole polynomials
+template <typename T> class GadgetMatrix {
+private:
+  uint32_t l_gadget;
+  uint32_t base_log;
+  uint32_t mask;
+  uint32_t halfbg;
+  T offset;
+
+public:
+  GadgetMatrix(uint32_t base_log, uint32_t l_gadget)
+      : l_gadget(l_gadget), base_log(base_log) {
+    uint32_t bg = 1 << base_log;
+    this->halfbg = bg / 2;
+    this->mask = bg - 1;
+    T temp = 0;
+    for (uint32_t i = 0; i < this->l_gadget; i++) {
+      temp += 1ULL << (sizeof(T) * 8 - (i + 1) * this->base_log);
+    }
+    this->offset = temp * this->halfbg;
+  }
+
+  /// Signed digits of level level (0 being the most significant one) of the
+  /// size coefficients of polynomial
+  template <typename V>
+  void decompose_one_level(V *result, const T *polynomial, uint32_t level,
+                           uint32_t size) const {
+    uint32_t decal = (sizeof(T) * 8 - (level + 1) * this->base_log);
+    for (uint32_t i = 0; i < size; i++) {
+      T s = polynomial[i] + this->offset;
+      T temp1 = (s >> decal) & this->mask;
+      result[i] = (V)(temp1 - this->halfbg);
+    }
+  }
+};
+
+// Host counterpart of GadgetMatrixSingle in src/crypto/gadget.cuh
+template <typename T> class GadgetMatrixSingle {
+private:
+  uint32_t l_gadget;
+  uint32_t base_log;
+  uint32_t mask;
+  uint32_t halfbg;
+  T offset;
+
+public:
+  GadgetMatrixSingle(uint32_t base_log, uint32_t l_gadget)
+      : l_gadget(l_gadget), base_log(base_log) {
+    uint32_t bg = 1 << base_log;
+    this->halfbg = bg / 2;
+    this->mask = bg - 1;
+    T temp = 0;
+    for (uint32_t i = 0; i < this->l_gadget; i++) {
+      temp += 1ULL << (sizeof(T) * 8 - (i + 1) * this->base_log);
+    }
+    this->offset = temp * this->halfbg;
+  }
+
+  T decompose_one_level_single(T element, uint32_t level) const {
+    T s = element + this->offset;
+    uint32_t decal = (sizeof(T) * 8 - (level + 1) * this->base_log);
+    T temp1 = (s >> decal) & this->mask;
+    return (T)(temp1 - this->halfbg);
+  }
+};
+
+#endif // CNCRT_CPU_GADGET_H
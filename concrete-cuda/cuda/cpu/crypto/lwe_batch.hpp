@@ -0,0 +1,57 @@
+#ifndef CNCRT_CPU_LWE_BATCH_H
+#define CNCRT_CPU_LWE_BATCH_H
+
+#include "utils/thread_pool.hpp"
+#include <algorithm>
+#include <cstdint>
+
+/*
+ * Layouts of a batch of num_samples LWE ciphertexts of dimension
+ * lwe_dimension
+ *
+ * - sample-major, the layout of every other engine: the lwe_dimension + 1
+ * words (a_0, ..., a_{n-1}, b) of each ciphertext are contiguous, word k of
+ * sample s is at s * (lwe_dimension + 1) + k
+ * - coefficient-major: word k of all the samples are contiguous, word k of
+ * sample s is at k * num_samples + s, the bodies being the last row
+ *
+ * Converting from one to the other is a transposition of a (num_samples,
+ * lwe_dimension + 1) matrix, done by square tiles that fit in cache.
+ */
+const uint32_t LWE_BATCH_TRANSPOSE_TILE = 32;
+
+template <typename Torus>
+void transpose_matrix(Torus *out, const Torus *in, uint32_t rows,
+                      uint32_t cols, ThreadPool &pool) {
+  uint32_t tile = LWE_BATCH_TRANSPOSE_TILE;
+  uint32_t num_row_tiles = (rows + tile - 1) / tile;
+  pool.parallel_for(0, num_row_tiles, [&](uint32_t row_tile) {
+    uint32_t first_row = row_tile * tile;
+    uint32_t last_row = std::min(first_row + tile, rows);
+    for (uint32_t first_col = 0; first_col < cols; first_col += tile) {
+      uint32_t last_col = std::min(first_col + tile, cols);
+      for (uint32_t row = first_row; row < last_row; row++)
+        for (uint32_t col = first_col; col < last_col; col++)
+          out[(size_t)col * rows + row] = in[(size_t)row * cols + col];
+    }
+  });
+}
+
+/// Sample-major to coefficient-major, out and in must not overlap
+template <typename Torus>
+void cpu_lwe_batch_to_coefficient_major(Torus *lwe_out, const Torus *lwe_in,
+                                        uint32_t lwe_dimension,
+                                        uint32_t num_samples,
+                                        ThreadPool &pool = ThreadPool::global()) {
+  transpose_matrix(lwe_out, lwe_in, num_samples, lwe_dimension + 1, pool);
+}
+
+/// Coefficient-major to sample-major, out and in must not overlap
+template <typename Torus>
+void cpu_lwe_batch_from_coefficient_major(
+    Torus *lwe_out, const Torus *lwe_in, uint32_t lwe_dimension,
+    uint32_t num_samples, ThreadPool &pool = ThreadPool::global()) {
+  transpose_matrix(lwe_out, lwe_in, lwe_dimension + 1, num_samples, pool);
+}
+
+#endif // CNCRT_CPU_LWE_BATCH_H
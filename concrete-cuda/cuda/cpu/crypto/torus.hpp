@@ -0,0 +1,165 @@
+#ifndef CNCRT_CPU_TORUS_H
+#define CNCRT_CPU_TORUS_H
+
+#include "utils/simd.hpp"
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+// Host counterparts of the helpers in src/crypto/torus.cuh, they must stay
+// bit-identical to the device versions
+
+template <typename Torus> inline Torus typecast_double_to_torus(double x) {
+  if constexpr (sizeof(Torus) < 8) {
+    long long ret = x;
+    return (Torus)ret;
+  } else {
+    // x may reach 2^64, which wraps to 0 as in the device int128 conversion
+    return (Torus)(unsigned __int128)x;
+  }
+}
+
+template <typename T>
+inline T round_to_closest_multiple(T x, uint32_t base_log, uint32_t l_gadget) {
+  T shift = sizeof(T) * 8 - l_gadget * base_log;
+  T mask = 1ll << (shift - 1);
+  T b = (x & mask) >> (shift - 1);
+  T res = x >> shift;
+  res += b;
+  res <<= shift;
+  return res;
+}
+
+template <typename T>
+inline T rescale_torus_element(T element, uint32_t log_shift) {
+  return round((double)element / (double(std::numeric_limits<T>::max()) + 1.0) *
+               (double)log_shift);
+}
+
+template <typename T>
+inline T modulus_switch(T element, uint32_t log_modulus) {
+  T res = (element >> (sizeof(T) * 8 - log_modulus - 1)) + 1;
+  res >>= 1;
+  return res & (((T)1 << log_modulus) - 1);
+}
+
+/// out[i] = modulus_switch(in[i], log_modulus) for i in [0, size[, with
+/// log_modulus <= 16
+template <typename Torus>
+inline void modulus_switch_vector_scalar(uint16_t *out, const Torus *in,
+                                         uint32_t size, uint32_t log_modulus) {
+  for (uint32_t i = 0; i < size; i++)
+    out[i] = (uint16_t)modulus_switch(in[i], log_modulus);
+}
+
+#ifdef CNCRT_CPU_X86
+// The switched elements fit in 16 bits, they are narrowed by collecting the
+// low 32 bits words of the 64 bits lanes then packing them with AVX2, and
+// with the truncating conversions with AVX-512, all of them in their
+// zero-masked forms to avoid the GCC 12 false positive on the undefined
+// pass-through operand of the unmasked ones
+__attribute__((target("avx2"))) inline void
+modulus_switch_vector_avx2(uint16_t *out, const uint64_t *in, uint32_t size,
+                           uint32_t log_modulus) {
+  __m128i shift = _mm_cvtsi32_si128(64 - log_modulus - 1);
+  __m256i one = _mm256_set1_epi64x(1);
+  __m256i mask = _mm256_set1_epi64x(((uint64_t)1 << log_modulus) - 1);
+  __m256i low_words = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+  uint32_t i = 0;
+  for (; i + 4 <= size; i += 4) {
+    __m256i a = _mm256_loadu_si256((const __m256i *)&in[i]);
+    a = _mm256_add_epi64(_mm256_srl_epi64(a, shift), one);
+    a = _mm256_and_si256(_mm256_srli_epi64(a, 1), mask);
+    __m128i words =
+        _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(a, low_words));
+    _mm_storel_epi64((__m128i *)&out[i], _mm_packus_epi32(words, words));
+  }
+  modulus_switch_vector_scalar(&out[i], &in[i], size - i, log_modulus);
+}
+
+__attribute__((target("avx2"))) inline void
+modulus_switch_vector_avx2(uint16_t *out, const uint32_t *in, uint32_t size,
+                           uint32_t log_modulus) {
+  __m128i shift = _mm_cvtsi32_si128(32 - log_modulus - 1);
+  __m256i one = _mm256_set1_epi32(1);
+  __m256i mask = _mm256_set1_epi32((1u << log_modulus) - 1);
+  uint32_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    __m256i a = _mm256_loadu_si256((const __m256i *)&in[i]);
+    a = _mm256_add_epi32(_mm256_srl_epi32(a, shift), one);
+    a = _mm256_and_si256(_mm256_srli_epi32(a, 1), mask);
+    __m128i words = _mm_packus_epi32(_mm256_castsi256_si128(a),
+                                     _mm256_extracti128_si256(a, 1));
+    _mm_storeu_si128((__m128i *)&out[i], words);
+  }
+  modulus_switch_vector_scalar(&out[i], &in[i], size - i, log_modulus);
+}
+
+__attribute__((target("avx512f"))) inline void
+modulus_switch_vector_avx512(uint16_t *out, const uint64_t *in, uint32_t size,
+                             uint32_t log_modulus) {
+  __m128i shift = _mm_cvtsi32_si128(64 - log_modulus - 1);
+  __m512i one = _mm512_set1_epi64(1);
+  __m512i mask = _mm512_set1_epi64(((uint64_t)1 << log_modulus) - 1);
+  uint32_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    __m512i a = _mm512_loadu_si512((const void *)&in[i]);
+    a = _mm512_add_epi64(_mm512_maskz_srl_epi64(0xff, a, shift), one);
+    a = _mm512_and_si512(_mm512_maskz_srli_epi64(0xff, a, 1), mask);
+    _mm_storeu_si128((__m128i *)&out[i], _mm512_maskz_cvtepi64_epi16(0xff, a));
+  }
+  modulus_switch_vector_scalar(&out[i], &in[i], size - i, log_modulus);
+}
+
+__attribute__((target("avx512f"))) inline void
+modulus_switch_vector_avx512(uint16_t *out, const uint32_t *in, uint32_t size,
+                             uint32_t log_modulus) {
+  __m128i shift = _mm_cvtsi32_si128(32 - log_modulus - 1);
+  __m512i one = _mm512_set1_epi32(1);
+  __m512i mask = _mm512_set1_epi32((1u << log_modulus) - 1);
+  uint32_t i = 0;
+  for (; i + 16 <= size; i += 16) {
+    __m512i a = _mm512_loadu_si512((const void *)&in[i]);
+    a = _mm512_add_epi32(_mm512_maskz_srl_epi32(0xffff, a, shift), one);
+    a = _mm512_and_si512(_mm512_maskz_srli_epi32(0xffff, a, 1), mask);
+    _mm256_storeu_si256((__m256i *)&out[i], _mm512_maskz_cvtepi32_epi16(0xffff, a));
+  }
+  modulus_switch_vector_scalar(&out[i], &in[i], size - i, log_modulus);
+}
+#endif
+
+/// Integer modulus switch of a vector of torus elements to [0,
+/// 2^log_modulus[ in 16 bits words, the vectorized counterpart of
+/// modulus_switch. It is the exact rounding of rescale_torus_element, which
+/// it matches bit for bit modulo 2^log_modulus on 32 bits; on 64 bits the
+/// conversion to double of rescale_torus_element may round the elements
+/// lying less than 2^11 below a rounding boundary onto it. The blind
+/// rotations use it, or modulus_switch through rescale_input_element, like
+/// the device does, and never rescale_torus_element.
+template <typename Torus>
+inline void modulus_switch_vector(uint16_t *out, const Torus *in,
+                                  uint32_t size, uint32_t log_modulus,
+                                  SimdLevel level = get_simd_level()) {
+#ifdef CNCRT_CPU_X86
+  if (level == AVX512)
+    return modulus_switch_vector_avx512(out, in, size, log_modulus);
+  if (level == AVX2)
+    return modulus_switch_vector_avx2(out, in, size, log_modulus);
+#endif
+  modulus_switch_vector_scalar(out, in, size, log_modulus);
+}
+
+/// Monomial degree in [0, log_shift[ of an element of the input of a blind
+/// rotation, log_shift being the power of two 2N: the inputs switched by
+/// the pre-pass are already degrees, the torus ones go through
+/// modulus_switch to match the device bit for bit
+template <typename Torus, typename InputTorus>
+inline Torus rescale_input_element(InputTorus element, uint32_t log_shift) {
+  if constexpr (std::is_same<InputTorus, uint16_t>::value)
+    return (Torus)element;
+  else
+    return modulus_switch(element, __builtin_ctz(log_shift));
+}
+
+#endif // CNCRT_CPU_TORUS_H
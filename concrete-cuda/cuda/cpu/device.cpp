@@ -0,0 +1,85 @@
+#include "device.h"
+#include "utils/host_stream.hpp"
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+/// Creates a host stream, a worker thread running the enqueued work in order
+void *cpu_create_stream() { return new HostStream; }
+
+/// Waits for the work enqueued on the stream and destroys it
+int cpu_destroy_stream(void *v_stream) {
+  auto stream = static_cast<HostStream *>(v_stream);
+  delete stream;
+  return 0;
+}
+
+/// Waits for all the work enqueued on the stream
+int cpu_synchronize_stream(void *v_stream) {
+  auto stream = static_cast<HostStream *>(v_stream);
+  stream->synchronize();
+  return 0;
+}
+
+/// Creates a host event, the handle is a reference to an event shared with
+/// the stream tasks that record or wait for it
+void *cpu_create_event() {
+  return new std::shared_ptr<HostEvent>(std::make_shared<HostEvent>());
+}
+
+/// Waits for the last record of the event and releases the handle, the
+/// event itself lives until the wait tasks still queued on other streams
+/// are done
+int cpu_destroy_event(void *v_event) {
+  auto event = static_cast<std::shared_ptr<HostEvent> *>(v_event);
+  (*event)->synchronize();
+  delete event;
+  return 0;
+}
+
+/// Records in the event all the work enqueued so far on the stream
+int cpu_record_event(void *v_event, void *v_stream) {
+  auto event = static_cast<std::shared_ptr<HostEvent> *>(v_event);
+  auto stream = static_cast<HostStream *>(v_stream);
+  stream->record(*event);
+  return 0;
+}
+
+/// Checks whether the work recorded in the event is done, without blocking
+/// 1: done
+/// 0: still running
+int cpu_query_event(void *v_event) {
+  auto event = static_cast<std::shared_ptr<HostEvent> *>(v_event);
+  return (*event)->query() ? 1 : 0;
+}
+
+/// Blocks until the work recorded in the event is done
+int cpu_synchronize_event(void *v_event) {
+  auto event = static_cast<std::shared_ptr<HostEvent> *>(v_event);
+  (*event)->synchronize();
+  return 0;
+}
+
+/// Makes the work enqueued afterwards on the stream wait for the work
+/// recorded in the event, without blocking the caller
+int cpu_stream_wait_event(void *v_stream, void *v_event) {
+  auto stream = static_cast<HostStream *>(v_stream);
+  auto event = static_cast<std::shared_ptr<HostEvent> *>(v_event);
+  stream->wait_event(*event);
+  return 0;
+}
+
+/// Enqueues a copy on the stream, the counterpart of the cuda_memcpy_async_*
+/// functions
+/// 0: success
+/// -3: error, zero copy size
+int cpu_memcpy_async(void *dest, const void *src, uint64_t size,
+                     void *v_stream) {
+  if (size == 0) {
+    // error code: zero copy size
+    return -3;
+  }
+  auto stream = static_cast<HostStream *>(v_stream);
+  stream->enqueue([=] { memcpy(dest, src, size); });
+  return 0;
+}
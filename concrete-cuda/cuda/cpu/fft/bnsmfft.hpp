@@ -0,0 +1,304 @@
+#ifndef CNCRT_CPU_BNSMFFT_H
+#define CNCRT_CPU_BNSMFFT_H
+
+#include "complex/operations.hpp"
+#include "utils/simd.hpp"
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+/*
+ * Host counterpart of the negacyclic FFT of src/fft/bnsmfft.cuh
+ *
+ * The N real coefficients of a polynomial are compressed into N/2 complex
+ * numbers, the even coefficients in the real parts and the odd ones in the
+ * imaginary parts. The direct transform bit-reverses them, runs the
+ * log2(N/2) butterfly levels with the twiddles exp(i pi (2r + 1) / 2^k) of
+ * the negTwids tables, and applies the correction step with the twiddles
+ * exp(i pi (2j + 1) / N). The inverse transform runs the same steps
+ * backwards with the conjugate twiddles, halving the values at each level.
+ * The spectra are thus laid out as those of the device engine, in
+ * particular the Fourier bootstrapping keys.
+ *
+ * The butterfly levels are vectorized on the interleaved complex numbers
+ * with AVX2 (2 complex numbers per register) and AVX-512 (4 per register),
+ * the first levels, whose butterflies are narrower than a register, are
+ * done on scalars.
+ */
+
+inline void direct_butterflies_scalar(double2 *A, const double2 *twiddles,
+                                      uint32_t fft_size, uint32_t half) {
+  for (uint32_t b = 0; b < fft_size; b += 2 * half) {
+    for (uint32_t r = 0; r < half; r++) {
+      double2 u = A[b + r];
+      double2 v = A[b + r + half] * twiddles[half + r];
+      A[b + r] = u + v;
+      A[b + r + half] = u - v;
+    }
+  }
+}
+
+inline void inverse_butterflies_scalar(double2 *A,
+                                       const double2 *inverse_twiddles,
+                                       uint32_t fft_size, uint32_t half) {
+  for (uint32_t b = 0; b < fft_size; b += 2 * half) {
+    for (uint32_t r = 0; r < half; r++) {
+      double2 u = A[b + r];
+      double2 v = A[b + r + half];
+      A[b + r] = (u + v) * 0.5;
+      A[b + r + half] = (u - v) * inverse_twiddles[half + r];
+    }
+  }
+}
+
+#ifdef CNCRT_CPU_X86
+__attribute__((target("avx2,fma"))) inline void
+direct_butterflies_avx2(double2 *A, const double2 *twiddles, uint32_t fft_size,
+                        uint32_t half) {
+  double *data = (double *)A;
+  const double *w = (const double *)twiddles;
+  for (uint32_t b = 0; b < fft_size; b += 2 * half) {
+    for (uint32_t r = 0; r < half; r += 2) {
+      __m256d u = _mm256_loadu_pd(&data[2 * (b + r)]);
+      __m256d v = complex_mul_avx2(_mm256_loadu_pd(&data[2 * (b + r + half)]),
+                                   _mm256_loadu_pd(&w[2 * (half + r)]));
+      _mm256_storeu_pd(&data[2 * (b + r)], _mm256_add_pd(u, v));
+      _mm256_storeu_pd(&data[2 * (b + r + half)], _mm256_sub_pd(u, v));
+    }
+  }
+}
+
+__attribute__((target("avx2,fma"))) inline void
+inverse_butterflies_avx2(double2 *A, const double2 *inverse_twiddles,
+                         uint32_t fft_size, uint32_t half) {
+  double *data = (double *)A;
+  const double *w = (const double *)inverse_twiddles;
+  __m256d one_half = _mm256_set1_pd(0.5);
+  for (uint32_t b = 0; b < fft_size; b += 2 * half) {
+    for (uint32_t r = 0; r < half; r += 2) {
+      __m256d u = _mm256_loadu_pd(&data[2 * (b + r)]);
+      __m256d v = _mm256_loadu_pd(&data[2 * (b + r + half)]);
+      _mm256_storeu_pd(&data[2 * (b + r)],
+                       _mm256_mul_pd(_mm256_add_pd(u, v), one_half));
+      _mm256_storeu_pd(&data[2 * (b + r + half)],
+                       complex_mul_avx2(_mm256_sub_pd(u, v),
+                                        _mm256_loadu_pd(&w[2 * (half + r)])));
+    }
+  }
+}
+
+__attribute__((target("avx512f"))) inline void
+direct_butterflies_avx512(double2 *A, const double2 *twiddles,
+                          uint32_t fft_size, uint32_t half) {
+  double *data = (double *)A;
+  const double *w = (const double *)twiddles;
+  for (uint32_t b = 0; b < fft_size; b += 2 * half) {
+    for (uint32_t r = 0; r < half; r += 4) {
+      __m512d u = _mm512_loadu_pd(&data[2 * (b + r)]);
+      __m512d v =
+          complex_mul_avx512(_mm512_loadu_pd(&data[2 * (b + r + half)]),
+                             _mm512_loadu_pd(&w[2 * (half + r)]));
+      _mm512_storeu_pd(&data[2 * (b + r)], _mm512_add_pd(u, v));
+      _mm512_storeu_pd(&data[2 * (b + r + half)], _mm512_sub_pd(u, v));
+    }
+  }
+}
+
+__attribute__((target("avx512f"))) inline void
+inverse_butterflies_avx512(double2 *A, const double2 *inverse_twiddles,
+                           uint32_t fft_size, uint32_t half) {
+  double *data = (double *)A;
+  const double *w = (const double *)inverse_twiddles;
+  __m512d one_half = _mm512_set1_pd(0.5);
+  for (uint32_t b = 0; b < fft_size; b += 2 * half) {
+    for (uint32_t r = 0; r < half; r += 4) {
+      __m512d u = _mm512_loadu_pd(&data[2 * (b + r)]);
+      __m512d v = _mm512_loadu_pd(&data[2 * (b + r + half)]);
+      _mm512_storeu_pd(&data[2 * (b + r)],
+                       _mm512_mul_pd(_mm512_add_pd(u, v), one_half));
+      _mm512_storeu_pd(&data[2 * (b + r + half)],
+                       complex_mul_avx512(_mm512_sub_pd(u, v),
+                                          _mm512_loadu_pd(&w[2 * (half + r)])));
+    }
+  }
+}
+#endif
+
+inline void direct_butterflies(double2 *A, const double2 *twiddles,
+                               uint32_t fft_size, uint32_t half,
+                               SimdLevel level) {
+#ifdef CNCRT_CPU_X86
+  if (level == AVX512 && half >= 4)
+    return direct_butterflies_avx512(A, twiddles, fft_size, half);
+  if (level >= AVX2 && half >= 2)
+    return direct_butterflies_avx2(A, twiddles, fft_size, half);
+#endif
+  direct_butterflies_scalar(A, twiddles, fft_size, half);
+}
+
+inline void inverse_butterflies(double2 *A, const double2 *inverse_twiddles,
+                                uint32_t fft_size, uint32_t half,
+                                SimdLevel level) {
+#ifdef CNCRT_CPU_X86
+  if (level == AVX512 && half >= 4)
+    return inverse_butterflies_avx512(A, inverse_twiddles, fft_size, half);
+  if (level >= AVX2 && half >= 2)
+    return inverse_butterflies_avx2(A, inverse_twiddles, fft_size, half);
+#endif
+  inverse_butterflies_scalar(A, inverse_twiddles, fft_size, half);
+}
+
+/*
+ * Precomputed tables of the negacyclic FFT of a polynomial size, shared by
+ * all the threads. get returns the tables of a polynomial size, computed on
+ * the first call.
+ */
+class NegacyclicFFT {
+public:
+  explicit NegacyclicFFT(uint32_t polynomial_size)
+      : degree(polynomial_size), fft_size(polynomial_size / 2),
+        twiddles(polynomial_size / 2), inverse_twiddles(polynomial_size / 2),
+        correction_twiddles(polynomial_size / 4), roots(2 * polynomial_size) {
+    // Same bit reversal swaps as cuda_initialize_twiddles
+    for (uint32_t i = 1, j = 0; i < fft_size; i++) {
+      uint32_t bit = fft_size >> 1;
+      for (; j & bit; bit >>= 1)
+        j ^= bit;
+      j ^= bit;
+      if (i < j)
+        swaps.emplace_back(i, j);
+    }
+    // The twiddles of the level with butterflies of width half are stored
+    // at [half, 2 * half[, they are those of the negTwids tables
+    const long double pi = 3.141592653589793238462643383279502884L;
+    for (uint32_t half = 1; half < fft_size; half *= 2) {
+      for (uint32_t r = 0; r < half; r++) {
+        long double angle = pi * (2 * r + 1) / (2 * half);
+        twiddles[half + r] = {(double)std::cos(angle), (double)std::sin(angle)};
+      }
+    }
+    // exp(i pi / 2) is exactly i in the device engine
+    if (fft_size > 1)
+      twiddles[1] = {0., 1.};
+    for (uint32_t k = 1; k < fft_size; k++)
+      inverse_twiddles[k] = conjugate(twiddles[k]) * 0.5;
+    for (uint32_t j = 0; j < degree / 4; j++) {
+      long double angle = pi * (2 * j + 1) / degree;
+      correction_twiddles[j] = {(double)std::cos(angle),
+                                (double)std::sin(angle)};
+    }
+    for (uint32_t t = 0; t < 2 * degree; t++) {
+      long double angle = pi * t / degree;
+      roots[t] = {(double)std::cos(angle), (double)std::sin(angle)};
+    }
+  }
+
+  static const NegacyclicFFT &get(uint32_t polynomial_size) {
+    static std::mutex mtx;
+    static std::map<uint32_t, std::unique_ptr<NegacyclicFFT>> ffts;
+    std::lock_guard<std::mutex> lock(mtx);
+    auto &fft = ffts[polynomial_size];
+    if (!fft)
+      fft.reset(new NegacyclicFFT(polynomial_size));
+    return *fft;
+  }
+
+  uint32_t polynomial_size() const { return degree; }
+
+  /// Value at the point j of the forward transform of X^monomial_degree:
+  /// the transform evaluates polynomials at exp(i pi (2j + 1) / N) for j in
+  /// [0, N / 2[, so that products become pointwise
+  double2 monomial(uint32_t j, uint32_t monomial_degree) const {
+    return roots[(uint64_t)(2 * j + 1) * monomial_degree % (2 * degree)];
+  }
+
+  /// NSMFFT_direct followed by correction_direct_fft_inplace, on
+  /// polynomial_size / 2 complex numbers
+  void forward(double2 *A, SimdLevel level = get_simd_level()) const {
+    bit_reverse_inplace(A);
+    for (uint32_t half = 1; half < fft_size; half *= 2)
+      direct_butterflies(A, twiddles.data(), fft_size, half, level);
+    correction_direct_fft_inplace(A);
+  }
+
+  /// forward on count consecutive polynomials of polynomial_size / 2
+  /// complex numbers, each butterfly level being run on all of them before
+  /// the next one: its twiddles are loaded once for the batch and the
+  /// butterflies of the different polynomials, independent, overlap in the
+  /// pipeline. The results are those of forward
+  void forward_batch(double2 *A, uint32_t count,
+                     SimdLevel level = get_simd_level()) const {
+    for (uint32_t p = 0; p < count; p++)
+      bit_reverse_inplace(&A[(size_t)p * fft_size]);
+    for (uint32_t half = 1; half < fft_size; half *= 2)
+      direct_butterflies(A, twiddles.data(), count * fft_size, half, level);
+    for (uint32_t p = 0; p < count; p++)
+      correction_direct_fft_inplace(&A[(size_t)p * fft_size]);
+  }
+
+  /// correction_inverse_fft_inplace followed by NSMFFT_inverse
+  void inverse(double2 *A, SimdLevel level = get_simd_level()) const {
+    correction_inverse_fft_inplace(A);
+    for (uint32_t half = fft_size / 2; half >= 1; half /= 2)
+      inverse_butterflies(A, inverse_twiddles.data(), fft_size, half, level);
+    bit_reverse_inplace(A);
+  }
+
+private:
+  uint32_t degree;
+  uint32_t fft_size;
+  std::vector<std::pair<uint32_t, uint32_t>> swaps;
+  std::vector<double2> twiddles;
+  std::vector<double2> inverse_twiddles;
+  std::vector<double2> correction_twiddles;
+  std::vector<double2> roots;
+
+  void bit_reverse_inplace(double2 *A) const {
+    for (auto &swap : swaps)
+      std::swap(A[swap.first], A[swap.second]);
+  }
+
+  void correction_direct_fft_inplace(double2 *x) const {
+    for (uint32_t j = 0; j < degree / 4; j++) {
+      double2 left = x[j];
+      double2 right = x[fft_size - j - 1];
+      double2 tw = correction_twiddles[j];
+      double add_RE = left.x + right.x;
+      double sub_RE = left.x - right.x;
+      double add_IM = left.y + right.y;
+      double sub_IM = left.y - right.y;
+
+      double tmp1 = add_IM * tw.x + sub_RE * tw.y;
+      double tmp2 = -sub_RE * tw.x + add_IM * tw.y;
+      x[j].x = (add_RE + tmp1) * 0.5;
+      x[j].y = (sub_IM + tmp2) * 0.5;
+      x[fft_size - j - 1].x = (add_RE - tmp1) * 0.5;
+      x[fft_size - j - 1].y = (-sub_IM + tmp2) * 0.5;
+    }
+  }
+
+  void correction_inverse_fft_inplace(double2 *x) const {
+    for (uint32_t j = 0; j < degree / 4; j++) {
+      double2 left = x[j];
+      double2 right = x[fft_size - j - 1];
+      double2 tw = correction_twiddles[j];
+      double add_RE = left.x + right.x;
+      double sub_RE = left.x - right.x;
+      double add_IM = left.y + right.y;
+      double sub_IM = left.y - right.y;
+
+      double tmp1 = add_IM * tw.x - sub_RE * tw.y;
+      double tmp2 = sub_RE * tw.x + add_IM * tw.y;
+      x[j].x = (add_RE - tmp1) * 0.5;
+      x[j].y = (sub_IM + tmp2) * 0.5;
+      x[fft_size - j - 1].x = (add_RE + tmp1) * 0.5;
+      x[fft_size - j - 1].y = (-sub_IM + tmp2) * 0.5;
+    }
+  }
+};
+
+#endif // CNCRT_CPU_BNSMFFT_H
@@ -0,0 +1,535 @@
+#include "keyswitch.hpp"
+#include "keyswitch.h"
+#include "keyswitch_coefficient_major.hpp"
+#include "keyswitch_gemm.hpp"
+#include "packing_keyswitch.hpp"
+#include "utils/host_stream.hpp"
+
+#include <cstdint>
+
+/* Perform keyswitch on a batch of input LWE ciphertexts for 32 bits on the
+ * CPU
+ *
+ * Same arguments and same results as cuda_keyswitch_lwe_ciphertext_vector_32,
+ * but all the buffers live in host memory. v_stream is not used, the
+ * function returns once the batch is keyswitched.
+ *
+ * The samples are spread over the threads of the global pool and the
+ * accumulation of the KSK rows is vectorized with AVX2/AVX-512 when the CPU
+ * supports it
+ */
+void cpu_keyswitch_lwe_ciphertext_vector_32(void * /*v_stream*/, void *lwe_out, void *lwe_in,
+                        void *ksk,
+                        uint32_t lwe_dimension_before,
+                        uint32_t lwe_dimension_after,
+                        uint32_t base_log, uint32_t l_gadget,
+                        uint32_t num_samples) {
+    cpu_keyswitch_lwe_ciphertext_vector(
+            static_cast<uint32_t *>(lwe_out), static_cast<uint32_t *>(lwe_in),
+            static_cast<uint32_t*>(ksk),
+            lwe_dimension_before, lwe_dimension_after,
+            base_log, l_gadget,
+            num_samples);
+}
+
+/* Perform keyswitch on a batch of input LWE ciphertexts for 64 bits on the
+ * CPU
+ *
+ * See cpu_keyswitch_lwe_ciphertext_vector_32
+ */
+void cpu_keyswitch_lwe_ciphertext_vector_64(void * /*v_stream*/, void *lwe_out, void *lwe_in,
+                        void *ksk,
+                        uint32_t lwe_dimension_before,
+                        uint32_t lwe_dimension_after,
+                        uint32_t base_log, uint32_t l_gadget,
+                        uint32_t num_samples) {
+    cpu_keyswitch_lwe_ciphertext_vector(
+            static_cast<uint64_t *>(lwe_out), static_cast<uint64_t *>(lwe_in),
+            static_cast<uint64_t*>(ksk),
+            lwe_dimension_before, lwe_dimension_after,
+            base_log, l_gadget,
+            num_samples);
+}
+
+/* Perform a cache-blocked keyswitch on a batch of input LWE ciphertexts for
+ * 32 bits on the CPU
+ *
+ * Same arguments and results as cpu_keyswitch_lwe_ciphertext_vector_32, but
+ * the KSK is applied tile by tile to groups of ciphertexts so that it is
+ * streamed from memory once per group instead of once per ciphertext. The
+ * tiles are sized for a 1 MB cache, this mode pays off for batches of a few
+ * ciphertexts per thread or more.
+ */
+void cpu_keyswitch_tiled_lwe_ciphertext_vector_32(void * /*v_stream*/, void *lwe_out, void *lwe_in,
+                        void *ksk,
+                        uint32_t lwe_dimension_before,
+                        uint32_t lwe_dimension_after,
+                        uint32_t base_log, uint32_t l_gadget,
+                        uint32_t num_samples) {
+    cpu_keyswitch_tiled_lwe_ciphertext_vector(
+            static_cast<uint32_t *>(lwe_out), static_cast<uint32_t *>(lwe_in),
+            static_cast<uint32_t*>(ksk),
+            lwe_dimension_before, lwe_dimension_after,
+            base_log, l_gadget,
+            num_samples);
+}
+
+/* Perform a cache-blocked keyswitch on a batch of input LWE ciphertexts for
+ * 64 bits on the CPU
+ *
+ * See cpu_keyswitch_tiled_lwe_ciphertext_vector_32
+ */
+void cpu_keyswitch_tiled_lwe_ciphertext_vector_64(void * /*v_stream*/, void *lwe_out, void *lwe_in,
+                        void *ksk,
+                        uint32_t lwe_dimension_before,
+                        uint32_t lwe_dimension_after,
+                        uint32_t base_log, uint32_t l_gadget,
+                        uint32_t num_samples) {
+    cpu_keyswitch_tiled_lwe_ciphertext_vector(
+            static_cast<uint64_t *>(lwe_out), static_cast<uint64_t *>(lwe_in),
+            static_cast<uint64_t*>(ksk),
+            lwe_dimension_before, lwe_dimension_after,
+            base_log, l_gadget,
+            num_samples);
+}
+
+/* Perform keyswitch on a batch of input LWE ciphertexts for 32 bits on the
+ * CPU, as a product between the matrix of the decomposed input masks and
+ * the KSK
+ *
+ * Same arguments as cpu_keyswitch_lwe_ciphertext_vector_32. The whole batch
+ * is first decomposed into a matrix of 8, 16 or 32 bits digits with the
+ * GadgetMatrixSingle decomposition, then a register blocked kernel computes
+ * its product with the KSK, which makes the keyswitch compute bound for
+ * large batches. The result decrypts like the other engines but may differ
+ * from them in the noise bits, since the digit equal to -B/2 is not chosen
+ * in the same way.
+ */
+void cpu_keyswitch_gemm_lwe_ciphertext_vector_32(void * /*v_stream*/, void *lwe_out, void *lwe_in,
+                        void *ksk,
+                        uint32_t lwe_dimension_before,
+                        uint32_t lwe_dimension_after,
+                        uint32_t base_log, uint32_t l_gadget,
+                        uint32_t num_samples) {
+    cpu_keyswitch_gemm_lwe_ciphertext_vector(
+            static_cast<uint32_t *>(lwe_out), static_cast<uint32_t *>(lwe_in),
+            static_cast<uint32_t*>(ksk),
+            lwe_dimension_before, lwe_dimension_after,
+            base_log, l_gadget,
+            num_samples);
+}
+
+/* Perform keyswitch on a batch of input LWE ciphertexts for 64 bits on the
+ * CPU, as a product between the matrix of the decomposed input masks and
+ * the KSK
+ *
+ * See cpu_keyswitch_gemm_lwe_ciphertext_vector_32
+ */
+void cpu_keyswitch_gemm_lwe_ciphertext_vector_64(void * /*v_stream*/, void *lwe_out, void *lwe_in,
+                        void *ksk,
+                        uint32_t lwe_dimension_before,
+                        uint32_t lwe_dimension_after,
+                        uint32_t base_log, uint32_t l_gadget,
+                        uint32_t num_samples) {
+    cpu_keyswitch_gemm_lwe_ciphertext_vector(
+            static_cast<uint64_t *>(lwe_out), static_cast<uint64_t *>(lwe_in),
+            static_cast<uint64_t*>(ksk),
+            lwe_dimension_before, lwe_dimension_after,
+            base_log, l_gadget,
+            num_samples);
+}
+
+/* Perform keyswitch on a batch of input LWE ciphertexts for 32 bits on the
+ * CPU with a seeded keyswitch key
+ *
+ * - ksk_bodies: the lwe_dimension_before * l_gadget bodies of the KSK, in
+ * the order of the rows of the regular KSK
+ * - seed: the 16 bytes AES-128 key the masks of the KSK are generated from,
+ * i.e. the little endian bytes of the CompressionSeed of a concrete-core
+ * LweSeededKeyswitchKey. Mask element k of row r is word
+ * r * lwe_dimension_after + k of the random stream of the seed, see
+ * AesCtr128 in cpu/crypto/aes.hpp
+ *
+ * The other arguments are the ones of cpu_keyswitch_lwe_ciphertext_vector_32.
+ * The stored key is lwe_dimension_after + 1 times smaller than the regular
+ * one: every group of ciphertexts regenerates the KSK tile by tile in a
+ * cache resident buffer, and the result is bit-identical to the keyswitch
+ * with the expanded key.
+ */
+void cpu_keyswitch_seeded_lwe_ciphertext_vector_32(void * /*v_stream*/, void *lwe_out, void *lwe_in,
+                        void *ksk_bodies, void *seed,
+                        uint32_t lwe_dimension_before,
+                        uint32_t lwe_dimension_after,
+                        uint32_t base_log, uint32_t l_gadget,
+                        uint32_t num_samples) {
+    cpu_keyswitch_seeded_lwe_ciphertext_vector(
+            static_cast<uint32_t *>(lwe_out), static_cast<uint32_t *>(lwe_in),
+            static_cast<uint32_t*>(ksk_bodies), static_cast<uint8_t *>(seed),
+            lwe_dimension_before, lwe_dimension_after,
+            base_log, l_gadget,
+            num_samples);
+}
+
+/* Perform keyswitch on a batch of input LWE ciphertexts for 64 bits on the
+ * CPU with a seeded keyswitch key
+ *
+ * See cpu_keyswitch_seeded_lwe_ciphertext_vector_32
+ */
+void cpu_keyswitch_seeded_lwe_ciphertext_vector_64(void * /*v_stream*/, void *lwe_out, void *lwe_in,
+                        void *ksk_bodies, void *seed,
+                        uint32_t lwe_dimension_before,
+                        uint32_t lwe_dimension_after,
+                        uint32_t base_log, uint32_t l_gadget,
+                        uint32_t num_samples) {
+    cpu_keyswitch_seeded_lwe_ciphertext_vector(
+            static_cast<uint64_t *>(lwe_out), static_cast<uint64_t *>(lwe_in),
+            static_cast<uint64_t*>(ksk_bodies), static_cast<uint8_t *>(seed),
+            lwe_dimension_before, lwe_dimension_after,
+            base_log, l_gadget,
+            num_samples);
+}
+
+/* Expand a seeded keyswitch key for 32 bits into a regular one
+ *
+ * - ksk: output, lwe_dimension_before * l_gadget * (lwe_dimension_after + 1)
+ * words in the layout expected by cpu_keyswitch_lwe_ciphertext_vector_32
+ * - ksk_bodies, seed: the seeded key, see
+ * cpu_keyswitch_seeded_lwe_ciphertext_vector_32
+ *
+ * The expanded key can be copied to the GPU with cuda_memcpy_async_to_gpu
+ * and used with cuda_keyswitch_lwe_ciphertext_vector_32.
+ */
+void cpu_expand_seeded_lwe_keyswitch_key_32(void *ksk, void *ksk_bodies, void *seed,
+                        uint32_t lwe_dimension_before,
+                        uint32_t lwe_dimension_after,
+                        uint32_t l_gadget) {
+    cpu_expand_seeded_lwe_keyswitch_key(
+            static_cast<uint32_t *>(ksk), static_cast<uint32_t *>(ksk_bodies),
+            static_cast<uint8_t *>(seed),
+            lwe_dimension_before, lwe_dimension_after, l_gadget);
+}
+
+/* Expand a seeded keyswitch key for 64 bits into a regular one
+ *
+ * See cpu_expand_seeded_lwe_keyswitch_key_32
+ */
+void cpu_expand_seeded_lwe_keyswitch_key_64(void *ksk, void *ksk_bodies, void *seed,
+                        uint32_t lwe_dimension_before,
+                        uint32_t lwe_dimension_after,
+                        uint32_t l_gadget) {
+    cpu_expand_seeded_lwe_keyswitch_key(
+            static_cast<uint64_t *>(ksk), static_cast<uint64_t *>(ksk_bodies),
+            static_cast<uint8_t *>(seed),
+            lwe_dimension_before, lwe_dimension_after, l_gadget);
+}
+
+/* Truncate a 64 bits keyswitch key to 32 bits words
+ *
+ * - ksk_out: output, lwe_dimension_before * l_gadget * (lwe_dimension_after
+ * + 1) 32 bits words
+ * - ksk_in: 64 bits KSK in the layout of cpu_keyswitch_lwe_ciphertext_vector_64
+ *
+ * Every element is replaced by its high 32 bits word rounded to the closest.
+ * After round_to_closest_multiple only the top base_log * l_gadget bits of
+ * the input masks are used, and the low words of the KSK are mostly noise,
+ * so the truncated key is half the size for a small additional noise, see
+ * cpu_truncated_keyswitch_key_noise_variance_64.
+ */
+void cpu_truncate_lwe_keyswitch_key_64(void *ksk_out, void *ksk_in,
+                        uint32_t lwe_dimension_before,
+                        uint32_t lwe_dimension_after,
+                        uint32_t l_gadget) {
+    cpu_truncate_lwe_keyswitch_key(
+            static_cast<uint32_t *>(ksk_out), static_cast<uint64_t *>(ksk_in),
+            lwe_dimension_before, lwe_dimension_after, l_gadget);
+}
+
+/* Perform keyswitch on a batch of input LWE ciphertexts for 64 bits on the
+ * CPU with a truncated keyswitch key
+ *
+ * - ksk: KSK truncated by cpu_truncate_lwe_keyswitch_key_64
+ *
+ * The other arguments are the ones of cpu_keyswitch_lwe_ciphertext_vector_64.
+ * The KSK words are widened to 64 bits inside the accumulation loop, with the
+ * cache blocking of cpu_keyswitch_tiled_lwe_ciphertext_vector_64. The
+ * result differs from the keyswitch with the full key by a noise of
+ * variance cpu_truncated_keyswitch_key_noise_variance_64.
+ */
+void cpu_keyswitch_truncated_lwe_ciphertext_vector_64(void * /*v_stream*/, void *lwe_out, void *lwe_in,
+                        void *ksk,
+                        uint32_t lwe_dimension_before,
+                        uint32_t lwe_dimension_after,
+                        uint32_t base_log, uint32_t l_gadget,
+                        uint32_t num_samples) {
+    cpu_keyswitch_truncated_lwe_ciphertext_vector(
+            static_cast<uint64_t *>(lwe_out), static_cast<uint64_t *>(lwe_in),
+            static_cast<uint32_t*>(ksk),
+            lwe_dimension_before, lwe_dimension_after,
+            base_log, l_gadget,
+            num_samples);
+}
+
+/* Variance of the noise added to every keyswitched ciphertext by the
+ * truncation of the KSK, on the torus normalized to [0, 1[ and for binary
+ * keys
+ *
+ * It is to be added to the variance of the keyswitch with the full key. For
+ * instance lwe_dimension_before = 2048, lwe_dimension_after = 750, base_log
+ * = 3 and l_gadget = 5 give a standard deviation of about 2^-21.6, to be
+ * compared with the standard deviation of the KSK encryption noise.
+ */
+double cpu_truncated_keyswitch_key_noise_variance_64(
+                        uint32_t lwe_dimension_before,
+                        uint32_t lwe_dimension_after,
+                        uint32_t base_log, uint32_t l_gadget) {
+    return get_truncated_ksk_noise_variance(lwe_dimension_before,
+                                            lwe_dimension_after,
+                                            base_log, l_gadget);
+}
+
+/* Convert a batch of LWE ciphertexts for 32 bits from the sample-major
+ * layout to the coefficient-major one
+ *
+ * - lwe_out: output, word k of sample s at k * num_samples + s
+ * - lwe_in: num_samples ciphertexts of lwe_dimension + 1 words, one after
+ * the other as in every other function of this library
+ *
+ * lwe_out and lwe_in must not overlap.
+ */
+void cpu_convert_lwe_batch_to_coefficient_major_32(void *lwe_out, void *lwe_in,
+                        uint32_t lwe_dimension, uint32_t num_samples) {
+    cpu_lwe_batch_to_coefficient_major(
+            static_cast<uint32_t *>(lwe_out), static_cast<uint32_t *>(lwe_in),
+            lwe_dimension, num_samples);
+}
+
+/* Convert a batch of LWE ciphertexts for 64 bits from the sample-major
+ * layout to the coefficient-major one
+ *
+ * See cpu_convert_lwe_batch_to_coefficient_major_32
+ */
+void cpu_convert_lwe_batch_to_coefficient_major_64(void *lwe_out, void *lwe_in,
+                        uint32_t lwe_dimension, uint32_t num_samples) {
+    cpu_lwe_batch_to_coefficient_major(
+            static_cast<uint64_t *>(lwe_out), static_cast<uint64_t *>(lwe_in),
+            lwe_dimension, num_samples);
+}
+
+/* Convert a batch of LWE ciphertexts for 32 bits from the coefficient-major
+ * layout back to the sample-major one
+ *
+ * See cpu_convert_lwe_batch_to_coefficient_major_32
+ */
+void cpu_convert_lwe_batch_from_coefficient_major_32(void *lwe_out, void *lwe_in,
+                        uint32_t lwe_dimension, uint32_t num_samples) {
+    cpu_lwe_batch_from_coefficient_major(
+            static_cast<uint32_t *>(lwe_out), static_cast<uint32_t *>(lwe_in),
+            lwe_dimension, num_samples);
+}
+
+/* Convert a batch of LWE ciphertexts for 64 bits from the coefficient-major
+ * layout back to the sample-major one
+ *
+ * See cpu_convert_lwe_batch_to_coefficient_major_32
+ */
+void cpu_convert_lwe_batch_from_coefficient_major_64(void *lwe_out, void *lwe_in,
+                        uint32_t lwe_dimension, uint32_t num_samples) {
+    cpu_lwe_batch_from_coefficient_major(
+            static_cast<uint64_t *>(lwe_out), static_cast<uint64_t *>(lwe_in),
+            lwe_dimension, num_samples);
+}
+
+/* Perform keyswitch on a batch of input LWE ciphertexts for 32 bits on the
+ * CPU, in the coefficient-major layout
+ *
+ * - lwe_out: output batch in the coefficient-major layout,
+ * (lwe_dimension_after + 1) * num_samples words
+ * - lwe_in: input batch in the coefficient-major layout, see
+ * cpu_convert_lwe_batch_to_coefficient_major_32
+ *
+ * The KSK and the other arguments are the ones of
+ * cpu_keyswitch_lwe_ciphertext_vector_32, and the output is the
+ * coefficient-major form of its output. The computation is vectorized
+ * across blocks of 16 samples: each KSK word is broadcast once and
+ * multiplied into the digits of all the samples of the block.
+ */
+void cpu_keyswitch_coefficient_major_lwe_ciphertext_vector_32(void * /*v_stream*/, void *lwe_out, void *lwe_in,
+                        void *ksk,
+                        uint32_t lwe_dimension_before,
+                        uint32_t lwe_dimension_after,
+                        uint32_t base_log, uint32_t l_gadget,
+                        uint32_t num_samples) {
+    cpu_keyswitch_coefficient_major_lwe_ciphertext_vector(
+            static_cast<uint32_t *>(lwe_out), static_cast<uint32_t *>(lwe_in),
+            static_cast<uint32_t*>(ksk),
+            lwe_dimension_before, lwe_dimension_after,
+            base_log, l_gadget,
+            num_samples);
+}
+
+/* Perform keyswitch on a batch of input LWE ciphertexts for 64 bits on the
+ * CPU, in the coefficient-major layout
+ *
+ * See cpu_keyswitch_coefficient_major_lwe_ciphertext_vector_32
+ */
+void cpu_keyswitch_coefficient_major_lwe_ciphertext_vector_64(void * /*v_stream*/, void *lwe_out, void *lwe_in,
+                        void *ksk,
+                        uint32_t lwe_dimension_before,
+                        uint32_t lwe_dimension_after,
+                        uint32_t base_log, uint32_t l_gadget,
+                        uint32_t num_samples) {
+    cpu_keyswitch_coefficient_major_lwe_ciphertext_vector(
+            static_cast<uint64_t *>(lwe_out), static_cast<uint64_t *>(lwe_in),
+            static_cast<uint64_t*>(ksk),
+            lwe_dimension_before, lwe_dimension_after,
+            base_log, l_gadget,
+            num_samples);
+}
+
+/* Pack a batch of LWE ciphertexts for 32 bits into a single GLWE ciphertext
+ * on the CPU
+ *
+ * - glwe_out: output GLWE ciphertext, (glwe_dimension + 1) *
+ * polynomial_size words, the glwe_dimension mask polynomials then the body
+ * - lwe_in: num_lwes LWE ciphertexts of lwe_dimension_in + 1 words
+ * - pksk: packing keyswitch key, for each input key element and each level
+ * (the most significant one first) a GLWE encryption of the key element
+ * times q / B^(level + 1), as LwePackingKeyswitchKey in concrete-core
+ * - num_lwes: at most polynomial_size, nothing is done otherwise
+ *
+ * Coefficient c of the decrypted output is the decrypted LWE number c, the
+ * other coefficients being 0. This packs up to polynomial_size ciphertexts
+ * in the size of one GLWE, for instance to send results back or to build
+ * the LUT inputs of cuda_cmux_tree_32.
+ */
+void cpu_packing_keyswitch_lwe_ciphertext_vector_32(void * /*v_stream*/, void *glwe_out, void *lwe_in,
+                        void *pksk,
+                        uint32_t lwe_dimension_in,
+                        uint32_t glwe_dimension,
+                        uint32_t polynomial_size,
+                        uint32_t base_log, uint32_t l_gadget,
+                        uint32_t num_lwes) {
+    if (num_lwes > polynomial_size)
+        return;
+    cpu_packing_keyswitch_lwe_ciphertext_vector(
+            static_cast<uint32_t *>(glwe_out), static_cast<uint32_t *>(lwe_in),
+            static_cast<uint32_t*>(pksk),
+            lwe_dimension_in, glwe_dimension, polynomial_size,
+            base_log, l_gadget,
+            num_lwes);
+}
+
+/* Pack a batch of LWE ciphertexts for 64 bits into a single GLWE ciphertext
+ * on the CPU
+ *
+ * See cpu_packing_keyswitch_lwe_ciphertext_vector_32
+ */
+void cpu_packing_keyswitch_lwe_ciphertext_vector_64(void * /*v_stream*/, void *glwe_out, void *lwe_in,
+                        void *pksk,
+                        uint32_t lwe_dimension_in,
+                        uint32_t glwe_dimension,
+                        uint32_t polynomial_size,
+                        uint32_t base_log, uint32_t l_gadget,
+                        uint32_t num_lwes) {
+    if (num_lwes > polynomial_size)
+        return;
+    cpu_packing_keyswitch_lwe_ciphertext_vector(
+            static_cast<uint64_t *>(glwe_out), static_cast<uint64_t *>(lwe_in),
+            static_cast<uint64_t*>(pksk),
+            lwe_dimension_in, glwe_dimension, polynomial_size,
+            base_log, l_gadget,
+            num_lwes);
+}
+
+/* Enqueue the keyswitch of a batch of input LWE ciphertexts for 32 bits on
+ * a host stream, without waiting for it
+ *
+ * - v_stream: host stream created by cpu_create_stream
+ *
+ * The other arguments are the ones of cpu_keyswitch_lwe_ciphertext_vector_32,
+ * and the buffers must stay valid until the keyswitch is done. This is the
+ * host emulation of cuda_keyswitch_lwe_ciphertext_vector_async_32:
+ * completion is observed with cpu_synchronize_stream or with an event
+ * recorded on v_stream (cpu_record_event).
+ */
+void cpu_keyswitch_lwe_ciphertext_vector_async_32(void *v_stream, void *lwe_out, void *lwe_in,
+                        void *ksk,
+                        uint32_t lwe_dimension_before,
+                        uint32_t lwe_dimension_after,
+                        uint32_t base_log, uint32_t l_gadget,
+                        uint32_t num_samples) {
+    auto stream = static_cast<HostStream *>(v_stream);
+    stream->enqueue([=] {
+        cpu_keyswitch_lwe_ciphertext_vector(
+                static_cast<uint32_t *>(lwe_out), static_cast<uint32_t *>(lwe_in),
+                static_cast<uint32_t*>(ksk),
+                lwe_dimension_before, lwe_dimension_after,
+                base_log, l_gadget,
+                num_samples);
+    });
+}
+
+/* Enqueue the keyswitch of a batch of input LWE ciphertexts for 64 bits on
+ * a host stream, without waiting for it
+ *
+ * See cpu_keyswitch_lwe_ciphertext_vector_async_32
+ */
+void cpu_keyswitch_lwe_ciphertext_vector_async_64(void *v_stream, void *lwe_out, void *lwe_in,
+                        void *ksk,
+                        uint32_t lwe_dimension_before,
+                        uint32_t lwe_dimension_after,
+                        uint32_t base_log, uint32_t l_gadget,
+                        uint32_t num_samples) {
+    auto stream = static_cast<HostStream *>(v_stream);
+    stream->enqueue([=] {
+        cpu_keyswitch_lwe_ciphertext_vector(
+                static_cast<uint64_t *>(lwe_out), static_cast<uint64_t *>(lwe_in),
+                static_cast<uint64_t*>(ksk),
+                lwe_dimension_before, lwe_dimension_after,
+                base_log, l_gadget,
+                num_samples);
+    });
+}
+
+/* Perform keyswitch on a batch of input LWE ciphertexts for 32 bits on the
+ * CPU, and modulus switch the result to the input domain of the bootstrap
+ *
+ * Same arguments and results as
+ * cuda_keyswitch_modulus_switched_lwe_ciphertext_vector_32: lwe_out receives
+ * num_samples * (lwe_dimension_after + 1) uint16_t elements in
+ * [0, 2 * polynomial_size[
+ */
+void cpu_keyswitch_modulus_switched_lwe_ciphertext_vector_32(void * /*v_stream*/, void *lwe_out, void *lwe_in,
+                        void *ksk,
+                        uint32_t lwe_dimension_before,
+                        uint32_t lwe_dimension_after,
+                        uint32_t base_log, uint32_t l_gadget,
+                        uint32_t polynomial_size,
+                        uint32_t num_samples) {
+    cpu_keyswitch_modulus_switched_lwe_ciphertext_vector(
+            static_cast<uint16_t *>(lwe_out), static_cast<uint32_t *>(lwe_in),
+            static_cast<uint32_t*>(ksk),
+            lwe_dimension_before, lwe_dimension_after,
+            base_log, l_gadget, log2(polynomial_size) + 1,
+            num_samples);
+}
+
+/* Perform keyswitch on a batch of input LWE ciphertexts for 64 bits on the
+ * CPU, and modulus switch the result to the input domain of the bootstrap
+ *
+ * See cpu_keyswitch_modulus_switched_lwe_ciphertext_vector_32
+ */
+void cpu_keyswitch_modulus_switched_lwe_ciphertext_vector_64(void * /*v_stream*/, void *lwe_out, void *lwe_in,
+                        void *ksk,
+                        uint32_t lwe_dimension_before,
+                        uint32_t lwe_dimension_after,
+                        uint32_t base_log, uint32_t l_gadget,
+                        uint32_t polynomial_size,
+                        uint32_t num_samples) {
+    cpu_keyswitch_modulus_switched_lwe_ciphertext_vector(
+            static_cast<uint16_t *>(lwe_out), static_cast<uint64_t *>(lwe_in),
+            static_cast<uint64_t*>(ksk),
+            lwe_dimension_before, lwe_dimension_after,
+            base_log, l_gadget, log2(polynomial_size) + 1,
+            num_samples);
+}
@@ -0,0 +1,430 @@
+#ifndef CNCRT_CPU_KS_H
+#define CNCRT_CPU_KS_H
+
+#include "crypto/aes.hpp"
+#include "crypto/torus.hpp"
+#include "utils/simd.hpp"
+#include "utils/thread_pool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+template <typename Torus>
+inline const Torus *get_ith_block(const Torus *ksk, int i, int level,
+                                  uint32_t lwe_dimension_after,
+                                  uint32_t l_gadget) {
+  int pos = i * l_gadget * (lwe_dimension_after + 1) +
+            level * (lwe_dimension_after + 1);
+  return &ksk[pos];
+}
+
+template <typename Torus>
+inline Torus decompose_one(Torus &state, Torus mod_b_mask, int base_log) {
+  Torus res = state & mod_b_mask;
+  state >>= base_log;
+  Torus carry = ((res - 1ll) | state) & res;
+  carry >>= base_log - 1;
+  state += carry;
+  res -= carry << base_log;
+  return res;
+}
+
+/*
+ * Keyswitch of a single LWE ciphertext, host counterpart of the keyswitch
+ * kernel in src/keyswitch.cuh: same KSK layout, same decomposition and same
+ * order of the wrapping operations, so that both engines produce the same
+ * bits. Zero digits are skipped since they leave the output unchanged.
+ */
+template <typename Torus>
+void keyswitch_one_sample(Torus *lwe_out, const Torus *lwe_in,
+                          const Torus *ksk, uint32_t lwe_dimension_before,
+                          uint32_t lwe_dimension_after, uint32_t base_log,
+                          uint32_t l_gadget, SimdLevel level) {
+  for (uint32_t k = 0; k < lwe_dimension_after; k++)
+    lwe_out[k] = 0;
+  lwe_out[lwe_dimension_after] = lwe_in[lwe_dimension_before];
+
+  Torus mod_b_mask = (1ll << base_log) - 1ll;
+  for (uint32_t i = 0; i < lwe_dimension_before; i++) {
+    Torus a_i = round_to_closest_multiple(lwe_in[i], base_log, l_gadget);
+    Torus state = a_i >> (sizeof(Torus) * 8 - base_log * l_gadget);
+
+    for (uint32_t j = 0; j < l_gadget; j++) {
+      auto ksk_block = get_ith_block(ksk, i, l_gadget - j - 1,
+                                     lwe_dimension_after, l_gadget);
+      Torus decomposed = decompose_one<Torus>(state, mod_b_mask, base_log);
+      if (decomposed == 0)
+        continue;
+      sub_scaled_vector(lwe_out, ksk_block, decomposed,
+                        lwe_dimension_after + 1, level);
+    }
+  }
+}
+
+/*
+ * Host keyswitch of a batch of LWE ciphertexts, the samples are spread over
+ * the threads of the pool
+ */
+template <typename Torus>
+void cpu_keyswitch_lwe_ciphertext_vector(
+    Torus *lwe_out, const Torus *lwe_in, const Torus *ksk,
+    uint32_t lwe_dimension_before, uint32_t lwe_dimension_after,
+    uint32_t base_log, uint32_t l_gadget, uint32_t num_samples,
+    ThreadPool &pool = ThreadPool::global(),
+    SimdLevel level = get_simd_level()) {
+  pool.parallel_for(0, num_samples, [&](uint32_t sample) {
+    keyswitch_one_sample<Torus>(
+        &lwe_out[(size_t)sample * (lwe_dimension_after + 1)],
+        &lwe_in[(size_t)sample * (lwe_dimension_before + 1)], ksk,
+        lwe_dimension_before, lwe_dimension_after, base_log, l_gadget, level);
+  });
+}
+
+/*
+ * Tiling of the batched keyswitch
+ *
+ * The KSK is cut in tiles of input_tile consecutive input mask elements
+ * (input_tile * l_gadget rows of lwe_dimension_after + 1 words), and each
+ * tile is applied to sample_tile ciphertexts while it sits in cache before
+ * moving to the next one. The KSK is thus streamed from memory once per
+ * group of sample_tile ciphertexts instead of once per ciphertext.
+ */
+struct KeyswitchTiling {
+  uint32_t input_tile;
+  uint32_t sample_tile;
+};
+
+/// Picks the tiles so that a KSK tile fills half of cache_bytes and the
+/// output accumulators of a sample tile a quarter of it. The sample tile is
+/// also capped so that every thread of the pool gets a group of samples.
+/// KskTorus is the type the KSK is stored with.
+template <typename Torus, typename KskTorus = Torus>
+KeyswitchTiling get_keyswitch_tiling(uint32_t lwe_dimension_before,
+                                     uint32_t lwe_dimension_after,
+                                     uint32_t l_gadget, uint32_t num_samples,
+                                     uint32_t num_threads,
+                                     size_t cache_bytes = 1 << 20) {
+  size_t row_bytes = sizeof(Torus) * (lwe_dimension_after + 1);
+  size_t ksk_row_bytes = sizeof(KskTorus) * (lwe_dimension_after + 1);
+  KeyswitchTiling tiling;
+  tiling.input_tile = std::clamp<size_t>(
+      cache_bytes / 2 / (ksk_row_bytes * l_gadget), 1, lwe_dimension_before);
+  uint32_t samples_per_thread =
+      (num_samples + num_threads - 1) / std::max(num_threads, 1u);
+  tiling.sample_tile = std::clamp<size_t>(cache_bytes / 4 / row_bytes, 1,
+                                          std::max(samples_per_thread, 1u));
+  return tiling;
+}
+
+/// Number of KSK bytes read from memory by the tiled keyswitch of a batch,
+/// assuming the KSK tiles stay in cache for a whole sample tile
+template <typename KskTorus>
+size_t get_keyswitch_tiled_ksk_bytes(KeyswitchTiling tiling,
+                                     uint32_t lwe_dimension_before,
+                                     uint32_t lwe_dimension_after,
+                                     uint32_t l_gadget, uint32_t num_samples) {
+  size_t ksk_bytes = sizeof(KskTorus) * lwe_dimension_before * l_gadget *
+                     (lwe_dimension_after + 1);
+  size_t num_passes = (num_samples + tiling.sample_tile - 1) / tiling.sample_tile;
+  return ksk_bytes * num_passes;
+}
+
+/// Sets the outputs of the samples [first_sample, last_sample[ to the
+/// trivial encryption of their input body
+template <typename Torus>
+void init_keyswitch_outputs(Torus *lwe_out, const Torus *lwe_in,
+                            uint32_t lwe_dimension_before,
+                            uint32_t lwe_dimension_after,
+                            uint32_t first_sample, uint32_t last_sample) {
+  for (uint32_t sample = first_sample; sample < last_sample; sample++) {
+    Torus *block_lwe_out = &lwe_out[(size_t)sample * (lwe_dimension_after + 1)];
+    for (uint32_t k = 0; k < lwe_dimension_after; k++)
+      block_lwe_out[k] = 0;
+    block_lwe_out[lwe_dimension_after] =
+        lwe_in[(size_t)sample * (lwe_dimension_before + 1) + lwe_dimension_before];
+  }
+}
+
+/// Applies the KSK rows of the input mask elements [first_input,
+/// last_input[ to the samples [first_sample, last_sample[, ksk_tile pointing
+/// to the rows of first_input
+template <typename Torus, typename KskTorus = Torus>
+void keyswitch_tile(Torus *lwe_out, const Torus *lwe_in, const KskTorus *ksk_tile,
+                    uint32_t lwe_dimension_before, uint32_t lwe_dimension_after,
+                    uint32_t base_log, uint32_t l_gadget, uint32_t first_input,
+                    uint32_t last_input, uint32_t first_sample,
+                    uint32_t last_sample, SimdLevel level) {
+  Torus mod_b_mask = (1ll << base_log) - 1ll;
+  for (uint32_t sample = first_sample; sample < last_sample; sample++) {
+    Torus *block_lwe_out = &lwe_out[(size_t)sample * (lwe_dimension_after + 1)];
+    const Torus *block_lwe_in = &lwe_in[(size_t)sample * (lwe_dimension_before + 1)];
+    for (uint32_t i = first_input; i < last_input; i++) {
+      Torus a_i = round_to_closest_multiple(block_lwe_in[i], base_log, l_gadget);
+      Torus state = a_i >> (sizeof(Torus) * 8 - base_log * l_gadget);
+      for (uint32_t j = 0; j < l_gadget; j++) {
+        auto ksk_block = get_ith_block(ksk_tile, i - first_input,
+                                       l_gadget - j - 1, lwe_dimension_after,
+                                       l_gadget);
+        Torus decomposed = decompose_one<Torus>(state, mod_b_mask, base_log);
+        if (decomposed == 0)
+          continue;
+        sub_scaled_vector(block_lwe_out, ksk_block, decomposed,
+                          lwe_dimension_after + 1, level);
+      }
+    }
+  }
+}
+
+/*
+ * Tiled host keyswitch of a batch of LWE ciphertexts
+ *
+ * The groups of sample_tile ciphertexts are spread over the threads of the
+ * pool, each group loops over the KSK tiles and applies each of them to all
+ * of its ciphertexts. The wrapping accumulation is commutative so the
+ * result is bit-identical to cpu_keyswitch_lwe_ciphertext_vector.
+ *
+ * The KSK may also be stored truncated to the high words of its elements,
+ * see cpu_keyswitch_truncated_lwe_ciphertext_vector.
+ */
+template <typename Torus, typename KskTorus = Torus>
+void cpu_keyswitch_tiled_lwe_ciphertext_vector(
+    Torus *lwe_out, const Torus *lwe_in, const KskTorus *ksk,
+    uint32_t lwe_dimension_before, uint32_t lwe_dimension_after,
+    uint32_t base_log, uint32_t l_gadget, uint32_t num_samples,
+    KeyswitchTiling tiling, ThreadPool &pool = ThreadPool::global(),
+    SimdLevel level = get_simd_level()) {
+  uint32_t num_groups = (num_samples + tiling.sample_tile - 1) / tiling.sample_tile;
+
+  pool.parallel_for(0, num_groups, [&](uint32_t group) {
+    uint32_t first_sample = group * tiling.sample_tile;
+    uint32_t last_sample = std::min(first_sample + tiling.sample_tile, num_samples);
+    init_keyswitch_outputs(lwe_out, lwe_in, lwe_dimension_before,
+                           lwe_dimension_after, first_sample, last_sample);
+
+    for (uint32_t first_input = 0; first_input < lwe_dimension_before;
+         first_input += tiling.input_tile) {
+      uint32_t last_input =
+          std::min(first_input + tiling.input_tile, lwe_dimension_before);
+      keyswitch_tile(lwe_out, lwe_in,
+                     get_ith_block(ksk, first_input, 0, lwe_dimension_after,
+                                   l_gadget),
+                     lwe_dimension_before, lwe_dimension_after, base_log,
+                     l_gadget, first_input, last_input, first_sample,
+                     last_sample, level);
+    }
+  });
+}
+
+template <typename Torus, typename KskTorus = Torus>
+void cpu_keyswitch_tiled_lwe_ciphertext_vector(
+    Torus *lwe_out, const Torus *lwe_in, const KskTorus *ksk,
+    uint32_t lwe_dimension_before, uint32_t lwe_dimension_after,
+    uint32_t base_log, uint32_t l_gadget, uint32_t num_samples) {
+  auto &pool = ThreadPool::global();
+  auto tiling = get_keyswitch_tiling<Torus, KskTorus>(
+      lwe_dimension_before, lwe_dimension_after, l_gadget, num_samples,
+      pool.num_threads());
+  cpu_keyswitch_tiled_lwe_ciphertext_vector<Torus, KskTorus>(
+      lwe_out, lwe_in, ksk, lwe_dimension_before, lwe_dimension_after,
+      base_log, l_gadget, num_samples, tiling, pool);
+}
+
+/*
+ * Truncated keyswitch keys for 64 bits ciphertexts
+ *
+ * Each element of the KSK is stored as its high 32 bits word, rounded to the
+ * closest, and widened back with zero low bits inside the keyswitch loop.
+ * This halves the size of the key and the bandwidth of the keyswitch, at the
+ * cost of an additional noise, see get_truncated_ksk_noise_variance.
+ */
+
+/// High word of a KSK element, rounded to the closest
+inline uint32_t truncate_ksk_element(uint64_t element) {
+  return (uint32_t)((element + ((uint64_t)1 << 31)) >> 32);
+}
+
+template <typename Torus>
+void cpu_truncate_lwe_keyswitch_key(uint32_t *ksk_out, const Torus *ksk_in,
+                                    uint32_t lwe_dimension_before,
+                                    uint32_t lwe_dimension_after,
+                                    uint32_t l_gadget,
+                                    ThreadPool &pool = ThreadPool::global()) {
+  static_assert(sizeof(Torus) == 8, "only 64 bits keys can be truncated");
+  size_t row_size = (size_t)l_gadget * (lwe_dimension_after + 1);
+  pool.parallel_for(0, lwe_dimension_before, [&](uint32_t i) {
+    for (size_t k = i * row_size; k < (i + 1) * row_size; k++)
+      ksk_out[k] = truncate_ksk_element(ksk_in[k]);
+  });
+}
+
+/// Variance, on the torus normalized to [0, 1[, of the noise the truncation
+/// of the KSK adds to each keyswitched ciphertext, for a binary output key.
+///
+/// The rounding error of every KSK element is uniform in [-2^31, 2^31[,
+/// of variance 2^-64 / 12 on the torus. The phase of a KSK row under the
+/// output key thus gets an error of variance (1 + lwe_dimension_after / 2) *
+/// 2^-64 / 12, and the keyswitch sums lwe_dimension_before * l_gadget such
+/// rows multiplied by digits in [-B/2, B/2], of mean square (B^2 + 2) / 12.
+inline double get_truncated_ksk_noise_variance(uint32_t lwe_dimension_before,
+                                               uint32_t lwe_dimension_after,
+                                               uint32_t base_log,
+                                               uint32_t l_gadget) {
+  double rounding_variance = std::ldexp(1., -64) / 12.;
+  double row_variance = (1. + lwe_dimension_after / 2.) * rounding_variance;
+  double base = std::ldexp(1., base_log);
+  double digit_square = (base * base + 2.) / 12.;
+  return (double)lwe_dimension_before * l_gadget * digit_square * row_variance;
+}
+
+/// Keyswitch of 64 bits ciphertexts with a KSK truncated by
+/// cpu_truncate_lwe_keyswitch_key, uses the tiled engine
+inline void cpu_keyswitch_truncated_lwe_ciphertext_vector(
+    uint64_t *lwe_out, const uint64_t *lwe_in, const uint32_t *ksk,
+    uint32_t lwe_dimension_before, uint32_t lwe_dimension_after,
+    uint32_t base_log, uint32_t l_gadget, uint32_t num_samples) {
+  cpu_keyswitch_tiled_lwe_ciphertext_vector<uint64_t, uint32_t>(
+      lwe_out, lwe_in, ksk, lwe_dimension_before, lwe_dimension_after,
+      base_log, l_gadget, num_samples);
+}
+
+/*
+ * Seeded keyswitch keys
+ *
+ * A seeded KSK only stores the bodies of the lwe_dimension_before * l_gadget
+ * LWE ciphertexts of the KSK, in the order of get_ith_block, along with a
+ * 16 bytes seed. This is the format of concrete-core's LweSeededKeyswitchKey:
+ * the seed is its CompressionSeed and LweSeededKeyswitchKey::expand_into
+ * draws the masks of all the rows in order from a single generator seeded
+ * with it, so mask element k of KSK row r = i * l_gadget + level is word
+ * r * lwe_dimension_after + k of the random stream of AesCtr128. This
+ * divides the size of the key by lwe_dimension_after + 1.
+ */
+
+/// Regenerates the KSK rows [first_row, first_row + num_rows[ in the layout
+/// of get_ith_block
+template <typename Torus>
+void expand_seeded_lwe_keyswitch_key_rows(Torus *ksk_rows, const Torus *ksk_bodies,
+                                          const AesCtr128 &aes,
+                                          uint32_t lwe_dimension_after,
+                                          uint32_t first_row, uint32_t num_rows) {
+  for (uint32_t r = 0; r < num_rows; r++) {
+    Torus *row = &ksk_rows[(size_t)r * (lwe_dimension_after + 1)];
+    aes.fill_keystream(row, (uint64_t)(first_row + r) * lwe_dimension_after,
+                       lwe_dimension_after);
+    row[lwe_dimension_after] = ksk_bodies[first_row + r];
+  }
+}
+
+/// Expands a whole seeded KSK into a regular one
+template <typename Torus>
+void cpu_expand_seeded_lwe_keyswitch_key(Torus *ksk, const Torus *ksk_bodies,
+                                         const uint8_t seed[16],
+                                         uint32_t lwe_dimension_before,
+                                         uint32_t lwe_dimension_after,
+                                         uint32_t l_gadget,
+                                         ThreadPool &pool = ThreadPool::global()) {
+  AesCtr128 aes(seed);
+  pool.parallel_for(0, lwe_dimension_before, [&](uint32_t i) {
+    expand_seeded_lwe_keyswitch_key_rows(
+        &ksk[(size_t)i * l_gadget * (lwe_dimension_after + 1)], ksk_bodies,
+        aes, lwe_dimension_after, i * l_gadget, l_gadget);
+  });
+}
+
+/*
+ * Host keyswitch of a batch of LWE ciphertexts with a seeded KSK
+ *
+ * Same tiling as cpu_keyswitch_tiled_lwe_ciphertext_vector: each group of
+ * ciphertexts regenerates every KSK tile once in a buffer that stays in
+ * cache and applies it to all of its ciphertexts, so the AES cost is
+ * amortized over the group. The result is bit-identical to the keyswitch
+ * with the expanded key.
+ */
+template <typename Torus>
+void cpu_keyswitch_seeded_lwe_ciphertext_vector(
+    Torus *lwe_out, const Torus *lwe_in, const Torus *ksk_bodies,
+    const uint8_t seed[16], uint32_t lwe_dimension_before,
+    uint32_t lwe_dimension_after, uint32_t base_log, uint32_t l_gadget,
+    uint32_t num_samples, ThreadPool &pool = ThreadPool::global(),
+    SimdLevel level = get_simd_level()) {
+  AesCtr128 aes(seed);
+  auto tiling = get_keyswitch_tiling<Torus>(lwe_dimension_before,
+                                            lwe_dimension_after, l_gadget,
+                                            num_samples, pool.num_threads());
+  uint32_t num_groups = (num_samples + tiling.sample_tile - 1) / tiling.sample_tile;
+
+  pool.parallel_for(0, num_groups, [&](uint32_t group) {
+    uint32_t first_sample = group * tiling.sample_tile;
+    uint32_t last_sample = std::min(first_sample + tiling.sample_tile, num_samples);
+    init_keyswitch_outputs(lwe_out, lwe_in, lwe_dimension_before,
+                           lwe_dimension_after, first_sample, last_sample);
+
+    std::vector<Torus> ksk_tile((size_t)tiling.input_tile * l_gadget *
+                                (lwe_dimension_after + 1));
+    for (uint32_t first_input = 0; first_input < lwe_dimension_before;
+         first_input += tiling.input_tile) {
+      uint32_t last_input =
+          std::min(first_input + tiling.input_tile, lwe_dimension_before);
+      expand_seeded_lwe_keyswitch_key_rows(
+          ksk_tile.data(), ksk_bodies, aes, lwe_dimension_after,
+          first_input * l_gadget, (last_input - first_input) * l_gadget);
+      keyswitch_tile(lwe_out, lwe_in, ksk_tile.data(), lwe_dimension_before,
+                     lwe_dimension_after, base_log, l_gadget, first_input,
+                     last_input, first_sample, last_sample, level);
+    }
+  });
+}
+
+/*
+ * Host keyswitch of a batch of LWE ciphertexts fused with the modulus switch
+ * to the input domain of the bootstrap
+ *
+ * Each element of the output is modulus_switch(x, log_modulus) of the
+ * element x of the regular keyswitch output, stored as an OutputTorus. The
+ * groups of samples of the tiled keyswitch are keyswitched into a buffer of
+ * the group that stays in cache, and only their compact modulus switched
+ * copy is written to lwe_out.
+ */
+template <typename Torus, typename OutputTorus = uint16_t>
+void cpu_keyswitch_modulus_switched_lwe_ciphertext_vector(
+    OutputTorus *lwe_out, const Torus *lwe_in, const Torus *ksk,
+    uint32_t lwe_dimension_before, uint32_t lwe_dimension_after,
+    uint32_t base_log, uint32_t l_gadget, uint32_t log_modulus,
+    uint32_t num_samples, ThreadPool &pool = ThreadPool::global(),
+    SimdLevel level = get_simd_level()) {
+  auto tiling = get_keyswitch_tiling<Torus>(lwe_dimension_before,
+                                            lwe_dimension_after, l_gadget,
+                                            num_samples, pool.num_threads());
+  uint32_t num_groups = (num_samples + tiling.sample_tile - 1) / tiling.sample_tile;
+
+  pool.parallel_for(0, num_groups, [&](uint32_t group) {
+    uint32_t first_sample = group * tiling.sample_tile;
+    uint32_t last_sample = std::min(first_sample + tiling.sample_tile, num_samples);
+    uint32_t group_size = last_sample - first_sample;
+    const Torus *group_lwe_in =
+        &lwe_in[(size_t)first_sample * (lwe_dimension_before + 1)];
+
+    std::vector<Torus> group_lwe_out((size_t)group_size *
+                                     (lwe_dimension_after + 1));
+    init_keyswitch_outputs(group_lwe_out.data(), group_lwe_in,
+                           lwe_dimension_before, lwe_dimension_after, 0,
+                           group_size);
+    for (uint32_t first_input = 0; first_input < lwe_dimension_before;
+         first_input += tiling.input_tile) {
+      uint32_t last_input =
+          std::min(first_input + tiling.input_tile, lwe_dimension_before);
+      keyswitch_tile(group_lwe_out.data(), group_lwe_in,
+                     get_ith_block(ksk, first_input, 0, lwe_dimension_after,
+                                   l_gadget),
+                     lwe_dimension_before, lwe_dimension_after, base_log,
+                     l_gadget, first_input, last_input, 0, group_size, level);
+    }
+
+    OutputTorus *group_out = &lwe_out[(size_t)first_sample * (lwe_dimension_after + 1)];
+    for (size_t k = 0; k < group_lwe_out.size(); k++)
+      group_out[k] = (OutputTorus)modulus_switch(group_lwe_out[k], log_modulus);
+  });
+}
+
+#endif // CNCRT_CPU_KS_H
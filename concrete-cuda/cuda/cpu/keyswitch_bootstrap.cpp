@@ -0,0 +1,61 @@
+#include "keyswitch_bootstrap.hpp"
+#include "bootstrap.h"
+
+#include <cstdint>
+
+/* Perform the keyswitch followed by the amortized bootstrap on a batch of
+ * input LWE ciphertexts for 32 bits on the CPU
+ *
+ *  - lwe_in: num_samples LWE ciphertexts of dimension input_lwe_dimension,
+ *    keyswitched to lwe_dimension with ksk, ks_base_log and ks_l_gadget as
+ *    in cpu_keyswitch_lwe_ciphertext_vector_32
+ *  - the keyswitched ciphertexts are bootstrapped with bootstrapping_key,
+ *    pbs_base_log and pbs_l_gadget, the test vectors and lwe_out being the
+ *    ones of cpu_bootstrap_amortized_lwe_ciphertext_vector_32
+ *
+ * The keyswitched ciphertexts only live in a scratch of each group of
+ * ciphertexts, owned by the call, the caller does not allocate anything.
+ * Same arguments as cuda_keyswitch_bootstrap_amortized_lwe_ciphertext_vector_32.
+ * v_stream and max_shared_memory are not used, the function returns once
+ * the batch is done. Nothing is done for unsupported polynomial sizes.
+ */
+void cpu_keyswitch_bootstrap_amortized_lwe_ciphertext_vector_32(
+    void * /*v_stream*/, void *lwe_out, void *lut_vector,
+    void *lut_vector_indexes, void *lwe_in, void *ksk, void *bootstrapping_key,
+    uint32_t input_lwe_dimension, uint32_t lwe_dimension,
+    uint32_t polynomial_size, uint32_t ks_base_log, uint32_t ks_l_gadget,
+    uint32_t pbs_base_log, uint32_t pbs_l_gadget, uint32_t num_samples,
+    uint32_t /*num_lut_vectors*/, uint32_t lwe_idx,
+    uint32_t /*max_shared_memory*/) {
+  if (!is_supported_polynomial_size(polynomial_size))
+    return;
+  cpu_keyswitch_bootstrap_amortized_lwe_ciphertext_vector(
+      (uint32_t *)lwe_out, (uint32_t *)lut_vector,
+      (uint32_t *)lut_vector_indexes, (uint32_t *)lwe_in, (uint32_t *)ksk,
+      (double2 *)bootstrapping_key, input_lwe_dimension, lwe_dimension,
+      polynomial_size, ks_base_log, ks_l_gadget, pbs_base_log, pbs_l_gadget,
+      num_samples, lwe_idx);
+}
+
+/* Perform the keyswitch followed by the amortized bootstrap on a batch of
+ * input LWE ciphertexts for 64 bits on the CPU
+ *
+ * See cpu_keyswitch_bootstrap_amortized_lwe_ciphertext_vector_32
+ */
+void cpu_keyswitch_bootstrap_amortized_lwe_ciphertext_vector_64(
+    void * /*v_stream*/, void *lwe_out, void *lut_vector,
+    void *lut_vector_indexes, void *lwe_in, void *ksk, void *bootstrapping_key,
+    uint32_t input_lwe_dimension, uint32_t lwe_dimension,
+    uint32_t polynomial_size, uint32_t ks_base_log, uint32_t ks_l_gadget,
+    uint32_t pbs_base_log, uint32_t pbs_l_gadget, uint32_t num_samples,
+    uint32_t /*num_lut_vectors*/, uint32_t lwe_idx,
+    uint32_t /*max_shared_memory*/) {
+  if (!is_supported_polynomial_size(polynomial_size))
+    return;
+  cpu_keyswitch_bootstrap_amortized_lwe_ciphertext_vector(
+      (uint64_t *)lwe_out, (uint64_t *)lut_vector,
+      (uint32_t *)lut_vector_indexes, (uint64_t *)lwe_in, (uint64_t *)ksk,
+      (double2 *)bootstrapping_key, input_lwe_dimension, lwe_dimension,
+      polynomial_size, ks_base_log, ks_l_gadget, pbs_base_log, pbs_l_gadget,
+      num_samples, lwe_idx);
+}
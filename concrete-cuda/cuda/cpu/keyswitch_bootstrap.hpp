@@ -0,0 +1,107 @@
+#ifndef CNCRT_CPU_KS_PBS_H
+#define CNCRT_CPU_KS_PBS_H
+
+#include "bootstrap_amortized.hpp"
+#include "keyswitch.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+/// Scratch of the keyswitch followed by the bootstrap of a group of
+/// ciphertexts: the keyswitched LWE ciphertexts of the group and their
+/// modulus switch, the GLWE accumulator and the buffers of the blind
+/// rotation. Each task of a call allocates its own and releases it when
+/// done, nothing is kept from one call to the next.
+template <typename Torus> struct KeyswitchBootstrapBuffers {
+  std::vector<Torus> lwe_keyswitched;
+  std::vector<uint16_t> lwe_switched;
+  std::vector<Torus> accumulator;
+  BootstrapBuffers<Torus> bootstrap;
+
+  KeyswitchBootstrapBuffers(uint32_t group_size, uint32_t lwe_dimension,
+                            uint32_t glwe_dimension, uint32_t polynomial_size)
+      : lwe_keyswitched((size_t)group_size * (lwe_dimension + 1)),
+        lwe_switched((size_t)group_size * (lwe_dimension + 1)),
+        accumulator((glwe_dimension + 1) * polynomial_size),
+        bootstrap(glwe_dimension, polynomial_size) {}
+};
+
+/*
+ * Keyswitch followed by the amortized bootstrap of a batch of LWE
+ * ciphertexts, the usual gate of a circuit
+ *
+ * The batch is cut in the groups of sample_tile ciphertexts of the tiled
+ * keyswitch (see get_keyswitch_tiling), spread over the threads of the
+ * pool. Each group is keyswitched from input_lwe_dimension to
+ * lwe_dimension tile by tile of the KSK, so that the KSK is streamed once
+ * per group rather than once per ciphertext, into a scratch that stays in
+ * cache. The group is then modulus switched and its ciphertexts
+ * bootstrapped one after the other: the intermediate batch is never
+ * materialized and there is a single pass over the pool instead of two.
+ * The result is bit-identical to cpu_keyswitch_lwe_ciphertext_vector
+ * followed by cpu_bootstrap_amortized_lwe_ciphertext_vector, with the same
+ * layouts for lwe_in, the KSK, the test vectors and lwe_out.
+ */
+template <typename Torus>
+void cpu_keyswitch_bootstrap_amortized_lwe_ciphertext_vector(
+    Torus *lwe_out, const Torus *lut_vector, const uint32_t *lut_vector_indexes,
+    const Torus *lwe_in, const Torus *ksk, const double2 *bootstrapping_key,
+    uint32_t input_lwe_dimension, uint32_t lwe_dimension,
+    uint32_t polynomial_size, uint32_t ks_base_log, uint32_t ks_l_gadget,
+    uint32_t pbs_base_log, uint32_t pbs_l_gadget, uint32_t num_samples,
+    uint32_t lwe_idx, uint32_t glwe_dimension = 1,
+    ThreadPool &pool = ThreadPool::global(),
+    SimdLevel level = get_simd_level()) {
+  auto &fft = NegacyclicFFT::get(polynomial_size);
+  size_t glwe_size = (size_t)(glwe_dimension + 1) * polynomial_size;
+  uint32_t log_modulus = get_bootstrap_log_modulus(polynomial_size);
+  auto tiling = get_keyswitch_tiling<Torus>(input_lwe_dimension,
+                                            lwe_dimension, ks_l_gadget,
+                                            num_samples, pool.num_threads());
+  uint32_t num_groups =
+      (num_samples + tiling.sample_tile - 1) / tiling.sample_tile;
+
+  pool.parallel_for(0, num_groups, [&](uint32_t group) {
+    uint32_t first_sample = group * tiling.sample_tile;
+    uint32_t last_sample =
+        std::min(first_sample + tiling.sample_tile, num_samples);
+    uint32_t group_size = last_sample - first_sample;
+    const Torus *group_lwe_in =
+        &lwe_in[(size_t)first_sample * (input_lwe_dimension + 1)];
+    KeyswitchBootstrapBuffers<Torus> buffers(group_size, lwe_dimension,
+                                             glwe_dimension, polynomial_size);
+
+    init_keyswitch_outputs(buffers.lwe_keyswitched.data(), group_lwe_in,
+                           input_lwe_dimension, lwe_dimension, 0, group_size);
+    for (uint32_t first_input = 0; first_input < input_lwe_dimension;
+         first_input += tiling.input_tile) {
+      uint32_t last_input =
+          std::min(first_input + tiling.input_tile, input_lwe_dimension);
+      keyswitch_tile(buffers.lwe_keyswitched.data(), group_lwe_in,
+                     get_ith_block(ksk, first_input, 0, lwe_dimension,
+                                   ks_l_gadget),
+                     input_lwe_dimension, lwe_dimension, ks_base_log,
+                     ks_l_gadget, first_input, last_input, 0, group_size,
+                     level);
+    }
+    modulus_switch_vector(buffers.lwe_switched.data(),
+                          buffers.lwe_keyswitched.data(),
+                          buffers.lwe_switched.size(), log_modulus, level);
+
+    for (uint32_t s = 0; s < group_size; s++) {
+      uint32_t sample = first_sample + s;
+      const Torus *lut = select_lut(lut_vector, lut_vector_indexes, lwe_idx,
+                                    sample, glwe_size);
+      blind_rotate_one_sample<Torus, uint16_t>(
+          buffers.accumulator.data(), lut,
+          &buffers.lwe_switched[(size_t)s * (lwe_dimension + 1)],
+          bootstrapping_key, lwe_dimension, glwe_dimension, polynomial_size,
+          pbs_base_log, pbs_l_gadget, fft, buffers.bootstrap, level);
+      sample_extract(
+          &lwe_out[(size_t)sample * (glwe_dimension * polynomial_size + 1)],
+          buffers.accumulator.data(), glwe_dimension, polynomial_size);
+    }
+  });
+}
+
+#endif // CNCRT_CPU_KS_PBS_H
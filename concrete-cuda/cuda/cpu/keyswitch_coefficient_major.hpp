@@ -0,0 +1,206 @@
+#ifndef CNCRT_CPU_KS_COEFFICIENT_MAJOR_H
+#define CNCRT_CPU_KS_COEFFICIENT_MAJOR_H
+
+#include "crypto/lwe_batch.hpp"
+#include "keyswitch.hpp"
+#include <vector>
+
+/*
+ * Keyswitch of a batch in the coefficient-major layout (see lwe_batch.hpp)
+ *
+ * The samples are processed by blocks of KS_CM_SAMPLE_BLOCK. For an output
+ * coefficient k, the block accumulators stay in vector registers while the
+ * KSK words of column k are broadcast, one per KSK row, and multiplied into
+ * the digits of all the samples of the block. Vectorization is thus along
+ * the samples, at the full width of the registers whatever the LWE
+ * dimensions. The digits of the block are computed for KS_CM_INPUT_CHUNK
+ * input mask elements at a time, from contiguous loads of the input rows.
+ * The chunk is kept small since the KSK columns are read with a stride of
+ * one KSK row: with l_gadget * KS_CM_INPUT_CHUNK rows the strided reads stay
+ * within the reach of the TLB, larger chunks are twice slower.
+ */
+const uint32_t KS_CM_SAMPLE_BLOCK = 16;
+const uint32_t KS_CM_INPUT_CHUNK = 4;
+
+/// acc[s] -= sum_r ksk_column[r * ksk_stride] * digits[r][s] for the
+/// KS_CM_SAMPLE_BLOCK samples s of a block
+template <typename Torus>
+inline void broadcast_sub_rows_scalar(Torus *acc, const Torus *ksk_column,
+                                      size_t ksk_stride, const Torus *digits,
+                                      uint32_t num_rows) {
+  for (uint32_t r = 0; r < num_rows; r++) {
+    Torus word = ksk_column[r * ksk_stride];
+    for (uint32_t s = 0; s < KS_CM_SAMPLE_BLOCK; s++)
+      acc[s] -= word * digits[r * KS_CM_SAMPLE_BLOCK + s];
+  }
+}
+
+#ifdef CNCRT_CPU_X86
+__attribute__((target("avx2"))) inline void
+broadcast_sub_rows_avx2(uint64_t *acc, const uint64_t *ksk_column,
+                        size_t ksk_stride, const uint64_t *digits,
+                        uint32_t num_rows) {
+  __m256i a[4];
+  for (int v = 0; v < 4; v++)
+    a[v] = _mm256_loadu_si256((const __m256i *)&acc[4 * v]);
+  for (uint32_t r = 0; r < num_rows; r++) {
+    __m256i word = _mm256_set1_epi64x(ksk_column[r * ksk_stride]);
+    const uint64_t *row = &digits[r * KS_CM_SAMPLE_BLOCK];
+    for (int v = 0; v < 4; v++)
+      a[v] = _mm256_sub_epi64(
+          a[v], mullo_epi64_avx2(
+                    word, _mm256_loadu_si256((const __m256i *)&row[4 * v])));
+  }
+  for (int v = 0; v < 4; v++)
+    _mm256_storeu_si256((__m256i *)&acc[4 * v], a[v]);
+}
+
+__attribute__((target("avx2"))) inline void
+broadcast_sub_rows_avx2(uint32_t *acc, const uint32_t *ksk_column,
+                        size_t ksk_stride, const uint32_t *digits,
+                        uint32_t num_rows) {
+  __m256i a[2];
+  for (int v = 0; v < 2; v++)
+    a[v] = _mm256_loadu_si256((const __m256i *)&acc[8 * v]);
+  for (uint32_t r = 0; r < num_rows; r++) {
+    __m256i word = _mm256_set1_epi32(ksk_column[r * ksk_stride]);
+    const uint32_t *row = &digits[r * KS_CM_SAMPLE_BLOCK];
+    for (int v = 0; v < 2; v++)
+      a[v] = _mm256_sub_epi32(
+          a[v], _mm256_mullo_epi32(
+                    word, _mm256_loadu_si256((const __m256i *)&row[8 * v])));
+  }
+  for (int v = 0; v < 2; v++)
+    _mm256_storeu_si256((__m256i *)&acc[8 * v], a[v]);
+}
+
+__attribute__((target("avx512f,avx512dq"))) inline void
+broadcast_sub_rows_avx512(uint64_t *acc, const uint64_t *ksk_column,
+                          size_t ksk_stride, const uint64_t *digits,
+                          uint32_t num_rows) {
+  __m512i a0 = _mm512_loadu_si512((const void *)&acc[0]);
+  __m512i a1 = _mm512_loadu_si512((const void *)&acc[8]);
+  for (uint32_t r = 0; r < num_rows; r++) {
+    __m512i word = _mm512_set1_epi64(ksk_column[r * ksk_stride]);
+    const uint64_t *row = &digits[r * KS_CM_SAMPLE_BLOCK];
+    a0 = _mm512_sub_epi64(
+        a0, _mm512_mullo_epi64(word, _mm512_loadu_si512((const void *)&row[0])));
+    a1 = _mm512_sub_epi64(
+        a1, _mm512_mullo_epi64(word, _mm512_loadu_si512((const void *)&row[8])));
+  }
+  _mm512_storeu_si512((void *)&acc[0], a0);
+  _mm512_storeu_si512((void *)&acc[8], a1);
+}
+
+__attribute__((target("avx512f,avx512dq"))) inline void
+broadcast_sub_rows_avx512(uint32_t *acc, const uint32_t *ksk_column,
+                          size_t ksk_stride, const uint32_t *digits,
+                          uint32_t num_rows) {
+  __m512i a = _mm512_loadu_si512((const void *)acc);
+  for (uint32_t r = 0; r < num_rows; r++) {
+    __m512i word = _mm512_set1_epi32(ksk_column[r * ksk_stride]);
+    a = _mm512_sub_epi32(
+        a, _mm512_mullo_epi32(
+               word, _mm512_loadu_si512(
+                         (const void *)&digits[r * KS_CM_SAMPLE_BLOCK])));
+  }
+  _mm512_storeu_si512((void *)acc, a);
+}
+#endif
+
+template <typename Torus>
+inline void broadcast_sub_rows(Torus *acc, const Torus *ksk_column,
+                               size_t ksk_stride, const Torus *digits,
+                               uint32_t num_rows, SimdLevel level) {
+#ifdef CNCRT_CPU_X86
+  if (level == AVX512)
+    return broadcast_sub_rows_avx512(acc, ksk_column, ksk_stride, digits,
+                                     num_rows);
+  if (level == AVX2)
+    return broadcast_sub_rows_avx2(acc, ksk_column, ksk_stride, digits,
+                                   num_rows);
+#endif
+  broadcast_sub_rows_scalar(acc, ksk_column, ksk_stride, digits, num_rows);
+}
+
+/*
+ * Host keyswitch of a batch in the coefficient-major layout: lwe_in holds
+ * lwe_dimension_before + 1 rows of num_samples words and lwe_out
+ * lwe_dimension_after + 1 rows of num_samples words. Same KSK and same
+ * decomposition as cpu_keyswitch_lwe_ciphertext_vector, so that the result
+ * is the transposition of its result.
+ *
+ * Each thread task handles a group of sample blocks, sized like the sample
+ * tile of get_keyswitch_tiling, so that the KSK words of an input chunk are
+ * reused from cache by all the blocks of the group.
+ */
+template <typename Torus>
+void cpu_keyswitch_coefficient_major_lwe_ciphertext_vector(
+    Torus *lwe_out, const Torus *lwe_in, const Torus *ksk,
+    uint32_t lwe_dimension_before, uint32_t lwe_dimension_after,
+    uint32_t base_log, uint32_t l_gadget, uint32_t num_samples,
+    ThreadPool &pool = ThreadPool::global(),
+    SimdLevel level = get_simd_level()) {
+  uint32_t block = KS_CM_SAMPLE_BLOCK;
+  uint32_t num_blocks = (num_samples + block - 1) / block;
+  auto tiling = get_keyswitch_tiling<Torus>(lwe_dimension_before,
+                                            lwe_dimension_after, l_gadget,
+                                            num_samples, pool.num_threads());
+  uint32_t group = (tiling.sample_tile + block - 1) / block;
+  uint32_t num_groups = (num_blocks + group - 1) / group;
+  size_t ksk_stride = lwe_dimension_after + 1;
+  Torus mod_b_mask = (1ll << base_log) - 1ll;
+
+  pool.parallel_for(0, num_groups, [&](uint32_t g) {
+    uint32_t first_sample = g * group * block;
+    uint32_t width = std::min(group * block, num_samples - first_sample);
+    uint32_t group_blocks = (width + block - 1) / block;
+    size_t acc_size = (size_t)(lwe_dimension_after + 1) * block;
+    size_t digits_size = (size_t)KS_CM_INPUT_CHUNK * l_gadget * block;
+    // The missing samples of the last block get zero digits and do not
+    // change the accumulators
+    std::vector<Torus> acc(group_blocks * acc_size, 0);
+    std::vector<Torus> digits(group_blocks * digits_size, 0);
+    for (uint32_t s = 0; s < width; s++)
+      acc[(s / block) * acc_size + (size_t)lwe_dimension_after * block +
+          s % block] =
+          lwe_in[(size_t)lwe_dimension_before * num_samples + first_sample + s];
+
+    for (uint32_t first_input = 0; first_input < lwe_dimension_before;
+         first_input += KS_CM_INPUT_CHUNK) {
+      uint32_t last_input =
+          std::min(first_input + KS_CM_INPUT_CHUNK, lwe_dimension_before);
+      // Digit row (i - first_input) * l_gadget + level of a block matches
+      // KSK row i * l_gadget + level
+      for (uint32_t i = first_input; i < last_input; i++) {
+        const Torus *row = &lwe_in[(size_t)i * num_samples + first_sample];
+        for (uint32_t s = 0; s < width; s++) {
+          Torus *digit_rows = &digits[(s / block) * digits_size +
+                                      (size_t)(i - first_input) * l_gadget *
+                                          block];
+          Torus a_i = round_to_closest_multiple(row[s], base_log, l_gadget);
+          Torus state = a_i >> (sizeof(Torus) * 8 - base_log * l_gadget);
+          for (uint32_t j = 0; j < l_gadget; j++)
+            digit_rows[(l_gadget - j - 1) * block + s % block] =
+                decompose_one<Torus>(state, mod_b_mask, base_log);
+        }
+      }
+
+      uint32_t num_rows = (last_input - first_input) * l_gadget;
+      const Torus *ksk_rows =
+          get_ith_block(ksk, first_input, 0, lwe_dimension_after, l_gadget);
+      for (uint32_t k = 0; k <= lwe_dimension_after; k++)
+        for (uint32_t b = 0; b < group_blocks; b++)
+          broadcast_sub_rows(&acc[b * acc_size + (size_t)k * block],
+                             &ksk_rows[k], ksk_stride,
+                             &digits[b * digits_size], num_rows, level);
+    }
+
+    for (uint32_t k = 0; k <= lwe_dimension_after; k++)
+      for (uint32_t s = 0; s < width; s++)
+        lwe_out[(size_t)k * num_samples + first_sample + s] =
+            acc[(s / block) * acc_size + (size_t)k * block + s % block];
+  });
+}
+
+#endif // CNCRT_CPU_KS_COEFFICIENT_MAJOR_H
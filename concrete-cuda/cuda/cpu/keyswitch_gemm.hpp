@@ -0,0 +1,255 @@
+#ifndef CNCRT_CPU_KS_GEMM_H
+#define CNCRT_CPU_KS_GEMM_H
+
+#include "crypto/gadget.hpp"
+#include "crypto/torus.hpp"
+#include "utils/simd.hpp"
+#include "utils/thread_pool.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+/*
+ * Keyswitch expressed as an integer matrix product
+ *
+ * With K = lwe_dimension_before * l_gadget, the batch keyswitch is
+ *   lwe_out = (0,..,0,b) - D x KSK
+ * where D is the num_samples x K matrix of the decomposed input masks and
+ * KSK is read as a K x (lwe_dimension_after + 1) matrix: row i * l_gadget +
+ * level of the KSK holds the encryption of s1_i q / B^(level + 1), and column
+ * i * l_gadget + level of D holds the digit of level `level` of the rounded
+ * a_i, as given by GadgetMatrixSingle (level 0 being the most significant
+ * digit).
+ *
+ * The digits lie in [-B/2, B/2[ so D is stored with the smallest signed type
+ * able to hold them, and the product is computed by a register blocked
+ * kernel wrapping modulo 2^32 or 2^64.
+ *
+ * GadgetMatrixSingle and decompose_one may pick different digits for the
+ * same input when a digit is exactly -B/2, so this engine decrypts to the
+ * same messages as the other keyswitch engines but is not bit-identical to
+ * them.
+ */
+
+/// Fills the num_samples x (lwe_dimension_before * l_gadget) digit matrix of
+/// the batch
+template <typename Torus, typename Digit>
+void decompose_lwe_masks(Digit *digits, const Torus *lwe_in,
+                         uint32_t lwe_dimension_before, uint32_t base_log,
+                         uint32_t l_gadget, uint32_t num_samples,
+                         ThreadPool &pool) {
+  GadgetMatrixSingle<Torus> gadget(base_log, l_gadget);
+  size_t k_size = (size_t)lwe_dimension_before * l_gadget;
+  pool.parallel_for(0, num_samples, [&](uint32_t sample) {
+    const Torus *block_lwe_in = &lwe_in[(size_t)sample * (lwe_dimension_before + 1)];
+    Digit *block_digits = &digits[sample * k_size];
+    for (uint32_t i = 0; i < lwe_dimension_before; i++) {
+      Torus a_i = round_to_closest_multiple(block_lwe_in[i], base_log, l_gadget);
+      for (uint32_t level = 0; level < l_gadget; level++)
+        block_digits[i * l_gadget + level] =
+            (Digit)gadget.decompose_one_level_single(a_i, level);
+    }
+  });
+}
+
+/// c[mr x nr] -= d[mr x kc] * b[kc x nr], any mr and nr
+template <typename Torus, typename Digit>
+inline void gemm_sub_kernel_scalar(Torus *c, size_t ldc, const Digit *d,
+                                   size_t ldd, const Torus *b, size_t ldb,
+                                   uint32_t mr, uint32_t nr, uint32_t kc) {
+  for (uint32_t r = 0; r < mr; r++) {
+    for (uint32_t k = 0; k < kc; k++) {
+      Torus digit = (Torus)(int64_t)d[r * ldd + k];
+      if (digit == 0)
+        continue;
+      for (uint32_t col = 0; col < nr; col++)
+        c[r * ldc + col] -= b[k * ldb + col] * digit;
+    }
+  }
+}
+
+// Rows of the micro kernels: each KSK vector loaded is used for that many
+// samples
+constexpr uint32_t GEMM_MR = 4;
+
+#ifdef CNCRT_CPU_X86
+// 4 x 8 block of 64 bits outputs in 8 registers
+template <typename Digit>
+__attribute__((target("avx2"))) inline void
+gemm_sub_micro_kernel_avx2(uint64_t *c, size_t ldc, const Digit *d, size_t ldd,
+                           const uint64_t *b, size_t ldb, uint32_t kc) {
+  __m256i acc[GEMM_MR][2];
+  for (uint32_t r = 0; r < GEMM_MR; r++) {
+    acc[r][0] = _mm256_loadu_si256((const __m256i *)&c[r * ldc]);
+    acc[r][1] = _mm256_loadu_si256((const __m256i *)&c[r * ldc + 4]);
+  }
+  for (uint32_t k = 0; k < kc; k++) {
+    __m256i b0 = _mm256_loadu_si256((const __m256i *)&b[k * ldb]);
+    __m256i b1 = _mm256_loadu_si256((const __m256i *)&b[k * ldb + 4]);
+    for (uint32_t r = 0; r < GEMM_MR; r++) {
+      __m256i digit = _mm256_set1_epi64x((int64_t)d[r * ldd + k]);
+      acc[r][0] = _mm256_sub_epi64(acc[r][0], mullo_epi64_avx2(b0, digit));
+      acc[r][1] = _mm256_sub_epi64(acc[r][1], mullo_epi64_avx2(b1, digit));
+    }
+  }
+  for (uint32_t r = 0; r < GEMM_MR; r++) {
+    _mm256_storeu_si256((__m256i *)&c[r * ldc], acc[r][0]);
+    _mm256_storeu_si256((__m256i *)&c[r * ldc + 4], acc[r][1]);
+  }
+}
+
+// 4 x 16 block of 64 bits outputs in 8 registers
+template <typename Digit>
+__attribute__((target("avx512f,avx512dq"))) inline void
+gemm_sub_micro_kernel_avx512(uint64_t *c, size_t ldc, const Digit *d,
+                             size_t ldd, const uint64_t *b, size_t ldb,
+                             uint32_t kc) {
+  __m512i acc[GEMM_MR][2];
+  for (uint32_t r = 0; r < GEMM_MR; r++) {
+    acc[r][0] = _mm512_loadu_si512((const void *)&c[r * ldc]);
+    acc[r][1] = _mm512_loadu_si512((const void *)&c[r * ldc + 8]);
+  }
+  for (uint32_t k = 0; k < kc; k++) {
+    __m512i b0 = _mm512_loadu_si512((const void *)&b[k * ldb]);
+    __m512i b1 = _mm512_loadu_si512((const void *)&b[k * ldb + 8]);
+    for (uint32_t r = 0; r < GEMM_MR; r++) {
+      __m512i digit = _mm512_set1_epi64((int64_t)d[r * ldd + k]);
+      acc[r][0] = _mm512_sub_epi64(acc[r][0], _mm512_mullo_epi64(b0, digit));
+      acc[r][1] = _mm512_sub_epi64(acc[r][1], _mm512_mullo_epi64(b1, digit));
+    }
+  }
+  for (uint32_t r = 0; r < GEMM_MR; r++) {
+    _mm512_storeu_si512((void *)&c[r * ldc], acc[r][0]);
+    _mm512_storeu_si512((void *)&c[r * ldc + 8], acc[r][1]);
+  }
+}
+#endif
+
+/// Width of the micro kernel used for a given torus and SIMD level, 0 when
+/// only the scalar kernel is available
+template <typename Torus> inline uint32_t gemm_micro_kernel_width(SimdLevel level) {
+  if constexpr (sizeof(Torus) == 8) {
+    if (level == AVX512)
+      return 16;
+    if (level == AVX2)
+      return 8;
+  }
+  return 0;
+}
+
+/// c[mr x nc] -= d[mr x kc] * b[kc x nc], dispatching the full blocks to the
+/// micro kernels and the edges to the scalar kernel
+template <typename Torus, typename Digit>
+void gemm_sub_block(Torus *c, size_t ldc, const Digit *d, size_t ldd,
+                    const Torus *b, size_t ldb, uint32_t mr, uint32_t nc,
+                    uint32_t kc, SimdLevel level) {
+  uint32_t nr = gemm_micro_kernel_width<Torus>(level);
+  uint32_t col = 0;
+#ifdef CNCRT_CPU_X86
+  if constexpr (sizeof(Torus) == 8) {
+    if (nr > 0 && mr == GEMM_MR) {
+      for (; col + nr <= nc; col += nr) {
+        if (level == AVX512)
+          gemm_sub_micro_kernel_avx512<Digit>(&c[col], ldc, d, ldd, &b[col],
+                                              ldb, kc);
+        else
+          gemm_sub_micro_kernel_avx2<Digit>(&c[col], ldc, d, ldd, &b[col],
+                                            ldb, kc);
+      }
+    }
+  }
+#endif
+  gemm_sub_kernel_scalar<Torus, Digit>(&c[col], ldc, d, ldd, &b[col], ldb, mr,
+                                       nc - col, kc);
+}
+
+/*
+ * lwe_out = (0,..,0,b) - digits x ksk, the samples are cut in blocks of
+ * GEMM_MR rows spread over the pool, and the KSK in kc x nc blocks sized for
+ * the L2 cache
+ */
+template <typename Torus, typename Digit>
+void keyswitch_gemm(Torus *lwe_out, const Torus *lwe_in, const Digit *digits,
+                    const Torus *ksk, uint32_t lwe_dimension_before,
+                    uint32_t lwe_dimension_after, uint32_t l_gadget,
+                    uint32_t num_samples, ThreadPool &pool, SimdLevel level) {
+  constexpr uint32_t kc_block = 128;
+  constexpr uint32_t nc_block = 256;
+  constexpr uint32_t rows_per_task = 8 * GEMM_MR;
+
+  uint32_t lwe_size_after = lwe_dimension_after + 1;
+  uint32_t k_size = lwe_dimension_before * l_gadget;
+  uint32_t num_tasks = (num_samples + rows_per_task - 1) / rows_per_task;
+
+  pool.parallel_for(0, num_tasks, [&](uint32_t task) {
+    uint32_t first_row = task * rows_per_task;
+    uint32_t last_row = std::min(first_row + rows_per_task, num_samples);
+
+    for (uint32_t row = first_row; row < last_row; row++) {
+      Torus *block_lwe_out = &lwe_out[(size_t)row * lwe_size_after];
+      for (uint32_t col = 0; col < lwe_dimension_after; col++)
+        block_lwe_out[col] = 0;
+      block_lwe_out[lwe_dimension_after] =
+          lwe_in[(size_t)row * (lwe_dimension_before + 1) + lwe_dimension_before];
+    }
+
+    for (uint32_t jc = 0; jc < lwe_size_after; jc += nc_block) {
+      uint32_t nc = std::min(nc_block, lwe_size_after - jc);
+      for (uint32_t pc = 0; pc < k_size; pc += kc_block) {
+        uint32_t kc = std::min(kc_block, k_size - pc);
+        for (uint32_t ir = first_row; ir < last_row; ir += GEMM_MR) {
+          uint32_t mr = std::min(GEMM_MR, last_row - ir);
+          gemm_sub_block<Torus, Digit>(
+              &lwe_out[(size_t)ir * lwe_size_after + jc], lwe_size_after,
+              &digits[(size_t)ir * k_size + pc], k_size,
+              &ksk[(size_t)pc * lwe_size_after + jc], lwe_size_after, mr, nc,
+              kc, level);
+        }
+      }
+    }
+  });
+}
+
+template <typename Torus, typename Digit>
+void cpu_keyswitch_gemm_lwe_ciphertext_vector(
+    Torus *lwe_out, const Torus *lwe_in, const Torus *ksk,
+    uint32_t lwe_dimension_before, uint32_t lwe_dimension_after,
+    uint32_t base_log, uint32_t l_gadget, uint32_t num_samples,
+    ThreadPool &pool, SimdLevel level) {
+  std::vector<Digit> digits((size_t)num_samples * lwe_dimension_before *
+                            l_gadget);
+  decompose_lwe_masks<Torus, Digit>(digits.data(), lwe_in,
+                                    lwe_dimension_before, base_log, l_gadget,
+                                    num_samples, pool);
+  keyswitch_gemm<Torus, Digit>(lwe_out, lwe_in, digits.data(), ksk,
+                               lwe_dimension_before, lwe_dimension_after,
+                               l_gadget, num_samples, pool, level);
+}
+
+/*
+ * Host keyswitch of a batch of LWE ciphertexts as a digit matrix product,
+ * the digits are stored on 8 bits up to base_log = 8, on 16 bits up to
+ * base_log = 16 and on 32 bits above
+ */
+template <typename Torus>
+void cpu_keyswitch_gemm_lwe_ciphertext_vector(
+    Torus *lwe_out, const Torus *lwe_in, const Torus *ksk,
+    uint32_t lwe_dimension_before, uint32_t lwe_dimension_after,
+    uint32_t base_log, uint32_t l_gadget, uint32_t num_samples,
+    ThreadPool &pool = ThreadPool::global(),
+    SimdLevel level = get_simd_level()) {
+  if (base_log <= 8)
+    cpu_keyswitch_gemm_lwe_ciphertext_vector<Torus, int8_t>(
+        lwe_out, lwe_in, ksk, lwe_dimension_before, lwe_dimension_after,
+        base_log, l_gadget, num_samples, pool, level);
+  else if (base_log <= 16)
+    cpu_keyswitch_gemm_lwe_ciphertext_vector<Torus, int16_t>(
+        lwe_out, lwe_in, ksk, lwe_dimension_before, lwe_dimension_after,
+        base_log, l_gadget, num_samples, pool, level);
+  else
+    cpu_keyswitch_gemm_lwe_ciphertext_vector<Torus, int32_t>(
+        lwe_out, lwe_in, ksk, lwe_dimension_before, lwe_dimension_after,
+        base_log, l_gadget, num_samples, pool, level);
+}
+
+#endif // CNCRT_CPU_KS_GEMM_H
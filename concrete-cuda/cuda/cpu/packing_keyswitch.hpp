@@ -0,0 +1,100 @@
+#ifndef CNCRT_CPU_PACKING_KS_H
+#define CNCRT_CPU_PACKING_KS_H
+
+#include "keyswitch.hpp"
+#include "polynomial/functions.hpp"
+#include <vector>
+
+/*
+ * LWE to GLWE packing keyswitch
+ *
+ * The packing keyswitch key (PKSK) has the layout of LwePackingKeyswitchKey
+ * in concrete-core: for each input key element i and each level j, a GLWE
+ * ciphertext of glwe_dimension + 1 polynomials (the masks, then the body)
+ * encrypting the constant polynomial key_in[i] * q / B^(j+1), level 0 being
+ * the most significant one as in the LWE KSK.
+ *
+ * Ciphertext c of the input batch is keyswitched to a GLWE ciphertext and
+ * multiplied by X^c, and all the results are summed, so that coefficient c
+ * of the output GLWE plaintext is the plaintext of LWE c.
+ */
+template <typename Torus>
+inline const Torus *get_ith_packing_block(const Torus *pksk, uint32_t i,
+                                          uint32_t level,
+                                          uint32_t glwe_dimension,
+                                          uint32_t polynomial_size,
+                                          uint32_t l_gadget) {
+  return &pksk[((size_t)i * l_gadget + level) * (glwe_dimension + 1) *
+               polynomial_size];
+}
+
+/*
+ * Host packing keyswitch of num_lwes <= polynomial_size LWE ciphertexts into
+ * one GLWE ciphertext
+ *
+ * The multiplication by X^c is fused in the accumulation: each PKSK
+ * polynomial is subtracted scaled and rotated by c, as two contiguous
+ * vectorized segments, instead of keyswitching to a temporary GLWE and
+ * rotating it. The LWEs are split in one range per thread, each summed in
+ * its own GLWE accumulator, and the PKSK is applied by tiles of input mask
+ * elements that stay in cache for the whole range. The result is
+ * bit-identical to the keyswitch-then-rotate definition.
+ */
+template <typename Torus>
+void cpu_packing_keyswitch_lwe_ciphertext_vector(
+    Torus *glwe_out, const Torus *lwe_in, const Torus *pksk,
+    uint32_t lwe_dimension_in, uint32_t glwe_dimension,
+    uint32_t polynomial_size, uint32_t base_log, uint32_t l_gadget,
+    uint32_t num_lwes, ThreadPool &pool = ThreadPool::global(),
+    SimdLevel level = get_simd_level(), size_t cache_bytes = 1 << 20) {
+  size_t glwe_size = (size_t)(glwe_dimension + 1) * polynomial_size;
+  uint32_t num_tasks = std::max(std::min(pool.num_threads(), num_lwes), 1u);
+  uint32_t input_tile = std::clamp<size_t>(
+      cache_bytes / 2 / (sizeof(Torus) * glwe_size * l_gadget), 1,
+      lwe_dimension_in);
+  Torus mod_b_mask = (1ll << base_log) - 1ll;
+  std::vector<Torus> partial(num_tasks * glwe_size, 0);
+
+  pool.parallel_for(0, num_tasks, [&](uint32_t task) {
+    Torus *acc = &partial[task * glwe_size];
+    uint32_t first_lwe = (uint64_t)task * num_lwes / num_tasks;
+    uint32_t last_lwe = (uint64_t)(task + 1) * num_lwes / num_tasks;
+    for (uint32_t c = first_lwe; c < last_lwe; c++)
+      acc[glwe_dimension * polynomial_size + c] +=
+          lwe_in[(size_t)c * (lwe_dimension_in + 1) + lwe_dimension_in];
+
+    for (uint32_t first_input = 0; first_input < lwe_dimension_in;
+         first_input += input_tile) {
+      uint32_t last_input = std::min(first_input + input_tile, lwe_dimension_in);
+      for (uint32_t c = first_lwe; c < last_lwe; c++) {
+        const Torus *block_lwe_in = &lwe_in[(size_t)c * (lwe_dimension_in + 1)];
+        for (uint32_t i = first_input; i < last_input; i++) {
+          Torus a_i = round_to_closest_multiple(block_lwe_in[i], base_log,
+                                                l_gadget);
+          Torus state = a_i >> (sizeof(Torus) * 8 - base_log * l_gadget);
+          for (uint32_t j = 0; j < l_gadget; j++) {
+            Torus decomposed = decompose_one<Torus>(state, mod_b_mask, base_log);
+            if (decomposed == 0)
+              continue;
+            const Torus *pksk_block =
+                get_ith_packing_block(pksk, i, l_gadget - j - 1, glwe_dimension,
+                                      polynomial_size, l_gadget);
+            for (uint32_t p = 0; p <= glwe_dimension; p++)
+              sub_scaled_monomial_product_negacyclic(
+                  &acc[p * polynomial_size], &pksk_block[p * polynomial_size],
+                  decomposed, c, polynomial_size, level);
+          }
+        }
+      }
+    }
+  });
+
+  for (size_t k = 0; k < glwe_size; k++) {
+    Torus sum = 0;
+    for (uint32_t task = 0; task < num_tasks; task++)
+      sum += partial[task * glwe_size + k];
+    glwe_out[k] = sum;
+  }
+}
+
+#endif // CNCRT_CPU_PACKING_KS_H
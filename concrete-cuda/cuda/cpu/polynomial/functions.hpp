@@ -0,0 +1,123 @@
+#ifndef CNCRT_CPU_POLYNOMIAL_FUNC_H
+#define CNCRT_CPU_POLYNOMIAL_FUNC_H
+
+#include "complex/operations.hpp"
+#include "crypto/torus.hpp"
+#include "utils/simd.hpp"
+#include <cmath>
+#include <cstdint>
+
+/*
+ * Host polynomial helpers, counterparts of src/polynomial/functions.cuh.
+ * Polynomials are arrays of polynomial_size coefficients modulo
+ * X^polynomial_size + 1, and monomial degrees are taken in
+ * [0, 2 * polynomial_size[.
+ */
+
+/// out -= scale * X^degree * poly, vectorized as two contiguous segments
+template <typename Torus>
+inline void sub_scaled_monomial_product_negacyclic(
+    Torus *out, const Torus *poly, Torus scale, uint32_t degree,
+    uint32_t polynomial_size, SimdLevel level = get_simd_level()) {
+  if (degree >= polynomial_size) {
+    degree -= polynomial_size;
+    scale = -scale;
+  }
+  // X^degree * poly[m] lands on out[m + degree] for m < N - degree and on
+  // -out[m + degree - N] otherwise
+  sub_scaled_vector(&out[degree], poly, scale, polynomial_size - degree, level);
+  sub_scaled_vector(out, &poly[polynomial_size - degree], (Torus)-scale, degree,
+                    level);
+}
+
+/// result = X^degree * poly
+template <typename Torus>
+inline void multiply_by_monomial_negacyclic(Torus *result, const Torus *poly,
+                                            uint32_t degree,
+                                            uint32_t polynomial_size) {
+  bool negate = degree >= polynomial_size;
+  if (negate)
+    degree -= polynomial_size;
+  for (uint32_t m = 0; m < polynomial_size - degree; m++)
+    result[m + degree] = negate ? -poly[m] : poly[m];
+  for (uint32_t m = polynomial_size - degree; m < polynomial_size; m++)
+    result[m + degree - polynomial_size] = negate ? poly[m] : -poly[m];
+}
+
+/// Compresses the real polynomial src into polynomial_size / 2 complex
+/// numbers for the FFT, even coefficients in the real parts
+template <typename T>
+inline void real_to_complex_compressed(double2 *dst, const T *src,
+                                       uint32_t polynomial_size) {
+  for (uint32_t k = 0; k < polynomial_size / 2; k++)
+    dst[k] = {(double)src[2 * k], (double)src[2 * k + 1]};
+}
+
+/// accumulator = input / X^j
+template <typename T>
+inline void divide_by_monomial_negacyclic(T *accumulator, const T *input,
+                                          uint32_t j,
+                                          uint32_t polynomial_size) {
+  multiply_by_monomial_negacyclic(accumulator, input,
+                                  (2 * polynomial_size - j) %
+                                      (2 * polynomial_size),
+                                  polynomial_size);
+}
+
+/// result_acc = acc * X^j - acc
+template <typename T>
+inline void multiply_by_monomial_negacyclic_and_sub_polynomial(
+    const T *acc, T *result_acc, uint32_t j, uint32_t polynomial_size) {
+  multiply_by_monomial_negacyclic(result_acc, acc, j, polynomial_size);
+  for (uint32_t m = 0; m < polynomial_size; m++)
+    result_acc[m] -= acc[m];
+}
+
+template <typename T>
+inline void round_to_closest_multiple_inplace(T *rotated_acc, int base_log,
+                                              int l_gadget,
+                                              uint32_t polynomial_size) {
+  for (uint32_t m = 0; m < polynomial_size; m++)
+    rotated_acc[m] = round_to_closest_multiple(rotated_acc[m], base_log,
+                                               l_gadget);
+}
+
+/// Adds to result the torus polynomial whose compressed values, normalized
+/// to [-1/2, 1/2[, come out of the inverse FFT
+template <typename Torus>
+inline void add_to_torus(const double2 *m_values, Torus *result,
+                         uint32_t polynomial_size) {
+  double mx = (double)std::numeric_limits<Torus>::max();
+  for (uint32_t k = 0; k < polynomial_size / 2; k++) {
+    double values[2] = {m_values[k].x, m_values[k].y};
+    for (int part = 0; part < 2; part++) {
+      double frac = values[part] - floor(values[part]);
+      frac *= mx;
+      double carry = frac - floor(frac);
+      frac += (carry >= 0.5);
+      result[2 * k + part] += typecast_double_to_torus<Torus>(frac);
+    }
+  }
+}
+
+/// Body of the LWE ciphertext extracted from the coefficient nth
+template <typename Torus>
+inline void sample_extract_body(Torus *lwe_out, const Torus *accumulator,
+                                uint32_t polynomial_size, uint32_t nth = 0) {
+  lwe_out[polynomial_size] = accumulator[nth];
+}
+
+/// Mask of the LWE ciphertext extracted from the coefficient nth:
+/// accumulator[nth - m] for m in [0, nth], then -accumulator[N + nth - m]
+/// for m in ]nth, N[, that is the first nth + 1 coefficients reversed and
+/// the others reversed and negated
+template <typename Torus>
+inline void sample_extract_mask(Torus *lwe_out, const Torus *accumulator,
+                                uint32_t polynomial_size, uint32_t nth = 0,
+                                SimdLevel level = get_simd_level()) {
+  reverse_vector(lwe_out, accumulator, nth + 1, false, level);
+  reverse_vector(&lwe_out[nth + 1], &accumulator[nth + 1],
+                 polynomial_size - nth - 1, true, level);
+}
+
+#endif // CNCRT_CPU_POLYNOMIAL_FUNC_H
@@ -0,0 +1,161 @@
+#ifndef CNCRT_CPU_POLYNOMIAL_MATH_H
+#define CNCRT_CPU_POLYNOMIAL_MATH_H
+
+#include "complex/operations.hpp"
+#include "utils/simd.hpp"
+#include <cstdint>
+
+/*
+ * Host counterparts of src/polynomial/polynomial_math.cuh on polynomials in
+ * the Fourier domain, polynomial_size / 2 complex numbers
+ */
+
+/// result[k] += first[k] * second[k] for k in [0, size[
+inline void polynomial_product_accumulate_in_fourier_domain_scalar(
+    double2 *result, const double2 *first, const double2 *second,
+    uint32_t size) {
+  for (uint32_t k = 0; k < size; k++)
+    result[k] += first[k] * second[k];
+}
+
+#ifdef CNCRT_CPU_X86
+__attribute__((target("avx2,fma"))) inline void
+polynomial_product_accumulate_in_fourier_domain_avx2(double2 *result,
+                                                     const double2 *first,
+                                                     const double2 *second,
+                                                     uint32_t size) {
+  uint32_t k = 0;
+  for (; k + 2 <= size; k += 2) {
+    __m256d a = _mm256_loadu_pd((const double *)&first[k]);
+    __m256d b = _mm256_loadu_pd((const double *)&second[k]);
+    __m256d r = _mm256_loadu_pd((const double *)&result[k]);
+    _mm256_storeu_pd((double *)&result[k],
+                     _mm256_add_pd(r, complex_mul_avx2(a, b)));
+  }
+  polynomial_product_accumulate_in_fourier_domain_scalar(
+      &result[k], &first[k], &second[k], size - k);
+}
+
+__attribute__((target("avx512f"))) inline void
+polynomial_product_accumulate_in_fourier_domain_avx512(double2 *result,
+                                                       const double2 *first,
+                                                       const double2 *second,
+                                                       uint32_t size) {
+  uint32_t k = 0;
+  for (; k + 4 <= size; k += 4) {
+    __m512d a = _mm512_loadu_pd((const double *)&first[k]);
+    __m512d b = _mm512_loadu_pd((const double *)&second[k]);
+    __m512d r = _mm512_loadu_pd((const double *)&result[k]);
+    _mm512_storeu_pd((double *)&result[k],
+                     _mm512_add_pd(r, complex_mul_avx512(a, b)));
+  }
+  polynomial_product_accumulate_in_fourier_domain_scalar(
+      &result[k], &first[k], &second[k], size - k);
+}
+#endif
+
+inline void polynomial_product_accumulate_in_fourier_domain(
+    double2 *result, const double2 *first, const double2 *second,
+    uint32_t size, SimdLevel level = get_simd_level()) {
+#ifdef CNCRT_CPU_X86
+  if (level == AVX512)
+    return polynomial_product_accumulate_in_fourier_domain_avx512(
+        result, first, second, size);
+  if (level == AVX2)
+    return polynomial_product_accumulate_in_fourier_domain_avx2(
+        result, first, second, size);
+#endif
+  polynomial_product_accumulate_in_fourier_domain_scalar(result, first, second,
+                                                         size);
+}
+
+/*
+ * Product of a vector of num_rows polynomials with a matrix of num_rows x
+ * num_columns polynomials stored row by row, in the Fourier domain:
+ * result[c] = sum over r of vector[r] * matrix[r][c], all of size
+ * coefficients.
+ *
+ * Fused form of num_rows * num_columns calls to
+ * polynomial_product_accumulate_in_fourier_domain on a zeroed result: each
+ * register of the result accumulates the products of all the rows before
+ * being stored once. The products are added in the same order, so the
+ * result is bit-identical.
+ */
+inline void polynomial_vector_matrix_product_in_fourier_domain_scalar(
+    double2 *result, const double2 *vector, const double2 *matrix,
+    uint32_t num_rows, uint32_t num_columns, uint32_t size,
+    uint32_t first = 0) {
+  for (uint32_t c = 0; c < num_columns; c++) {
+    for (uint32_t k = first; k < size; k++) {
+      double2 sum = {0., 0.};
+      for (uint32_t r = 0; r < num_rows; r++)
+        sum += vector[(size_t)r * size + k] *
+               matrix[((size_t)r * num_columns + c) * size + k];
+      result[(size_t)c * size + k] = sum;
+    }
+  }
+}
+
+#ifdef CNCRT_CPU_X86
+__attribute__((target("avx2,fma"))) inline void
+polynomial_vector_matrix_product_in_fourier_domain_avx2(
+    double2 *result, const double2 *vector, const double2 *matrix,
+    uint32_t num_rows, uint32_t num_columns, uint32_t size) {
+  uint32_t k = 0;
+  for (; k + 2 <= size; k += 2) {
+    for (uint32_t c = 0; c < num_columns; c++) {
+      __m256d sum = _mm256_setzero_pd();
+      for (uint32_t r = 0; r < num_rows; r++) {
+        __m256d a =
+            _mm256_loadu_pd((const double *)&vector[(size_t)r * size + k]);
+        __m256d b = _mm256_loadu_pd(
+            (const double *)&matrix[((size_t)r * num_columns + c) * size + k]);
+        sum = _mm256_add_pd(sum, complex_mul_avx2(a, b));
+      }
+      _mm256_storeu_pd((double *)&result[(size_t)c * size + k], sum);
+    }
+  }
+  polynomial_vector_matrix_product_in_fourier_domain_scalar(
+      result, vector, matrix, num_rows, num_columns, size, k);
+}
+
+__attribute__((target("avx512f"))) inline void
+polynomial_vector_matrix_product_in_fourier_domain_avx512(
+    double2 *result, const double2 *vector, const double2 *matrix,
+    uint32_t num_rows, uint32_t num_columns, uint32_t size) {
+  uint32_t k = 0;
+  for (; k + 4 <= size; k += 4) {
+    for (uint32_t c = 0; c < num_columns; c++) {
+      __m512d sum = _mm512_setzero_pd();
+      for (uint32_t r = 0; r < num_rows; r++) {
+        __m512d a =
+            _mm512_loadu_pd((const double *)&vector[(size_t)r * size + k]);
+        __m512d b = _mm512_loadu_pd(
+            (const double *)&matrix[((size_t)r * num_columns + c) * size + k]);
+        sum = _mm512_add_pd(sum, complex_mul_avx512(a, b));
+      }
+      _mm512_storeu_pd((double *)&result[(size_t)c * size + k], sum);
+    }
+  }
+  polynomial_vector_matrix_product_in_fourier_domain_scalar(
+      result, vector, matrix, num_rows, num_columns, size, k);
+}
+#endif
+
+inline void polynomial_vector_matrix_product_in_fourier_domain(
+    double2 *result, const double2 *vector, const double2 *matrix,
+    uint32_t num_rows, uint32_t num_columns, uint32_t size,
+    SimdLevel level = get_simd_level()) {
+#ifdef CNCRT_CPU_X86
+  if (level == AVX512)
+    return polynomial_vector_matrix_product_in_fourier_domain_avx512(
+        result, vector, matrix, num_rows, num_columns, size);
+  if (level == AVX2)
+    return polynomial_vector_matrix_product_in_fourier_domain_avx2(
+        result, vector, matrix, num_rows, num_columns, size);
+#endif
+  polynomial_vector_matrix_product_in_fourier_domain_scalar(
+      result, vector, matrix, num_rows, num_columns, size);
+}
+
+#endif // CNCRT_CPU_POLYNOMIAL_MATH_H
@@ -0,0 +1,47 @@
+#include "sample_extract.hpp"
+#include "bootstrap.h"
+
+#include <cstdint>
+
+/* Extract LWE ciphertexts from the coefficients of a batch of GLWE
+ * ciphertexts of 32 bits on the CPU
+ *
+ *  - lwe_out: num_glwes * num_nths LWE ciphertexts of dimension
+ *    glwe_dimension * polynomial_size, ordered by GLWE ciphertext then by
+ *    coefficient
+ *  - glwe_in: num_glwes GLWE ciphertexts of glwe_dimension + 1 polynomials,
+ *    such as the accumulators written by
+ *    cpu_bootstrap_amortized_glwe_output_lwe_ciphertext_vector_32
+ *  - nths: num_nths coefficients in [0, polynomial_size[ extracted from
+ *    every GLWE ciphertext
+ *
+ * Extracting the coefficient 0 gives the sample extraction of the
+ * bootstrap. v_stream is not used, the function returns once the batch is
+ * extracted. Nothing is done if one of nths is out of [0, polynomial_size[.
+ */
+void cpu_extract_lwe_samples_from_glwe_ciphertext_vector_32(
+    void * /*v_stream*/, void *lwe_out, void *glwe_in, void *nths,
+    uint32_t num_nths, uint32_t glwe_dimension, uint32_t polynomial_size,
+    uint32_t num_glwes) {
+  if (!are_valid_nths((uint32_t *)nths, num_nths, polynomial_size))
+    return;
+  cpu_extract_lwe_samples_from_glwe_ciphertext_vector(
+      (uint32_t *)lwe_out, (uint32_t *)glwe_in, (uint32_t *)nths, num_nths,
+      glwe_dimension, polynomial_size, num_glwes);
+}
+
+/* Extract LWE ciphertexts from the coefficients of a batch of GLWE
+ * ciphertexts of 64 bits on the CPU
+ *
+ * See cpu_extract_lwe_samples_from_glwe_ciphertext_vector_32
+ */
+void cpu_extract_lwe_samples_from_glwe_ciphertext_vector_64(
+    void * /*v_stream*/, void *lwe_out, void *glwe_in, void *nths,
+    uint32_t num_nths, uint32_t glwe_dimension, uint32_t polynomial_size,
+    uint32_t num_glwes) {
+  if (!are_valid_nths((uint32_t *)nths, num_nths, polynomial_size))
+    return;
+  cpu_extract_lwe_samples_from_glwe_ciphertext_vector(
+      (uint64_t *)lwe_out, (uint64_t *)glwe_in, (uint32_t *)nths, num_nths,
+      glwe_dimension, polynomial_size, num_glwes);
+}
@@ -0,0 +1,65 @@
+#ifndef CNCRT_CPU_SAMPLE_EXTRACT_H
+#define CNCRT_CPU_SAMPLE_EXTRACT_H
+
+#include "polynomial/functions.hpp"
+#include "utils/simd.hpp"
+#include "utils/thread_pool.hpp"
+#include <cstdint>
+
+/// Extracts the LWE ciphertext of dimension glwe_dimension *
+/// polynomial_size of the coefficient nth of the GLWE accumulator
+template <typename Torus>
+void sample_extract(Torus *lwe_out, const Torus *accumulator,
+                    uint32_t glwe_dimension, uint32_t polynomial_size,
+                    uint32_t nth = 0, SimdLevel level = get_simd_level()) {
+  for (uint32_t c = 0; c < glwe_dimension; c++)
+    sample_extract_mask(&lwe_out[c * polynomial_size],
+                        &accumulator[c * polynomial_size], polynomial_size,
+                        nth, level);
+  sample_extract_body(&lwe_out[(glwe_dimension - 1) * polynomial_size],
+                      &accumulator[glwe_dimension * polynomial_size],
+                      polynomial_size, nth);
+}
+
+/// Whether all the coefficients of nths are in [0, polynomial_size[
+inline bool are_valid_nths(const uint32_t *nths, uint32_t num_nths,
+                           uint32_t polynomial_size) {
+  for (uint32_t i = 0; i < num_nths; i++)
+    if (nths[i] >= polynomial_size)
+      return false;
+  return true;
+}
+
+/*
+ * Extraction of the coefficients nths[0], ..., nths[num_nths - 1] of each
+ * GLWE ciphertext of a batch
+ *
+ *  - glwe_in: num_glwes GLWE ciphertexts of glwe_dimension + 1 polynomials,
+ *    the masks followed by the body
+ *  - lwe_out: num_glwes * num_nths LWE ciphertexts of dimension
+ *    glwe_dimension * polynomial_size, the coefficient nths[i] of the GLWE
+ *    ciphertext g being extracted to lwe_out[(g * num_nths + i) *
+ *    (glwe_dimension * polynomial_size + 1)]
+ *
+ * Each extraction is a reversed copy of the masks with the tail negated,
+ * vectorized with reverse_vector. The GLWE ciphertexts are spread over the
+ * threads of the pool, all the coefficients of a ciphertext being extracted
+ * by the same thread while it is in cache.
+ */
+template <typename Torus>
+void cpu_extract_lwe_samples_from_glwe_ciphertext_vector(
+    Torus *lwe_out, const Torus *glwe_in, const uint32_t *nths,
+    uint32_t num_nths, uint32_t glwe_dimension, uint32_t polynomial_size,
+    uint32_t num_glwes, ThreadPool &pool = ThreadPool::global(),
+    SimdLevel level = get_simd_level()) {
+  size_t glwe_size = (size_t)(glwe_dimension + 1) * polynomial_size;
+  size_t lwe_size = (size_t)glwe_dimension * polynomial_size + 1;
+  pool.parallel_for(0, num_glwes, [&](uint32_t glwe) {
+    for (uint32_t i = 0; i < num_nths; i++)
+      sample_extract(&lwe_out[((size_t)glwe * num_nths + i) * lwe_size],
+                     &glwe_in[glwe * glwe_size], glwe_dimension,
+                     polynomial_size, nths[i], level);
+  });
+}
+
+#endif // CNCRT_CPU_SAMPLE_EXTRACT_H
@@ -0,0 +1,137 @@
+#ifndef CNCRT_CPU_HOST_STREAM_H
+#define CNCRT_CPU_HOST_STREAM_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+/*
+ * Host emulation of CUDA events
+ *
+ * Each record bumps the recorded generation and enqueues a marker on the
+ * stream that completes it once the work enqueued before it is done. An
+ * event that was never recorded is complete, as in CUDA.
+ */
+class HostEvent {
+public:
+  /// Generation to wait for to observe the last record
+  uint64_t record() {
+    std::lock_guard<std::mutex> lock(m_mtx);
+    return ++m_recorded;
+  }
+
+  uint64_t recorded() {
+    std::lock_guard<std::mutex> lock(m_mtx);
+    return m_recorded;
+  }
+
+  void complete(uint64_t generation) {
+    {
+      std::lock_guard<std::mutex> lock(m_mtx);
+      if (generation > m_completed)
+        m_completed = generation;
+    }
+    m_cv.notify_all();
+  }
+
+  bool query() {
+    std::lock_guard<std::mutex> lock(m_mtx);
+    return m_completed >= m_recorded;
+  }
+
+  void wait(uint64_t generation) {
+    std::unique_lock<std::mutex> lock(m_mtx);
+    m_cv.wait(lock, [&] { return m_completed >= generation; });
+  }
+
+  void synchronize() { wait(recorded()); }
+
+private:
+  std::mutex m_mtx;
+  std::condition_variable m_cv;
+  uint64_t m_recorded = 0;
+  uint64_t m_completed = 0;
+};
+
+/*
+ * Host emulation of a CUDA stream: a worker thread runs the enqueued tasks
+ * one after the other, in order, while the caller goes on. The tasks may
+ * use the global ThreadPool, the worker is not one of its threads.
+ */
+class HostStream {
+public:
+  HostStream() : m_worker([this] { run(); }) {}
+
+  ~HostStream() {
+    {
+      std::lock_guard<std::mutex> lock(m_mtx);
+      m_stop = true;
+    }
+    m_cv.notify_all();
+    m_worker.join();
+  }
+
+  HostStream(const HostStream &) = delete;
+  HostStream &operator=(const HostStream &) = delete;
+
+  void enqueue(std::function<void()> task) {
+    {
+      std::lock_guard<std::mutex> lock(m_mtx);
+      m_tasks.push_back(std::move(task));
+    }
+    m_cv.notify_all();
+  }
+
+  /// Blocks until every task enqueued so far is done
+  void synchronize() {
+    std::unique_lock<std::mutex> lock(m_mtx);
+    m_idle_cv.wait(lock, [&] { return m_tasks.empty() && !m_busy; });
+  }
+
+  /// The enqueued tasks share the ownership of the event, so it may be
+  /// released by its handle while they are still queued
+  void record(const std::shared_ptr<HostEvent> &event) {
+    uint64_t generation = event->record();
+    enqueue([event, generation] { event->complete(generation); });
+  }
+
+  /// The tasks enqueued afterwards start once the last record of the event
+  /// is complete
+  void wait_event(const std::shared_ptr<HostEvent> &event) {
+    uint64_t generation = event->recorded();
+    enqueue([event, generation] { event->wait(generation); });
+  }
+
+private:
+  std::mutex m_mtx;
+  std::condition_variable m_cv;
+  std::condition_variable m_idle_cv;
+  std::deque<std::function<void()>> m_tasks;
+  bool m_busy = false;
+  bool m_stop = false;
+  std::thread m_worker;
+
+  void run() {
+    std::unique_lock<std::mutex> lock(m_mtx);
+    while (true) {
+      m_cv.wait(lock, [&] { return m_stop || !m_tasks.empty(); });
+      if (m_tasks.empty())
+        return;
+      auto task = std::move(m_tasks.front());
+      m_tasks.pop_front();
+      m_busy = true;
+      lock.unlock();
+      task();
+      lock.lock();
+      m_busy = false;
+      if (m_tasks.empty())
+        m_idle_cv.notify_all();
+    }
+  }
+};
+
+#endif // CNCRT_CPU_HOST_STREAM_H
@@ -0,0 +1,273 @@
+#ifndef CNCRT_CPU_SIMD_H
+#define CNCRT_CPU_SIMD_H
+
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define CNCRT_CPU_X86
+#include <immintrin.h>
+#endif
+
+/*
+ * Vector kernels shared by the CPU engines
+ *
+ * Every kernel has a scalar version and, on x86, AVX2 and AVX-512 versions
+ * compiled with function level target attributes, so that the library does
+ * not need any -m flag and the best version is picked at runtime. All
+ * versions wrap modulo 2^32 or 2^64 and are bit-identical.
+ */
+enum SimdLevel { SCALAR = 0, AVX2 = 1, AVX512 = 2 };
+
+inline SimdLevel detect_simd_level() {
+#ifdef CNCRT_CPU_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq"))
+    return AVX512;
+  if (__builtin_cpu_supports("avx2"))
+    return AVX2;
+#endif
+  return SCALAR;
+}
+
+inline SimdLevel get_simd_level() {
+  static const SimdLevel level = detect_simd_level();
+  return level;
+}
+
+/// out[i] -= in[i] * scale for i in [0, size[
+template <typename Torus>
+inline void sub_scaled_vector_scalar(Torus *out, const Torus *in, Torus scale,
+                                     uint32_t size) {
+  for (uint32_t i = 0; i < size; i++)
+    out[i] -= in[i] * scale;
+}
+
+#ifdef CNCRT_CPU_X86
+// AVX2 has no 64 bits low multiplication, it is rebuilt from three 32x32->64
+// products, the high x high one being shifted out
+__attribute__((target("avx2"))) inline __m256i mullo_epi64_avx2(__m256i a,
+                                                                 __m256i b) {
+  __m256i lo = _mm256_mul_epu32(a, b);
+  __m256i cross = _mm256_add_epi64(
+      _mm256_mul_epu32(_mm256_srli_epi64(a, 32), b),
+      _mm256_mul_epu32(a, _mm256_srli_epi64(b, 32)));
+  return _mm256_add_epi64(lo, _mm256_slli_epi64(cross, 32));
+}
+
+__attribute__((target("avx2"))) inline void
+sub_scaled_vector_avx2(uint64_t *out, const uint64_t *in, uint64_t scale,
+                       uint32_t size) {
+  __m256i s = _mm256_set1_epi64x(scale);
+  uint32_t i = 0;
+  for (; i + 4 <= size; i += 4) {
+    __m256i a = _mm256_loadu_si256((const __m256i *)&in[i]);
+    __m256i o = _mm256_loadu_si256((const __m256i *)&out[i]);
+    o = _mm256_sub_epi64(o, mullo_epi64_avx2(a, s));
+    _mm256_storeu_si256((__m256i *)&out[i], o);
+  }
+  sub_scaled_vector_scalar(&out[i], &in[i], scale, size - i);
+}
+
+__attribute__((target("avx2"))) inline void
+sub_scaled_vector_avx2(uint32_t *out, const uint32_t *in, uint32_t scale,
+                       uint32_t size) {
+  __m256i s = _mm256_set1_epi32(scale);
+  uint32_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    __m256i a = _mm256_loadu_si256((const __m256i *)&in[i]);
+    __m256i o = _mm256_loadu_si256((const __m256i *)&out[i]);
+    o = _mm256_sub_epi32(o, _mm256_mullo_epi32(a, s));
+    _mm256_storeu_si256((__m256i *)&out[i], o);
+  }
+  sub_scaled_vector_scalar(&out[i], &in[i], scale, size - i);
+}
+
+__attribute__((target("avx512f,avx512dq"))) inline void
+sub_scaled_vector_avx512(uint64_t *out, const uint64_t *in, uint64_t scale,
+                         uint32_t size) {
+  __m512i s = _mm512_set1_epi64(scale);
+  uint32_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    __m512i a = _mm512_loadu_si512((const void *)&in[i]);
+    __m512i o = _mm512_loadu_si512((const void *)&out[i]);
+    o = _mm512_sub_epi64(o, _mm512_mullo_epi64(a, s));
+    _mm512_storeu_si512((void *)&out[i], o);
+  }
+  sub_scaled_vector_scalar(&out[i], &in[i], scale, size - i);
+}
+
+__attribute__((target("avx512f,avx512dq"))) inline void
+sub_scaled_vector_avx512(uint32_t *out, const uint32_t *in, uint32_t scale,
+                         uint32_t size) {
+  __m512i s = _mm512_set1_epi32(scale);
+  uint32_t i = 0;
+  for (; i + 16 <= size; i += 16) {
+    __m512i a = _mm512_loadu_si512((const void *)&in[i]);
+    __m512i o = _mm512_loadu_si512((const void *)&out[i]);
+    o = _mm512_sub_epi32(o, _mm512_mullo_epi32(a, s));
+    _mm512_storeu_si512((void *)&out[i], o);
+  }
+  sub_scaled_vector_scalar(&out[i], &in[i], scale, size - i);
+}
+#endif
+
+template <typename Torus>
+inline void sub_scaled_vector(Torus *out, const Torus *in, Torus scale,
+                              uint32_t size,
+                              SimdLevel level = get_simd_level()) {
+#ifdef CNCRT_CPU_X86
+  if (level == AVX512)
+    return sub_scaled_vector_avx512(out, in, scale, size);
+  if (level == AVX2)
+    return sub_scaled_vector_avx2(out, in, scale, size);
+#endif
+  sub_scaled_vector_scalar(out, in, scale, size);
+}
+
+/// out[i] = in[size - 1 - i], negated if negate, for i in [0, size[
+template <typename Torus>
+inline void reverse_vector_scalar(Torus *out, const Torus *in, uint32_t size,
+                                  bool negate) {
+  Torus sign = negate ? (Torus)-1 : 0;
+  for (uint32_t i = 0; i < size; i++)
+    out[i] = (in[size - 1 - i] ^ sign) - sign;
+}
+
+#ifdef CNCRT_CPU_X86
+// The negation is (x ^ sign) - sign with sign all ones, and the identity
+// with sign zero, so that both cases run the same loop. The AVX-512
+// permutations use the zero-masked forms for the same reason as
+// sub_scaled_high_vector_avx512
+__attribute__((target("avx2"))) inline void
+reverse_vector_avx2(uint64_t *out, const uint64_t *in, uint32_t size,
+                    bool negate) {
+  __m256i sign = _mm256_set1_epi64x(negate ? -1 : 0);
+  uint32_t i = 0;
+  for (; i + 4 <= size; i += 4) {
+    __m256i a = _mm256_loadu_si256((const __m256i *)&in[size - 4 - i]);
+    a = _mm256_permute4x64_epi64(a, 0x1b);
+    a = _mm256_sub_epi64(_mm256_xor_si256(a, sign), sign);
+    _mm256_storeu_si256((__m256i *)&out[i], a);
+  }
+  reverse_vector_scalar(&out[i], in, size - i, negate);
+}
+
+__attribute__((target("avx2"))) inline void
+reverse_vector_avx2(uint32_t *out, const uint32_t *in, uint32_t size,
+                    bool negate) {
+  __m256i sign = _mm256_set1_epi32(negate ? -1 : 0);
+  __m256i reverse = _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+  uint32_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    __m256i a = _mm256_loadu_si256((const __m256i *)&in[size - 8 - i]);
+    a = _mm256_permutevar8x32_epi32(a, reverse);
+    a = _mm256_sub_epi32(_mm256_xor_si256(a, sign), sign);
+    _mm256_storeu_si256((__m256i *)&out[i], a);
+  }
+  reverse_vector_scalar(&out[i], in, size - i, negate);
+}
+
+__attribute__((target("avx512f"))) inline void
+reverse_vector_avx512(uint64_t *out, const uint64_t *in, uint32_t size,
+                      bool negate) {
+  __m512i sign = _mm512_set1_epi64(negate ? -1 : 0);
+  __m512i reverse = _mm512_setr_epi64(7, 6, 5, 4, 3, 2, 1, 0);
+  uint32_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    __m512i a = _mm512_loadu_si512((const void *)&in[size - 8 - i]);
+    a = _mm512_maskz_permutexvar_epi64(0xff, reverse, a);
+    a = _mm512_sub_epi64(_mm512_xor_si512(a, sign), sign);
+    _mm512_storeu_si512((void *)&out[i], a);
+  }
+  reverse_vector_scalar(&out[i], in, size - i, negate);
+}
+
+__attribute__((target("avx512f"))) inline void
+reverse_vector_avx512(uint32_t *out, const uint32_t *in, uint32_t size,
+                      bool negate) {
+  __m512i sign = _mm512_set1_epi32(negate ? -1 : 0);
+  __m512i reverse = _mm512_setr_epi32(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5,
+                                      4, 3, 2, 1, 0);
+  uint32_t i = 0;
+  for (; i + 16 <= size; i += 16) {
+    __m512i a = _mm512_loadu_si512((const void *)&in[size - 16 - i]);
+    a = _mm512_maskz_permutexvar_epi32(0xffff, reverse, a);
+    a = _mm512_sub_epi32(_mm512_xor_si512(a, sign), sign);
+    _mm512_storeu_si512((void *)&out[i], a);
+  }
+  reverse_vector_scalar(&out[i], in, size - i, negate);
+}
+#endif
+
+template <typename Torus>
+inline void reverse_vector(Torus *out, const Torus *in, uint32_t size,
+                           bool negate, SimdLevel level = get_simd_level()) {
+#ifdef CNCRT_CPU_X86
+  if (level == AVX512)
+    return reverse_vector_avx512(out, in, size, negate);
+  if (level == AVX2)
+    return reverse_vector_avx2(out, in, size, negate);
+#endif
+  reverse_vector_scalar(out, in, size, negate);
+}
+
+/*
+ * Kernels with a 64 bits accumulator and 32 bits inputs holding the high
+ * word of 64 bits values: out[i] -= (in[i] << 32) * scale. Modulo 2^64 this
+ * is ((in[i] * scale) mod 2^32) << 32, so a 32 bits multiplication is
+ * enough.
+ */
+inline void sub_scaled_high_vector_scalar(uint64_t *out, const uint32_t *in,
+                                          uint64_t scale, uint32_t size) {
+  for (uint32_t i = 0; i < size; i++)
+    out[i] -= (uint64_t)(uint32_t)(in[i] * (uint32_t)scale) << 32;
+}
+
+#ifdef CNCRT_CPU_X86
+__attribute__((target("avx2"))) inline void
+sub_scaled_high_vector_avx2(uint64_t *out, const uint32_t *in, uint64_t scale,
+                            uint32_t size) {
+  __m128i s = _mm_set1_epi32((uint32_t)scale);
+  uint32_t i = 0;
+  for (; i + 4 <= size; i += 4) {
+    __m128i a = _mm_mullo_epi32(_mm_loadu_si128((const __m128i *)&in[i]), s);
+    __m256i wide = _mm256_slli_epi64(_mm256_cvtepu32_epi64(a), 32);
+    __m256i o = _mm256_loadu_si256((const __m256i *)&out[i]);
+    _mm256_storeu_si256((__m256i *)&out[i], _mm256_sub_epi64(o, wide));
+  }
+  sub_scaled_high_vector_scalar(&out[i], &in[i], scale, size - i);
+}
+
+__attribute__((target("avx512f,avx512dq"))) inline void
+sub_scaled_high_vector_avx512(uint64_t *out, const uint32_t *in,
+                              uint64_t scale, uint32_t size) {
+  __m256i s = _mm256_set1_epi32((uint32_t)scale);
+  uint32_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    __m256i a =
+        _mm256_mullo_epi32(_mm256_loadu_si256((const __m256i *)&in[i]), s);
+    // The zero-masked forms avoid a GCC 12 false positive on the undefined
+    // pass-through operand of the unmasked ones
+    __m512i wide = _mm512_maskz_slli_epi64(
+        0xff, _mm512_maskz_cvtepu32_epi64(0xff, a), 32);
+    __m512i o = _mm512_loadu_si512((const void *)&out[i]);
+    _mm512_storeu_si512((void *)&out[i], _mm512_sub_epi64(o, wide));
+  }
+  sub_scaled_high_vector_scalar(&out[i], &in[i], scale, size - i);
+}
+#endif
+
+/// Overload of sub_scaled_vector for a KSK truncated to its high words
+inline void sub_scaled_vector(uint64_t *out, const uint32_t *in,
+                              uint64_t scale, uint32_t size,
+                              SimdLevel level = get_simd_level()) {
+#ifdef CNCRT_CPU_X86
+  if (level == AVX512)
+    return sub_scaled_high_vector_avx512(out, in, scale, size);
+  if (level == AVX2)
+    return sub_scaled_high_vector_avx2(out, in, scale, size);
+#endif
+  sub_scaled_high_vector_scalar(out, in, scale, size);
+}
+
+#endif // CNCRT_CPU_SIMD_H
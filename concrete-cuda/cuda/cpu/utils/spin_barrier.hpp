@@ -0,0 +1,64 @@
+#ifndef CNCRT_CPU_SPIN_BARRIER_H
+#define CNCRT_CPU_SPIN_BARRIER_H
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+/*
+ * Barrier between a fixed number of threads that busy-waits instead of
+ * sleeping, the host counterpart of the grid synchronization of the
+ * cooperative kernels: it is crossed three times per iteration of a blind
+ * rotation, far too often to pay for a wake up through the kernel.
+ *
+ * Waiting threads yield after a while, so that the barrier still makes
+ * progress when there are fewer cores than threads. The threads must all
+ * be running at once, e.g. the tasks of a ThreadPool::parallel_for of at
+ * most num_threads() indexes.
+ */
+class SpinBarrier {
+public:
+  explicit SpinBarrier(uint32_t num_threads) : m_num_threads(num_threads) {}
+
+  SpinBarrier(const SpinBarrier &) = delete;
+  SpinBarrier &operator=(const SpinBarrier &) = delete;
+
+  /// Returns once all the threads have called it, the writes done before
+  /// the call by any of them being visible to all
+  void arrive_and_wait() {
+    uint32_t generation = m_generation.load(std::memory_order_acquire);
+    if (m_arrived.fetch_add(1, std::memory_order_acq_rel) + 1 ==
+        m_num_threads) {
+      // The count is reset before the release of the waiting threads, which
+      // may arrive at the next barrier right away
+      m_arrived.store(0, std::memory_order_relaxed);
+      m_generation.fetch_add(1, std::memory_order_release);
+      return;
+    }
+    for (uint32_t spins = 0;
+         m_generation.load(std::memory_order_acquire) == generation; spins++) {
+      if (spins < max_spins)
+        pause();
+      else
+        std::this_thread::yield();
+    }
+  }
+
+private:
+  static constexpr uint32_t max_spins = 4096;
+  const uint32_t m_num_threads;
+  std::atomic<uint32_t> m_arrived{0};
+  std::atomic<uint32_t> m_generation{0};
+
+  static void pause() {
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#endif
+  }
+};
+
+#endif // CNCRT_CPU_SPIN_BARRIER_H
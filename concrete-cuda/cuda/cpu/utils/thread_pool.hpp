@@ -0,0 +1,129 @@
+#ifndef CNCRT_CPU_THREAD_POOL_H
+#define CNCRT_CPU_THREAD_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+ * Fixed size pool of worker threads used by the CPU engines
+ *
+ * The calling thread takes part in the work, so a pool built with
+ * num_threads threads only spawns num_threads - 1 workers. Calls to
+ * parallel_for from different threads are serialized, and a task calling
+ * parallel_for on the pool that runs it runs all the indexes itself.
+ */
+class ThreadPool {
+public:
+  explicit ThreadPool(uint32_t num_threads) {
+    for (uint32_t i = 1; i < num_threads; i++)
+      m_workers.emplace_back([this] { worker_loop(); });
+  }
+
+  ~ThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(m_mtx);
+      m_stop = true;
+    }
+    m_start_cv.notify_all();
+    for (auto &worker : m_workers)
+      worker.join();
+  }
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  uint32_t num_threads() const { return m_workers.size() + 1; }
+
+  /// Whether the calling thread is running a task of a parallel_for of
+  /// this pool, whose nested parallel_for calls run inline
+  bool in_task() const { return t_running_pool == this; }
+
+  /// Runs func(i) for every i in [begin, end[ and returns once they are all
+  /// done. Indexes are handed out one at a time, so that any task may wait
+  /// on another one as long as end - begin <= num_threads()
+  template <typename F> void parallel_for(uint32_t begin, uint32_t end, F &&func) {
+    if (end <= begin)
+      return;
+    if (m_workers.empty() || end - begin == 1 || in_task()) {
+      for (uint32_t i = begin; i < end; i++)
+        func(i);
+      return;
+    }
+
+    std::lock_guard<std::mutex> call_lock(m_call_mtx);
+    std::function<void(uint32_t)> task = [&func](uint32_t i) { func(i); };
+    {
+      std::lock_guard<std::mutex> lock(m_mtx);
+      m_task = &task;
+      m_next = begin;
+      m_end = end;
+      m_busy = m_workers.size();
+      m_generation++;
+    }
+    m_start_cv.notify_all();
+
+    run_task();
+
+    std::unique_lock<std::mutex> lock(m_mtx);
+    m_done_cv.wait(lock, [this] { return m_busy == 0; });
+    m_task = nullptr;
+  }
+
+  /// Pool shared by all the CPU engines, sized on the number of hardware
+  /// threads
+  static ThreadPool &global() {
+    static ThreadPool pool(std::max(1u, std::thread::hardware_concurrency()));
+    return pool;
+  }
+
+private:
+  std::vector<std::thread> m_workers;
+  std::mutex m_call_mtx;
+  std::mutex m_mtx;
+  std::condition_variable m_start_cv;
+  std::condition_variable m_done_cv;
+  std::function<void(uint32_t)> *m_task = nullptr;
+  std::atomic<uint64_t> m_next{0};
+  uint64_t m_end = 0;
+  uint32_t m_busy = 0;
+  uint64_t m_generation = 0;
+  bool m_stop = false;
+  inline static thread_local const ThreadPool *t_running_pool = nullptr;
+
+  void run_task() {
+    const ThreadPool *outer_pool = t_running_pool;
+    t_running_pool = this;
+    for (uint64_t i = m_next.fetch_add(1); i < m_end; i = m_next.fetch_add(1))
+      (*m_task)(i);
+    t_running_pool = outer_pool;
+  }
+
+  void worker_loop() {
+    uint64_t seen_generation = 0;
+    while (true) {
+      {
+        std::unique_lock<std::mutex> lock(m_mtx);
+        m_start_cv.wait(lock, [&] {
+          return m_stop || m_generation != seen_generation;
+        });
+        if (m_stop)
+          return;
+        seen_generation = m_generation;
+      }
+      run_task();
+      {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        if (--m_busy == 0)
+          m_done_cv.notify_one();
+      }
+    }
+  }
+};
+
+#endif // CNCRT_CPU_THREAD_POOL_H
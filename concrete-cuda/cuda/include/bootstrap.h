@@ -47,6 +47,246 @@ void cuda_bootstrap_amortized_lwe_ciphertext_vector_64(
     uint32_t lwe_idx,
     uint32_t max_shared_memory);
 
+void cuda_bootstrap_amortized_modulus_switched_lwe_ciphertext_vector_32(
+    void *v_stream,
+    void *lwe_out,
+    void *test_vector,
+    void *test_vector_indexes,
+    void *lwe_in,
+    void *bootstrapping_key,
+    uint32_t input_lwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t base_log,
+    uint32_t l_gadget,
+    uint32_t num_samples,
+    uint32_t num_test_vectors,
+    uint32_t lwe_idx,
+    uint32_t max_shared_memory);
+
+void cuda_bootstrap_amortized_modulus_switched_lwe_ciphertext_vector_64(
+    void *v_stream,
+    void *lwe_out,
+    void *test_vector,
+    void *test_vector_indexes,
+    void *lwe_in,
+    void *bootstrapping_key,
+    uint32_t input_lwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t base_log,
+    uint32_t l_gadget,
+    uint32_t num_samples,
+    uint32_t num_test_vectors,
+    uint32_t lwe_idx,
+    uint32_t max_shared_memory);
+
+void cuda_bootstrap_amortized_lwe_ciphertext_vector_with_glwe_dimension_32(
+    void *v_stream,
+    void *lwe_out,
+    void *test_vector,
+    void *test_vector_indexes,
+    void *lwe_in,
+    void *bootstrapping_key,
+    uint32_t input_lwe_dimension,
+    uint32_t glwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t base_log,
+    uint32_t l_gadget,
+    uint32_t num_samples,
+    uint32_t num_test_vectors,
+    uint32_t lwe_idx,
+    uint32_t max_shared_memory);
+
+void cuda_bootstrap_amortized_lwe_ciphertext_vector_with_glwe_dimension_64(
+    void *v_stream,
+    void *lwe_out,
+    void *test_vector,
+    void *test_vector_indexes,
+    void *lwe_in,
+    void *bootstrapping_key,
+    uint32_t input_lwe_dimension,
+    uint32_t glwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t base_log,
+    uint32_t l_gadget,
+    uint32_t num_samples,
+    uint32_t num_test_vectors,
+    uint32_t lwe_idx,
+    uint32_t max_shared_memory);
+
+void cuda_bootstrap_amortized_shared_lut_lwe_ciphertext_vector_32(
+    void *v_stream,
+    void *lwe_out,
+    void *test_vector,
+    void *lwe_in,
+    void *bootstrapping_key,
+    uint32_t input_lwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t base_log,
+    uint32_t l_gadget,
+    uint32_t num_samples,
+    uint32_t max_shared_memory);
+
+void cuda_bootstrap_amortized_shared_lut_lwe_ciphertext_vector_64(
+    void *v_stream,
+    void *lwe_out,
+    void *test_vector,
+    void *lwe_in,
+    void *bootstrapping_key,
+    uint32_t input_lwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t base_log,
+    uint32_t l_gadget,
+    uint32_t num_samples,
+    uint32_t max_shared_memory);
+
+void cuda_bootstrap_amortized_batched_fft_lwe_ciphertext_vector_32(
+    void *v_stream,
+    void *lwe_out,
+    void *test_vector,
+    void *test_vector_indexes,
+    void *lwe_in,
+    void *bootstrapping_key,
+    uint32_t input_lwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t base_log,
+    uint32_t l_gadget,
+    uint32_t num_samples,
+    uint32_t num_test_vectors,
+    uint32_t lwe_idx,
+    uint32_t max_shared_memory);
+
+void cuda_bootstrap_amortized_batched_fft_lwe_ciphertext_vector_64(
+    void *v_stream,
+    void *lwe_out,
+    void *test_vector,
+    void *test_vector_indexes,
+    void *lwe_in,
+    void *bootstrapping_key,
+    uint32_t input_lwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t base_log,
+    uint32_t l_gadget,
+    uint32_t num_samples,
+    uint32_t num_test_vectors,
+    uint32_t lwe_idx,
+    uint32_t max_shared_memory);
+
+void cuda_bootstrap_amortized_many_lut_lwe_ciphertext_vector_32(
+    void *v_stream,
+    void *lwe_out,
+    void *test_vector,
+    void *test_vector_indexes,
+    void *lwe_in,
+    void *bootstrapping_key,
+    uint32_t input_lwe_dimension,
+    uint32_t glwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t base_log,
+    uint32_t l_gadget,
+    uint32_t num_samples,
+    uint32_t num_test_vectors,
+    uint32_t lwe_idx,
+    uint32_t lut_count,
+    uint32_t max_shared_memory);
+
+void cuda_bootstrap_amortized_many_lut_lwe_ciphertext_vector_64(
+    void *v_stream,
+    void *lwe_out,
+    void *test_vector,
+    void *test_vector_indexes,
+    void *lwe_in,
+    void *bootstrapping_key,
+    uint32_t input_lwe_dimension,
+    uint32_t glwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t base_log,
+    uint32_t l_gadget,
+    uint32_t num_samples,
+    uint32_t num_test_vectors,
+    uint32_t lwe_idx,
+    uint32_t lut_count,
+    uint32_t max_shared_memory);
+
+void cuda_bootstrap_amortized_glwe_output_lwe_ciphertext_vector_32(
+    void *v_stream,
+    void *glwe_out,
+    void *test_vector,
+    void *test_vector_indexes,
+    void *lwe_in,
+    void *bootstrapping_key,
+    uint32_t input_lwe_dimension,
+    uint32_t glwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t base_log,
+    uint32_t l_gadget,
+    uint32_t num_samples,
+    uint32_t num_test_vectors,
+    uint32_t lwe_idx,
+    uint32_t fourier_output,
+    uint32_t max_shared_memory);
+
+void cuda_bootstrap_amortized_glwe_output_lwe_ciphertext_vector_64(
+    void *v_stream,
+    void *glwe_out,
+    void *test_vector,
+    void *test_vector_indexes,
+    void *lwe_in,
+    void *bootstrapping_key,
+    uint32_t input_lwe_dimension,
+    uint32_t glwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t base_log,
+    uint32_t l_gadget,
+    uint32_t num_samples,
+    uint32_t num_test_vectors,
+    uint32_t lwe_idx,
+    uint32_t fourier_output,
+    uint32_t max_shared_memory);
+
+void cuda_convert_lwe_multi_bit_bootstrap_key_32(void *dest, void *src, void *v_stream,
+                                  uint32_t gpu_index, uint32_t input_lwe_dim, uint32_t glwe_dim,
+                                  uint32_t l_gadget, uint32_t polynomial_size,
+                                  uint32_t grouping_factor);
+
+void cuda_convert_lwe_multi_bit_bootstrap_key_64(void *dest, void *src, void *v_stream,
+                                  uint32_t gpu_index, uint32_t input_lwe_dim, uint32_t glwe_dim,
+                                  uint32_t l_gadget, uint32_t polynomial_size,
+                                  uint32_t grouping_factor);
+
+void cuda_bootstrap_multi_bit_lwe_ciphertext_vector_32(
+    void *v_stream,
+    void *lwe_out,
+    void *test_vector,
+    void *test_vector_indexes,
+    void *lwe_in,
+    void *bootstrapping_key,
+    uint32_t input_lwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t base_log,
+    uint32_t l_gadget,
+    uint32_t grouping_factor,
+    uint32_t num_samples,
+    uint32_t num_test_vectors,
+    uint32_t lwe_idx,
+    uint32_t max_shared_memory);
+
+void cuda_bootstrap_multi_bit_lwe_ciphertext_vector_64(
+    void *v_stream,
+    void *lwe_out,
+    void *test_vector,
+    void *test_vector_indexes,
+    void *lwe_in,
+    void *bootstrapping_key,
+    uint32_t input_lwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t base_log,
+    uint32_t l_gadget,
+    uint32_t grouping_factor,
+    uint32_t num_samples,
+    uint32_t num_test_vectors,
+    uint32_t lwe_idx,
+    uint32_t max_shared_memory);
+
 void cuda_bootstrap_low_latency_lwe_ciphertext_vector_32(
     void *v_stream,
     void *lwe_out,
@@ -63,7 +303,460 @@ void cuda_bootstrap_low_latency_lwe_ciphertext_vector_32(
     uint32_t lwe_idx,
     uint32_t max_shared_memory);
 
-void cuda_bootstrap_low_latency_lwe_ciphertext_vector_64(
+void cuda_bootstrap_low_latency_lwe_ciphertext_vector_64(
+    void *v_stream,
+    void *lwe_out,
+    void *test_vector,
+    void *test_vector_indexes,
+    void *lwe_in,
+    void *bootstrapping_key,
+    uint32_t input_lwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t base_log,
+    uint32_t l_gadget,
+    uint32_t num_samples,
+    uint32_t num_test_vectors,
+    uint32_t lwe_idx,
+    uint32_t max_shared_memory);
+
+void cuda_bootstrap_low_latency_shared_lut_lwe_ciphertext_vector_32(
+    void *v_stream,
+    void *lwe_out,
+    void *test_vector,
+    void *lwe_in,
+    void *bootstrapping_key,
+    uint32_t input_lwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t base_log,
+    uint32_t l_gadget,
+    uint32_t num_samples,
+    uint32_t max_shared_memory);
+
+void cuda_bootstrap_low_latency_shared_lut_lwe_ciphertext_vector_64(
+    void *v_stream,
+    void *lwe_out,
+    void *test_vector,
+    void *lwe_in,
+    void *bootstrapping_key,
+    uint32_t input_lwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t base_log,
+    uint32_t l_gadget,
+    uint32_t num_samples,
+    uint32_t max_shared_memory);
+
+void cuda_bootstrap_low_latency_lwe_ciphertext_vector_with_glwe_dimension_32(
+    void *v_stream,
+    void *lwe_out,
+    void *test_vector,
+    void *test_vector_indexes,
+    void *lwe_in,
+    void *bootstrapping_key,
+    uint32_t input_lwe_dimension,
+    uint32_t glwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t base_log,
+    uint32_t l_gadget,
+    uint32_t num_samples,
+    uint32_t num_test_vectors,
+    uint32_t lwe_idx,
+    uint32_t max_shared_memory);
+
+void cuda_bootstrap_low_latency_lwe_ciphertext_vector_with_glwe_dimension_64(
+    void *v_stream,
+    void *lwe_out,
+    void *test_vector,
+    void *test_vector_indexes,
+    void *lwe_in,
+    void *bootstrapping_key,
+    uint32_t input_lwe_dimension,
+    uint32_t glwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t base_log,
+    uint32_t l_gadget,
+    uint32_t num_samples,
+    uint32_t num_test_vectors,
+    uint32_t lwe_idx,
+    uint32_t max_shared_memory);
+
+void *cuda_create_bootstrap_low_latency_context_32(
+    uint32_t gpu_index,
+    uint32_t polynomial_size,
+    uint32_t l_gadget,
+    uint32_t max_num_samples);
+
+void *cuda_create_bootstrap_low_latency_context_64(
+    uint32_t gpu_index,
+    uint32_t polynomial_size,
+    uint32_t l_gadget,
+    uint32_t max_num_samples);
+
+void cuda_bootstrap_low_latency_with_context_lwe_ciphertext_vector_32(
+    void *v_stream,
+    void *context,
+    void *lwe_out,
+    void *test_vector,
+    void *lwe_in,
+    void *bootstrapping_key,
+    uint32_t input_lwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t base_log,
+    uint32_t l_gadget,
+    uint32_t num_samples);
+
+void cuda_bootstrap_low_latency_with_context_lwe_ciphertext_vector_64(
+    void *v_stream,
+    void *context,
+    void *lwe_out,
+    void *test_vector,
+    void *lwe_in,
+    void *bootstrapping_key,
+    uint32_t input_lwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t base_log,
+    uint32_t l_gadget,
+    uint32_t num_samples);
+
+int cuda_destroy_bootstrap_low_latency_context(
+    void *context,
+    uint32_t gpu_index);
+
+void cuda_bootstrap_auto_lwe_ciphertext_vector_32(
+    void *v_stream,
+    void *lwe_out,
+    void *test_vector,
+    void *test_vector_indexes,
+    void *lwe_in,
+    void *bootstrapping_key,
+    uint32_t input_lwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t base_log,
+    uint32_t l_gadget,
+    uint32_t num_samples,
+    uint32_t num_test_vectors,
+    uint32_t lwe_idx,
+    uint32_t max_shared_memory);
+
+void cuda_bootstrap_auto_lwe_ciphertext_vector_64(
+    void *v_stream,
+    void *lwe_out,
+    void *test_vector,
+    void *test_vector_indexes,
+    void *lwe_in,
+    void *bootstrapping_key,
+    uint32_t input_lwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t base_log,
+    uint32_t l_gadget,
+    uint32_t num_samples,
+    uint32_t num_test_vectors,
+    uint32_t lwe_idx,
+    uint32_t max_shared_memory);
+
+void cuda_keyswitch_bootstrap_amortized_lwe_ciphertext_vector_32(
+    void *v_stream,
+    void *lwe_out,
+    void *test_vector,
+    void *test_vector_indexes,
+    void *lwe_in,
+    void *ksk,
+    void *bootstrapping_key,
+    uint32_t input_lwe_dimension,
+    uint32_t lwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t ks_base_log,
+    uint32_t ks_l_gadget,
+    uint32_t pbs_base_log,
+    uint32_t pbs_l_gadget,
+    uint32_t num_samples,
+    uint32_t num_test_vectors,
+    uint32_t lwe_idx,
+    uint32_t max_shared_memory);
+
+void cuda_keyswitch_bootstrap_amortized_lwe_ciphertext_vector_64(
+    void *v_stream,
+    void *lwe_out,
+    void *test_vector,
+    void *test_vector_indexes,
+    void *lwe_in,
+    void *ksk,
+    void *bootstrapping_key,
+    uint32_t input_lwe_dimension,
+    uint32_t lwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t ks_base_log,
+    uint32_t ks_l_gadget,
+    uint32_t pbs_base_log,
+    uint32_t pbs_l_gadget,
+    uint32_t num_samples,
+    uint32_t num_test_vectors,
+    uint32_t lwe_idx,
+    uint32_t max_shared_memory);
+
+void cuda_cmux_tree_32(
+        void *v_stream,
+        void *glwe_out,
+        void *ggsw_in,
+        void *lut_vector,
+        uint32_t glwe_dimension,
+        uint32_t polynomial_size,
+        uint32_t base_log,
+        uint32_t l_gadget,
+        uint32_t r,
+        uint32_t max_shared_memory);
+
+void cuda_cmux_tree_64(
+        void *v_stream,
+        void *glwe_out,
+        void *ggsw_in,
+        void *lut_vector,
+        uint32_t glwe_dimension,
+        uint32_t polynomial_size,
+        uint32_t base_log,
+        uint32_t l_gadget,
+        uint32_t r,
+        uint32_t max_shared_memory);
+
+
+
+void cuda_extract_bits_32(
+    void *v_stream,
+    void *list_lwe_out,
+    void *lwe_in,
+    void *lwe_in_buffer,
+    void *lwe_in_shifted_buffer,
+    void *lwe_out_ks_buffer,
+    void *lwe_out_pbs_buffer,
+    void *lut_pbs,
+    void *lut_vector_indexes,
+    void *ksk,
+    void *fourier_bsk,
+    uint32_t number_of_bits,
+    uint32_t delta_log,
+    uint32_t lwe_dimension_before,
+    uint32_t lwe_dimension_after,
+    uint32_t base_log_bsk,
+    uint32_t l_gadget_bsk,
+    uint32_t base_log_ksk,
+    uint32_t l_gadget_ksk,
+    uint32_t number_of_samples);
+
+
+void cuda_extract_bits_64(
+        void *v_stream,
+        void *list_lwe_out,
+        void *lwe_in,
+        void *lwe_in_buffer,
+        void *lwe_in_shifted_buffer,
+        void *lwe_out_ks_buffer,
+        void *lwe_out_pbs_buffer,
+        void *lut_pbs,
+        void *lut_vector_indexes,
+        void *ksk,
+        void *fourier_bsk,
+        uint32_t number_of_bits,
+        uint32_t delta_log,
+        uint32_t lwe_dimension_before,
+        uint32_t lwe_dimension_after,
+        uint32_t base_log_bsk,
+        uint32_t l_gadget_bsk,
+        uint32_t base_log_ksk,
+        uint32_t l_gadget_ksk,
+        uint32_t number_of_samples);
+
+void cpu_initialize_twiddles(uint32_t polynomial_size, uint32_t gpu_index);
+
+void cpu_convert_lwe_bootstrap_key_32(void *dest, void *src, void *v_stream,
+                                  uint32_t gpu_index, uint32_t input_lwe_dim, uint32_t glwe_dim,
+                                  uint32_t l_gadget, uint32_t polynomial_size);
+
+void cpu_convert_lwe_bootstrap_key_64(void *dest, void *src, void *v_stream,
+                                  uint32_t gpu_index, uint32_t input_lwe_dim, uint32_t glwe_dim,
+                                  uint32_t l_gadget, uint32_t polynomial_size);
+
+void cpu_bootstrap_amortized_lwe_ciphertext_vector_32(
+    void *v_stream,
+    void *lwe_out,
+    void *test_vector,
+    void *test_vector_indexes,
+    void *lwe_in,
+    void *bootstrapping_key,
+    uint32_t input_lwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t base_log,
+    uint32_t l_gadget,
+    uint32_t num_samples,
+    uint32_t num_test_vectors,
+    uint32_t lwe_idx,
+    uint32_t max_shared_memory);
+
+void cpu_bootstrap_amortized_lwe_ciphertext_vector_64(
+    void *v_stream,
+    void *lwe_out,
+    void *test_vector,
+    void *test_vector_indexes,
+    void *lwe_in,
+    void *bootstrapping_key,
+    uint32_t input_lwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t base_log,
+    uint32_t l_gadget,
+    uint32_t num_samples,
+    uint32_t num_test_vectors,
+    uint32_t lwe_idx,
+    uint32_t max_shared_memory);
+
+void cpu_bootstrap_low_latency_lwe_ciphertext_vector_32(
+    void *v_stream,
+    void *lwe_out,
+    void *test_vector,
+    void *test_vector_indexes,
+    void *lwe_in,
+    void *bootstrapping_key,
+    uint32_t input_lwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t base_log,
+    uint32_t l_gadget,
+    uint32_t num_samples,
+    uint32_t num_test_vectors,
+    uint32_t lwe_idx,
+    uint32_t max_shared_memory);
+
+void cpu_bootstrap_low_latency_lwe_ciphertext_vector_64(
+    void *v_stream,
+    void *lwe_out,
+    void *test_vector,
+    void *test_vector_indexes,
+    void *lwe_in,
+    void *bootstrapping_key,
+    uint32_t input_lwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t base_log,
+    uint32_t l_gadget,
+    uint32_t num_samples,
+    uint32_t num_test_vectors,
+    uint32_t lwe_idx,
+    uint32_t max_shared_memory);
+
+void cpu_bootstrap_low_latency_lwe_ciphertext_vector_with_glwe_dimension_32(
+    void *v_stream,
+    void *lwe_out,
+    void *test_vector,
+    void *test_vector_indexes,
+    void *lwe_in,
+    void *bootstrapping_key,
+    uint32_t input_lwe_dimension,
+    uint32_t glwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t base_log,
+    uint32_t l_gadget,
+    uint32_t num_samples,
+    uint32_t num_test_vectors,
+    uint32_t lwe_idx,
+    uint32_t max_shared_memory);
+
+void cpu_bootstrap_low_latency_lwe_ciphertext_vector_with_glwe_dimension_64(
+    void *v_stream,
+    void *lwe_out,
+    void *test_vector,
+    void *test_vector_indexes,
+    void *lwe_in,
+    void *bootstrapping_key,
+    uint32_t input_lwe_dimension,
+    uint32_t glwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t base_log,
+    uint32_t l_gadget,
+    uint32_t num_samples,
+    uint32_t num_test_vectors,
+    uint32_t lwe_idx,
+    uint32_t max_shared_memory);
+
+void *cpu_create_bootstrap_low_latency_context_32(
+    uint32_t gpu_index,
+    uint32_t polynomial_size,
+    uint32_t l_gadget,
+    uint32_t max_num_samples);
+
+void *cpu_create_bootstrap_low_latency_context_64(
+    uint32_t gpu_index,
+    uint32_t polynomial_size,
+    uint32_t l_gadget,
+    uint32_t max_num_samples);
+
+void cpu_bootstrap_low_latency_with_context_lwe_ciphertext_vector_32(
+    void *v_stream,
+    void *context,
+    void *lwe_out,
+    void *test_vector,
+    void *lwe_in,
+    void *bootstrapping_key,
+    uint32_t input_lwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t base_log,
+    uint32_t l_gadget,
+    uint32_t num_samples);
+
+void cpu_bootstrap_low_latency_with_context_lwe_ciphertext_vector_64(
+    void *v_stream,
+    void *context,
+    void *lwe_out,
+    void *test_vector,
+    void *lwe_in,
+    void *bootstrapping_key,
+    uint32_t input_lwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t base_log,
+    uint32_t l_gadget,
+    uint32_t num_samples);
+
+int cpu_destroy_bootstrap_low_latency_context(
+    void *context,
+    uint32_t gpu_index);
+
+void cpu_bootstrap_amortized_shared_lut_lwe_ciphertext_vector_32(
+    void *v_stream,
+    void *lwe_out,
+    void *test_vector,
+    void *lwe_in,
+    void *bootstrapping_key,
+    uint32_t input_lwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t base_log,
+    uint32_t l_gadget,
+    uint32_t num_samples,
+    uint32_t max_shared_memory);
+
+void cpu_bootstrap_amortized_shared_lut_lwe_ciphertext_vector_64(
+    void *v_stream,
+    void *lwe_out,
+    void *test_vector,
+    void *lwe_in,
+    void *bootstrapping_key,
+    uint32_t input_lwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t base_log,
+    uint32_t l_gadget,
+    uint32_t num_samples,
+    uint32_t max_shared_memory);
+
+void cpu_bootstrap_amortized_modulus_switched_lwe_ciphertext_vector_32(
+    void *v_stream,
+    void *lwe_out,
+    void *test_vector,
+    void *test_vector_indexes,
+    void *lwe_in,
+    void *bootstrapping_key,
+    uint32_t input_lwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t base_log,
+    uint32_t l_gadget,
+    uint32_t num_samples,
+    uint32_t num_test_vectors,
+    uint32_t lwe_idx,
+    uint32_t max_shared_memory);
+
+void cpu_bootstrap_amortized_modulus_switched_lwe_ciphertext_vector_64(
     void *v_stream,
     void *lwe_out,
     void *test_vector,
@@ -79,77 +772,263 @@ void cuda_bootstrap_low_latency_lwe_ciphertext_vector_64(
     uint32_t lwe_idx,
     uint32_t max_shared_memory);
 
-void cuda_cmux_tree_32(
-        void *v_stream,
-        void *glwe_out,
-        void *ggsw_in,
-        void *lut_vector,
-        uint32_t glwe_dimension,
-        uint32_t polynomial_size,
-        uint32_t base_log,
-        uint32_t l_gadget,
-        uint32_t r,
-        uint32_t max_shared_memory);
+void cpu_bootstrap_amortized_many_lut_lwe_ciphertext_vector_32(
+    void *v_stream,
+    void *lwe_out,
+    void *test_vector,
+    void *test_vector_indexes,
+    void *lwe_in,
+    void *bootstrapping_key,
+    uint32_t input_lwe_dimension,
+    uint32_t glwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t base_log,
+    uint32_t l_gadget,
+    uint32_t num_samples,
+    uint32_t num_test_vectors,
+    uint32_t lwe_idx,
+    uint32_t lut_count,
+    uint32_t max_shared_memory);
 
-void cuda_cmux_tree_64(
-        void *v_stream,
-        void *glwe_out,
-        void *ggsw_in,
-        void *lut_vector,
-        uint32_t glwe_dimension,
-        uint32_t polynomial_size,
-        uint32_t base_log,
-        uint32_t l_gadget,
-        uint32_t r,
-        uint32_t max_shared_memory);
+void cpu_bootstrap_amortized_many_lut_lwe_ciphertext_vector_64(
+    void *v_stream,
+    void *lwe_out,
+    void *test_vector,
+    void *test_vector_indexes,
+    void *lwe_in,
+    void *bootstrapping_key,
+    uint32_t input_lwe_dimension,
+    uint32_t glwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t base_log,
+    uint32_t l_gadget,
+    uint32_t num_samples,
+    uint32_t num_test_vectors,
+    uint32_t lwe_idx,
+    uint32_t lut_count,
+    uint32_t max_shared_memory);
 
+void cpu_pack_many_lut_test_vector_32(void *lut_out, void *luts,
+                                      uint32_t lut_count,
+                                      uint32_t glwe_dimension,
+                                      uint32_t polynomial_size);
 
+void cpu_pack_many_lut_test_vector_64(void *lut_out, void *luts,
+                                      uint32_t lut_count,
+                                      uint32_t glwe_dimension,
+                                      uint32_t polynomial_size);
 
-void cuda_extract_bits_32(
+uint32_t cpu_encode_and_expand_lut_vector_32(
+    void *lut_vector,
+    void *lut_vector_indexes,
+    void *luts,
+    uint32_t lut_size,
+    uint32_t num_luts,
+    uint32_t message_bits,
+    uint32_t glwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t deduplicate);
+
+uint32_t cpu_encode_and_expand_lut_vector_64(
+    void *lut_vector,
+    void *lut_vector_indexes,
+    void *luts,
+    uint32_t lut_size,
+    uint32_t num_luts,
+    uint32_t message_bits,
+    uint32_t glwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t deduplicate);
+
+void cpu_convert_lwe_multi_bit_bootstrap_key_32(void *dest, void *src, void *v_stream,
+                                  uint32_t gpu_index, uint32_t input_lwe_dim, uint32_t glwe_dim,
+                                  uint32_t l_gadget, uint32_t polynomial_size,
+                                  uint32_t grouping_factor);
+
+void cpu_convert_lwe_multi_bit_bootstrap_key_64(void *dest, void *src, void *v_stream,
+                                  uint32_t gpu_index, uint32_t input_lwe_dim, uint32_t glwe_dim,
+                                  uint32_t l_gadget, uint32_t polynomial_size,
+                                  uint32_t grouping_factor);
+
+void cpu_bootstrap_multi_bit_lwe_ciphertext_vector_32(
     void *v_stream,
-    void *list_lwe_out,
+    void *lwe_out,
+    void *test_vector,
+    void *test_vector_indexes,
+    void *lwe_in,
+    void *bootstrapping_key,
+    uint32_t input_lwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t base_log,
+    uint32_t l_gadget,
+    uint32_t grouping_factor,
+    uint32_t num_samples,
+    uint32_t num_test_vectors,
+    uint32_t lwe_idx,
+    uint32_t max_shared_memory);
+
+void cpu_bootstrap_multi_bit_lwe_ciphertext_vector_64(
+    void *v_stream,
+    void *lwe_out,
+    void *test_vector,
+    void *test_vector_indexes,
+    void *lwe_in,
+    void *bootstrapping_key,
+    uint32_t input_lwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t base_log,
+    uint32_t l_gadget,
+    uint32_t grouping_factor,
+    uint32_t num_samples,
+    uint32_t num_test_vectors,
+    uint32_t lwe_idx,
+    uint32_t max_shared_memory);
+
+void cpu_bootstrap_amortized_lwe_ciphertext_vector_with_glwe_dimension_32(
+    void *v_stream,
+    void *lwe_out,
+    void *test_vector,
+    void *test_vector_indexes,
+    void *lwe_in,
+    void *bootstrapping_key,
+    uint32_t input_lwe_dimension,
+    uint32_t glwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t base_log,
+    uint32_t l_gadget,
+    uint32_t num_samples,
+    uint32_t num_test_vectors,
+    uint32_t lwe_idx,
+    uint32_t max_shared_memory);
+
+void cpu_bootstrap_amortized_lwe_ciphertext_vector_with_glwe_dimension_64(
+    void *v_stream,
+    void *lwe_out,
+    void *test_vector,
+    void *test_vector_indexes,
+    void *lwe_in,
+    void *bootstrapping_key,
+    uint32_t input_lwe_dimension,
+    uint32_t glwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t base_log,
+    uint32_t l_gadget,
+    uint32_t num_samples,
+    uint32_t num_test_vectors,
+    uint32_t lwe_idx,
+    uint32_t max_shared_memory);
+
+void cpu_keyswitch_bootstrap_amortized_lwe_ciphertext_vector_32(
+    void *v_stream,
+    void *lwe_out,
+    void *test_vector,
+    void *test_vector_indexes,
     void *lwe_in,
-    void *lwe_in_buffer,
-    void *lwe_in_shifted_buffer,
-    void *lwe_out_ks_buffer,
-    void *lwe_out_pbs_buffer,
-    void *lut_pbs,
-    void *lut_vector_indexes,
     void *ksk,
-    void *fourier_bsk,
-    uint32_t number_of_bits,
-    uint32_t delta_log,
-    uint32_t lwe_dimension_before,
-    uint32_t lwe_dimension_after,
-    uint32_t base_log_bsk,
-    uint32_t l_gadget_bsk,
-    uint32_t base_log_ksk,
-    uint32_t l_gadget_ksk,
-    uint32_t number_of_samples);
+    void *bootstrapping_key,
+    uint32_t input_lwe_dimension,
+    uint32_t lwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t ks_base_log,
+    uint32_t ks_l_gadget,
+    uint32_t pbs_base_log,
+    uint32_t pbs_l_gadget,
+    uint32_t num_samples,
+    uint32_t num_test_vectors,
+    uint32_t lwe_idx,
+    uint32_t max_shared_memory);
 
+void cpu_keyswitch_bootstrap_amortized_lwe_ciphertext_vector_64(
+    void *v_stream,
+    void *lwe_out,
+    void *test_vector,
+    void *test_vector_indexes,
+    void *lwe_in,
+    void *ksk,
+    void *bootstrapping_key,
+    uint32_t input_lwe_dimension,
+    uint32_t lwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t ks_base_log,
+    uint32_t ks_l_gadget,
+    uint32_t pbs_base_log,
+    uint32_t pbs_l_gadget,
+    uint32_t num_samples,
+    uint32_t num_test_vectors,
+    uint32_t lwe_idx,
+    uint32_t max_shared_memory);
 
-void cuda_extract_bits_64(
-        void *v_stream,
-        void *list_lwe_out,
-        void *lwe_in,
-        void *lwe_in_buffer,
-        void *lwe_in_shifted_buffer,
-        void *lwe_out_ks_buffer,
-        void *lwe_out_pbs_buffer,
-        void *lut_pbs,
-        void *lut_vector_indexes,
-        void *ksk,
-        void *fourier_bsk,
-        uint32_t number_of_bits,
-        uint32_t delta_log,
-        uint32_t lwe_dimension_before,
-        uint32_t lwe_dimension_after,
-        uint32_t base_log_bsk,
-        uint32_t l_gadget_bsk,
-        uint32_t base_log_ksk,
-        uint32_t l_gadget_ksk,
-        uint32_t number_of_samples);
+void cpu_bootstrap_amortized_glwe_output_lwe_ciphertext_vector_32(
+    void *v_stream,
+    void *glwe_out,
+    void *test_vector,
+    void *test_vector_indexes,
+    void *lwe_in,
+    void *bootstrapping_key,
+    uint32_t input_lwe_dimension,
+    uint32_t glwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t base_log,
+    uint32_t l_gadget,
+    uint32_t num_samples,
+    uint32_t num_test_vectors,
+    uint32_t lwe_idx,
+    uint32_t fourier_output,
+    uint32_t max_shared_memory);
+
+void cpu_bootstrap_amortized_glwe_output_lwe_ciphertext_vector_64(
+    void *v_stream,
+    void *glwe_out,
+    void *test_vector,
+    void *test_vector_indexes,
+    void *lwe_in,
+    void *bootstrapping_key,
+    uint32_t input_lwe_dimension,
+    uint32_t glwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t base_log,
+    uint32_t l_gadget,
+    uint32_t num_samples,
+    uint32_t num_test_vectors,
+    uint32_t lwe_idx,
+    uint32_t fourier_output,
+    uint32_t max_shared_memory);
+
+void cpu_extract_lwe_samples_from_glwe_ciphertext_vector_32(
+    void *v_stream,
+    void *lwe_out,
+    void *glwe_in,
+    void *nths,
+    uint32_t num_nths,
+    uint32_t glwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t num_glwes);
+
+void cpu_extract_lwe_samples_from_glwe_ciphertext_vector_64(
+    void *v_stream,
+    void *lwe_out,
+    void *glwe_in,
+    void *nths,
+    uint32_t num_nths,
+    uint32_t glwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t num_glwes);
+
+void cpu_modulus_switch_lwe_ciphertext_vector_32(
+    void *v_stream,
+    void *lwe_out,
+    void *lwe_in,
+    uint32_t lwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t num_samples);
 
+void cpu_modulus_switch_lwe_ciphertext_vector_64(
+    void *v_stream,
+    void *lwe_out,
+    void *lwe_in,
+    uint32_t lwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t num_samples);
 
 };
 
@@ -0,0 +1,109 @@
+#ifndef CNCRT_PBS_CONTEXT_H
+#define CNCRT_PBS_CONTEXT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+/*
+ * Buffers of the low latency bootstrap kept from one call to the next
+ *
+ * Pure host code, the memory being allocated through the Memory backend:
+ * DeviceMemory (src/bootstrap_low_latency.cuh) for the GPU engine,
+ * HostMemory for the CPU one. The context holds the join buffers of the
+ * launches of at most chunk_size ciphertexts, one per polynomial of the
+ * GLWE accumulator, the masks followed by the body, each ciphertext taking
+ * l_gadget polynomials of each in the Fourier domain, and the parameters
+ * they were sized for. The shared memory configuration of the kernel is
+ * done once, when the context is created. The engines without shared
+ * memory, the CPU one, also keep their scratch in the context, allocated by
+ * the first call and only reallocated by a call that needs more.
+ *
+ * A context is used by one stream at a time: the launches of a call reuse
+ * the buffers of the previous one once it is done, which the stream order
+ * guarantees.
+ */
+
+/// Host memory backend of the bootstrap contexts
+struct HostMemory {
+  static void *allocate(size_t bytes) {
+    // Room for a whole number of cache lines, as required by aligned_alloc
+    return std::aligned_alloc(64, (bytes + 63) / 64 * 64);
+  }
+  static void release(void *ptr) { std::free(ptr); }
+};
+
+template <typename Memory> class LowLatencyPbsContext {
+public:
+  /// Context for the bootstrap of LWE ciphertexts of torus_bytes bytes
+  /// elements with test vectors of glwe_dimension + 1 polynomials of
+  /// polynomial_size coefficients, l_gadget decomposition levels, in
+  /// launches of at most chunk_size ciphertexts
+  LowLatencyPbsContext(uint32_t torus_bytes, uint32_t polynomial_size,
+                       uint32_t l_gadget, uint32_t chunk_size,
+                       uint32_t glwe_dimension = 1)
+      : m_torus_bytes(torus_bytes), m_polynomial_size(polynomial_size),
+        m_l_gadget(l_gadget), m_chunk_size(chunk_size),
+        m_glwe_dimension(glwe_dimension) {
+    m_join_buffer =
+        Memory::allocate((glwe_dimension + 1) * get_join_buffer_bytes());
+  }
+
+  ~LowLatencyPbsContext() {
+    Memory::release(m_join_buffer);
+    if (m_scratch != nullptr)
+      Memory::release(m_scratch);
+  }
+
+  LowLatencyPbsContext(const LowLatencyPbsContext &) = delete;
+  LowLatencyPbsContext &operator=(const LowLatencyPbsContext &) = delete;
+
+  /// Whether the context was created for these parameters
+  bool is_compatible(uint32_t torus_bytes, uint32_t polynomial_size,
+                     uint32_t l_gadget) const {
+    return torus_bytes == m_torus_bytes &&
+           polynomial_size == m_polynomial_size && l_gadget == m_l_gadget;
+  }
+
+  uint32_t chunk_size() const { return m_chunk_size; }
+
+  uint32_t glwe_dimension() const { return m_glwe_dimension; }
+
+  /// Bytes of the join buffer of each polynomial of the accumulator, 16
+  /// bytes per coefficient of a polynomial in the Fourier domain
+  size_t get_join_buffer_bytes() const {
+    return (size_t)m_l_gadget * m_chunk_size * m_polynomial_size / 2 * 16;
+  }
+
+  /// Join buffers of the glwe_dimension masks, the body one coming right
+  /// after
+  void *mask_join_buffer() const { return m_join_buffer; }
+
+  void *body_join_buffer() const {
+    return static_cast<char *>(m_join_buffer) +
+           m_glwe_dimension * get_join_buffer_bytes();
+  }
+
+  /// Scratch of at least bytes bytes, kept for the next calls
+  void *scratch(size_t bytes) {
+    if (bytes > m_scratch_bytes) {
+      if (m_scratch != nullptr)
+        Memory::release(m_scratch);
+      m_scratch = Memory::allocate(bytes);
+      m_scratch_bytes = bytes;
+    }
+    return m_scratch;
+  }
+
+private:
+  uint32_t m_torus_bytes;
+  uint32_t m_polynomial_size;
+  uint32_t m_l_gadget;
+  uint32_t m_chunk_size;
+  uint32_t m_glwe_dimension;
+  void *m_join_buffer;
+  void *m_scratch = nullptr;
+  size_t m_scratch_bytes = 0;
+};
+
+#endif // CNCRT_PBS_CONTEXT_H
@@ -0,0 +1,285 @@
+#ifndef CNCRT_PBS_DISPATCH_H
+#define CNCRT_PBS_DISPATCH_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+/*
+ * Cost model choosing between the amortized and the low latency bootstrap
+ *
+ * Pure host code, shared by cuda_bootstrap_auto_lwe_ciphertext_vector_* and
+ * the tests, with the device described by PbsDeviceProperties instead of
+ * being queried.
+ *
+ * Both kernels run blocks of polynomial_size / opt threads (see
+ * Degree<N>::opt). The amortized kernel runs one block per ciphertext that
+ * performs the whole external product of each iteration, (k + 1) * l
+ * forward FFTs and k + 1 inverse ones. The low latency kernel runs
+ * l * (k + 1) blocks per ciphertext, one per level and column, each doing
+ * one forward and one inverse FFT per iteration, with k + 1 grid
+ * synchronizations in between, one per column of the external product. It is a cooperative launch, so all of its
+ * blocks must be resident at once.
+ *
+ * A launch takes max(latency, throughput) cycles:
+ *  - latency: number of waves of resident blocks times the cycles of one
+ *    block, its FFT work spread over its threads
+ *  - throughput: the FFT work of the whole launch spread over the double
+ *    precision units of all the SMs
+ * The FFT work of a polynomial is counted as cycles_per_fft_element
+ * cycles per element of its N log2(N) butterflies.
+ */
+
+/// Description of a GPU for the cost model
+struct PbsDeviceProperties {
+  uint32_t sm_count;
+  uint32_t max_threads_per_sm;
+  uint32_t max_blocks_per_sm;
+  uint32_t shared_memory_per_sm;
+  uint32_t fp64_units_per_sm;
+  /// Global memory the amortized kernel may use as scratch when its
+  /// buffers do not fit in shared memory
+  uint64_t scratch_memory;
+  /// Cost of one cooperative grid synchronization
+  uint32_t grid_sync_cycles = 2048;
+  /// Cost of one element of a butterfly pass of the FFT
+  uint32_t cycles_per_fft_element = 20;
+};
+
+enum PbsVariant { PBS_AMORTIZED = 0, PBS_LOW_LATENCY = 1 };
+
+/// Variant chosen for a batch, launched on consecutive chunks of at most
+/// chunk_size ciphertexts
+struct PbsPlan {
+  PbsVariant variant;
+  uint32_t chunk_size;
+  double estimated_cycles;
+};
+
+/// Number of threads of the blocks of both kernels, polynomial_size /
+/// Degree<polynomial_size>::opt
+inline uint32_t get_pbs_threads_per_block(uint32_t polynomial_size) {
+  uint32_t opt = polynomial_size <= 1024   ? 4
+                 : polynomial_size == 2048 ? 8
+                 : polynomial_size == 4096 ? 16
+                                           : 32;
+  return polynomial_size / opt;
+}
+
+/// Shared memory of a block of the amortized kernel with all its buffers in
+/// shared memory, SM_FULL in host_bootstrap_amortized
+inline uint32_t get_amortized_pbs_full_shared_memory(uint32_t torus_bytes,
+                                                     uint32_t glwe_dimension,
+                                                     uint32_t polynomial_size) {
+  return torus_bytes * polynomial_size * (glwe_dimension + 1) * 2 +
+         2 * polynomial_size + 16 * polynomial_size / 2 * (glwe_dimension + 1) +
+         16 * polynomial_size / 2;
+}
+
+/// Shared memory of a block of the amortized kernel with only its FFT
+/// buffer in shared memory, SM_PART in host_bootstrap_amortized
+inline uint32_t get_amortized_pbs_partial_shared_memory(
+    uint32_t polynomial_size) {
+  return 16 * polynomial_size / 2;
+}
+
+/// Shared memory of a block of the low latency kernel, bytes_needed in
+/// host_bootstrap_low_latency
+inline uint32_t get_low_latency_pbs_shared_memory(uint32_t torus_bytes,
+                                                  uint32_t polynomial_size) {
+  return 2 * polynomial_size + torus_bytes * polynomial_size +
+         16 * polynomial_size / 2;
+}
+
+/// Blocks of shared_memory bytes and threads threads resident on one SM
+inline uint32_t get_blocks_per_sm(const PbsDeviceProperties &device,
+                                  uint32_t threads, uint32_t shared_memory) {
+  uint32_t blocks =
+      std::min(device.max_blocks_per_sm, device.max_threads_per_sm / threads);
+  if (shared_memory > 0)
+    blocks = std::min(blocks, device.shared_memory_per_sm / shared_memory);
+  return blocks;
+}
+
+/// Shared memory used by a block of the amortized kernel given the
+/// max_shared_memory argument of the bootstrap
+inline uint32_t get_amortized_pbs_shared_memory(uint32_t torus_bytes,
+                                                uint32_t glwe_dimension,
+                                                uint32_t polynomial_size,
+                                                uint32_t max_shared_memory) {
+  uint32_t full = get_amortized_pbs_full_shared_memory(
+      torus_bytes, glwe_dimension, polynomial_size);
+  uint32_t partial = get_amortized_pbs_partial_shared_memory(polynomial_size);
+  if (max_shared_memory >= full)
+    return full;
+  if (max_shared_memory >= partial)
+    return partial;
+  return 0;
+}
+
+/// Ciphertexts bootstrapped at once by the amortized kernel, the counterpart
+/// of cuda_get_pbs_per_gpu
+inline uint32_t get_amortized_pbs_residency(const PbsDeviceProperties &device,
+                                            uint32_t torus_bytes,
+                                            uint32_t glwe_dimension,
+                                            uint32_t polynomial_size,
+                                            uint32_t max_shared_memory) {
+  uint32_t shared_memory = get_amortized_pbs_shared_memory(
+      torus_bytes, glwe_dimension, polynomial_size, max_shared_memory);
+  return device.sm_count *
+         get_blocks_per_sm(device, get_pbs_threads_per_block(polynomial_size),
+                           shared_memory);
+}
+
+/// Largest batch of a single cooperative launch of the low latency kernel,
+/// 0 if it cannot run with these parameters: it only supports
+/// glwe_dimension = 1 and needs its buffers in shared memory
+inline uint32_t get_low_latency_pbs_max_samples(
+    const PbsDeviceProperties &device, uint32_t torus_bytes,
+    uint32_t glwe_dimension, uint32_t polynomial_size, uint32_t l_gadget,
+    uint32_t max_shared_memory) {
+  uint32_t shared_memory =
+      get_low_latency_pbs_shared_memory(torus_bytes, polynomial_size);
+  if (glwe_dimension != 1 || shared_memory > max_shared_memory)
+    return 0;
+  uint32_t resident_blocks =
+      device.sm_count *
+      get_blocks_per_sm(device, get_pbs_threads_per_block(polynomial_size),
+                        shared_memory);
+  return resident_blocks / (l_gadget * (glwe_dimension + 1));
+}
+
+/// Cooperative launches of the low latency kernel for a batch: num_chunks
+/// launches of at most chunk_size consecutive ciphertexts
+struct PbsChunks {
+  uint32_t num_chunks;
+  uint32_t chunk_size;
+};
+
+/*
+ * Splits a batch of the low latency bootstrap in cooperative launches
+ *
+ * resident_blocks is the number of blocks of the kernel that can be resident
+ * at once on the device, each ciphertext taking l_gadget * (glwe_dimension
+ * + 1) of them. The batch is split in the fewest launches that fit, with
+ * sizes balanced so that the last one is not left with a few ciphertexts.
+ * Returns no launch if a single ciphertext does not fit.
+ */
+inline PbsChunks plan_low_latency_pbs_chunks(uint32_t resident_blocks,
+                                             uint32_t glwe_dimension,
+                                             uint32_t l_gadget,
+                                             uint32_t num_samples) {
+  uint32_t max_samples = resident_blocks / (l_gadget * (glwe_dimension + 1));
+  if (max_samples == 0 || num_samples == 0)
+    return {0, 0};
+  uint32_t num_chunks = (num_samples + max_samples - 1) / max_samples;
+  return {num_chunks, (num_samples + num_chunks - 1) / num_chunks};
+}
+
+/// Cycles of the FFT work of one polynomial, forward or inverse
+inline double get_fft_cycles(const PbsDeviceProperties &device,
+                             uint32_t polynomial_size) {
+  return (double)device.cycles_per_fft_element * polynomial_size *
+         std::log2((double)polynomial_size);
+}
+
+/// Estimated cycles of the amortized bootstrap of num_samples ciphertexts
+/// in launches of at most chunk_size ciphertexts
+inline double estimate_amortized_pbs_cycles(
+    const PbsDeviceProperties &device, uint32_t residency,
+    uint32_t input_lwe_dimension, uint32_t glwe_dimension,
+    uint32_t polynomial_size, uint32_t l_gadget, uint32_t num_samples,
+    uint32_t chunk_size) {
+  double block_work = (double)input_lwe_dimension * (glwe_dimension + 1) *
+                      (l_gadget + 1) * get_fft_cycles(device, polynomial_size);
+  double cycles = 0;
+  for (uint32_t first = 0; first < num_samples; first += chunk_size) {
+    uint32_t samples = std::min(chunk_size, num_samples - first);
+    uint32_t waves = (samples + residency - 1) / residency;
+    double latency =
+        waves * block_work / get_pbs_threads_per_block(polynomial_size);
+    double throughput =
+        samples * block_work / ((double)device.sm_count * device.fp64_units_per_sm);
+    cycles += std::max(latency, throughput);
+  }
+  return cycles;
+}
+
+/// Estimated cycles of the low latency bootstrap of num_samples ciphertexts
+/// in cooperative launches of at most chunk_size ciphertexts
+inline double estimate_low_latency_pbs_cycles(
+    const PbsDeviceProperties &device, uint32_t input_lwe_dimension,
+    uint32_t glwe_dimension, uint32_t polynomial_size, uint32_t l_gadget,
+    uint32_t num_samples, uint32_t chunk_size) {
+  double block_work = 2 * get_fft_cycles(device, polynomial_size);
+  uint32_t blocks_per_sample = l_gadget * (glwe_dimension + 1);
+  double cycles = 0;
+  for (uint32_t first = 0; first < num_samples; first += chunk_size) {
+    uint32_t samples = std::min(chunk_size, num_samples - first);
+    double latency =
+        block_work / get_pbs_threads_per_block(polynomial_size) +
+        (glwe_dimension + 1) * device.grid_sync_cycles;
+    double throughput = samples * blocks_per_sample * block_work /
+                        ((double)device.sm_count * device.fp64_units_per_sm);
+    cycles += input_lwe_dimension * std::max(latency, throughput);
+  }
+  return cycles;
+}
+
+/*
+ * Picks the bootstrap variant of a batch and the size of its launches
+ *
+ * The low latency kernel is launched on the chunks of
+ * plan_low_latency_pbs_chunks. The amortized kernel takes
+ * the whole batch, unless its scratch in global memory, when its buffers do
+ * not fit in shared memory, exceeds device.scratch_memory: the batch is then
+ * split in chunks that fit, rounded down to whole waves when possible. The
+ * variant with the lowest estimate is returned, the amortized one on ties
+ * or when the low latency kernel cannot run.
+ */
+inline PbsPlan plan_bootstrap(const PbsDeviceProperties &device,
+                              uint32_t torus_bytes,
+                              uint32_t input_lwe_dimension,
+                              uint32_t glwe_dimension, uint32_t polynomial_size,
+                              uint32_t l_gadget, uint32_t num_samples,
+                              uint32_t max_shared_memory) {
+  uint32_t residency =
+      std::max(1u, get_amortized_pbs_residency(device, torus_bytes,
+                                               glwe_dimension, polynomial_size,
+                                               max_shared_memory));
+  uint64_t scratch_per_sample =
+      get_amortized_pbs_full_shared_memory(torus_bytes, glwe_dimension,
+                                           polynomial_size) -
+      get_amortized_pbs_shared_memory(torus_bytes, glwe_dimension,
+                                      polynomial_size, max_shared_memory);
+  uint32_t amortized_chunk = std::max(num_samples, 1u);
+  if (scratch_per_sample > 0) {
+    uint64_t fitting = std::max<uint64_t>(
+        device.scratch_memory / scratch_per_sample, 1);
+    if (fitting < amortized_chunk)
+      amortized_chunk = fitting >= residency ? fitting / residency * residency
+                                             : (uint32_t)fitting;
+  }
+  PbsPlan plan = {PBS_AMORTIZED, amortized_chunk,
+                  estimate_amortized_pbs_cycles(
+                      device, residency, input_lwe_dimension, glwe_dimension,
+                      polynomial_size, l_gadget, num_samples,
+                      amortized_chunk)};
+
+  uint32_t max_samples = get_low_latency_pbs_max_samples(
+      device, torus_bytes, glwe_dimension, polynomial_size, l_gadget,
+      max_shared_memory);
+  PbsChunks chunks = plan_low_latency_pbs_chunks(
+      max_samples * l_gadget * (glwe_dimension + 1), glwe_dimension, l_gadget,
+      num_samples);
+  if (chunks.num_chunks > 0) {
+    double cycles = estimate_low_latency_pbs_cycles(
+        device, input_lwe_dimension, glwe_dimension, polynomial_size,
+        l_gadget, num_samples, chunks.chunk_size);
+    if (cycles < plan.estimated_cycles)
+      plan = {PBS_LOW_LATENCY, chunks.chunk_size, cycles};
+  }
+  return plan;
+}
+
+#endif // CNCRT_PBS_DISPATCH_H
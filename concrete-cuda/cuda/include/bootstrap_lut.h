@@ -0,0 +1,127 @@
+#ifndef CNCRT_PBS_LUT_H
+#define CNCRT_PBS_LUT_H
+
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * Encoding of lookup tables into the test vectors of the bootstrap
+ *
+ * Pure host code, behind cpu_encode_and_expand_lut_vector_*, whose test
+ * vectors serve both the cpu_bootstrap_* and, once uploaded, the
+ * cuda_bootstrap_* functions. A lookup table of lut_size entries,
+ * a power of 2, is spread over the polynomial_size coefficients of the body
+ * of a test vector: entry i > 0 fills the mega case of polynomial_size /
+ * lut_size coefficients starting at the middle of the case i - 1, the test
+ * vector being rotated by half a case so that the phases rounding to i land
+ * in it. Entry 0 fills the first half case, and the last half case wraps
+ * negacyclically to the opposite of entry 0. The entries are encoded as
+ * messages of message_bits bits with a padding bit, shifted by
+ * sizeof(Torus) * 8 - message_bits - 1, so message_bits is at most
+ * sizeof(Torus) * 8 - 2.
+ */
+
+/// Whether lookup tables of lut_size entries can be expanded into test
+/// vectors of polynomial_size coefficients: both powers of 2, with mega
+/// cases of at least 2 coefficients
+inline bool is_valid_lut_size(uint32_t lut_size, uint32_t polynomial_size) {
+  return lut_size > 0 && (lut_size & (lut_size - 1)) == 0 &&
+         polynomial_size % lut_size == 0 && polynomial_size / lut_size >= 2;
+}
+
+/// Whether messages of message_bits bits and their padding bit fit in a
+/// Torus with a shift of at least 1
+template <typename Torus> bool is_valid_message_bits(uint32_t message_bits) {
+  return message_bits + 1 < sizeof(Torus) * 8;
+}
+
+/// Expands the lookup table lut into the body of a test vector, as
+/// described above
+template <typename Torus>
+void encode_and_expand_lut(Torus *body, const uint64_t *lut, uint32_t lut_size,
+                           uint32_t message_bits, uint32_t polynomial_size) {
+  uint32_t mega_case_size = polynomial_size / lut_size;
+  uint32_t half_case = mega_case_size / 2;
+  uint32_t shift = sizeof(Torus) * 8 - message_bits - 1;
+
+  // Constant runs, filled with vector stores
+  std::fill(body, body + half_case, (Torus)lut[0] << shift);
+  for (uint32_t i = 1; i < lut_size; i++) {
+    Torus *start = &body[(i - 1) * mega_case_size + half_case];
+    std::fill(start, start + mega_case_size, (Torus)lut[i] << shift);
+  }
+  std::fill(&body[polynomial_size - half_case], body + polynomial_size,
+            (Torus)(-((Torus)lut[0] << shift)));
+}
+
+/*
+ * Encodes and expands num_luts lookup tables of lut_size entries, stored one
+ * after the other in luts, into lut_vector in the layout of the bootstrap:
+ * test vectors of glwe_dimension zero mask polynomials followed by the body.
+ *
+ * Without deduplicate, the table i gives the test vector i. With
+ * deduplicate, equal tables share a single test vector, in the order of
+ * their first occurrence. lut_vector_indexes, if not null, gets for each
+ * table the index of its test vector, the lut_vector_indexes of the
+ * bootstrap of a batch where ciphertext i is evaluated with table i.
+ *
+ * Returns the number of test vectors written to lut_vector, the
+ * num_lut_vectors of the bootstrap, or 0 if the sizes are not valid (see
+ * is_valid_lut_size and is_valid_message_bits).
+ */
+template <typename Torus>
+uint32_t encode_and_expand_lut_vector(Torus *lut_vector,
+                                      uint32_t *lut_vector_indexes,
+                                      const uint64_t *luts, uint32_t lut_size,
+                                      uint32_t num_luts, uint32_t message_bits,
+                                      uint32_t glwe_dimension,
+                                      uint32_t polynomial_size,
+                                      bool deduplicate) {
+  if (!is_valid_lut_size(lut_size, polynomial_size) ||
+      !is_valid_message_bits<Torus>(message_bits))
+    return 0;
+  size_t glwe_size = (size_t)(glwe_dimension + 1) * polynomial_size;
+
+  // Tables already expanded, by hash of their entries
+  std::unordered_multimap<uint64_t, uint32_t> expanded;
+  std::vector<uint32_t> first_table;
+  uint32_t num_lut_vectors = 0;
+  for (uint32_t t = 0; t < num_luts; t++) {
+    const uint64_t *lut = &luts[(size_t)t * lut_size];
+    uint64_t hash = 0;
+    if (deduplicate) {
+      // FNV-1a over the entries
+      hash = 14695981039346656037ull;
+      for (uint32_t i = 0; i < lut_size; i++)
+        hash = (hash ^ lut[i]) * 1099511628211ull;
+      bool found = false;
+      auto range = expanded.equal_range(hash);
+      for (auto it = range.first; it != range.second && !found; ++it) {
+        const uint64_t *other = &luts[(size_t)first_table[it->second] *
+                                      lut_size];
+        if (std::equal(lut, lut + lut_size, other)) {
+          if (lut_vector_indexes != nullptr)
+            lut_vector_indexes[t] = it->second;
+          found = true;
+        }
+      }
+      if (found)
+        continue;
+      expanded.emplace(hash, num_lut_vectors);
+      first_table.push_back(t);
+    }
+
+    Torus *test_vector = &lut_vector[num_lut_vectors * glwe_size];
+    std::fill(test_vector, test_vector + glwe_dimension * polynomial_size, 0);
+    encode_and_expand_lut(&test_vector[glwe_dimension * polynomial_size], lut,
+                          lut_size, message_bits, polynomial_size);
+    if (lut_vector_indexes != nullptr)
+      lut_vector_indexes[t] = num_lut_vectors;
+    num_lut_vectors++;
+  }
+  return num_lut_vectors;
+}
+
+#endif // CNCRT_PBS_LUT_H
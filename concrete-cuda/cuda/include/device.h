@@ -5,6 +5,20 @@ void *cuda_create_stream(uint32_t gpu_index);
 
 int cuda_destroy_stream(void *v_stream, uint32_t gpu_index);
 
+int cuda_synchronize_stream(void *v_stream, uint32_t gpu_index);
+
+void *cuda_create_event(uint32_t gpu_index);
+
+int cuda_destroy_event(void *v_event, uint32_t gpu_index);
+
+int cuda_record_event(void *v_event, void *v_stream, uint32_t gpu_index);
+
+int cuda_query_event(void *v_event, uint32_t gpu_index);
+
+int cuda_synchronize_event(void *v_event, uint32_t gpu_index);
+
+int cuda_stream_wait_event(void *v_stream, void *v_event, uint32_t gpu_index);
+
 void *cuda_malloc(uint64_t size, uint32_t gpu_index);
 
 int cuda_check_valid_malloc(uint64_t size, uint32_t gpu_index);
@@ -27,4 +41,26 @@ int cuda_synchronize_device(uint32_t gpu_index);
 int cuda_drop(void *ptr, uint32_t gpu_index);
 
 int cuda_get_max_shared_memory(uint32_t gpu_index);
+
+// Host emulation of streams and events, see cpu/utils/host_stream.hpp
+void *cpu_create_stream();
+
+int cpu_destroy_stream(void *v_stream);
+
+int cpu_synchronize_stream(void *v_stream);
+
+void *cpu_create_event();
+
+int cpu_destroy_event(void *v_event);
+
+int cpu_record_event(void *v_event, void *v_stream);
+
+int cpu_query_event(void *v_event);
+
+int cpu_synchronize_event(void *v_event);
+
+int cpu_stream_wait_event(void *v_stream, void *v_event);
+
+int cpu_memcpy_async(void *dest, const void *src, uint64_t size,
+                     void *v_stream);
 }
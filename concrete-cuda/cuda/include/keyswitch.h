@@ -19,6 +19,191 @@ void cuda_keyswitch_lwe_ciphertext_vector_64(void *v_stream, void *lwe_out, void
                         uint32_t base_log, uint32_t l_gadget,
                         uint32_t num_samples);
 
+void cuda_keyswitch_lwe_ciphertext_vector_async_32(void *v_stream, void *lwe_out, void *lwe_in,
+                        void *ksk,
+                        uint32_t lwe_dimension_before,
+                        uint32_t lwe_dimension_after,
+                        uint32_t base_log, uint32_t l_gadget,
+                        uint32_t num_samples);
+
+void cuda_keyswitch_lwe_ciphertext_vector_async_64(void *v_stream, void *lwe_out, void *lwe_in,
+                        void *ksk,
+                        uint32_t lwe_dimension_before,
+                        uint32_t lwe_dimension_after,
+                        uint32_t base_log, uint32_t l_gadget,
+                        uint32_t num_samples);
+
+void cuda_keyswitch_modulus_switched_lwe_ciphertext_vector_32(void *v_stream, void *lwe_out, void *lwe_in,
+                        void *ksk,
+                        uint32_t lwe_dimension_before,
+                        uint32_t lwe_dimension_after,
+                        uint32_t base_log, uint32_t l_gadget,
+                        uint32_t polynomial_size,
+                        uint32_t num_samples);
+
+void cuda_keyswitch_modulus_switched_lwe_ciphertext_vector_64(void *v_stream, void *lwe_out, void *lwe_in,
+                        void *ksk,
+                        uint32_t lwe_dimension_before,
+                        uint32_t lwe_dimension_after,
+                        uint32_t base_log, uint32_t l_gadget,
+                        uint32_t polynomial_size,
+                        uint32_t num_samples);
+
+void cpu_keyswitch_lwe_ciphertext_vector_32(void *v_stream, void *lwe_out, void *lwe_in,
+                        void *ksk,
+                        uint32_t lwe_dimension_before,
+                        uint32_t lwe_dimension_after,
+                        uint32_t base_log, uint32_t l_gadget,
+                        uint32_t num_samples);
+
+void cpu_keyswitch_lwe_ciphertext_vector_64(void *v_stream, void *lwe_out, void *lwe_in,
+                        void *ksk,
+                        uint32_t lwe_dimension_before,
+                        uint32_t lwe_dimension_after,
+                        uint32_t base_log, uint32_t l_gadget,
+                        uint32_t num_samples);
+
+void cpu_keyswitch_tiled_lwe_ciphertext_vector_32(void *v_stream, void *lwe_out, void *lwe_in,
+                        void *ksk,
+                        uint32_t lwe_dimension_before,
+                        uint32_t lwe_dimension_after,
+                        uint32_t base_log, uint32_t l_gadget,
+                        uint32_t num_samples);
+
+void cpu_keyswitch_tiled_lwe_ciphertext_vector_64(void *v_stream, void *lwe_out, void *lwe_in,
+                        void *ksk,
+                        uint32_t lwe_dimension_before,
+                        uint32_t lwe_dimension_after,
+                        uint32_t base_log, uint32_t l_gadget,
+                        uint32_t num_samples);
+
+void cpu_keyswitch_gemm_lwe_ciphertext_vector_32(void *v_stream, void *lwe_out, void *lwe_in,
+                        void *ksk,
+                        uint32_t lwe_dimension_before,
+                        uint32_t lwe_dimension_after,
+                        uint32_t base_log, uint32_t l_gadget,
+                        uint32_t num_samples);
+
+void cpu_keyswitch_gemm_lwe_ciphertext_vector_64(void *v_stream, void *lwe_out, void *lwe_in,
+                        void *ksk,
+                        uint32_t lwe_dimension_before,
+                        uint32_t lwe_dimension_after,
+                        uint32_t base_log, uint32_t l_gadget,
+                        uint32_t num_samples);
+
+void cpu_keyswitch_seeded_lwe_ciphertext_vector_32(void *v_stream, void *lwe_out, void *lwe_in,
+                        void *ksk_bodies, void *seed,
+                        uint32_t lwe_dimension_before,
+                        uint32_t lwe_dimension_after,
+                        uint32_t base_log, uint32_t l_gadget,
+                        uint32_t num_samples);
+
+void cpu_keyswitch_seeded_lwe_ciphertext_vector_64(void *v_stream, void *lwe_out, void *lwe_in,
+                        void *ksk_bodies, void *seed,
+                        uint32_t lwe_dimension_before,
+                        uint32_t lwe_dimension_after,
+                        uint32_t base_log, uint32_t l_gadget,
+                        uint32_t num_samples);
+
+void cpu_expand_seeded_lwe_keyswitch_key_32(void *ksk, void *ksk_bodies, void *seed,
+                        uint32_t lwe_dimension_before,
+                        uint32_t lwe_dimension_after,
+                        uint32_t l_gadget);
+
+void cpu_expand_seeded_lwe_keyswitch_key_64(void *ksk, void *ksk_bodies, void *seed,
+                        uint32_t lwe_dimension_before,
+                        uint32_t lwe_dimension_after,
+                        uint32_t l_gadget);
+
+void cpu_truncate_lwe_keyswitch_key_64(void *ksk_out, void *ksk_in,
+                        uint32_t lwe_dimension_before,
+                        uint32_t lwe_dimension_after,
+                        uint32_t l_gadget);
+
+void cpu_keyswitch_truncated_lwe_ciphertext_vector_64(void *v_stream, void *lwe_out, void *lwe_in,
+                        void *ksk,
+                        uint32_t lwe_dimension_before,
+                        uint32_t lwe_dimension_after,
+                        uint32_t base_log, uint32_t l_gadget,
+                        uint32_t num_samples);
+
+double cpu_truncated_keyswitch_key_noise_variance_64(
+                        uint32_t lwe_dimension_before,
+                        uint32_t lwe_dimension_after,
+                        uint32_t base_log, uint32_t l_gadget);
+
+void cpu_convert_lwe_batch_to_coefficient_major_32(void *lwe_out, void *lwe_in,
+                        uint32_t lwe_dimension, uint32_t num_samples);
+
+void cpu_convert_lwe_batch_to_coefficient_major_64(void *lwe_out, void *lwe_in,
+                        uint32_t lwe_dimension, uint32_t num_samples);
+
+void cpu_convert_lwe_batch_from_coefficient_major_32(void *lwe_out, void *lwe_in,
+                        uint32_t lwe_dimension, uint32_t num_samples);
+
+void cpu_convert_lwe_batch_from_coefficient_major_64(void *lwe_out, void *lwe_in,
+                        uint32_t lwe_dimension, uint32_t num_samples);
+
+void cpu_keyswitch_coefficient_major_lwe_ciphertext_vector_32(void *v_stream, void *lwe_out, void *lwe_in,
+                        void *ksk,
+                        uint32_t lwe_dimension_before,
+                        uint32_t lwe_dimension_after,
+                        uint32_t base_log, uint32_t l_gadget,
+                        uint32_t num_samples);
+
+void cpu_keyswitch_coefficient_major_lwe_ciphertext_vector_64(void *v_stream, void *lwe_out, void *lwe_in,
+                        void *ksk,
+                        uint32_t lwe_dimension_before,
+                        uint32_t lwe_dimension_after,
+                        uint32_t base_log, uint32_t l_gadget,
+                        uint32_t num_samples);
+
+void cpu_packing_keyswitch_lwe_ciphertext_vector_32(void *v_stream, void *glwe_out, void *lwe_in,
+                        void *pksk,
+                        uint32_t lwe_dimension_in,
+                        uint32_t glwe_dimension,
+                        uint32_t polynomial_size,
+                        uint32_t base_log, uint32_t l_gadget,
+                        uint32_t num_lwes);
+
+void cpu_packing_keyswitch_lwe_ciphertext_vector_64(void *v_stream, void *glwe_out, void *lwe_in,
+                        void *pksk,
+                        uint32_t lwe_dimension_in,
+                        uint32_t glwe_dimension,
+                        uint32_t polynomial_size,
+                        uint32_t base_log, uint32_t l_gadget,
+                        uint32_t num_lwes);
+
+void cpu_keyswitch_lwe_ciphertext_vector_async_32(void *v_stream, void *lwe_out, void *lwe_in,
+                        void *ksk,
+                        uint32_t lwe_dimension_before,
+                        uint32_t lwe_dimension_after,
+                        uint32_t base_log, uint32_t l_gadget,
+                        uint32_t num_samples);
+
+void cpu_keyswitch_lwe_ciphertext_vector_async_64(void *v_stream, void *lwe_out, void *lwe_in,
+                        void *ksk,
+                        uint32_t lwe_dimension_before,
+                        uint32_t lwe_dimension_after,
+                        uint32_t base_log, uint32_t l_gadget,
+                        uint32_t num_samples);
+
+void cpu_keyswitch_modulus_switched_lwe_ciphertext_vector_32(void *v_stream, void *lwe_out, void *lwe_in,
+                        void *ksk,
+                        uint32_t lwe_dimension_before,
+                        uint32_t lwe_dimension_after,
+                        uint32_t base_log, uint32_t l_gadget,
+                        uint32_t polynomial_size,
+                        uint32_t num_samples);
+
+void cpu_keyswitch_modulus_switched_lwe_ciphertext_vector_64(void *v_stream, void *lwe_out, void *lwe_in,
+                        void *ksk,
+                        uint32_t lwe_dimension_before,
+                        uint32_t lwe_dimension_after,
+                        uint32_t base_log, uint32_t l_gadget,
+                        uint32_t polynomial_size,
+                        uint32_t num_samples);
+
 }
 
 #endif // CNCRT_KS_H_
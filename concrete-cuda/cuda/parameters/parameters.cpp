@@ -1,44 +1,9 @@
 
 
+#include "parameters.h"
 #include <iostream>
 using namespace std;
 
-const int NORM2_MAX = 31;
-const int P_MAX = 7;
-
-typedef struct V0Parameter {
-  int k;
-  int polynomialSize;
-  int nSmall;
-  int brLevel;
-  int brLogBase;
-  int ksLevel;
-  int ksLogBase;
-
-  V0Parameter(int k_, int polynomialSize_, int nSmall_, int brLevel_,
-              int brLogBase_, int ksLevel_, int ksLogBase_) {
-    k = k_;
-    polynomialSize = polynomialSize_;
-    nSmall = nSmall_;
-    brLevel = brLevel_;
-    brLogBase = brLogBase_;
-    ksLevel = ksLevel_;
-    ksLogBase = ksLogBase_;
-  }
-
-} V0Parameter;
-
-typedef struct V0Variances {
-  float logstdEncrypt;
-  float logstdDecrypt;
-
-  V0Variances(float logstdEncrypt_, float logstdDecrypt_) {
-    logstdEncrypt = logstdEncrypt_;
-    logstdDecrypt = logstdDecrypt_;
-  }
-
-} V0Variances;
-
 V0Parameter parameters[NORM2_MAX][P_MAX] = {
     {V0Parameter(1, 10, 472, 2, 8, 4, 2), V0Parameter(1, 10, 514, 2, 8, 5, 2),
      V0Parameter(1, 10, 564, 2, 8, 5, 2), V0Parameter(1, 10, 599, 3, 6, 6, 2),
@@ -0,0 +1,51 @@
+#ifndef CUDA_PARAMETERS_H
+#define CUDA_PARAMETERS_H
+
+const int NORM2_MAX = 31;
+const int P_MAX = 7;
+
+// Parameters of the table indexed by the 2-norm of the dot product before the
+// bootstrap and the precision p, both starting at 1. polynomialSize is the
+// log2 of the polynomial size, the keyswitch goes from dimension
+// k * 2^polynomialSize to nSmall. Entries of zeros have no parameters.
+typedef struct V0Parameter {
+  int k;
+  int polynomialSize;
+  int nSmall;
+  int brLevel;
+  int brLogBase;
+  int ksLevel;
+  int ksLogBase;
+
+  V0Parameter(int k_, int polynomialSize_, int nSmall_, int brLevel_,
+              int brLogBase_, int ksLevel_, int ksLogBase_) {
+    k = k_;
+    polynomialSize = polynomialSize_;
+    nSmall = nSmall_;
+    brLevel = brLevel_;
+    brLogBase = brLogBase_;
+    ksLevel = ksLevel_;
+    ksLogBase = ksLogBase_;
+  }
+
+} V0Parameter;
+
+typedef struct V0Variances {
+  float logstdEncrypt;
+  float logstdDecrypt;
+
+  V0Variances(float logstdEncrypt_, float logstdDecrypt_) {
+    logstdEncrypt = logstdEncrypt_;
+    logstdDecrypt = logstdDecrypt_;
+  }
+
+} V0Variances;
+
+extern "C" {
+
+V0Parameter *get_parameters(int norm, int p);
+
+V0Variances *get_variances(int norm, int p);
+}
+
+#endif // CUDA_PARAMETERS_H
@@ -9,7 +9,9 @@
  * num_lut_vectors vectors to reduce memory usage
  *  - lut_vector_indexes: stores the index corresponding to
  * which test vector to use for each sample in
- * lut_vector
+ * lut_vector, or null if all the samples use the first
+ * test vector of lut_vector (see
+ * cuda_bootstrap_amortized_shared_lut_lwe_ciphertext_vector_32)
  *  - lwe_in: input batch of num_samples LWE ciphertexts, containing n
  * mask values + 1 body value
  *  - bootstrapping_key: RGSW encryption of the LWE secret key sk1
@@ -172,3 +174,706 @@ void cuda_bootstrap_amortized_lwe_ciphertext_vector_64(
     break;
   }
 }
+
+/* Perform bootstrapping on a batch of input LWE ciphertexts already modulus
+ * switched to [0, 2N[
+ *
+ * Same arguments as cuda_bootstrap_amortized_lwe_ciphertext_vector_32,
+ * except that lwe_in holds num_samples * (input_lwe_dimension + 1) uint16_t
+ * elements in [0, 2N[, as written by
+ * cuda_keyswitch_modulus_switched_lwe_ciphertext_vector_32. They are used
+ * directly as monomial degrees in the blind rotation, without the modulus
+ * switch pre-pass the other entry points run.
+ */
+void cuda_bootstrap_amortized_modulus_switched_lwe_ciphertext_vector_32(
+    void *v_stream,
+    void *lwe_out,
+    void *lut_vector,
+    void *lut_vector_indexes,
+    void *lwe_in,
+    void *bootstrapping_key,
+    uint32_t input_lwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t base_log,
+    uint32_t l_gadget,
+    uint32_t num_samples,
+    uint32_t num_lut_vectors,
+    uint32_t lwe_idx,
+    uint32_t max_shared_memory) {
+
+  switch (polynomial_size) {
+  case 512:
+    host_bootstrap_amortized<uint32_t, Degree<512>, uint16_t>(
+        v_stream, (uint32_t *)lwe_out, (uint32_t *)lut_vector,
+        (uint32_t *)lut_vector_indexes, (uint16_t *)lwe_in,
+        (double2 *)bootstrapping_key, input_lwe_dimension, polynomial_size,
+        base_log, l_gadget, num_samples,
+        num_lut_vectors, lwe_idx, max_shared_memory);
+    break;
+  case 1024:
+    host_bootstrap_amortized<uint32_t, Degree<1024>, uint16_t>(
+        v_stream, (uint32_t *)lwe_out, (uint32_t *)lut_vector,
+        (uint32_t *)lut_vector_indexes, (uint16_t *)lwe_in,
+        (double2 *)bootstrapping_key, input_lwe_dimension, polynomial_size,
+        base_log, l_gadget, num_samples,
+        num_lut_vectors, lwe_idx, max_shared_memory);
+    break;
+  case 2048:
+    host_bootstrap_amortized<uint32_t, Degree<2048>, uint16_t>(
+        v_stream, (uint32_t *)lwe_out, (uint32_t *)lut_vector,
+        (uint32_t *)lut_vector_indexes, (uint16_t *)lwe_in,
+        (double2 *)bootstrapping_key, input_lwe_dimension, polynomial_size,
+        base_log, l_gadget, num_samples,
+        num_lut_vectors, lwe_idx, max_shared_memory);
+    break;
+  case 4096:
+    host_bootstrap_amortized<uint32_t, Degree<4096>, uint16_t>(
+        v_stream, (uint32_t *)lwe_out, (uint32_t *)lut_vector,
+        (uint32_t *)lut_vector_indexes, (uint16_t *)lwe_in,
+        (double2 *)bootstrapping_key, input_lwe_dimension, polynomial_size,
+        base_log, l_gadget, num_samples,
+        num_lut_vectors, lwe_idx, max_shared_memory);
+    break;
+  case 8192:
+    host_bootstrap_amortized<uint32_t, Degree<8192>, uint16_t>(
+        v_stream, (uint32_t *)lwe_out, (uint32_t *)lut_vector,
+        (uint32_t *)lut_vector_indexes, (uint16_t *)lwe_in,
+        (double2 *)bootstrapping_key, input_lwe_dimension, polynomial_size,
+        base_log, l_gadget, num_samples,
+        num_lut_vectors, lwe_idx, max_shared_memory);
+    break;
+  default:
+    break;
+  }
+}
+
+/* Perform bootstrapping on a batch of input LWE ciphertexts already modulus
+ * switched to [0, 2N[
+ *
+ * See cuda_bootstrap_amortized_modulus_switched_lwe_ciphertext_vector_32
+ */
+void cuda_bootstrap_amortized_modulus_switched_lwe_ciphertext_vector_64(
+    void *v_stream,
+    void *lwe_out,
+    void *lut_vector,
+    void *lut_vector_indexes,
+    void *lwe_in,
+    void *bootstrapping_key,
+    uint32_t input_lwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t base_log,
+    uint32_t l_gadget,
+    uint32_t num_samples,
+    uint32_t num_lut_vectors,
+    uint32_t lwe_idx,
+    uint32_t max_shared_memory) {
+
+  switch (polynomial_size) {
+  case 512:
+    host_bootstrap_amortized<uint64_t, Degree<512>, uint16_t>(
+        v_stream, (uint64_t *)lwe_out, (uint64_t *)lut_vector,
+        (uint32_t *)lut_vector_indexes, (uint16_t *)lwe_in,
+        (double2 *)bootstrapping_key, input_lwe_dimension, polynomial_size,
+        base_log, l_gadget, num_samples,
+        num_lut_vectors, lwe_idx, max_shared_memory);
+    break;
+  case 1024:
+    host_bootstrap_amortized<uint64_t, Degree<1024>, uint16_t>(
+        v_stream, (uint64_t *)lwe_out, (uint64_t *)lut_vector,
+        (uint32_t *)lut_vector_indexes, (uint16_t *)lwe_in,
+        (double2 *)bootstrapping_key, input_lwe_dimension, polynomial_size,
+        base_log, l_gadget, num_samples,
+        num_lut_vectors, lwe_idx, max_shared_memory);
+    break;
+  case 2048:
+    host_bootstrap_amortized<uint64_t, Degree<2048>, uint16_t>(
+        v_stream, (uint64_t *)lwe_out, (uint64_t *)lut_vector,
+        (uint32_t *)lut_vector_indexes, (uint16_t *)lwe_in,
+        (double2 *)bootstrapping_key, input_lwe_dimension, polynomial_size,
+        base_log, l_gadget, num_samples,
+        num_lut_vectors, lwe_idx, max_shared_memory);
+    break;
+  case 4096:
+    host_bootstrap_amortized<uint64_t, Degree<4096>, uint16_t>(
+        v_stream, (uint64_t *)lwe_out, (uint64_t *)lut_vector,
+        (uint32_t *)lut_vector_indexes, (uint16_t *)lwe_in,
+        (double2 *)bootstrapping_key, input_lwe_dimension, polynomial_size,
+        base_log, l_gadget, num_samples,
+        num_lut_vectors, lwe_idx, max_shared_memory);
+    break;
+  case 8192:
+    host_bootstrap_amortized<uint64_t, Degree<8192>, uint16_t>(
+        v_stream, (uint64_t *)lwe_out, (uint64_t *)lut_vector,
+        (uint32_t *)lut_vector_indexes, (uint16_t *)lwe_in,
+        (double2 *)bootstrapping_key, input_lwe_dimension, polynomial_size,
+        base_log, l_gadget, num_samples,
+        num_lut_vectors, lwe_idx, max_shared_memory);
+    break;
+  default:
+    break;
+  }
+}
+
+template <typename Torus>
+void bootstrap_amortized_with_glwe_dimension(
+    void *v_stream, void *lwe_out, void *lut_vector, void *lut_vector_indexes,
+    void *lwe_in, void *bootstrapping_key, uint32_t input_lwe_dimension,
+    uint32_t glwe_dimension, uint32_t polynomial_size, uint32_t base_log,
+    uint32_t l_gadget, uint32_t num_samples, uint32_t num_lut_vectors,
+    uint32_t lwe_idx, uint32_t max_shared_memory) {
+
+  switch (polynomial_size) {
+  case 512:
+    host_bootstrap_amortized<Torus, Degree<512>>(
+        v_stream, (Torus *)lwe_out, (Torus *)lut_vector,
+        (uint32_t *)lut_vector_indexes, (Torus *)lwe_in,
+        (double2 *)bootstrapping_key, input_lwe_dimension, polynomial_size,
+        base_log, l_gadget, num_samples,
+        num_lut_vectors, lwe_idx, max_shared_memory, glwe_dimension);
+    break;
+  case 1024:
+    host_bootstrap_amortized<Torus, Degree<1024>>(
+        v_stream, (Torus *)lwe_out, (Torus *)lut_vector,
+        (uint32_t *)lut_vector_indexes, (Torus *)lwe_in,
+        (double2 *)bootstrapping_key, input_lwe_dimension, polynomial_size,
+        base_log, l_gadget, num_samples,
+        num_lut_vectors, lwe_idx, max_shared_memory, glwe_dimension);
+    break;
+  case 2048:
+    host_bootstrap_amortized<Torus, Degree<2048>>(
+        v_stream, (Torus *)lwe_out, (Torus *)lut_vector,
+        (uint32_t *)lut_vector_indexes, (Torus *)lwe_in,
+        (double2 *)bootstrapping_key, input_lwe_dimension, polynomial_size,
+        base_log, l_gadget, num_samples,
+        num_lut_vectors, lwe_idx, max_shared_memory, glwe_dimension);
+    break;
+  case 4096:
+    host_bootstrap_amortized<Torus, Degree<4096>>(
+        v_stream, (Torus *)lwe_out, (Torus *)lut_vector,
+        (uint32_t *)lut_vector_indexes, (Torus *)lwe_in,
+        (double2 *)bootstrapping_key, input_lwe_dimension, polynomial_size,
+        base_log, l_gadget, num_samples,
+        num_lut_vectors, lwe_idx, max_shared_memory, glwe_dimension);
+    break;
+  case 8192:
+    host_bootstrap_amortized<Torus, Degree<8192>>(
+        v_stream, (Torus *)lwe_out, (Torus *)lut_vector,
+        (uint32_t *)lut_vector_indexes, (Torus *)lwe_in,
+        (double2 *)bootstrapping_key, input_lwe_dimension, polynomial_size,
+        base_log, l_gadget, num_samples,
+        num_lut_vectors, lwe_idx, max_shared_memory, glwe_dimension);
+    break;
+  default:
+    break;
+  }
+}
+
+/* Perform bootstrapping on a batch of input LWE ciphertexts with a GLWE
+ * accumulator of any dimension
+ *
+ * Same arguments as cuda_bootstrap_amortized_lwe_ciphertext_vector_32, plus
+ * glwe_dimension, the number k of mask polynomials of the accumulator. The
+ * bootstrapping key is converted with the same glwe_dimension, each test
+ * vector holds k + 1 polynomials (the masks, then the body) and the output
+ * ciphertexts are of dimension k * polynomial_size. With glwe_dimension = 1
+ * this is cuda_bootstrap_amortized_lwe_ciphertext_vector_32.
+ */
+void cuda_bootstrap_amortized_lwe_ciphertext_vector_with_glwe_dimension_32(
+    void *v_stream,
+    void *lwe_out,
+    void *lut_vector,
+    void *lut_vector_indexes,
+    void *lwe_in,
+    void *bootstrapping_key,
+    uint32_t input_lwe_dimension,
+    uint32_t glwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t base_log,
+    uint32_t l_gadget,
+    uint32_t num_samples,
+    uint32_t num_lut_vectors,
+    uint32_t lwe_idx,
+    uint32_t max_shared_memory) {
+  bootstrap_amortized_with_glwe_dimension<uint32_t>(
+      v_stream, lwe_out, lut_vector, lut_vector_indexes, lwe_in,
+      bootstrapping_key, input_lwe_dimension, glwe_dimension, polynomial_size,
+      base_log, l_gadget, num_samples, num_lut_vectors, lwe_idx,
+      max_shared_memory);
+}
+
+/* Perform bootstrapping on a batch of input LWE ciphertexts of 64 bits with
+ * a GLWE accumulator of any dimension
+ *
+ * See cuda_bootstrap_amortized_lwe_ciphertext_vector_with_glwe_dimension_32
+ */
+void cuda_bootstrap_amortized_lwe_ciphertext_vector_with_glwe_dimension_64(
+    void *v_stream,
+    void *lwe_out,
+    void *lut_vector,
+    void *lut_vector_indexes,
+    void *lwe_in,
+    void *bootstrapping_key,
+    uint32_t input_lwe_dimension,
+    uint32_t glwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t base_log,
+    uint32_t l_gadget,
+    uint32_t num_samples,
+    uint32_t num_lut_vectors,
+    uint32_t lwe_idx,
+    uint32_t max_shared_memory) {
+  bootstrap_amortized_with_glwe_dimension<uint64_t>(
+      v_stream, lwe_out, lut_vector, lut_vector_indexes, lwe_in,
+      bootstrapping_key, input_lwe_dimension, glwe_dimension, polynomial_size,
+      base_log, l_gadget, num_samples, num_lut_vectors, lwe_idx,
+      max_shared_memory);
+}
+
+/* Perform bootstrapping on a batch of input LWE ciphertexts of 32 bits that
+ * all use the same test vector
+ *
+ * Same arguments as cuda_bootstrap_amortized_lwe_ciphertext_vector_32
+ * without the index array: lut_vector holds a single test vector, read by
+ * all the blocks from L2. Neither the index array nor its upload are needed.
+ * The test vector is not staged in constant memory, whose reads are only
+ * fast when the threads of a warp read the same address, while each thread
+ * reads its own coefficients once per sample.
+ */
+void cuda_bootstrap_amortized_shared_lut_lwe_ciphertext_vector_32(
+    void *v_stream,
+    void *lwe_out,
+    void *lut_vector,
+    void *lwe_in,
+    void *bootstrapping_key,
+    uint32_t input_lwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t base_log,
+    uint32_t l_gadget,
+    uint32_t num_samples,
+    uint32_t max_shared_memory) {
+  cuda_bootstrap_amortized_lwe_ciphertext_vector_32(
+      v_stream, lwe_out, lut_vector, nullptr, lwe_in, bootstrapping_key,
+      input_lwe_dimension, polynomial_size, base_log, l_gadget, num_samples, 1,
+      0, max_shared_memory);
+}
+
+/* Perform bootstrapping on a batch of input LWE ciphertexts of 64 bits that
+ * all use the same test vector
+ *
+ * See cuda_bootstrap_amortized_shared_lut_lwe_ciphertext_vector_32
+ */
+void cuda_bootstrap_amortized_shared_lut_lwe_ciphertext_vector_64(
+    void *v_stream,
+    void *lwe_out,
+    void *lut_vector,
+    void *lwe_in,
+    void *bootstrapping_key,
+    uint32_t input_lwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t base_log,
+    uint32_t l_gadget,
+    uint32_t num_samples,
+    uint32_t max_shared_memory) {
+  cuda_bootstrap_amortized_lwe_ciphertext_vector_64(
+      v_stream, lwe_out, lut_vector, nullptr, lwe_in, bootstrapping_key,
+      input_lwe_dimension, polynomial_size, base_log, l_gadget, num_samples, 1,
+      0, max_shared_memory);
+}
+
+template <typename Torus>
+void bootstrap_amortized_batched_fft(
+    void *v_stream, void *lwe_out, void *lut_vector, void *lut_vector_indexes,
+    void *lwe_in, void *bootstrapping_key, uint32_t input_lwe_dimension,
+    uint32_t polynomial_size, uint32_t base_log, uint32_t l_gadget,
+    uint32_t num_samples, uint32_t num_lut_vectors, uint32_t lwe_idx,
+    uint32_t max_shared_memory) {
+
+  switch (polynomial_size) {
+  case 512:
+    host_bootstrap_amortized_batched_fft<Torus, Degree<512>>(
+        v_stream, (Torus *)lwe_out, (Torus *)lut_vector,
+        (uint32_t *)lut_vector_indexes, (Torus *)lwe_in,
+        (double2 *)bootstrapping_key, input_lwe_dimension, polynomial_size,
+        base_log, l_gadget, num_samples, num_lut_vectors, lwe_idx,
+        max_shared_memory);
+    break;
+  case 1024:
+    host_bootstrap_amortized_batched_fft<Torus, Degree<1024>>(
+        v_stream, (Torus *)lwe_out, (Torus *)lut_vector,
+        (uint32_t *)lut_vector_indexes, (Torus *)lwe_in,
+        (double2 *)bootstrapping_key, input_lwe_dimension, polynomial_size,
+        base_log, l_gadget, num_samples, num_lut_vectors, lwe_idx,
+        max_shared_memory);
+    break;
+  case 2048:
+    host_bootstrap_amortized_batched_fft<Torus, Degree<2048>>(
+        v_stream, (Torus *)lwe_out, (Torus *)lut_vector,
+        (uint32_t *)lut_vector_indexes, (Torus *)lwe_in,
+        (double2 *)bootstrapping_key, input_lwe_dimension, polynomial_size,
+        base_log, l_gadget, num_samples, num_lut_vectors, lwe_idx,
+        max_shared_memory);
+    break;
+  case 4096:
+    host_bootstrap_amortized_batched_fft<Torus, Degree<4096>>(
+        v_stream, (Torus *)lwe_out, (Torus *)lut_vector,
+        (uint32_t *)lut_vector_indexes, (Torus *)lwe_in,
+        (double2 *)bootstrapping_key, input_lwe_dimension, polynomial_size,
+        base_log, l_gadget, num_samples, num_lut_vectors, lwe_idx,
+        max_shared_memory);
+    break;
+  case 8192:
+    host_bootstrap_amortized_batched_fft<Torus, Degree<8192>>(
+        v_stream, (Torus *)lwe_out, (Torus *)lut_vector,
+        (uint32_t *)lut_vector_indexes, (Torus *)lwe_in,
+        (double2 *)bootstrapping_key, input_lwe_dimension, polynomial_size,
+        base_log, l_gadget, num_samples, num_lut_vectors, lwe_idx,
+        max_shared_memory);
+    break;
+  default:
+    break;
+  }
+}
+
+/* Perform bootstrapping on a batch of input LWE ciphertexts of 32 bits, with
+ * the forward FFTs of each external product batched
+ *
+ * Same arguments, layouts and results as
+ * cuda_bootstrap_amortized_lwe_ciphertext_vector_32: each block is 2D, its
+ * rows of threads decomposing and switching to the Fourier domain several
+ * of the l_gadget * 2 polynomials of an iteration at once instead of one
+ * after the other, before all the threads share the products with the
+ * GGSW. The whole accumulator state is kept in shared memory, the function
+ * falling back to cuda_bootstrap_amortized_lwe_ciphertext_vector_32 when it
+ * does not fit in max_shared_memory. The host counterpart is the batched_fft
+ * flag of the CPU amortized engine.
+ */
+void cuda_bootstrap_amortized_batched_fft_lwe_ciphertext_vector_32(
+    void *v_stream,
+    void *lwe_out,
+    void *lut_vector,
+    void *lut_vector_indexes,
+    void *lwe_in,
+    void *bootstrapping_key,
+    uint32_t input_lwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t base_log,
+    uint32_t l_gadget,
+    uint32_t num_samples,
+    uint32_t num_lut_vectors,
+    uint32_t lwe_idx,
+    uint32_t max_shared_memory) {
+  bootstrap_amortized_batched_fft<uint32_t>(
+      v_stream, lwe_out, lut_vector, lut_vector_indexes, lwe_in,
+      bootstrapping_key, input_lwe_dimension, polynomial_size, base_log,
+      l_gadget, num_samples, num_lut_vectors, lwe_idx, max_shared_memory);
+}
+
+/* Perform bootstrapping on a batch of input LWE ciphertexts of 64 bits, with
+ * the forward FFTs of each external product batched
+ *
+ * See cuda_bootstrap_amortized_batched_fft_lwe_ciphertext_vector_32
+ */
+void cuda_bootstrap_amortized_batched_fft_lwe_ciphertext_vector_64(
+    void *v_stream,
+    void *lwe_out,
+    void *lut_vector,
+    void *lut_vector_indexes,
+    void *lwe_in,
+    void *bootstrapping_key,
+    uint32_t input_lwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t base_log,
+    uint32_t l_gadget,
+    uint32_t num_samples,
+    uint32_t num_lut_vectors,
+    uint32_t lwe_idx,
+    uint32_t max_shared_memory) {
+  bootstrap_amortized_batched_fft<uint64_t>(
+      v_stream, lwe_out, lut_vector, lut_vector_indexes, lwe_in,
+      bootstrapping_key, input_lwe_dimension, polynomial_size, base_log,
+      l_gadget, num_samples, num_lut_vectors, lwe_idx, max_shared_memory);
+}
+
+template <typename Torus>
+void bootstrap_amortized_many_lut(
+    void *v_stream, void *lwe_out, void *lut_vector, void *lut_vector_indexes,
+    void *lwe_in, void *bootstrapping_key, uint32_t input_lwe_dimension,
+    uint32_t glwe_dimension, uint32_t polynomial_size, uint32_t base_log,
+    uint32_t l_gadget, uint32_t num_samples, uint32_t num_lut_vectors,
+    uint32_t lwe_idx, uint32_t lut_count, uint32_t max_shared_memory) {
+
+  if (glwe_dimension == 0 || lut_count == 0 ||
+      (lut_count & (lut_count - 1)) != 0 || lut_count > polynomial_size)
+    return;
+
+  // Switch the inputs to multiples of lut_count in [0, 2N[, the kernel takes
+  // them as already switched
+  uint16_t *lwe_in_switched;
+  checkCudaErrors(cudaMalloc((void **)&lwe_in_switched,
+                             (size_t)num_samples * (input_lwe_dimension + 1) *
+                                 sizeof(uint16_t)));
+  host_modulus_switch_lwe_ciphertext_vector<Torus>(
+      v_stream, lwe_in_switched, (Torus *)lwe_in, input_lwe_dimension,
+      polynomial_size, num_samples, lut_count);
+
+  switch (polynomial_size) {
+  case 512:
+    host_bootstrap_amortized<Torus, Degree<512>, uint16_t>(
+        v_stream, (Torus *)lwe_out, (Torus *)lut_vector,
+        (uint32_t *)lut_vector_indexes, lwe_in_switched,
+        (double2 *)bootstrapping_key, input_lwe_dimension, polynomial_size,
+        base_log, l_gadget, num_samples, num_lut_vectors, lwe_idx,
+        max_shared_memory, glwe_dimension, lut_count);
+    break;
+  case 1024:
+    host_bootstrap_amortized<Torus, Degree<1024>, uint16_t>(
+        v_stream, (Torus *)lwe_out, (Torus *)lut_vector,
+        (uint32_t *)lut_vector_indexes, lwe_in_switched,
+        (double2 *)bootstrapping_key, input_lwe_dimension, polynomial_size,
+        base_log, l_gadget, num_samples, num_lut_vectors, lwe_idx,
+        max_shared_memory, glwe_dimension, lut_count);
+    break;
+  case 2048:
+    host_bootstrap_amortized<Torus, Degree<2048>, uint16_t>(
+        v_stream, (Torus *)lwe_out, (Torus *)lut_vector,
+        (uint32_t *)lut_vector_indexes, lwe_in_switched,
+        (double2 *)bootstrapping_key, input_lwe_dimension, polynomial_size,
+        base_log, l_gadget, num_samples, num_lut_vectors, lwe_idx,
+        max_shared_memory, glwe_dimension, lut_count);
+    break;
+  case 4096:
+    host_bootstrap_amortized<Torus, Degree<4096>, uint16_t>(
+        v_stream, (Torus *)lwe_out, (Torus *)lut_vector,
+        (uint32_t *)lut_vector_indexes, lwe_in_switched,
+        (double2 *)bootstrapping_key, input_lwe_dimension, polynomial_size,
+        base_log, l_gadget, num_samples, num_lut_vectors, lwe_idx,
+        max_shared_memory, glwe_dimension, lut_count);
+    break;
+  case 8192:
+    host_bootstrap_amortized<Torus, Degree<8192>, uint16_t>(
+        v_stream, (Torus *)lwe_out, (Torus *)lut_vector,
+        (uint32_t *)lut_vector_indexes, lwe_in_switched,
+        (double2 *)bootstrapping_key, input_lwe_dimension, polynomial_size,
+        base_log, l_gadget, num_samples, num_lut_vectors, lwe_idx,
+        max_shared_memory, glwe_dimension, lut_count);
+    break;
+  default:
+    break;
+  }
+  cudaFree(lwe_in_switched);
+}
+
+/* Evaluate lut_count functions of each input LWE ciphertext of 32 bits with
+ * one blind rotation
+ *
+ * Same arguments as
+ * cuda_bootstrap_amortized_lwe_ciphertext_vector_with_glwe_dimension_32,
+ * plus:
+ *  - lut_vector: test vectors packed by cpu_pack_many_lut_test_vector_32
+ *  - lut_count: number of functions packed in each test vector, a power of
+ *    two with half a box of the test vectors spanning at least lut_count
+ *    coefficients
+ *  - lwe_out: num_samples * lut_count ciphertexts, the lut_count outputs of
+ *    each input being contiguous
+ *
+ * The inputs are first switched to multiples of lut_count in [0, 2N[ by the
+ * integer modulus switch pre-pass, then device_bootstrap_amortized extracts
+ * the lut_count first coefficients of each accumulator. The host reference
+ * is cpu_bootstrap_amortized_many_lut_lwe_ciphertext_vector_32. Nothing is
+ * done if lut_count is not a power of two or is larger than
+ * polynomial_size.
+ */
+void cuda_bootstrap_amortized_many_lut_lwe_ciphertext_vector_32(
+    void *v_stream,
+    void *lwe_out,
+    void *lut_vector,
+    void *lut_vector_indexes,
+    void *lwe_in,
+    void *bootstrapping_key,
+    uint32_t input_lwe_dimension,
+    uint32_t glwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t base_log,
+    uint32_t l_gadget,
+    uint32_t num_samples,
+    uint32_t num_lut_vectors,
+    uint32_t lwe_idx,
+    uint32_t lut_count,
+    uint32_t max_shared_memory) {
+  bootstrap_amortized_many_lut<uint32_t>(
+      v_stream, lwe_out, lut_vector, lut_vector_indexes, lwe_in,
+      bootstrapping_key, input_lwe_dimension, glwe_dimension, polynomial_size,
+      base_log, l_gadget, num_samples, num_lut_vectors, lwe_idx, lut_count,
+      max_shared_memory);
+}
+
+/* Evaluate lut_count functions of each input LWE ciphertext of 64 bits with
+ * one blind rotation
+ *
+ * See cuda_bootstrap_amortized_many_lut_lwe_ciphertext_vector_32
+ */
+void cuda_bootstrap_amortized_many_lut_lwe_ciphertext_vector_64(
+    void *v_stream,
+    void *lwe_out,
+    void *lut_vector,
+    void *lut_vector_indexes,
+    void *lwe_in,
+    void *bootstrapping_key,
+    uint32_t input_lwe_dimension,
+    uint32_t glwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t base_log,
+    uint32_t l_gadget,
+    uint32_t num_samples,
+    uint32_t num_lut_vectors,
+    uint32_t lwe_idx,
+    uint32_t lut_count,
+    uint32_t max_shared_memory) {
+  bootstrap_amortized_many_lut<uint64_t>(
+      v_stream, lwe_out, lut_vector, lut_vector_indexes, lwe_in,
+      bootstrapping_key, input_lwe_dimension, glwe_dimension, polynomial_size,
+      base_log, l_gadget, num_samples, num_lut_vectors, lwe_idx, lut_count,
+      max_shared_memory);
+}
+
+template <typename Torus, PbsOutput output>
+void bootstrap_amortized_glwe_output(
+    void *v_stream, void *glwe_out, void *lut_vector, void *lut_vector_indexes,
+    void *lwe_in, void *bootstrapping_key, uint32_t input_lwe_dimension,
+    uint32_t glwe_dimension, uint32_t polynomial_size, uint32_t base_log,
+    uint32_t l_gadget, uint32_t num_samples, uint32_t num_lut_vectors,
+    uint32_t lwe_idx, uint32_t max_shared_memory) {
+
+  if (glwe_dimension == 0)
+    return;
+
+  switch (polynomial_size) {
+  case 512:
+    host_bootstrap_amortized<Torus, Degree<512>, Torus, output>(
+        v_stream, (Torus *)glwe_out, (Torus *)lut_vector,
+        (uint32_t *)lut_vector_indexes, (Torus *)lwe_in,
+        (double2 *)bootstrapping_key, input_lwe_dimension, polynomial_size,
+        base_log, l_gadget, num_samples, num_lut_vectors, lwe_idx,
+        max_shared_memory, glwe_dimension);
+    break;
+  case 1024:
+    host_bootstrap_amortized<Torus, Degree<1024>, Torus, output>(
+        v_stream, (Torus *)glwe_out, (Torus *)lut_vector,
+        (uint32_t *)lut_vector_indexes, (Torus *)lwe_in,
+        (double2 *)bootstrapping_key, input_lwe_dimension, polynomial_size,
+        base_log, l_gadget, num_samples, num_lut_vectors, lwe_idx,
+        max_shared_memory, glwe_dimension);
+    break;
+  case 2048:
+    host_bootstrap_amortized<Torus, Degree<2048>, Torus, output>(
+        v_stream, (Torus *)glwe_out, (Torus *)lut_vector,
+        (uint32_t *)lut_vector_indexes, (Torus *)lwe_in,
+        (double2 *)bootstrapping_key, input_lwe_dimension, polynomial_size,
+        base_log, l_gadget, num_samples, num_lut_vectors, lwe_idx,
+        max_shared_memory, glwe_dimension);
+    break;
+  case 4096:
+    host_bootstrap_amortized<Torus, Degree<4096>, Torus, output>(
+        v_stream, (Torus *)glwe_out, (Torus *)lut_vector,
+        (uint32_t *)lut_vector_indexes, (Torus *)lwe_in,
+        (double2 *)bootstrapping_key, input_lwe_dimension, polynomial_size,
+        base_log, l_gadget, num_samples, num_lut_vectors, lwe_idx,
+        max_shared_memory, glwe_dimension);
+    break;
+  case 8192:
+    host_bootstrap_amortized<Torus, Degree<8192>, Torus, output>(
+        v_stream, (Torus *)glwe_out, (Torus *)lut_vector,
+        (uint32_t *)lut_vector_indexes, (Torus *)lwe_in,
+        (double2 *)bootstrapping_key, input_lwe_dimension, polynomial_size,
+        base_log, l_gadget, num_samples, num_lut_vectors, lwe_idx,
+        max_shared_memory, glwe_dimension);
+    break;
+  default:
+    break;
+  }
+}
+
+/* Perform the amortized bootstrap on a batch of input LWE ciphertexts of 32
+ * bits, writing the GLWE accumulators instead of the extracted LWE
+ * ciphertexts
+ *
+ * Same arguments as
+ * cuda_bootstrap_amortized_lwe_ciphertext_vector_with_glwe_dimension_32,
+ * with lwe_out replaced by:
+ *  - glwe_out: num_samples GLWE ciphertexts of glwe_dimension + 1
+ *    polynomials, as uint32_t coefficients if fourier_output is 0, or as
+ *    polynomial_size / 2 double2 per polynomial in the Fourier domain of
+ *    the bootstrapping keys otherwise
+ *
+ * device_bootstrap_amortized skips the sample extraction and writes the
+ * accumulator of each block, transformed as cuda_convert_lwe_bootstrap_key_32
+ * transforms the keys in the Fourier case. The host reference is
+ * cpu_bootstrap_amortized_glwe_output_lwe_ciphertext_vector_32.
+ */
+void cuda_bootstrap_amortized_glwe_output_lwe_ciphertext_vector_32(
+    void *v_stream,
+    void *glwe_out,
+    void *lut_vector,
+    void *lut_vector_indexes,
+    void *lwe_in,
+    void *bootstrapping_key,
+    uint32_t input_lwe_dimension,
+    uint32_t glwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t base_log,
+    uint32_t l_gadget,
+    uint32_t num_samples,
+    uint32_t num_lut_vectors,
+    uint32_t lwe_idx,
+    uint32_t fourier_output,
+    uint32_t max_shared_memory) {
+  if (fourier_output)
+    bootstrap_amortized_glwe_output<uint32_t, PBS_FOURIER_GLWE_OUTPUT>(
+        v_stream, glwe_out, lut_vector, lut_vector_indexes, lwe_in,
+        bootstrapping_key, input_lwe_dimension, glwe_dimension,
+        polynomial_size, base_log, l_gadget, num_samples, num_lut_vectors,
+        lwe_idx, max_shared_memory);
+  else
+    bootstrap_amortized_glwe_output<uint32_t, PBS_GLWE_OUTPUT>(
+        v_stream, glwe_out, lut_vector, lut_vector_indexes, lwe_in,
+        bootstrapping_key, input_lwe_dimension, glwe_dimension,
+        polynomial_size, base_log, l_gadget, num_samples, num_lut_vectors,
+        lwe_idx, max_shared_memory);
+}
+
+/* Perform the amortized bootstrap on a batch of input LWE ciphertexts of 64
+ * bits, writing the GLWE accumulators instead of the extracted LWE
+ * ciphertexts
+ *
+ * See cuda_bootstrap_amortized_glwe_output_lwe_ciphertext_vector_32
+ */
+void cuda_bootstrap_amortized_glwe_output_lwe_ciphertext_vector_64(
+    void *v_stream,
+    void *glwe_out,
+    void *lut_vector,
+    void *lut_vector_indexes,
+    void *lwe_in,
+    void *bootstrapping_key,
+    uint32_t input_lwe_dimension,
+    uint32_t glwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t base_log,
+    uint32_t l_gadget,
+    uint32_t num_samples,
+    uint32_t num_lut_vectors,
+    uint32_t lwe_idx,
+    uint32_t fourier_output,
+    uint32_t max_shared_memory) {
+  if (fourier_output)
+    bootstrap_amortized_glwe_output<uint64_t, PBS_FOURIER_GLWE_OUTPUT>(
+        v_stream, glwe_out, lut_vector, lut_vector_indexes, lwe_in,
+        bootstrapping_key, input_lwe_dimension, glwe_dimension,
+        polynomial_size, base_log, l_gadget, num_samples, num_lut_vectors,
+        lwe_idx, max_shared_memory);
+  else
+    bootstrap_amortized_glwe_output<uint64_t, PBS_GLWE_OUTPUT>(
+        v_stream, glwe_out, lut_vector, lut_vector_indexes, lwe_in,
+        bootstrapping_key, input_lwe_dimension, glwe_dimension,
+        polynomial_size, base_log, l_gadget, num_samples, num_lut_vectors,
+        lwe_idx, max_shared_memory);
+}
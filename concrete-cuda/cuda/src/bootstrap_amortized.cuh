@@ -24,7 +24,17 @@
 #include "utils/memory.cuh"
 #include "utils/timer.cuh"
 
-template <typename Torus, class params, sharedMemDegree SMD>
+/// What device_bootstrap_amortized writes for each ciphertext: the LWE
+/// ciphertexts extracted from the accumulator, or the accumulator itself, a
+/// GLWE ciphertext, as coefficients or in the Fourier domain of the keys
+enum PbsOutput {
+  PBS_LWE_OUTPUT = 0,
+  PBS_GLWE_OUTPUT = 1,
+  PBS_FOURIER_GLWE_OUTPUT = 2
+};
+
+template <typename Torus, class params, sharedMemDegree SMD,
+          typename InputTorus = Torus, PbsOutput output = PBS_LWE_OUTPUT>
 /*
  * Kernel launched by host_bootstrap_amortized
  *
@@ -35,21 +45,39 @@ template <typename Torus, class params, sharedMemDegree SMD>
  * as there are input ciphertexts, but actually holds
  * num_lut_vectors vectors to reduce memory usage
  *  - lut_vector_indexes: stores the index corresponding to which test vector
- * to use for each sample in lut_vector
+ * to use for each sample in lut_vector, or null when all the samples use the
+ * first test vector of lut_vector
  *  - lwe_in: input batch of num_samples LWE ciphertexts, containing n mask
- * values + 1 body value
+ * values + 1 body value. With InputTorus = uint16_t the elements are already
+ * modulus switched to [0, 2N[ (see
+ * cuda_keyswitch_modulus_switched_lwe_ciphertext_vector_64) and are used
+ * as they are
  *  - bootstrapping_key: RGSW encryption of the LWE secret key sk1 under secret
  * key sk2
  *  - device_mem: pointer to the device's global memory in case we use it (SMD
  * == NOSM or PARTIALSM)
  *  - lwe_mask_size: size of the Torus vector used to encrypt the input
  * LWE ciphertexts - referred to as n above (~ 600)
+ *  - glwe_dimension: number of mask polynomials k of the GLWE accumulator, the
+ * test vectors hold k + 1 polynomials and the output LWE ciphertexts are of
+ * dimension k * polynomial_size
  *  - polynomial_size: size of the test polynomial (test vector) and size of the
  * GLWE polynomial (~1024)
  *  - base_log: log base used for the gadget matrix - B = 2^base_log (~8)
  *  - l_gadget: number of decomposition levels in the gadget matrix (~4)
  *  - gpu_num: index of the current GPU (useful for multi-GPU computations)
  *  - lwe_idx: equal to the number of samples per gpu x gpu_num
+ *  - lut_count: number of coefficients extracted from the accumulator, the
+ * output ciphertext i of the block being the coefficient i. Above 1 the
+ * inputs are switched to multiples of lut_count (see
+ * cuda_bootstrap_amortized_many_lut_lwe_ciphertext_vector_64) and lwe_out
+ * holds lut_count ciphertexts per sample
+ *  - output: with PBS_GLWE_OUTPUT the sample extraction is skipped and
+ * lwe_out gets the (glwe_dimension + 1) * polynomial_size coefficients of
+ * the accumulator of each sample. With PBS_FOURIER_GLWE_OUTPUT, lwe_out is
+ * an array of double2 that gets each polynomial of the accumulator
+ * transformed as the bootstrapping key is, polynomial_size / 2 complex
+ * numbers per polynomial
  *  - device_memory_size_per_sample: amount of global memory to allocate if SMD
  * is not FULLSM
  */
@@ -57,14 +85,16 @@ __global__ void device_bootstrap_amortized(
     Torus *lwe_out,
     Torus *lut_vector,
     uint32_t *lut_vector_indexes,
-    Torus *lwe_in,
+    InputTorus *lwe_in,
     double2 *bootstrapping_key,
     char *device_mem,
     uint32_t lwe_mask_size,
+    uint32_t glwe_dimension,
     uint32_t polynomial_size,
     uint32_t base_log,
     uint32_t l_gadget,
     uint32_t lwe_idx,
+    uint32_t lut_count,
     size_t device_memory_size_per_sample) {
   // We use shared memory for the polynomials that are used often during the
   // bootstrap, since shared memory is kept in L1 cache and accessing it is
@@ -77,49 +107,47 @@ __global__ void device_bootstrap_amortized(
   else
     selected_memory = &device_mem[blockIdx.x * device_memory_size_per_sample];
 
-  // For GPU bootstrapping the RLWE dimension is hard-set to 1: there is only
-  // one mask polynomial and 1 body to handle Also, since the decomposed
-  // polynomials take coefficients between -B/2 and B/2 they can be represented
-  // with only 16 bits, assuming the base log does not exceed 2^16
-  int16_t *accumulator_mask_decomposed = (int16_t *)selected_memory;
-  int16_t *accumulator_body_decomposed =
-      (int16_t *)accumulator_mask_decomposed + polynomial_size;
-  Torus *accumulator_mask = (Torus *)accumulator_body_decomposed +
-                            polynomial_size / (sizeof(Torus) / sizeof(int16_t));
-  Torus *accumulator_body =
-      (Torus *)accumulator_mask + (ptrdiff_t)polynomial_size;
-  Torus *accumulator_mask_rotated =
-      (Torus *)accumulator_body + (ptrdiff_t)polynomial_size;
-  Torus *accumulator_body_rotated =
-      (Torus *)accumulator_mask_rotated + (ptrdiff_t)polynomial_size;
-  double2 *mask_res_fft = (double2 *)accumulator_body_rotated +
-                          polynomial_size / (sizeof(double2) / sizeof(Torus));
-  double2 *body_res_fft =
-      (double2 *)mask_res_fft + (ptrdiff_t)polynomial_size / 2;
+  // The accumulator holds k mask polynomials followed by the body, the
+  // rotated accumulator and the products in the Fourier domain have the same
+  // layout. Since the decomposed polynomials take coefficients between -B/2
+  // and B/2 they can be represented with only 16 bits, assuming the base log
+  // does not exceed 2^16
+  int16_t *accumulator_decomposed = (int16_t *)selected_memory;
+  Torus *accumulator = (Torus *)accumulator_decomposed +
+                       polynomial_size / (sizeof(Torus) / sizeof(int16_t));
+  Torus *accumulator_rotated =
+      (Torus *)accumulator + (ptrdiff_t)(glwe_dimension + 1) * polynomial_size;
+  double2 *res_fft =
+      (double2 *)accumulator_rotated +
+      (glwe_dimension + 1) * polynomial_size /
+          (sizeof(double2) / sizeof(Torus));
   double2 *accumulator_fft = (double2 *)sharedmem;
   if constexpr (SMD != PARTIALSM)
-    accumulator_fft =
-        (double2 *)body_res_fft + (ptrdiff_t)(polynomial_size / 2);
+    accumulator_fft = (double2 *)res_fft +
+                      (ptrdiff_t)(glwe_dimension + 1) * polynomial_size / 2;
 
   auto block_lwe_in = &lwe_in[blockIdx.x * (lwe_mask_size + 1)];
+  // Without index array all the blocks share the first test vector, which
+  // stays in L2 for the whole batch
   Torus *block_lut_vector =
-      &lut_vector[lut_vector_indexes[lwe_idx + blockIdx.x] * params::degree * 2];
+      lut_vector_indexes == nullptr
+          ? lut_vector
+          : &lut_vector[lut_vector_indexes[lwe_idx + blockIdx.x] *
+                        params::degree * (glwe_dimension + 1)];
 
 
   GadgetMatrix<Torus, params> gadget(base_log, l_gadget);
 
   // Put "b", the body, in [0, 2N[
-  Torus b_hat = rescale_torus_element(
+  Torus b_hat = rescale_input_element<Torus>(
       block_lwe_in[lwe_mask_size],
       2 * params::degree); // 2 * params::log2_degree + 1);
 
-  divide_by_monomial_negacyclic_inplace<Torus, params::opt,
-      params::degree / params::opt>(
-      accumulator_mask, block_lut_vector, b_hat, false);
-
-  divide_by_monomial_negacyclic_inplace<Torus, params::opt,
-      params::degree / params::opt>(
-      accumulator_body, &block_lut_vector[params::degree], b_hat, false);
+  for (int c = 0; c <= glwe_dimension; c++)
+    divide_by_monomial_negacyclic_inplace<Torus, params::opt,
+        params::degree / params::opt>(
+        &accumulator[c * params::degree],
+        &block_lut_vector[c * params::degree], b_hat, false);
 
   // Loop over all the mask elements of the sample to accumulate
   // (X^a_i-1) multiplication, decomposition of the resulting polynomial
@@ -129,187 +157,207 @@ __global__ void device_bootstrap_amortized(
     synchronize_threads_in_block();
 
     // Put "a" in [0, 2N[ instead of Zq
-    Torus a_hat = rescale_torus_element(
+    Torus a_hat = rescale_input_element<Torus>(
         block_lwe_in[iteration],
         2 * params::degree); // 2 * params::log2_degree + 1);
 
     // Perform ACC * (X^ä - 1)
-    multiply_by_monomial_negacyclic_and_sub_polynomial<
-        Torus, params::opt, params::degree / params::opt>(
-        accumulator_mask, accumulator_mask_rotated, a_hat);
-
-    multiply_by_monomial_negacyclic_and_sub_polynomial<
-        Torus, params::opt, params::degree / params::opt>(
-        accumulator_body, accumulator_body_rotated, a_hat);
+    for (int c = 0; c <= glwe_dimension; c++)
+      multiply_by_monomial_negacyclic_and_sub_polynomial<
+          Torus, params::opt, params::degree / params::opt>(
+          &accumulator[c * params::degree],
+          &accumulator_rotated[c * params::degree], a_hat);
 
     synchronize_threads_in_block();
 
     // Perform a rounding to increase the accuracy of the
     // bootstrapped ciphertext
-    round_to_closest_multiple_inplace<Torus, params::opt,
-        params::degree / params::opt>(
-        accumulator_mask_rotated, base_log, l_gadget);
+    for (int c = 0; c <= glwe_dimension; c++)
+      round_to_closest_multiple_inplace<Torus, params::opt,
+          params::degree / params::opt>(
+          &accumulator_rotated[c * params::degree], base_log, l_gadget);
 
-    round_to_closest_multiple_inplace<Torus, params::opt,
-        params::degree / params::opt>(
-        accumulator_body_rotated, base_log, l_gadget);
     // Initialize the polynomial multiplication via FFT arrays
     // The polynomial multiplications happens at the block level
     // and each thread handles two or more coefficients
-    int pos = threadIdx.x;
-    for (int j = 0; j < params::opt / 2; j++) {
-      mask_res_fft[pos].x = 0;
-      mask_res_fft[pos].y = 0;
-      body_res_fft[pos].x = 0;
-      body_res_fft[pos].y = 0;
-      pos += params::degree / params::opt;
+    for (int c = 0; c <= glwe_dimension; c++) {
+      int pos = threadIdx.x;
+      for (int j = 0; j < params::opt / 2; j++) {
+        res_fft[c * params::degree / 2 + pos].x = 0;
+        res_fft[c * params::degree / 2 + pos].y = 0;
+        pos += params::degree / params::opt;
+      }
     }
 
-    // Now that the rotation is done, decompose the resulting polynomial
+    // Now that the rotation is done, decompose the resulting polynomials
     // coefficients so as to multiply each decomposed level with the
-    // corresponding part of the bootstrapping key
+    // corresponding part of the bootstrapping key: the polynomial k of the
+    // accumulator is multiplied with the row k of the GGSW, whose column c
+    // accumulates into the polynomial c of the result
     for (int decomp_level = 0; decomp_level < l_gadget; decomp_level++) {
+      for (int k = 0; k <= glwe_dimension; k++) {
+        synchronize_threads_in_block();
+        gadget.decompose_one_level(accumulator_decomposed,
+                                   &accumulator_rotated[k * params::degree],
+                                   decomp_level);
+        synchronize_threads_in_block();
+
+        // Reduce the size of the FFT to be performed by storing
+        // the real-valued polynomial into a complex polynomial
+        real_to_complex_compressed<int16_t, params>(accumulator_decomposed,
+                                                    accumulator_fft);
+
+        synchronize_threads_in_block();
+        // Switch to the FFT space
+        NSMFFT_direct<HalfDegree<params>>(accumulator_fft);
+        synchronize_threads_in_block();
+
+        correction_direct_fft_inplace<params>(accumulator_fft);
+        synchronize_threads_in_block();
+
+        // Get the bootstrapping key pieces necessary for the multiplication
+        // They are already in the Fourier domain, and perform the
+        // coefficient-wise product with each of them
+        double2 *bsk_row = get_ith_mask_kth_block(
+            bootstrapping_key, iteration, k, decomp_level, polynomial_size,
+            glwe_dimension, l_gadget);
+        for (int c = 0; c <= glwe_dimension; c++) {
+          auto bsk_slice = PolynomialFourier<double2, params>(
+              &bsk_row[c * params::degree / 2]);
+          polynomial_product_accumulate_in_fourier_domain(
+              &res_fft[c * params::degree / 2], accumulator_fft, bsk_slice);
+        }
+      }
+    }
 
-      gadget.decompose_one_level(accumulator_mask_decomposed,
-                                 accumulator_mask_rotated, decomp_level);
-
-      gadget.decompose_one_level(accumulator_body_decomposed,
-                                 accumulator_body_rotated, decomp_level);
-
+    // Come back to the coefficient representation
+    if constexpr (SMD == FULLSM || SMD == NOSM) {
       synchronize_threads_in_block();
 
-      // First, perform the polynomial multiplication for the mask
-
-      // Reduce the size of the FFT to be performed by storing
-      // the real-valued polynomial into a complex polynomial
-      real_to_complex_compressed<int16_t, params>(accumulator_mask_decomposed,
-                                                  accumulator_fft);
-
+      for (int c = 0; c <= glwe_dimension; c++)
+        correction_inverse_fft_inplace<params>(
+            &res_fft[c * params::degree / 2]);
       synchronize_threads_in_block();
-      // Switch to the FFT space
-      NSMFFT_direct<HalfDegree<params>>(accumulator_fft);
-      synchronize_threads_in_block();
-
-      correction_direct_fft_inplace<params>(accumulator_fft);
 
-      // Get the bootstrapping key piece necessary for the multiplication
-      // It is already in the Fourier domain
-      auto bsk_mask_slice = PolynomialFourier<double2, params>(
-          get_ith_mask_kth_block(
-              bootstrapping_key, iteration, 0, decomp_level,
-              polynomial_size, 1, l_gadget));
-      auto bsk_body_slice = PolynomialFourier<double2, params>(
-          get_ith_body_kth_block(
-              bootstrapping_key, iteration, 0, decomp_level,
-              polynomial_size, 1, l_gadget));
+      for (int c = 0; c <= glwe_dimension; c++)
+        NSMFFT_inverse<HalfDegree<params>>(&res_fft[c * params::degree / 2]);
 
       synchronize_threads_in_block();
 
-      // Perform the coefficient-wise product with the two pieces of
-      // bootstrapping key
-      polynomial_product_accumulate_in_fourier_domain(
-          mask_res_fft, accumulator_fft, bsk_mask_slice);
-      polynomial_product_accumulate_in_fourier_domain(
-          body_res_fft, accumulator_fft, bsk_body_slice);
-
-      synchronize_threads_in_block();
-
-      // Now handle the polynomial multiplication for the body
-      // in the same way
-      real_to_complex_compressed<int16_t, params>(accumulator_body_decomposed,
-                                                  accumulator_fft);
-      synchronize_threads_in_block();
-
-      NSMFFT_direct<HalfDegree<params>>(accumulator_fft);
+      for (int c = 0; c <= glwe_dimension; c++)
+        add_to_torus<Torus, params>(&res_fft[c * params::degree / 2],
+                                    &accumulator[c * params::degree]);
       synchronize_threads_in_block();
+    } else {
+      for (int c = 0; c <= glwe_dimension; c++) {
+        synchronize_threads_in_block();
+        int tid = threadIdx.x;
+#pragma unroll
+        for (int i = 0; i < params::opt / 2; i++) {
+          accumulator_fft[tid] = res_fft[c * params::degree / 2 + tid];
+          tid = tid + params::degree / params::opt;
+        }
+        synchronize_threads_in_block();
 
-      correction_direct_fft_inplace<params>(accumulator_fft);
+        correction_inverse_fft_inplace<params>(accumulator_fft);
+        synchronize_threads_in_block();
 
-      auto bsk_mask_slice_2 = PolynomialFourier<double2, params>(
-          get_ith_mask_kth_block(bootstrapping_key, iteration, 1, decomp_level,
-                                 polynomial_size, 1, l_gadget));
-      auto bsk_body_slice_2 = PolynomialFourier<double2, params>(
-          get_ith_body_kth_block(bootstrapping_key, iteration, 1, decomp_level,
-                                     polynomial_size, 1, l_gadget));
+        NSMFFT_inverse<HalfDegree<params>>(accumulator_fft);
+        synchronize_threads_in_block();
 
+        add_to_torus<Torus, params>(accumulator_fft,
+                                    &accumulator[c * params::degree]);
+      }
       synchronize_threads_in_block();
-
-      polynomial_product_accumulate_in_fourier_domain(
-          mask_res_fft, accumulator_fft, bsk_mask_slice_2);
-      polynomial_product_accumulate_in_fourier_domain(
-          body_res_fft, accumulator_fft, bsk_body_slice_2);
     }
+  }
 
-    // Come back to the coefficient representation
-    if constexpr (SMD == FULLSM || SMD == NOSM) {
-      synchronize_threads_in_block();
-
-      correction_inverse_fft_inplace<params>(mask_res_fft);
-      correction_inverse_fft_inplace<params>(body_res_fft);
-      synchronize_threads_in_block();
-
-      NSMFFT_inverse<HalfDegree<params>>(mask_res_fft);
-      NSMFFT_inverse<HalfDegree<params>>(body_res_fft);
-
-      synchronize_threads_in_block();
-
-      add_to_torus<Torus, params>(mask_res_fft, accumulator_mask);
-      add_to_torus<Torus, params>(body_res_fft, accumulator_body);
-      synchronize_threads_in_block();
-    } else {
+  // The blind rotation for this block is over
+  if constexpr (output == PBS_GLWE_OUTPUT) {
+    auto block_glwe_out =
+        &lwe_out[(size_t)blockIdx.x * (glwe_dimension + 1) * params::degree];
+    for (int c = 0; c <= glwe_dimension; c++) {
       int tid = threadIdx.x;
-#pragma unroll
-      for (int i = 0; i < params::opt / 2; i++) {
-        accumulator_fft[tid] = mask_res_fft[tid];
-        tid = tid + params::degree / params::opt;
+      for (int i = 0; i < params::opt; i++) {
+        block_glwe_out[c * params::degree + tid] =
+            accumulator[c * params::degree + tid];
+        tid += params::degree / params::opt;
       }
+    }
+    return;
+  } else if constexpr (output == PBS_FOURIER_GLWE_OUTPUT) {
+    // Each polynomial goes through the conversion of the bootstrapping key,
+    // so that the output is ready for a product with a converted key
+    auto block_glwe_out =
+        &((double2 *)lwe_out)[(size_t)blockIdx.x * (glwe_dimension + 1) *
+                              params::degree / 2];
+    for (int c = 0; c <= glwe_dimension; c++) {
       synchronize_threads_in_block();
-
-      correction_inverse_fft_inplace<params>(accumulator_fft);
+      real_to_complex_compressed<Torus, std::make_signed_t<Torus>, params>(
+          &accumulator[c * params::degree], accumulator_fft);
       synchronize_threads_in_block();
-
-      NSMFFT_inverse<HalfDegree<params>>(accumulator_fft);
+      NSMFFT_direct<HalfDegree<params>>(accumulator_fft);
       synchronize_threads_in_block();
-
-      add_to_torus<Torus, params>(accumulator_fft, accumulator_mask);
+      correction_direct_fft_inplace<params>(accumulator_fft);
       synchronize_threads_in_block();
 
-      tid = threadIdx.x;
-#pragma unroll
+      int tid = threadIdx.x;
       for (int i = 0; i < params::opt / 2; i++) {
-        accumulator_fft[tid] = body_res_fft[tid];
-        tid = tid + params::degree / params::opt;
+        block_glwe_out[c * params::degree / 2 + tid] = accumulator_fft[tid];
+        tid += params::degree / params::opt;
       }
-      synchronize_threads_in_block();
-
-      correction_inverse_fft_inplace<params>(accumulator_fft);
-      synchronize_threads_in_block();
+    }
+    return;
+  }
 
-      NSMFFT_inverse<HalfDegree<params>>(accumulator_fft);
+  // Now we can perform the sample extraction: for the body it's just
+  // the resulting constant coefficient of the accumulator
+  // For the mask it's more complicated, each mask polynomial gives
+  // polynomial_size elements of the LWE mask
+  for (int i = 0; i < lut_count; i++) {
+    auto block_lwe_out =
+        &lwe_out[((size_t)blockIdx.x * lut_count + i) *
+                 (glwe_dimension * polynomial_size + 1)];
+
+    // The extraction negates the masks in place, so the coefficient i is
+    // brought to the constant coefficient of a copy of the accumulator,
+    // the rotated accumulator being free after the blind rotation
+    Torus *extracted = accumulator;
+    if (lut_count > 1) {
+      for (int c = 0; c <= glwe_dimension; c++)
+        divide_by_monomial_negacyclic_inplace<Torus, params::opt,
+            params::degree / params::opt>(
+            &accumulator_rotated[c * params::degree],
+            &accumulator[c * params::degree], i, false);
       synchronize_threads_in_block();
+      extracted = accumulator_rotated;
+    }
 
-      add_to_torus<Torus, params>(accumulator_fft, accumulator_body);
+    for (int c = 0; c < glwe_dimension; c++) {
+      sample_extract_mask<Torus, params>(&block_lwe_out[c * params::degree],
+                                         &extracted[c * params::degree]);
       synchronize_threads_in_block();
     }
+    sample_extract_body<Torus, params>(
+        &block_lwe_out[(glwe_dimension - 1) * params::degree],
+        &extracted[glwe_dimension * params::degree]);
+    synchronize_threads_in_block();
   }
-
-  auto block_lwe_out = &lwe_out[blockIdx.x * (polynomial_size + 1)];
-
-  // The blind rotation for this block is over
-  // Now we can perform the sample extraction: for the body it's just
-  // the resulting constant coefficient of the accumulator
-  // For the mask it's more complicated
-  sample_extract_mask<Torus, params>(block_lwe_out, accumulator_mask);
-  sample_extract_body<Torus, params>(block_lwe_out, accumulator_body);
 }
 
-template <typename Torus, class params>
+/*
+ * Host wrapper to the amortized bootstrap, one block per ciphertext. With
+ * output other than PBS_LWE_OUTPUT, lwe_out receives the accumulators of
+ * the ciphertexts instead (see device_bootstrap_amortized).
+ */
+template <typename Torus, class params, typename InputTorus = Torus,
+          PbsOutput output = PBS_LWE_OUTPUT>
 __host__ void host_bootstrap_amortized(
     void *v_stream,
     Torus *lwe_out,
     Torus *lut_vector,
     uint32_t *lut_vector_indexes,
-    Torus *lwe_in,
+    InputTorus *lwe_in,
     double2 *bootstrapping_key,
     uint32_t input_lwe_dimension,
     uint32_t polynomial_size,
@@ -318,17 +366,38 @@ __host__ void host_bootstrap_amortized(
     uint32_t input_lwe_ciphertext_count,
     uint32_t num_lut_vectors,
     uint32_t lwe_idx,
-    uint32_t max_shared_memory) {
-
-  int SM_FULL = sizeof(Torus) * polynomial_size +   // accumulator mask
-                sizeof(Torus) * polynomial_size +   // accumulator body
-                sizeof(Torus) * polynomial_size +   // accumulator mask rotated
-                sizeof(Torus) * polynomial_size +   // accumulator body rotated
-                sizeof(int16_t) * polynomial_size + // accumulator_dec mask
-                sizeof(int16_t) * polynomial_size + // accumulator_dec_body
-                sizeof(double2) * polynomial_size / 2 + // accumulator fft mask
-                sizeof(double2) * polynomial_size / 2 + // accumulator fft body
-                sizeof(double2) * polynomial_size / 2;  // calculate buffer fft
+    uint32_t max_shared_memory,
+    uint32_t glwe_dimension = 1,
+    uint32_t lut_count = 1) {
+
+  // Inputs of the Torus type go through the integer modulus switch pre-pass
+  // first, so that the blind rotation loop reads 16 bits monomial degrees
+  if constexpr (!std::is_same<InputTorus, uint16_t>::value) {
+    uint16_t *lwe_in_switched;
+    checkCudaErrors(cudaMalloc((void **)&lwe_in_switched,
+                               (size_t)input_lwe_ciphertext_count *
+                                   (input_lwe_dimension + 1) *
+                                   sizeof(uint16_t)));
+    host_modulus_switch_lwe_ciphertext_vector<Torus>(
+        v_stream, lwe_in_switched, lwe_in, input_lwe_dimension,
+        polynomial_size, input_lwe_ciphertext_count, lut_count);
+    host_bootstrap_amortized<Torus, params, uint16_t, output>(
+        v_stream, lwe_out, lut_vector, lut_vector_indexes, lwe_in_switched,
+        bootstrapping_key, input_lwe_dimension, polynomial_size, base_log,
+        l_gadget, input_lwe_ciphertext_count, num_lut_vectors, lwe_idx,
+        max_shared_memory, glwe_dimension, lut_count);
+    cudaFree(lwe_in_switched);
+    return;
+  }
+
+  int SM_FULL =
+      sizeof(Torus) * polynomial_size * (glwe_dimension + 1) + // accumulator
+      sizeof(Torus) * polynomial_size *
+          (glwe_dimension + 1) +          // accumulator rotated
+      sizeof(int16_t) * polynomial_size + // accumulator_dec
+      sizeof(double2) * polynomial_size / 2 *
+          (glwe_dimension + 1) +              // accumulator fft
+      sizeof(double2) * polynomial_size / 2; // calculate buffer fft
 
   int SM_PART = sizeof(double2) * polynomial_size / 2; // calculate buffer fft
 
@@ -355,26 +424,26 @@ __host__ void host_bootstrap_amortized(
   // of shared memory)
   if (max_shared_memory < SM_PART) {
     checkCudaErrors(cudaMalloc((void **)&d_mem, DM_FULL * input_lwe_ciphertext_count));
-    device_bootstrap_amortized<Torus, params, NOSM>
+    device_bootstrap_amortized<Torus, params, NOSM, InputTorus, output>
     <<<grid, thds, 0, *stream>>>(
         lwe_out, lut_vector, lut_vector_indexes, lwe_in,
         bootstrapping_key, d_mem,
-        input_lwe_dimension, polynomial_size,
-        base_log, l_gadget, lwe_idx, DM_FULL);
+        input_lwe_dimension, glwe_dimension, polynomial_size,
+        base_log, l_gadget, lwe_idx, lut_count, DM_FULL);
   } else if (max_shared_memory < SM_FULL) {
-    cudaFuncSetAttribute(device_bootstrap_amortized<Torus, params, PARTIALSM>,
+    cudaFuncSetAttribute(device_bootstrap_amortized<Torus, params, PARTIALSM, InputTorus, output>,
                          cudaFuncAttributeMaxDynamicSharedMemorySize,
                          SM_PART);
     cudaFuncSetCacheConfig(
-        device_bootstrap_amortized<Torus, params, PARTIALSM>,
+        device_bootstrap_amortized<Torus, params, PARTIALSM, InputTorus, output>,
         cudaFuncCachePreferShared);
     checkCudaErrors(cudaMalloc((void **)&d_mem, DM_PART * input_lwe_ciphertext_count));
-    device_bootstrap_amortized<Torus, params, PARTIALSM>
+    device_bootstrap_amortized<Torus, params, PARTIALSM, InputTorus, output>
     <<<grid, thds, SM_PART, *stream>>>(
         lwe_out, lut_vector, lut_vector_indexes,
         lwe_in, bootstrapping_key,
-        d_mem, input_lwe_dimension, polynomial_size,
-        base_log, l_gadget, lwe_idx,
+        d_mem, input_lwe_dimension, glwe_dimension, polynomial_size,
+        base_log, l_gadget, lwe_idx, lut_count,
         DM_PART);
   } else {
     // For devices with compute capability 7.x a single thread block can
@@ -383,20 +452,20 @@ __host__ void host_bootstrap_amortized(
     // For lower compute capabilities, this call
     // just does nothing and the amount of shared memory used is 48 KB
     checkCudaErrors(cudaFuncSetAttribute(
-        device_bootstrap_amortized<Torus, params, FULLSM>,
+        device_bootstrap_amortized<Torus, params, FULLSM, InputTorus, output>,
         cudaFuncAttributeMaxDynamicSharedMemorySize,
         SM_FULL));
     checkCudaErrors(cudaFuncSetCacheConfig(
-        device_bootstrap_amortized<Torus, params, FULLSM>,
+        device_bootstrap_amortized<Torus, params, FULLSM, InputTorus, output>,
         cudaFuncCachePreferShared));
     checkCudaErrors(cudaMalloc((void **)&d_mem, 0));
 
-    device_bootstrap_amortized<Torus, params, FULLSM>
+    device_bootstrap_amortized<Torus, params, FULLSM, InputTorus, output>
     <<<grid, thds, SM_FULL, *stream>>>(
         lwe_out, lut_vector, lut_vector_indexes,
         lwe_in, bootstrapping_key,
-        d_mem, input_lwe_dimension, polynomial_size,
-        base_log, l_gadget, lwe_idx,
+        d_mem, input_lwe_dimension, glwe_dimension, polynomial_size,
+        base_log, l_gadget, lwe_idx, lut_count,
         0);
   }
   // Synchronize the streams before copying the result to lwe_out at the right
@@ -406,6 +475,243 @@ __host__ void host_bootstrap_amortized(
 
 }
 
+/*
+ * Variant of device_bootstrap_amortized with the forward FFTs of each
+ * external product batched, launched by host_bootstrap_amortized_batched_fft
+ * with the same arguments, the inputs being already modulus switched
+ *
+ * The block is 2D: threadIdx.y selects the decomposed polynomial p, the
+ * level p / (glwe_dimension + 1) of the polynomial p % (glwe_dimension + 1)
+ * of the rotated accumulator. blockDim.y divides the (glwe_dimension + 1) *
+ * l_gadget polynomials of an iteration, which are decomposed and switched to
+ * the Fourier domain blockDim.y at a time, each in its slot of join_fft,
+ * instead of one after the other. The products with the GGSW are then
+ * spread over all the threads of the block, each frequency of each column
+ * summing the slots in the order of device_bootstrap_amortized, and the
+ * glwe_dimension + 1 columns are switched back blockDim.y at a time.
+ *
+ * Every thread of the block goes through the barriers of the FFTs: the
+ * slices without a column to switch back transform their free join slot.
+ * The whole state lives in shared memory.
+ */
+template <typename Torus, class params>
+__global__ void device_bootstrap_amortized_batched_fft(
+    Torus *lwe_out,
+    Torus *lut_vector,
+    uint32_t *lut_vector_indexes,
+    uint16_t *lwe_in,
+    double2 *bootstrapping_key,
+    uint32_t lwe_mask_size,
+    uint32_t glwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t base_log,
+    uint32_t l_gadget,
+    uint32_t lwe_idx) {
+  extern __shared__ char sharedmem[];
+
+  uint32_t num_polynomials = (glwe_dimension + 1) * l_gadget;
+  uint32_t slice = threadIdx.y;
+  double2 *join_fft = (double2 *)sharedmem;
+  double2 *res_fft = join_fft + (ptrdiff_t)num_polynomials * params::degree / 2;
+  Torus *accumulator =
+      (Torus *)(res_fft + (ptrdiff_t)(glwe_dimension + 1) * params::degree / 2);
+  Torus *accumulator_rotated =
+      accumulator + (ptrdiff_t)(glwe_dimension + 1) * params::degree;
+  int16_t *slice_decomposed =
+      (int16_t *)(accumulator_rotated +
+                  (ptrdiff_t)(glwe_dimension + 1) * params::degree) +
+      slice * params::degree;
+
+  auto block_lwe_in = &lwe_in[blockIdx.x * (lwe_mask_size + 1)];
+  Torus *block_lut_vector =
+      lut_vector_indexes == nullptr
+          ? lut_vector
+          : &lut_vector[lut_vector_indexes[lwe_idx + blockIdx.x] *
+                        params::degree * (glwe_dimension + 1)];
+
+  GadgetMatrix<Torus, params> gadget(base_log, l_gadget);
+
+  Torus b_hat = block_lwe_in[lwe_mask_size];
+  for (int c = slice; c <= glwe_dimension; c += blockDim.y)
+    divide_by_monomial_negacyclic_inplace<Torus, params::opt,
+        params::degree / params::opt>(
+        &accumulator[c * params::degree],
+        &block_lut_vector[c * params::degree], b_hat, false);
+
+  for (int iteration = 0; iteration < lwe_mask_size; iteration++) {
+    synchronize_threads_in_block();
+
+    Torus a_hat = block_lwe_in[iteration];
+
+    // Perform ACC * (X^ä - 1) and the rounding, one polynomial per slice
+    for (int c = slice; c <= glwe_dimension; c += blockDim.y) {
+      multiply_by_monomial_negacyclic_and_sub_polynomial<
+          Torus, params::opt, params::degree / params::opt>(
+          &accumulator[c * params::degree],
+          &accumulator_rotated[c * params::degree], a_hat);
+      round_to_closest_multiple_inplace<Torus, params::opt,
+          params::degree / params::opt>(
+          &accumulator_rotated[c * params::degree], base_log, l_gadget);
+    }
+
+    // Decompose and switch to the Fourier domain blockDim.y polynomials at
+    // a time
+    for (int first = 0; first < num_polynomials; first += blockDim.y) {
+      int p = first + slice;
+      double2 *slot = &join_fft[p * params::degree / 2];
+      synchronize_threads_in_block();
+      gadget.decompose_one_level(
+          slice_decomposed,
+          &accumulator_rotated[(p % (glwe_dimension + 1)) * params::degree],
+          p / (glwe_dimension + 1));
+      synchronize_threads_in_block();
+      real_to_complex_compressed<int16_t, params>(slice_decomposed, slot);
+      synchronize_threads_in_block();
+      NSMFFT_direct<HalfDegree<params>>(slot);
+      synchronize_threads_in_block();
+      correction_direct_fft_inplace<params>(slot);
+    }
+    synchronize_threads_in_block();
+
+    // Products with the GGSW over all the threads of the block, frequency
+    // by frequency
+    int num_threads = blockDim.x * blockDim.y;
+    for (int i = threadIdx.y * blockDim.x + threadIdx.x;
+         i < (glwe_dimension + 1) * params::degree / 2; i += num_threads) {
+      int c = i / (params::degree / 2);
+      int j = i % (params::degree / 2);
+      double2 sum = {0., 0.};
+      for (int p = 0; p < num_polynomials; p++) {
+        double2 *bsk_row = get_ith_mask_kth_block(
+            bootstrapping_key, iteration, p % (glwe_dimension + 1),
+            p / (glwe_dimension + 1), polynomial_size, glwe_dimension,
+            l_gadget);
+        sum += join_fft[p * params::degree / 2 + j] *
+               bsk_row[c * params::degree / 2 + j];
+      }
+      res_fft[i] = sum;
+    }
+
+    // Come back to the coefficient representation blockDim.y columns at a
+    // time
+    for (int first = 0; first <= glwe_dimension; first += blockDim.y) {
+      int c = first + slice;
+      double2 *column_fft = c <= glwe_dimension
+                                ? &res_fft[c * params::degree / 2]
+                                : &join_fft[slice * params::degree / 2];
+      synchronize_threads_in_block();
+      correction_inverse_fft_inplace<params>(column_fft);
+      synchronize_threads_in_block();
+      NSMFFT_inverse<HalfDegree<params>>(column_fft);
+      synchronize_threads_in_block();
+      if (c <= glwe_dimension)
+        add_to_torus<Torus, params>(column_fft,
+                                    &accumulator[c * params::degree]);
+    }
+  }
+  synchronize_threads_in_block();
+
+  // Sample extraction without block-wide barriers: the mask coefficient i of
+  // the polynomial c is the coefficient 0 for i = 0 and minus the
+  // coefficient N - i otherwise, the body is the constant coefficient of the
+  // last polynomial
+  auto block_lwe_out =
+      &lwe_out[blockIdx.x * (glwe_dimension * polynomial_size + 1)];
+  int num_threads = blockDim.x * blockDim.y;
+  for (int i = threadIdx.y * blockDim.x + threadIdx.x;
+       i < glwe_dimension * params::degree; i += num_threads) {
+    int c = i / params::degree;
+    int coefficient = i % params::degree;
+    block_lwe_out[i] =
+        coefficient == 0
+            ? accumulator[c * params::degree]
+            : -accumulator[c * params::degree + params::degree - coefficient];
+  }
+  if (threadIdx.x == 0 && threadIdx.y == 0)
+    block_lwe_out[glwe_dimension * params::degree] =
+        accumulator[glwe_dimension * params::degree];
+}
+
+/*
+ * Host wrapper of device_bootstrap_amortized_batched_fft, same arguments as
+ * host_bootstrap_amortized
+ *
+ * The inputs go through the integer modulus switch pre-pass. blockDim.y is
+ * the largest divisor of the (glwe_dimension + 1) * l_gadget decomposed
+ * polynomials that keeps the block within 1024 threads. When the shared
+ * memory of the device cannot hold the join buffer of all the polynomials,
+ * the batch goes through host_bootstrap_amortized instead.
+ */
+template <typename Torus, class params>
+__host__ void host_bootstrap_amortized_batched_fft(
+    void *v_stream,
+    Torus *lwe_out,
+    Torus *lut_vector,
+    uint32_t *lut_vector_indexes,
+    Torus *lwe_in,
+    double2 *bootstrapping_key,
+    uint32_t input_lwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t base_log,
+    uint32_t l_gadget,
+    uint32_t input_lwe_ciphertext_count,
+    uint32_t num_lut_vectors,
+    uint32_t lwe_idx,
+    uint32_t max_shared_memory,
+    uint32_t glwe_dimension = 1) {
+  uint32_t num_polynomials = (glwe_dimension + 1) * l_gadget;
+  uint32_t threads_per_slice = polynomial_size / params::opt;
+  uint32_t slices = 1;
+  for (uint32_t d = 1; d <= num_polynomials; d++)
+    if (num_polynomials % d == 0 && d * threads_per_slice <= 1024)
+      slices = d;
+
+  int SM_BATCHED =
+      sizeof(double2) * polynomial_size / 2 * num_polynomials + // join fft
+      sizeof(double2) * polynomial_size / 2 *
+          (glwe_dimension + 1) + // accumulator fft
+      sizeof(Torus) * polynomial_size * (glwe_dimension + 1) * 2 + // acc, rot
+      sizeof(int16_t) * polynomial_size * slices; // accumulator_dec
+
+  if (max_shared_memory < SM_BATCHED) {
+    host_bootstrap_amortized<Torus, params>(
+        v_stream, lwe_out, lut_vector, lut_vector_indexes, lwe_in,
+        bootstrapping_key, input_lwe_dimension, polynomial_size, base_log,
+        l_gadget, input_lwe_ciphertext_count, num_lut_vectors, lwe_idx,
+        max_shared_memory, glwe_dimension);
+    return;
+  }
+
+  auto stream = static_cast<cudaStream_t *>(v_stream);
+  uint16_t *lwe_in_switched;
+  checkCudaErrors(cudaMalloc((void **)&lwe_in_switched,
+                             (size_t)input_lwe_ciphertext_count *
+                                 (input_lwe_dimension + 1) *
+                                 sizeof(uint16_t)));
+  host_modulus_switch_lwe_ciphertext_vector<Torus>(
+      v_stream, lwe_in_switched, lwe_in, input_lwe_dimension,
+      polynomial_size, input_lwe_ciphertext_count);
+
+  checkCudaErrors(cudaFuncSetAttribute(
+      device_bootstrap_amortized_batched_fft<Torus, params>,
+      cudaFuncAttributeMaxDynamicSharedMemorySize, SM_BATCHED));
+  checkCudaErrors(cudaFuncSetCacheConfig(
+      device_bootstrap_amortized_batched_fft<Torus, params>,
+      cudaFuncCachePreferShared));
+
+  dim3 grid(input_lwe_ciphertext_count, 1, 1);
+  dim3 thds(threads_per_slice, slices, 1);
+  device_bootstrap_amortized_batched_fft<Torus, params>
+      <<<grid, thds, SM_BATCHED, *stream>>>(
+          lwe_out, lut_vector, lut_vector_indexes, lwe_in_switched,
+          bootstrapping_key, input_lwe_dimension, glwe_dimension,
+          polynomial_size, base_log, l_gadget, lwe_idx);
+  checkCudaErrors(cudaGetLastError());
+
+  cudaStreamSynchronize(*stream);
+  cudaFree(lwe_in_switched);
+}
+
 template <typename Torus, class params>
 int cuda_get_pbs_per_gpu(int polynomial_size) {
 
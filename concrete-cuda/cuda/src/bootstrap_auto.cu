@@ -0,0 +1,161 @@
+#include <cuda_runtime.h>
+#include <helper_cuda.h>
+
+#include "bootstrap.h"
+#include "bootstrap_dispatch.h"
+
+/// Properties of the current device for the cost model of plan_bootstrap,
+/// half of the free global memory being left to the amortized scratch
+inline PbsDeviceProperties get_pbs_device_properties() {
+  int gpu_index = 0;
+  cudaGetDevice(&gpu_index);
+  cudaDeviceProp prop;
+  cudaGetDeviceProperties(&prop, gpu_index);
+  size_t free_memory = 0, total_memory = 0;
+  cudaMemGetInfo(&free_memory, &total_memory);
+
+  PbsDeviceProperties device;
+  device.sm_count = prop.multiProcessorCount;
+  device.max_threads_per_sm = prop.maxThreadsPerMultiProcessor;
+  device.max_blocks_per_sm = prop.maxBlocksPerMultiProcessor;
+  device.shared_memory_per_sm = prop.sharedMemPerMultiprocessor;
+  // Double precision units per SM of the datacenter parts (P100, V100, A100
+  // and H100), the other parts of the same major version have far fewer
+  int compute_capability = prop.major * 10 + prop.minor;
+  switch (compute_capability) {
+  case 60:
+  case 70:
+  case 80:
+    device.fp64_units_per_sm = 32;
+    break;
+  case 90:
+    device.fp64_units_per_sm = 64;
+    break;
+  default:
+    device.fp64_units_per_sm = 2;
+    break;
+  }
+  device.scratch_memory = free_memory / 2;
+  return device;
+}
+
+/// The low latency kernel reads the test vector s for the ciphertext s, the
+/// ones selected by lut_vector_indexes are gathered for it
+template <typename Torus>
+__global__ void gather_lut_vectors(Torus *lut_out, Torus *lut_vector,
+                                   uint32_t *lut_vector_indexes,
+                                   uint32_t lwe_idx,
+                                   uint32_t polynomial_size) {
+  Torus *block_lut_out = &lut_out[blockIdx.x * 2 * polynomial_size];
+  Torus *block_lut =
+      &lut_vector[lut_vector_indexes[lwe_idx + blockIdx.x] * 2 *
+                  polynomial_size];
+  for (uint32_t i = threadIdx.x; i < 2 * polynomial_size; i += blockDim.x)
+    block_lut_out[i] = block_lut[i];
+}
+
+template <typename Torus>
+void host_bootstrap_auto(
+    void *v_stream, Torus *lwe_out, Torus *lut_vector,
+    uint32_t *lut_vector_indexes, Torus *lwe_in, double2 *bootstrapping_key,
+    uint32_t input_lwe_dimension, uint32_t polynomial_size, uint32_t base_log,
+    uint32_t l_gadget, uint32_t num_samples, uint32_t num_lut_vectors,
+    uint32_t lwe_idx, uint32_t max_shared_memory,
+    decltype(cuda_bootstrap_amortized_lwe_ciphertext_vector_64) amortized,
+    decltype(cuda_bootstrap_low_latency_lwe_ciphertext_vector_64) low_latency,
+    decltype(cuda_bootstrap_low_latency_shared_lut_lwe_ciphertext_vector_64)
+        low_latency_shared_lut) {
+  if (num_samples == 0)
+    return;
+  auto stream = static_cast<cudaStream_t *>(v_stream);
+  PbsPlan plan = plan_bootstrap(get_pbs_device_properties(), sizeof(Torus),
+                                input_lwe_dimension, 1, polynomial_size,
+                                l_gadget, num_samples, max_shared_memory);
+
+  Torus *gathered_luts = nullptr;
+  if (plan.variant == PBS_LOW_LATENCY && lut_vector_indexes != nullptr)
+    checkCudaErrors(cudaMalloc((void **)&gathered_luts,
+                               sizeof(Torus) * 2 * polynomial_size *
+                                   plan.chunk_size));
+
+  for (uint32_t first = 0; first < num_samples; first += plan.chunk_size) {
+    uint32_t samples = std::min(plan.chunk_size, num_samples - first);
+    Torus *chunk_lwe_out = &lwe_out[(size_t)first * (polynomial_size + 1)];
+    Torus *chunk_lwe_in = &lwe_in[(size_t)first * (input_lwe_dimension + 1)];
+    if (plan.variant == PBS_AMORTIZED) {
+      amortized(v_stream, chunk_lwe_out, lut_vector, lut_vector_indexes,
+                chunk_lwe_in, bootstrapping_key, input_lwe_dimension,
+                polynomial_size, base_log, l_gadget, samples, num_lut_vectors,
+                lwe_idx + first, max_shared_memory);
+    } else if (lut_vector_indexes == nullptr) {
+      low_latency_shared_lut(v_stream, chunk_lwe_out, lut_vector, chunk_lwe_in,
+                             bootstrapping_key, input_lwe_dimension,
+                             polynomial_size, base_log, l_gadget, samples,
+                             max_shared_memory);
+    } else {
+      gather_lut_vectors<Torus><<<samples, 256, 0, *stream>>>(
+          gathered_luts, lut_vector, lut_vector_indexes, lwe_idx + first,
+          polynomial_size);
+      checkCudaErrors(cudaGetLastError());
+      low_latency(v_stream, chunk_lwe_out, gathered_luts, lut_vector_indexes,
+                  chunk_lwe_in, bootstrapping_key, input_lwe_dimension,
+                  polynomial_size, base_log, l_gadget, samples, samples, 0,
+                  max_shared_memory);
+    }
+  }
+  cudaStreamSynchronize(*stream);
+  cudaFree(gathered_luts);
+}
+
+/* Perform the bootstrap of a batch of LWE ciphertexts for 32 bits with the
+ * variant estimated to be the fastest for its size
+ *
+ * Same arguments and layouts as
+ * cuda_bootstrap_amortized_lwe_ciphertext_vector_32. The cost model of
+ * plan_bootstrap (include/bootstrap_dispatch.h) weighs the amortized kernel,
+ * one block per ciphertext, against the low latency one, l_gadget * 2
+ * blocks per ciphertext in a cooperative launch, given the number of SMs and
+ * the shared memory of the current device: small batches go to the low
+ * latency kernel, in chunks that fit in a cooperative launch, and large ones
+ * to the amortized kernel, in chunks whose scratch fits in half of the free
+ * global memory. The test vectors selected by lut_vector_indexes are
+ * gathered for the low latency kernel, which takes one per ciphertext, and
+ * with a null lut_vector_indexes the single test vector is read in place by
+ * cuda_bootstrap_low_latency_shared_lut_lwe_ciphertext_vector_32.
+ */
+void cuda_bootstrap_auto_lwe_ciphertext_vector_32(
+    void *v_stream, void *lwe_out, void *lut_vector, void *lut_vector_indexes,
+    void *lwe_in, void *bootstrapping_key, uint32_t input_lwe_dimension,
+    uint32_t polynomial_size, uint32_t base_log, uint32_t l_gadget,
+    uint32_t num_samples, uint32_t num_lut_vectors, uint32_t lwe_idx,
+    uint32_t max_shared_memory) {
+  host_bootstrap_auto<uint32_t>(
+      v_stream, (uint32_t *)lwe_out, (uint32_t *)lut_vector,
+      (uint32_t *)lut_vector_indexes, (uint32_t *)lwe_in,
+      (double2 *)bootstrapping_key, input_lwe_dimension, polynomial_size,
+      base_log, l_gadget, num_samples, num_lut_vectors, lwe_idx,
+      max_shared_memory, cuda_bootstrap_amortized_lwe_ciphertext_vector_32,
+      cuda_bootstrap_low_latency_lwe_ciphertext_vector_32,
+      cuda_bootstrap_low_latency_shared_lut_lwe_ciphertext_vector_32);
+}
+
+/* Perform the bootstrap of a batch of LWE ciphertexts for 64 bits with the
+ * variant estimated to be the fastest for its size
+ *
+ * See cuda_bootstrap_auto_lwe_ciphertext_vector_32
+ */
+void cuda_bootstrap_auto_lwe_ciphertext_vector_64(
+    void *v_stream, void *lwe_out, void *lut_vector, void *lut_vector_indexes,
+    void *lwe_in, void *bootstrapping_key, uint32_t input_lwe_dimension,
+    uint32_t polynomial_size, uint32_t base_log, uint32_t l_gadget,
+    uint32_t num_samples, uint32_t num_lut_vectors, uint32_t lwe_idx,
+    uint32_t max_shared_memory) {
+  host_bootstrap_auto<uint64_t>(
+      v_stream, (uint64_t *)lwe_out, (uint64_t *)lut_vector,
+      (uint32_t *)lut_vector_indexes, (uint64_t *)lwe_in,
+      (double2 *)bootstrapping_key, input_lwe_dimension, polynomial_size,
+      base_log, l_gadget, num_samples, num_lut_vectors, lwe_idx,
+      max_shared_memory, cuda_bootstrap_amortized_lwe_ciphertext_vector_64,
+      cuda_bootstrap_low_latency_lwe_ciphertext_vector_64,
+      cuda_bootstrap_low_latency_shared_lut_lwe_ciphertext_vector_64);
+}
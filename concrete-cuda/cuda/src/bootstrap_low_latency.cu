@@ -1,5 +1,59 @@
 #include "bootstrap_low_latency.cuh"
 
+template <typename Torus>
+void bootstrap_low_latency(
+    void *v_stream, void *lwe_out, void *lut_vector, void *lut_vector_indexes,
+    void *lwe_in, void *bootstrapping_key, uint32_t lwe_dimension,
+    uint32_t glwe_dimension, uint32_t polynomial_size, uint32_t base_log,
+    uint32_t l_gadget, uint32_t num_samples, uint32_t num_lut_vectors,
+    bool shared_lut = false) {
+
+  switch (polynomial_size) {
+  case 512:
+    host_bootstrap_low_latency<Torus, Degree<512>>(
+        v_stream, (Torus *)lwe_out, (Torus *)lut_vector,
+        (uint32_t *)lut_vector_indexes, (Torus *)lwe_in,
+        (double2 *)bootstrapping_key, lwe_dimension, polynomial_size,
+        base_log, l_gadget, num_samples,
+        num_lut_vectors, glwe_dimension, shared_lut);
+    break;
+  case 1024:
+    host_bootstrap_low_latency<Torus, Degree<1024>>(
+        v_stream, (Torus *)lwe_out, (Torus *)lut_vector,
+        (uint32_t *)lut_vector_indexes, (Torus *)lwe_in,
+        (double2 *)bootstrapping_key, lwe_dimension, polynomial_size,
+        base_log, l_gadget, num_samples,
+        num_lut_vectors, glwe_dimension, shared_lut);
+    break;
+  case 2048:
+    host_bootstrap_low_latency<Torus, Degree<2048>>(
+        v_stream, (Torus *)lwe_out, (Torus *)lut_vector,
+        (uint32_t *)lut_vector_indexes, (Torus *)lwe_in,
+        (double2 *)bootstrapping_key, lwe_dimension, polynomial_size,
+        base_log, l_gadget, num_samples,
+        num_lut_vectors, glwe_dimension, shared_lut);
+    break;
+  case 4096:
+    host_bootstrap_low_latency<Torus, Degree<4096>>(
+        v_stream, (Torus *)lwe_out, (Torus *)lut_vector,
+        (uint32_t *)lut_vector_indexes, (Torus *)lwe_in,
+        (double2 *)bootstrapping_key, lwe_dimension, polynomial_size,
+        base_log, l_gadget, num_samples,
+        num_lut_vectors, glwe_dimension, shared_lut);
+    break;
+  case 8192:
+    host_bootstrap_low_latency<Torus, Degree<8192>>(
+        v_stream, (Torus *)lwe_out, (Torus *)lut_vector,
+        (uint32_t *)lut_vector_indexes, (Torus *)lwe_in,
+        (double2 *)bootstrapping_key, lwe_dimension, polynomial_size,
+        base_log, l_gadget, num_samples,
+        num_lut_vectors, glwe_dimension, shared_lut);
+    break;
+  default:
+    break;
+  }
+}
+
 /* Perform bootstrapping on a batch of input LWE ciphertexts
  *
  *  - lwe_out: output batch of num_samples bootstrapped ciphertexts c =
@@ -53,6 +107,9 @@
  * the different stages (accumulators) are stored into the shared memory
  * 	- the accumulators serve to combine the results for all decomposition
  * levels
+ * 	- the kernel is a cooperative launch of l_gadget * 2 blocks per sample,
+ * batches with more blocks than can be resident at once on the device are
+ * split in consecutive launches (see plan_low_latency_pbs_chunks)
  * 	- the constant memory (64K) is used for storing the roots of identity
  * values for the FFT
  */
@@ -71,112 +128,346 @@ void cuda_bootstrap_low_latency_lwe_ciphertext_vector_32(
         uint32_t num_lut_vectors,
         uint32_t lwe_idx,
         uint32_t max_shared_memory) {
+  bootstrap_low_latency<uint32_t>(
+      v_stream, lwe_out, lut_vector, lut_vector_indexes, lwe_in,
+      bootstrapping_key, lwe_dimension, 1, polynomial_size,
+      base_log, l_gadget, num_samples, num_lut_vectors);
+}
+
+/* Perform bootstrapping on a batch of input LWE ciphertexts of 64 bits
+ *
+ * See cuda_bootstrap_low_latency_lwe_ciphertext_vector_32
+ */
+void cuda_bootstrap_low_latency_lwe_ciphertext_vector_64(
+        void *v_stream,
+        void *lwe_out,
+        void *lut_vector,
+        void *lut_vector_indexes,
+        void *lwe_in,
+        void *bootstrapping_key,
+        uint32_t lwe_dimension,
+        uint32_t polynomial_size,
+        uint32_t base_log,
+        uint32_t l_gadget,
+        uint32_t num_samples,
+        uint32_t num_lut_vectors,
+        uint32_t lwe_idx,
+        uint32_t max_shared_memory) {
+  bootstrap_low_latency<uint64_t>(
+      v_stream, lwe_out, lut_vector, lut_vector_indexes, lwe_in,
+      bootstrapping_key, lwe_dimension, 1, polynomial_size,
+      base_log, l_gadget, num_samples, num_lut_vectors);
+}
+
+/* Perform the low latency bootstrap on a batch of input LWE ciphertexts of
+ * 32 bits that all use the same test vector
+ *
+ * Same arguments as cuda_bootstrap_low_latency_lwe_ciphertext_vector_32
+ * without the index array, lut_vector holding a single test vector: every
+ * block reads it in place, with a zero stride between samples, instead of
+ * a copy per ciphertext. This is the low latency counterpart of
+ * cuda_bootstrap_amortized_shared_lut_lwe_ciphertext_vector_32.
+ */
+void cuda_bootstrap_low_latency_shared_lut_lwe_ciphertext_vector_32(
+        void *v_stream,
+        void *lwe_out,
+        void *lut_vector,
+        void *lwe_in,
+        void *bootstrapping_key,
+        uint32_t lwe_dimension,
+        uint32_t polynomial_size,
+        uint32_t base_log,
+        uint32_t l_gadget,
+        uint32_t num_samples,
+        uint32_t max_shared_memory) {
+  bootstrap_low_latency<uint32_t>(
+      v_stream, lwe_out, lut_vector, nullptr, lwe_in, bootstrapping_key,
+      lwe_dimension, 1, polynomial_size, base_log, l_gadget, num_samples, 1,
+      true);
+}
+
+/* Perform the low latency bootstrap on a batch of input LWE ciphertexts of
+ * 64 bits that all use the same test vector
+ *
+ * See cuda_bootstrap_low_latency_shared_lut_lwe_ciphertext_vector_32
+ */
+void cuda_bootstrap_low_latency_shared_lut_lwe_ciphertext_vector_64(
+        void *v_stream,
+        void *lwe_out,
+        void *lut_vector,
+        void *lwe_in,
+        void *bootstrapping_key,
+        uint32_t lwe_dimension,
+        uint32_t polynomial_size,
+        uint32_t base_log,
+        uint32_t l_gadget,
+        uint32_t num_samples,
+        uint32_t max_shared_memory) {
+  bootstrap_low_latency<uint64_t>(
+      v_stream, lwe_out, lut_vector, nullptr, lwe_in, bootstrapping_key,
+      lwe_dimension, 1, polynomial_size, base_log, l_gadget, num_samples, 1,
+      true);
+}
+
+/* Perform the low latency bootstrap on a batch of input LWE ciphertexts of
+ * 32 bits with a GLWE accumulator of any dimension
+ *
+ * Same arguments as cuda_bootstrap_low_latency_lwe_ciphertext_vector_32,
+ * plus glwe_dimension, the number k of mask polynomials of the accumulator:
+ * the test vectors and the bootstrapping key hold k + 1 polynomials per
+ * GLWE, and the output ciphertexts are of dimension k * polynomial_size. The
+ * kernel runs l_gadget * (k + 1) blocks per ciphertext. With glwe_dimension
+ * = 1 this is cuda_bootstrap_low_latency_lwe_ciphertext_vector_32, the host
+ * reference being
+ * cpu_bootstrap_low_latency_lwe_ciphertext_vector_with_glwe_dimension_32.
+ */
+void cuda_bootstrap_low_latency_lwe_ciphertext_vector_with_glwe_dimension_32(
+        void *v_stream,
+        void *lwe_out,
+        void *lut_vector,
+        void *lut_vector_indexes,
+        void *lwe_in,
+        void *bootstrapping_key,
+        uint32_t lwe_dimension,
+        uint32_t glwe_dimension,
+        uint32_t polynomial_size,
+        uint32_t base_log,
+        uint32_t l_gadget,
+        uint32_t num_samples,
+        uint32_t num_lut_vectors,
+        uint32_t lwe_idx,
+        uint32_t max_shared_memory) {
+  bootstrap_low_latency<uint32_t>(
+      v_stream, lwe_out, lut_vector, lut_vector_indexes, lwe_in,
+      bootstrapping_key, lwe_dimension, glwe_dimension, polynomial_size,
+      base_log, l_gadget, num_samples, num_lut_vectors);
+}
+
+/* Perform the low latency bootstrap on a batch of input LWE ciphertexts of
+ * 64 bits with a GLWE accumulator of any dimension
+ *
+ * See cuda_bootstrap_low_latency_lwe_ciphertext_vector_with_glwe_dimension_32
+ */
+void cuda_bootstrap_low_latency_lwe_ciphertext_vector_with_glwe_dimension_64(
+        void *v_stream,
+        void *lwe_out,
+        void *lut_vector,
+        void *lut_vector_indexes,
+        void *lwe_in,
+        void *bootstrapping_key,
+        uint32_t lwe_dimension,
+        uint32_t glwe_dimension,
+        uint32_t polynomial_size,
+        uint32_t base_log,
+        uint32_t l_gadget,
+        uint32_t num_samples,
+        uint32_t num_lut_vectors,
+        uint32_t lwe_idx,
+        uint32_t max_shared_memory) {
+  bootstrap_low_latency<uint64_t>(
+      v_stream, lwe_out, lut_vector, lut_vector_indexes, lwe_in,
+      bootstrapping_key, lwe_dimension, glwe_dimension, polynomial_size,
+      base_log, l_gadget, num_samples, num_lut_vectors);
+}
 
+
+/* Create the context of the low latency bootstrap of 32 bits ciphertexts
+ * with test vectors of polynomial_size coefficients and l_gadget levels, in
+ * batches of up to max_num_samples ciphertexts
+ *
+ * The shared memory of the kernel is configured for the device gpu_index
+ * and the join buffers of the largest cooperative launch that fits are
+ * allocated once, so that
+ * cuda_bootstrap_low_latency_with_context_lwe_ciphertext_vector_32 neither
+ * allocates nor synchronizes. Larger batches are still accepted, in several
+ * launches. Returns a null pointer for unsupported polynomial sizes or if
+ * not even one ciphertext fits on the device.
+ */
+void *cuda_create_bootstrap_low_latency_context_32(uint32_t gpu_index,
+                                                   uint32_t polynomial_size,
+                                                   uint32_t l_gadget,
+                                                   uint32_t max_num_samples) {
+  cudaSetDevice(gpu_index);
   switch (polynomial_size) {
   case 512:
-    host_bootstrap_low_latency<uint32_t, Degree<512>>(
-        v_stream, (uint32_t *)lwe_out, (uint32_t *)lut_vector,
-        (uint32_t *)lut_vector_indexes, (uint32_t *)lwe_in,
-        (double2 *)bootstrapping_key, lwe_dimension, polynomial_size,
-        base_log, l_gadget, num_samples,
-        num_lut_vectors);
+    return host_create_bootstrap_low_latency_context<uint32_t, Degree<512>>(
+        polynomial_size, l_gadget, max_num_samples);
+  case 1024:
+    return host_create_bootstrap_low_latency_context<uint32_t, Degree<1024>>(
+        polynomial_size, l_gadget, max_num_samples);
+  case 2048:
+    return host_create_bootstrap_low_latency_context<uint32_t, Degree<2048>>(
+        polynomial_size, l_gadget, max_num_samples);
+  case 4096:
+    return host_create_bootstrap_low_latency_context<uint32_t, Degree<4096>>(
+        polynomial_size, l_gadget, max_num_samples);
+  case 8192:
+    return host_create_bootstrap_low_latency_context<uint32_t, Degree<8192>>(
+        polynomial_size, l_gadget, max_num_samples);
+  default:
+    return nullptr;
+  }
+}
+
+/* Create the context of the low latency bootstrap of 64 bits ciphertexts
+ *
+ * See cuda_create_bootstrap_low_latency_context_32
+ */
+void *cuda_create_bootstrap_low_latency_context_64(uint32_t gpu_index,
+                                                   uint32_t polynomial_size,
+                                                   uint32_t l_gadget,
+                                                   uint32_t max_num_samples) {
+  cudaSetDevice(gpu_index);
+  switch (polynomial_size) {
+  case 512:
+    return host_create_bootstrap_low_latency_context<uint64_t, Degree<512>>(
+        polynomial_size, l_gadget, max_num_samples);
+  case 1024:
+    return host_create_bootstrap_low_latency_context<uint64_t, Degree<1024>>(
+        polynomial_size, l_gadget, max_num_samples);
+  case 2048:
+    return host_create_bootstrap_low_latency_context<uint64_t, Degree<2048>>(
+        polynomial_size, l_gadget, max_num_samples);
+  case 4096:
+    return host_create_bootstrap_low_latency_context<uint64_t, Degree<4096>>(
+        polynomial_size, l_gadget, max_num_samples);
+  case 8192:
+    return host_create_bootstrap_low_latency_context<uint64_t, Degree<8192>>(
+        polynomial_size, l_gadget, max_num_samples);
+  default:
+    return nullptr;
+  }
+}
+
+/* Perform the low latency bootstrap on a batch of input LWE ciphertexts for
+ * 32 bits with the buffers of a context
+ *
+ * Same arguments and layouts as
+ * cuda_bootstrap_low_latency_lwe_ciphertext_vector_32, ciphertext s using the
+ * test vector s. context comes from
+ * cuda_create_bootstrap_low_latency_context_32 with the same polynomial_size
+ * and l_gadget, nothing is done otherwise or if it is null, from a failed
+ * creation. The function returns once the
+ * launches are enqueued on the stream. A context must not be used by two
+ * streams at once.
+ */
+void cuda_bootstrap_low_latency_with_context_lwe_ciphertext_vector_32(
+        void *v_stream,
+        void *context,
+        void *lwe_out,
+        void *lut_vector,
+        void *lwe_in,
+        void *bootstrapping_key,
+        uint32_t lwe_dimension,
+        uint32_t polynomial_size,
+        uint32_t base_log,
+        uint32_t l_gadget,
+        uint32_t num_samples) {
+  auto pbs_context = static_cast<LowLatencyPbsContext<DeviceMemory> *>(context);
+  if (pbs_context == nullptr ||
+      !pbs_context->is_compatible(sizeof(uint32_t), polynomial_size, l_gadget))
+    return;
+
+  switch (polynomial_size) {
+  case 512:
+    host_bootstrap_low_latency_with_context<uint32_t, Degree<512>>(
+        v_stream, pbs_context, (uint32_t *)lwe_out, (uint32_t *)lut_vector,
+        (uint32_t *)lwe_in, (double2 *)bootstrapping_key, lwe_dimension,
+        polynomial_size, base_log, l_gadget, num_samples);
     break;
   case 1024:
-    host_bootstrap_low_latency<uint32_t, Degree<1024>>(
-        v_stream, (uint32_t *)lwe_out, (uint32_t *)lut_vector,
-        (uint32_t *)lut_vector_indexes, (uint32_t *)lwe_in,
-        (double2 *)bootstrapping_key, lwe_dimension, polynomial_size,
-        base_log, l_gadget, num_samples,
-        num_lut_vectors);
+    host_bootstrap_low_latency_with_context<uint32_t, Degree<1024>>(
+        v_stream, pbs_context, (uint32_t *)lwe_out, (uint32_t *)lut_vector,
+        (uint32_t *)lwe_in, (double2 *)bootstrapping_key, lwe_dimension,
+        polynomial_size, base_log, l_gadget, num_samples);
     break;
   case 2048:
-    host_bootstrap_low_latency<uint32_t, Degree<2048>>(
-        v_stream, (uint32_t *)lwe_out, (uint32_t *)lut_vector,
-        (uint32_t *)lut_vector_indexes, (uint32_t *)lwe_in,
-        (double2 *)bootstrapping_key, lwe_dimension, polynomial_size,
-        base_log, l_gadget, num_samples,
-        num_lut_vectors);
+    host_bootstrap_low_latency_with_context<uint32_t, Degree<2048>>(
+        v_stream, pbs_context, (uint32_t *)lwe_out, (uint32_t *)lut_vector,
+        (uint32_t *)lwe_in, (double2 *)bootstrapping_key, lwe_dimension,
+        polynomial_size, base_log, l_gadget, num_samples);
     break;
   case 4096:
-    host_bootstrap_low_latency<uint32_t, Degree<4096>>(
-        v_stream, (uint32_t *)lwe_out, (uint32_t *)lut_vector,
-        (uint32_t *)lut_vector_indexes, (uint32_t *)lwe_in,
-        (double2 *)bootstrapping_key, lwe_dimension, polynomial_size,
-        base_log, l_gadget, num_samples,
-        num_lut_vectors);
+    host_bootstrap_low_latency_with_context<uint32_t, Degree<4096>>(
+        v_stream, pbs_context, (uint32_t *)lwe_out, (uint32_t *)lut_vector,
+        (uint32_t *)lwe_in, (double2 *)bootstrapping_key, lwe_dimension,
+        polynomial_size, base_log, l_gadget, num_samples);
     break;
   case 8192:
-    host_bootstrap_low_latency<uint32_t, Degree<8192>>(
-        v_stream, (uint32_t *)lwe_out, (uint32_t *)lut_vector,
-        (uint32_t *)lut_vector_indexes, (uint32_t *)lwe_in,
-        (double2 *)bootstrapping_key, lwe_dimension, polynomial_size,
-        base_log, l_gadget, num_samples,
-        num_lut_vectors);
+    host_bootstrap_low_latency_with_context<uint32_t, Degree<8192>>(
+        v_stream, pbs_context, (uint32_t *)lwe_out, (uint32_t *)lut_vector,
+        (uint32_t *)lwe_in, (double2 *)bootstrapping_key, lwe_dimension,
+        polynomial_size, base_log, l_gadget, num_samples);
     break;
   default:
     break;
   }
 }
 
-void cuda_bootstrap_low_latency_lwe_ciphertext_vector_64(
+/* Perform the low latency bootstrap on a batch of input LWE ciphertexts for
+ * 64 bits with the buffers of a context
+ *
+ * See cuda_bootstrap_low_latency_with_context_lwe_ciphertext_vector_32
+ */
+void cuda_bootstrap_low_latency_with_context_lwe_ciphertext_vector_64(
         void *v_stream,
+        void *context,
         void *lwe_out,
         void *lut_vector,
-        void *lut_vector_indexes,
         void *lwe_in,
         void *bootstrapping_key,
         uint32_t lwe_dimension,
         uint32_t polynomial_size,
         uint32_t base_log,
         uint32_t l_gadget,
-        uint32_t num_samples,
-        uint32_t num_lut_vectors,
-        uint32_t lwe_idx,
-        uint32_t max_shared_memory) {
+        uint32_t num_samples) {
+  auto pbs_context = static_cast<LowLatencyPbsContext<DeviceMemory> *>(context);
+  if (pbs_context == nullptr ||
+      !pbs_context->is_compatible(sizeof(uint64_t), polynomial_size, l_gadget))
+    return;
 
   switch (polynomial_size) {
   case 512:
-    host_bootstrap_low_latency<uint64_t, Degree<512>>(
-        v_stream, (uint64_t *)lwe_out, (uint64_t *)lut_vector,
-        (uint32_t *)lut_vector_indexes, (uint64_t *)lwe_in,
-        (double2 *)bootstrapping_key, lwe_dimension, polynomial_size,
-        base_log, l_gadget, num_samples,
-        num_lut_vectors);
+    host_bootstrap_low_latency_with_context<uint64_t, Degree<512>>(
+        v_stream, pbs_context, (uint64_t *)lwe_out, (uint64_t *)lut_vector,
+        (uint64_t *)lwe_in, (double2 *)bootstrapping_key, lwe_dimension,
+        polynomial_size, base_log, l_gadget, num_samples);
     break;
   case 1024:
-    host_bootstrap_low_latency<uint64_t, Degree<1024>>(
-        v_stream, (uint64_t *)lwe_out, (uint64_t *)lut_vector,
-        (uint32_t *)lut_vector_indexes, (uint64_t *)lwe_in,
-        (double2 *)bootstrapping_key, lwe_dimension, polynomial_size,
-        base_log, l_gadget, num_samples,
-        num_lut_vectors);
+    host_bootstrap_low_latency_with_context<uint64_t, Degree<1024>>(
+        v_stream, pbs_context, (uint64_t *)lwe_out, (uint64_t *)lut_vector,
+        (uint64_t *)lwe_in, (double2 *)bootstrapping_key, lwe_dimension,
+        polynomial_size, base_log, l_gadget, num_samples);
     break;
   case 2048:
-    host_bootstrap_low_latency<uint64_t, Degree<2048>>(
-        v_stream, (uint64_t *)lwe_out, (uint64_t *)lut_vector,
-        (uint32_t *)lut_vector_indexes, (uint64_t *)lwe_in,
-        (double2 *)bootstrapping_key, lwe_dimension, polynomial_size,
-        base_log, l_gadget, num_samples,
-        num_lut_vectors);
+    host_bootstrap_low_latency_with_context<uint64_t, Degree<2048>>(
+        v_stream, pbs_context, (uint64_t *)lwe_out, (uint64_t *)lut_vector,
+        (uint64_t *)lwe_in, (double2 *)bootstrapping_key, lwe_dimension,
+        polynomial_size, base_log, l_gadget, num_samples);
     break;
   case 4096:
-    host_bootstrap_low_latency<uint64_t, Degree<4096>>(
-        v_stream, (uint64_t *)lwe_out, (uint64_t *)lut_vector,
-        (uint32_t *)lut_vector_indexes, (uint64_t *)lwe_in,
-        (double2 *)bootstrapping_key, lwe_dimension, polynomial_size,
-        base_log, l_gadget, num_samples,
-        num_lut_vectors);
+    host_bootstrap_low_latency_with_context<uint64_t, Degree<4096>>(
+        v_stream, pbs_context, (uint64_t *)lwe_out, (uint64_t *)lut_vector,
+        (uint64_t *)lwe_in, (double2 *)bootstrapping_key, lwe_dimension,
+        polynomial_size, base_log, l_gadget, num_samples);
     break;
   case 8192:
-    host_bootstrap_low_latency<uint64_t, Degree<8192>>(
-        v_stream, (uint64_t *)lwe_out, (uint64_t *)lut_vector,
-        (uint32_t *)lut_vector_indexes, (uint64_t *)lwe_in,
-        (double2 *)bootstrapping_key, lwe_dimension, polynomial_size,
-        base_log, l_gadget, num_samples,
-        num_lut_vectors);
+    host_bootstrap_low_latency_with_context<uint64_t, Degree<8192>>(
+        v_stream, pbs_context, (uint64_t *)lwe_out, (uint64_t *)lut_vector,
+        (uint64_t *)lwe_in, (double2 *)bootstrapping_key, lwe_dimension,
+        polynomial_size, base_log, l_gadget, num_samples);
     break;
   default:
     break;
   }
 }
 
+/* Destroy a context of the low latency bootstrap, once the work using it is
+ * done
+ */
+int cuda_destroy_bootstrap_low_latency_context(void *context,
+                                               uint32_t gpu_index) {
+  cudaSetDevice(gpu_index);
+  delete static_cast<LowLatencyPbsContext<DeviceMemory> *>(context);
+  return 0;
+}
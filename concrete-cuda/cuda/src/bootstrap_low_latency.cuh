@@ -11,6 +11,8 @@
 
 #include "../include/helper_cuda.h"
 #include "bootstrap.h"
+#include "bootstrap_context.h"
+#include "bootstrap_dispatch.h"
 #include "complex/operations.cuh"
 #include "crypto/gadget.cuh"
 #include "crypto/torus.cuh"
@@ -32,10 +34,10 @@ __device__ void
 mul_trgsw_trlwe(Torus *accumulator,
                 double2 *fft,
                 int16_t *trlwe_decomposed,
-                double2 *mask_join_buffer,
-                double2 *body_join_buffer,
+                double2 *join_buffer,
                 double2 *bootstrapping_key,
-                int polynomial_size, int l_gadget, int iteration, grid_group &grid) {
+                int polynomial_size, int glwe_dimension, int l_gadget,
+                int iteration, grid_group &grid) {
 
   // Put the decomposed TRLWE sample in the Fourier domain
   real_to_complex_compressed<int16_t, params>(trlwe_decomposed,
@@ -51,61 +53,45 @@ mul_trgsw_trlwe(Torus *accumulator,
 
 
 
-  // Get the pieces of the bootstrapping key that will be needed for the
-  // external product; blockIdx.x is the ID of the block that's executing
-  // this function, so we end up getting the lines of the bootstrapping key
-  // needed to perform the external product in this block (corresponding to
-  // the same decomposition level)
-
-    auto bsk_mask_slice = PolynomialFourier<double2, params>(
-      get_ith_mask_kth_block(
-          bootstrapping_key, iteration, blockIdx.y, blockIdx.x,
-          polynomial_size, 1, l_gadget));
-    auto bsk_body_slice = PolynomialFourier<double2, params>(
-      get_ith_body_kth_block(
-          bootstrapping_key, iteration, blockIdx.y, blockIdx.x,
-          polynomial_size, 1, l_gadget));
-
-  // Perform the matrix multiplication between the RGSW and the TRLWE,
-  // each block operating on a single level for mask and body
-
-  auto first_processed_bsk = (blockIdx.y == 0) ? bsk_mask_slice : bsk_body_slice;
-  auto second_processed_bsk = (blockIdx.y == 0) ? bsk_body_slice : bsk_mask_slice;
-
-  auto first_processed_acc = (blockIdx.y == 0) ?
-      &mask_join_buffer[params::degree / 2 * blockIdx.x] :
-      &body_join_buffer[params::degree / 2 * blockIdx.x];
-  auto second_processed_acc = (blockIdx.y == 0) ?
-      &body_join_buffer[params::degree / 2 * blockIdx.x] :
-      &mask_join_buffer[params::degree / 2 * blockIdx.x];
-
-  int tid = threadIdx.x;
-
-  //first product
-  for(int i = 0; i < params::opt / 2; i++) {
-      first_processed_acc[tid] = fft[tid] * first_processed_bsk.m_values[tid];
+  // Get the line of the bootstrapping key that will be needed for the
+  // external product; blockIdx.x is the decomposition level and blockIdx.y
+  // the polynomial of the accumulator handled by this block, the line holds
+  // the glwe_dimension + 1 polynomials it is multiplied with
+  auto bsk_line = get_ith_mask_kth_block(
+      bootstrapping_key, iteration, blockIdx.y, blockIdx.x,
+      polynomial_size, glwe_dimension, l_gadget);
+
+  // Perform the matrix multiplication between the RGSW and the TRLWE: the
+  // product with column c is added to the slot of column c and level
+  // blockIdx.x of the join buffer. Each round the blocks of a level write
+  // to distinct columns, the first one initializing the slots
+  for (int round = 0; round <= glwe_dimension; round++) {
+    int column = (blockIdx.y + round) % (glwe_dimension + 1);
+    auto bsk_slice = PolynomialFourier<double2, params>(
+        &bsk_line[column * params::degree / 2]);
+    auto processed_acc =
+        &join_buffer[(column * l_gadget + blockIdx.x) * params::degree / 2];
+
+    int tid = threadIdx.x;
+    for (int i = 0; i < params::opt / 2; i++) {
+      if (round == 0)
+        processed_acc[tid] = fft[tid] * bsk_slice.m_values[tid];
+      else
+        processed_acc[tid] += fft[tid] * bsk_slice.m_values[tid];
       tid += params::degree / params::opt;
-  }
-
-  grid.sync();
-  tid = threadIdx.x;
-  //second product
-    for(int i = 0; i < params::opt / 2; i++) {
-        second_processed_acc[tid] += fft[tid] * second_processed_bsk.m_values[tid];
-        tid += params::degree / params::opt;
     }
 
+    // All blocks are synchronized here; after the last round, join_buffer
+    // has the values needed from every other block
+    grid.sync();
+  }
 
   // -----------------------------------------------------------------
 
-  // All blocks are synchronized here; after this sync, *_join_buffer has the
-  // values needed from every other block
-  grid.sync();
-
-  auto src_acc =  (blockIdx.y == 0) ? mask_join_buffer : body_join_buffer;
+  auto src_acc = &join_buffer[blockIdx.y * l_gadget * params::degree / 2];
 
   // copy first product into fft buffer
-  tid = threadIdx.x;
+  int tid = threadIdx.x;
   for (int i = 0; i < params::opt / 2; i++) {
       fft[tid] = src_acc[tid];
       tid += params::degree / params::opt;
@@ -137,26 +123,35 @@ mul_trgsw_trlwe(Torus *accumulator,
   __syncthreads();
 }
 
-template <typename Torus, class params>
+template <typename Torus, class params, typename InputTorus = Torus>
 /*
  * Kernel launched by the low latency version of the
  * bootstrapping, that uses cooperative groups
- * lwe_out vector of output lwe s, with length (polynomial_size+1)*num_samples
- * lut_vector - vector of look up tables with length  polynomial_size * num_samples
+ * lwe_out vector of output lwe s, with length
+ * (glwe_dimension * polynomial_size + 1) * num_samples
+ * lut_vector - vector of look up tables, the one of sample z starting at
+ * z * lut_stride: lut_stride is (glwe_dimension + 1) * polynomial_size for
+ * one test vector per sample, 0 for a single test vector shared by all
  * lut_vector_indexes - mapping between lwe_in and lut_vector
- * lwe_in - vector of lwe inputs with length (lwe_mask_size + 1) * num_samples
+ * lwe_in - vector of lwe inputs with length (lwe_mask_size + 1) * num_samples,
+ * already modulus switched to [0, 2N[ with InputTorus = uint16_t
+ * join_buffer - (glwe_dimension + 1) * l_gadget polynomials in the Fourier
+ * domain per sample, column-major
  *
+ * The grid is (l_gadget, glwe_dimension + 1, num_samples): block (x, y, z)
+ * keeps the polynomial y of the accumulator of sample z and decomposes its
+ * level x.
  */
 __global__ void device_bootstrap_low_latency(
     Torus *lwe_out,
     Torus *lut_vector,
-    Torus *lwe_in,
+    InputTorus *lwe_in,
     double2 *bootstrapping_key,
-    double2 *mask_join_buffer,
-    double2 *body_join_buffer,
+    double2 *join_buffer,
     uint32_t lwe_mask_size,
-    uint32_t polynomial_size, uint32_t base_log, uint32_t l_gadget
-    ) {
+    uint32_t glwe_dimension,
+    uint32_t polynomial_size, uint32_t base_log, uint32_t l_gadget,
+    uint32_t lut_stride) {
 
   grid_group grid = this_grid();
   
@@ -180,11 +175,10 @@ __global__ void device_bootstrap_low_latency(
   // this block is operating, in the case of batch bootstraps
   auto block_lwe_in = &lwe_in[blockIdx.z * (lwe_mask_size + 1)];
 
-  auto block_lut_vector =
-          &lut_vector[blockIdx.z * params::degree * 2];
+  auto block_lut_vector = &lut_vector[blockIdx.z * lut_stride];
 
-  auto block_mask_join_buffer = &mask_join_buffer[blockIdx.z * l_gadget * params::degree / 2];
-  auto block_body_join_buffer = &body_join_buffer[blockIdx.z * l_gadget * params::degree / 2];
+  auto block_join_buffer = &join_buffer[blockIdx.z * (glwe_dimension + 1) *
+                                        l_gadget * params::degree / 2];
 
   // Since the space is L1 cache is small, we use the same memory location for
   // the rotated accumulator and the fft accumulator, since we know that the
@@ -192,28 +186,22 @@ __global__ void device_bootstrap_low_latency(
   GadgetMatrix<Torus, params> gadget(base_log, l_gadget);
 
   // Put "b" in [0, 2N[
-  Torus b_hat = rescale_torus_element(
+  Torus b_hat = rescale_input_element<Torus>(
       block_lwe_in[lwe_mask_size],
       2 * params::degree);
 
-  if (blockIdx.y == 0) {
-      divide_by_monomial_negacyclic_inplace<Torus, params::opt,
-              params::degree / params::opt>(
-              accumulator, block_lut_vector, b_hat, false);
-  }
-  else {
-      divide_by_monomial_negacyclic_inplace<Torus, params::opt,
-              params::degree / params::opt>(
-              accumulator, &block_lut_vector[params::degree], b_hat, false);
-  }
+  divide_by_monomial_negacyclic_inplace<Torus, params::opt,
+          params::degree / params::opt>(
+          accumulator, &block_lut_vector[blockIdx.y * params::degree], b_hat,
+          false);
 
   for (int i = 0; i < lwe_mask_size; i++) {
     synchronize_threads_in_block();
 
     // Put "a" in [0, 2N[
-    Torus a_hat = rescale_torus_element(
+    Torus a_hat = rescale_input_element<Torus>(
         block_lwe_in[i],
-        2 * params::degree); // 2 * params::log2_degree + 1);
+        2 * params::degree);
 
     // Perform ACC * (X^ä - 1)
     multiply_by_monomial_negacyclic_and_sub_polynomial<
@@ -228,7 +216,7 @@ __global__ void device_bootstrap_low_latency(
           accumulator_rotated, base_log, l_gadget);
 
     // Decompose the accumulator. Each block gets one level of the
-    // decomposition, for the mask and the body (so block 0 will have the
+    // decomposition of its polynomial (so block 0 will have the
     // accumulator decomposed at level 0, 1 at 1, etc.)
     gadget.decompose_one_level(accumulator_decomposed, accumulator_rotated,
                                blockIdx.x);
@@ -242,29 +230,130 @@ __global__ void device_bootstrap_low_latency(
         accumulator,
         accumulator_fft,
         accumulator_decomposed,
-        block_mask_join_buffer,
-        block_body_join_buffer,
+        block_join_buffer,
         bootstrapping_key,
-        polynomial_size, l_gadget, i, grid);
+        polynomial_size, glwe_dimension, l_gadget, i, grid);
   }
     
-  auto block_lwe_out = &lwe_out[blockIdx.z * (polynomial_size + 1)];
+  auto block_lwe_out =
+      &lwe_out[blockIdx.z * (glwe_dimension * polynomial_size + 1)];
 
-  if (blockIdx.x == 0 && blockIdx.y == 0) {
+  if (blockIdx.x == 0 && blockIdx.y < glwe_dimension) {
     // Perform a sample extract. At this point, all blocks have the result, but
-    // we do the computation at block 0 to avoid waiting for extra blocks, in
-    // case they're not synchronized
-    sample_extract_mask<Torus, params>(block_lwe_out, accumulator);
-  } else if (blockIdx.x == 0 && blockIdx.y == 1) {
-    sample_extract_body<Torus, params>(block_lwe_out, accumulator);
+    // we do the computation at the blocks of level 0 to avoid waiting for
+    // extra blocks, in case they're not synchronized
+    sample_extract_mask<Torus, params>(
+        &block_lwe_out[blockIdx.y * params::degree], accumulator);
+  } else if (blockIdx.x == 0) {
+    sample_extract_body<Torus, params>(
+        &block_lwe_out[(glwe_dimension - 1) * params::degree], accumulator);
   }
   
 }
 
 
+/// Device memory backend of the bootstrap contexts
+struct DeviceMemory {
+  static void *allocate(size_t bytes) {
+    void *ptr;
+    checkCudaErrors(cudaMalloc(&ptr, bytes));
+    return ptr;
+  }
+  static void release(void *ptr) { cudaFree(ptr); }
+};
+
+template <typename Torus, class params>
+__host__ int get_bootstrap_low_latency_shared_memory(uint32_t polynomial_size) {
+  return sizeof(int16_t) * polynomial_size +   // accumulator_decomp
+         sizeof(Torus) * polynomial_size +   // accumulator
+         sizeof(double2) * polynomial_size / 2;  // accumulator fft
+}
+
+/*
+ * Sets the shared memory configuration of the low latency kernel and
+ * returns the number of its blocks that can be resident at once on the
+ * current device, the limit of a cooperative launch
+ */
+template <typename Torus, class params, typename InputTorus = Torus>
+__host__ uint32_t configure_bootstrap_low_latency(uint32_t polynomial_size) {
+  int bytes_needed =
+      get_bootstrap_low_latency_shared_memory<Torus, params>(polynomial_size);
+  int thds = polynomial_size / params::opt;
+
+  checkCudaErrors(cudaFuncSetAttribute(
+      device_bootstrap_low_latency<Torus, params, InputTorus>,
+      cudaFuncAttributeMaxDynamicSharedMemorySize, bytes_needed));
+  cudaFuncSetCacheConfig(
+      device_bootstrap_low_latency<Torus, params, InputTorus>,
+      cudaFuncCachePreferShared);
+
+  int gpu_index, sm_count, blocks_per_sm;
+  checkCudaErrors(cudaGetDevice(&gpu_index));
+  checkCudaErrors(cudaDeviceGetAttribute(
+      &sm_count, cudaDevAttrMultiProcessorCount, gpu_index));
+  checkCudaErrors(cudaOccupancyMaxActiveBlocksPerMultiprocessor(
+      &blocks_per_sm, device_bootstrap_low_latency<Torus, params, InputTorus>,
+      thds, bytes_needed));
+  return sm_count * blocks_per_sm;
+}
+
+/*
+ * Enqueues the low latency bootstrap of num_samples ciphertexts on the
+ * stream, in consecutive cooperative launches of at most chunk_size
+ * ciphertexts that share the join buffer, sized for chunk_size ciphertexts.
+ * The test vectors are lut_stride elements apart, 0 for a shared one.
+ */
+template <typename Torus, class params, typename InputTorus = Torus>
+__host__ void launch_bootstrap_low_latency(
+    cudaStream_t *stream,
+    Torus *lwe_out,
+    Torus *lut_vector,
+    InputTorus *lwe_in,
+    double2 *bootstrapping_key,
+    double2 *join_buffer,
+    uint32_t chunk_size,
+    uint32_t lwe_mask_size,
+    uint32_t glwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t base_log,
+    uint32_t l_gadget,
+    uint32_t num_samples,
+    uint32_t lut_stride) {
+  int bytes_needed =
+      get_bootstrap_low_latency_shared_memory<Torus, params>(polynomial_size);
+  int thds = polynomial_size / params::opt;
+
+  for (uint32_t first = 0; first < num_samples; first += chunk_size) {
+    uint32_t samples = min(chunk_size, num_samples - first);
+    Torus *chunk_lwe_out =
+        &lwe_out[first * (glwe_dimension * polynomial_size + 1)];
+    Torus *chunk_lut_vector = &lut_vector[(size_t)first * lut_stride];
+    InputTorus *chunk_lwe_in = &lwe_in[first * (lwe_mask_size + 1)];
+    dim3 grid(l_gadget, glwe_dimension + 1, samples);
+
+    void *kernel_args[11];
+    kernel_args[0] = &chunk_lwe_out;
+    kernel_args[1] = &chunk_lut_vector;
+    kernel_args[2] = &chunk_lwe_in;
+    kernel_args[3] = &bootstrapping_key;
+    kernel_args[4] = &join_buffer;
+    kernel_args[5] = &lwe_mask_size;
+    kernel_args[6] = &glwe_dimension;
+    kernel_args[7] = &polynomial_size;
+    kernel_args[8] = &base_log;
+    kernel_args[9] = &l_gadget;
+    kernel_args[10] = &lut_stride;
+
+    checkCudaErrors(cudaLaunchCooperativeKernel ( (void *)device_bootstrap_low_latency<Torus, params, InputTorus>, grid, thds,  (void**)kernel_args, bytes_needed, *stream )) ;
+  }
+}
+
 /*
  * Host wrapper to the low latency version
- * of bootstrapping
+ * of bootstrapping, with a GLWE accumulator of glwe_dimension + 1
+ * polynomials. The inputs go through the integer modulus switch pre-pass
+ * and the kernel is instantiated for 16 bits inputs. With shared_lut, all
+ * the samples use the single test vector of lut_vector.
  */
 template <typename Torus, class params>
 __host__ void host_bootstrap_low_latency(
@@ -279,50 +368,103 @@ __host__ void host_bootstrap_low_latency(
     uint32_t base_log,
     uint32_t l_gadget,
     uint32_t num_samples,
-    uint32_t num_lut_vectors) {
+    uint32_t num_lut_vectors,
+    uint32_t glwe_dimension = 1,
+    bool shared_lut = false) {
   auto stream = static_cast<cudaStream_t *>(v_stream);
+  if (num_samples == 0)
+    return;
+
+  // A cooperative launch fails if its blocks cannot all be resident at once:
+  // the batch is split in launches that fit, issued in order on the stream so
+  // that they reuse the same join buffer
+  uint32_t resident_blocks =
+      configure_bootstrap_low_latency<Torus, params, uint16_t>(
+          polynomial_size);
+  PbsChunks chunks = plan_low_latency_pbs_chunks(
+      resident_blocks, glwe_dimension, l_gadget, num_samples);
+  if (chunks.num_chunks == 0) {
+    // Not even one sample fits in a cooperative launch on this device
+    printf("Error: the low latency bootstrap of polynomial size %u, glwe "
+           "dimension %u and %u levels does not fit on the device\n",
+           polynomial_size, glwe_dimension, l_gadget);
+    checkCudaErrors(cudaErrorInvalidConfiguration);
+  }
 
-  int buffer_size_per_gpu = l_gadget * num_samples * polynomial_size / 2 * sizeof(double2);
-  double2 *mask_buffer_fft;
-  double2 *body_buffer_fft;
-  checkCudaErrors(cudaMalloc((void **)&mask_buffer_fft, buffer_size_per_gpu));
-  checkCudaErrors(cudaMalloc((void **)&body_buffer_fft, buffer_size_per_gpu));
-
+  int buffer_size_per_gpu = (glwe_dimension + 1) * l_gadget *
+                            chunks.chunk_size * polynomial_size / 2 *
+                            sizeof(double2);
+  double2 *join_buffer;
+  checkCudaErrors(cudaMalloc((void **)&join_buffer, buffer_size_per_gpu));
+  uint16_t *lwe_in_switched;
+  checkCudaErrors(cudaMalloc((void **)&lwe_in_switched,
+                             (size_t)num_samples * (lwe_mask_size + 1) *
+                                 sizeof(uint16_t)));
+
+  host_modulus_switch_lwe_ciphertext_vector<Torus>(
+      v_stream, lwe_in_switched, lwe_in, lwe_mask_size, polynomial_size,
+      num_samples);
+  launch_bootstrap_low_latency<Torus, params, uint16_t>(
+      stream, lwe_out, lut_vector, lwe_in_switched, bootstrapping_key,
+      join_buffer, chunks.chunk_size, lwe_mask_size, glwe_dimension,
+      polynomial_size, base_log, l_gadget, num_samples,
+      shared_lut ? 0 : (glwe_dimension + 1) * polynomial_size);
 
-  int bytes_needed =
-      sizeof(int16_t) * polynomial_size +   // accumulator_decomp
-      sizeof(Torus) * polynomial_size +   // accumulator
-      sizeof(double2) * polynomial_size / 2;  // accumulator fft
-
-  int thds = polynomial_size / params::opt;
-  dim3 grid(l_gadget, 2, num_samples);
-
-  void *kernel_args[10];
-  kernel_args[0] = &lwe_out;
-  kernel_args[1] = &lut_vector;
-  kernel_args[2] = &lwe_in;
-  kernel_args[3] = &bootstrapping_key;
-  kernel_args[4] = &mask_buffer_fft;
-  kernel_args[5] = &body_buffer_fft;
-  kernel_args[6] = &lwe_mask_size;
-  kernel_args[7] = &polynomial_size;
-  kernel_args[8] = &base_log;
-  kernel_args[9] =&l_gadget;
-
-  checkCudaErrors(cudaFuncSetAttribute(device_bootstrap_low_latency<Torus,
-                                                                    params>,
-                           cudaFuncAttributeMaxDynamicSharedMemorySize,
-                           bytes_needed));
-  cudaFuncSetCacheConfig(device_bootstrap_low_latency<Torus, params>,
-                             cudaFuncCachePreferShared);
-  
-  checkCudaErrors(cudaLaunchCooperativeKernel ( (void *)device_bootstrap_low_latency<Torus, params>, grid, thds,  (void**)kernel_args, bytes_needed, *stream )) ;     
-  
   // Synchronize the streams before copying the result to lwe_out at the right
   // place
   cudaStreamSynchronize(*stream);
-  cudaFree(mask_buffer_fft);
-  cudaFree(body_buffer_fft);
+  cudaFree(join_buffer);
+  cudaFree(lwe_in_switched);
+}
+
+/*
+ * Creates the context of the low latency bootstrap of batches of up to
+ * max_num_samples ciphertexts: the shared memory of the kernel is configured
+ * and the join buffers of the largest launch that fits on the device are
+ * allocated. Returns nullptr if not even one ciphertext fits.
+ */
+template <typename Torus, class params>
+__host__ LowLatencyPbsContext<DeviceMemory> *
+host_create_bootstrap_low_latency_context(uint32_t polynomial_size,
+                                          uint32_t l_gadget,
+                                          uint32_t max_num_samples) {
+  uint32_t resident_blocks =
+      configure_bootstrap_low_latency<Torus, params>(polynomial_size);
+  PbsChunks chunks = plan_low_latency_pbs_chunks(resident_blocks, 1, l_gadget,
+                                                 max_num_samples);
+  if (chunks.num_chunks == 0)
+    return nullptr;
+  return new LowLatencyPbsContext<DeviceMemory>(
+      sizeof(Torus), polynomial_size, l_gadget, chunks.chunk_size);
+}
+
+/*
+ * Low latency bootstrap with the buffers of a context: nothing is allocated
+ * and the call returns as soon as the launches are enqueued. Without a
+ * buffer for the pre-pass, the kernel switches the Torus inputs itself, with
+ * the same integer modulus switch (see rescale_input_element).
+ */
+template <typename Torus, class params>
+__host__ void host_bootstrap_low_latency_with_context(
+    void *v_stream,
+    LowLatencyPbsContext<DeviceMemory> *context,
+    Torus *lwe_out,
+    Torus *lut_vector,
+    Torus *lwe_in,
+    double2 *bootstrapping_key,
+    uint32_t lwe_mask_size,
+    uint32_t polynomial_size,
+    uint32_t base_log,
+    uint32_t l_gadget,
+    uint32_t num_samples) {
+  // The mask and body join buffers of the context are contiguous, the join
+  // buffer of the kernel
+  launch_bootstrap_low_latency<Torus, params>(
+      static_cast<cudaStream_t *>(v_stream), lwe_out, lut_vector, lwe_in,
+      bootstrapping_key, (double2 *)context->mask_join_buffer(),
+      context->chunk_size(), lwe_mask_size, context->glwe_dimension(),
+      polynomial_size, base_log, l_gadget, num_samples,
+      (context->glwe_dimension() + 1) * polynomial_size);
 }
 
 #endif // LOWLAT_PBS_H
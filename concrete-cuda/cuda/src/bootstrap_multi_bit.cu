@@ -0,0 +1,119 @@
+#include "bootstrap_multi_bit.cuh"
+
+template <typename Torus>
+void bootstrap_multi_bit(void *v_stream, void *lwe_out, void *lut_vector,
+                         void *lut_vector_indexes, void *lwe_in,
+                         void *bootstrapping_key, uint32_t input_lwe_dimension,
+                         uint32_t polynomial_size, uint32_t base_log,
+                         uint32_t l_gadget, uint32_t grouping_factor,
+                         uint32_t num_samples, uint32_t lwe_idx,
+                         uint32_t max_shared_memory) {
+
+  if (grouping_factor == 0 || grouping_factor > MAX_GROUPING_FACTOR)
+    return;
+
+  switch (polynomial_size) {
+  case 512:
+    host_bootstrap_multi_bit<Torus, Degree<512>>(
+        v_stream, (Torus *)lwe_out, (Torus *)lut_vector,
+        (uint32_t *)lut_vector_indexes, (Torus *)lwe_in,
+        (double2 *)bootstrapping_key, input_lwe_dimension, polynomial_size,
+        base_log, l_gadget, grouping_factor, num_samples, lwe_idx,
+        max_shared_memory);
+    break;
+  case 1024:
+    host_bootstrap_multi_bit<Torus, Degree<1024>>(
+        v_stream, (Torus *)lwe_out, (Torus *)lut_vector,
+        (uint32_t *)lut_vector_indexes, (Torus *)lwe_in,
+        (double2 *)bootstrapping_key, input_lwe_dimension, polynomial_size,
+        base_log, l_gadget, grouping_factor, num_samples, lwe_idx,
+        max_shared_memory);
+    break;
+  case 2048:
+    host_bootstrap_multi_bit<Torus, Degree<2048>>(
+        v_stream, (Torus *)lwe_out, (Torus *)lut_vector,
+        (uint32_t *)lut_vector_indexes, (Torus *)lwe_in,
+        (double2 *)bootstrapping_key, input_lwe_dimension, polynomial_size,
+        base_log, l_gadget, grouping_factor, num_samples, lwe_idx,
+        max_shared_memory);
+    break;
+  case 4096:
+    host_bootstrap_multi_bit<Torus, Degree<4096>>(
+        v_stream, (Torus *)lwe_out, (Torus *)lut_vector,
+        (uint32_t *)lut_vector_indexes, (Torus *)lwe_in,
+        (double2 *)bootstrapping_key, input_lwe_dimension, polynomial_size,
+        base_log, l_gadget, grouping_factor, num_samples, lwe_idx,
+        max_shared_memory);
+    break;
+  case 8192:
+    host_bootstrap_multi_bit<Torus, Degree<8192>>(
+        v_stream, (Torus *)lwe_out, (Torus *)lut_vector,
+        (uint32_t *)lut_vector_indexes, (Torus *)lwe_in,
+        (double2 *)bootstrapping_key, input_lwe_dimension, polynomial_size,
+        base_log, l_gadget, grouping_factor, num_samples, lwe_idx,
+        max_shared_memory);
+    break;
+  default:
+    break;
+  }
+}
+
+/* Perform the bootstrap on a batch of input LWE ciphertexts of 32 bits,
+ * processing the mask elements by groups of grouping_factor
+ *
+ * Same arguments as cuda_bootstrap_amortized_lwe_ciphertext_vector_32, with
+ * a bootstrapping key converted by cuda_convert_lwe_multi_bit_bootstrap_key_32
+ * for the same grouping_factor, in [1, 3]. Each group costs the FFTs of one
+ * external product and 2^g - 1 products in the Fourier domain. The host
+ * reference is cpu_bootstrap_multi_bit_lwe_ciphertext_vector_32, whose
+ * results this matches up to the floating point rounding of the FFT.
+ * Nothing is done for other grouping factors.
+ */
+void cuda_bootstrap_multi_bit_lwe_ciphertext_vector_32(
+    void *v_stream,
+    void *lwe_out,
+    void *lut_vector,
+    void *lut_vector_indexes,
+    void *lwe_in,
+    void *bootstrapping_key,
+    uint32_t input_lwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t base_log,
+    uint32_t l_gadget,
+    uint32_t grouping_factor,
+    uint32_t num_samples,
+    uint32_t num_lut_vectors,
+    uint32_t lwe_idx,
+    uint32_t max_shared_memory) {
+  bootstrap_multi_bit<uint32_t>(
+      v_stream, lwe_out, lut_vector, lut_vector_indexes, lwe_in,
+      bootstrapping_key, input_lwe_dimension, polynomial_size, base_log,
+      l_gadget, grouping_factor, num_samples, lwe_idx, max_shared_memory);
+}
+
+/* Perform the bootstrap on a batch of input LWE ciphertexts of 64 bits,
+ * processing the mask elements by groups of grouping_factor
+ *
+ * See cuda_bootstrap_multi_bit_lwe_ciphertext_vector_32
+ */
+void cuda_bootstrap_multi_bit_lwe_ciphertext_vector_64(
+    void *v_stream,
+    void *lwe_out,
+    void *lut_vector,
+    void *lut_vector_indexes,
+    void *lwe_in,
+    void *bootstrapping_key,
+    uint32_t input_lwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t base_log,
+    uint32_t l_gadget,
+    uint32_t grouping_factor,
+    uint32_t num_samples,
+    uint32_t num_lut_vectors,
+    uint32_t lwe_idx,
+    uint32_t max_shared_memory) {
+  bootstrap_multi_bit<uint64_t>(
+      v_stream, lwe_out, lut_vector, lut_vector_indexes, lwe_in,
+      bootstrapping_key, input_lwe_dimension, polynomial_size, base_log,
+      l_gadget, grouping_factor, num_samples, lwe_idx, max_shared_memory);
+}
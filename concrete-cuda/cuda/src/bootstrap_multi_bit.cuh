@@ -0,0 +1,330 @@
+#ifdef __CDT_PARSER__
+#undef __CUDA_RUNTIME_H__
+#include <cuda_runtime.h>
+#include <helper_cuda.h>
+#endif
+
+#ifndef CNCRT_MULTI_BIT_PBS_H
+#define CNCRT_MULTI_BIT_PBS_H
+
+#include "../include/helper_cuda.h"
+#include "bootstrap.h"
+#include "complex/operations.cuh"
+#include "crypto/gadget.cuh"
+#include "crypto/torus.cuh"
+#include "fft/bnsmfft.cuh"
+#include "fft/smfft.cuh"
+#include "fft/twiddles.cuh"
+#include "polynomial/functions.cuh"
+#include "polynomial/parameters.cuh"
+#include "polynomial/polynomial.cuh"
+#include "polynomial/polynomial_math.cuh"
+#include "utils/memory.cuh"
+
+/// Largest group of mask elements handled by one iteration of the multi-bit
+/// blind rotation
+constexpr uint32_t MAX_GROUPING_FACTOR = 3;
+
+/// Value at the point j of the forward transform of X^monomial_degree: the
+/// transform of NSMFFT_direct followed by correction_direct_fft_inplace
+/// evaluates polynomials at exp(i pi (2j + 1) / N), so that the products
+/// by monomials become pointwise
+template <class params>
+__device__ inline double2 fourier_monomial(uint32_t j,
+                                           uint32_t monomial_degree) {
+  uint32_t exponent =
+      (uint64_t)(2 * j + 1) * monomial_degree % (2 * params::degree);
+  double2 monomial;
+  sincospi((double)exponent / params::degree, &monomial.y, &monomial.x);
+  return monomial;
+}
+
+/// Bytes of scratch of a block of device_bootstrap_multi_bit: the decomposed
+/// polynomial, the accumulator and its rounded copy, the FFT of the
+/// decomposed polynomial and the products of the 2^g - 1 GGSWs of a group
+template <typename Torus>
+__host__ __device__ size_t get_buffer_size_multi_bit(uint32_t glwe_dimension,
+                                                     uint32_t polynomial_size,
+                                                     uint32_t grouping_factor) {
+  size_t subset_count = (1u << grouping_factor) - 1;
+  return sizeof(int16_t) * polynomial_size +                   // decomposed
+         2 * sizeof(Torus) * (glwe_dimension + 1) * polynomial_size + // accs
+         sizeof(double2) * polynomial_size / 2 *
+             (1 + subset_count * (glwe_dimension + 1)); // fft and products
+}
+
+template <typename Torus, class params, sharedMemDegree SMD>
+/*
+ * Kernel launched by host_bootstrap_multi_bit, one block per sample, the
+ * device counterpart of blind_rotate_multi_bit_one_sample in
+ * cpu/bootstrap_multi_bit.hpp, which is its reference
+ *
+ * The mask elements are processed by groups of grouping_factor with one
+ * external product per group: the accumulator is decomposed and switched
+ * to the Fourier domain once per level and polynomial, each FFT being
+ * multiplied with the 2^g - 1 GGSWs of the group, and the accumulator gets
+ * sum_b (X^e_b - 1) * (ACC x G_b) with the monomials applied pointwise in
+ * the Fourier domain, followed by a single inverse FFT per polynomial.
+ *
+ *  - lwe_in: input ciphertexts already modulus switched to [0, 2N[ by
+ * device_modulus_switch_lwe_ciphertext_vector
+ *  - bootstrapping_key: multi-bit key converted by
+ * cuda_convert_lwe_multi_bit_bootstrap_key_64
+ *  - device_mem: scratch of get_buffer_size_multi_bit bytes per block when
+ * it does not fit in shared memory (SMD == NOSM)
+ * The other arguments are the ones of device_bootstrap_amortized.
+ */
+__global__ void device_bootstrap_multi_bit(
+    Torus *lwe_out,
+    Torus *lut_vector,
+    uint32_t *lut_vector_indexes,
+    uint16_t *lwe_in,
+    double2 *bootstrapping_key,
+    char *device_mem,
+    uint32_t lwe_mask_size,
+    uint32_t glwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t base_log,
+    uint32_t l_gadget,
+    uint32_t grouping_factor,
+    uint32_t lwe_idx,
+    size_t device_memory_size_per_sample) {
+  extern __shared__ char sharedmem[];
+  char *selected_memory;
+
+  if constexpr (SMD == FULLSM)
+    selected_memory = sharedmem;
+  else
+    selected_memory = &device_mem[blockIdx.x * device_memory_size_per_sample];
+
+  int16_t *accumulator_decomposed = (int16_t *)selected_memory;
+  Torus *accumulator = (Torus *)accumulator_decomposed +
+                       polynomial_size / (sizeof(Torus) / sizeof(int16_t));
+  Torus *accumulator_rotated =
+      (Torus *)accumulator + (ptrdiff_t)(glwe_dimension + 1) * polynomial_size;
+  double2 *accumulator_fft =
+      (double2 *)accumulator_rotated +
+      (glwe_dimension + 1) * polynomial_size /
+          (sizeof(double2) / sizeof(Torus));
+  // Products of the GGSWs of a group, (glwe_dimension + 1) polynomials per
+  // subset, the first one receiving their sum scaled by the monomials
+  double2 *subset_res_fft = accumulator_fft + polynomial_size / 2;
+
+  size_t glwe_fft_size = (size_t)(glwe_dimension + 1) * (polynomial_size / 2);
+  size_t ggsw_size = glwe_fft_size * (glwe_dimension + 1) * l_gadget;
+  uint32_t modulus = 2 * params::degree;
+
+  auto block_lwe_in = &lwe_in[blockIdx.x * (lwe_mask_size + 1)];
+  Torus *block_lut_vector =
+      lut_vector_indexes == nullptr
+          ? lut_vector
+          : &lut_vector[lut_vector_indexes[lwe_idx + blockIdx.x] *
+                        params::degree * (glwe_dimension + 1)];
+
+  GadgetMatrix<Torus, params> gadget(base_log, l_gadget);
+
+  // Put "b", the body, in [0, 2N[
+  Torus b_hat = block_lwe_in[lwe_mask_size];
+  for (int c = 0; c <= glwe_dimension; c++)
+    divide_by_monomial_negacyclic_inplace<Torus, params::opt,
+        params::degree / params::opt>(
+        &accumulator[c * params::degree],
+        &block_lut_vector[c * params::degree], b_hat, false);
+
+  double2 *group_key = bootstrapping_key;
+  for (uint32_t group_start = 0; group_start < lwe_mask_size;
+       group_start += grouping_factor) {
+    uint32_t group_size = min(grouping_factor, lwe_mask_size - group_start);
+    uint32_t subset_count = (1u << group_size) - 1;
+    double2 *current_key = group_key;
+    group_key += subset_count * ggsw_size;
+
+    // Degrees of the monomials of the subsets, in [0, 2N[, the same for all
+    // the threads so that the whole block skips the empty rotations
+    uint32_t subset_degree[1 << MAX_GROUPING_FACTOR] = {0};
+    bool rotates = false;
+    for (uint32_t i = 0; i < group_size; i++) {
+      uint32_t a_hat = block_lwe_in[group_start + i] % modulus;
+      rotates |= a_hat != 0;
+      for (uint32_t b = 1; b <= subset_count; b++)
+        if (b & (1u << i))
+          subset_degree[b] = (subset_degree[b] + a_hat) % modulus;
+    }
+    if (!rotates)
+      continue;
+
+    synchronize_threads_in_block();
+
+    // Rounded copy of the accumulator, and the products reset
+    for (int c = 0; c <= glwe_dimension; c++) {
+      int tid = threadIdx.x;
+      for (int i = 0; i < params::opt; i++) {
+        accumulator_rotated[c * params::degree + tid] =
+            accumulator[c * params::degree + tid];
+        tid += params::degree / params::opt;
+      }
+      round_to_closest_multiple_inplace<Torus, params::opt,
+          params::degree / params::opt>(
+          &accumulator_rotated[c * params::degree], base_log, l_gadget);
+    }
+    for (uint32_t p = 0; p < subset_count * (glwe_dimension + 1); p++) {
+      int pos = threadIdx.x;
+      for (int j = 0; j < params::opt / 2; j++) {
+        subset_res_fft[p * params::degree / 2 + pos].x = 0;
+        subset_res_fft[p * params::degree / 2 + pos].y = 0;
+        pos += params::degree / params::opt;
+      }
+    }
+
+    // ACC x G_b for every subset b, sharing the decomposition and the FFTs
+    for (int decomp_level = 0; decomp_level < l_gadget; decomp_level++) {
+      for (int k = 0; k <= glwe_dimension; k++) {
+        synchronize_threads_in_block();
+        gadget.decompose_one_level(accumulator_decomposed,
+                                   &accumulator_rotated[k * params::degree],
+                                   decomp_level);
+        synchronize_threads_in_block();
+        real_to_complex_compressed<int16_t, params>(accumulator_decomposed,
+                                                    accumulator_fft);
+        synchronize_threads_in_block();
+        NSMFFT_direct<HalfDegree<params>>(accumulator_fft);
+        synchronize_threads_in_block();
+        correction_direct_fft_inplace<params>(accumulator_fft);
+        synchronize_threads_in_block();
+
+        for (uint32_t b = 1; b <= subset_count; b++) {
+          double2 *bsk_row = get_ith_mask_kth_block(
+              &current_key[(b - 1) * ggsw_size], 0, k, decomp_level,
+              polynomial_size, glwe_dimension, l_gadget);
+          double2 *subset_res = &subset_res_fft[(b - 1) * glwe_fft_size];
+          for (int c = 0; c <= glwe_dimension; c++)
+            polynomial_product_accumulate_in_fourier_domain<params, double2>(
+                &subset_res[c * params::degree / 2], accumulator_fft,
+                &bsk_row[c * params::degree / 2]);
+        }
+      }
+    }
+    synchronize_threads_in_block();
+
+    // Sum of the products scaled by X^e_b - 1, pointwise: each thread reads
+    // the points it writes, so the sum goes to the products of the first
+    // subset in place
+    for (int c = 0; c <= glwe_dimension; c++) {
+      int pos = threadIdx.x;
+      for (int j = 0; j < params::opt / 2; j++) {
+        double2 sum = {0., 0.};
+        for (uint32_t b = 1; b <= subset_count; b++) {
+          if (subset_degree[b] == 0)
+            continue;
+          double2 monomial = fourier_monomial<params>(pos, subset_degree[b]);
+          monomial.x -= 1.;
+          sum += monomial * subset_res_fft[(b - 1) * glwe_fft_size +
+                                           c * params::degree / 2 + pos];
+        }
+        subset_res_fft[c * params::degree / 2 + pos] = sum;
+        pos += params::degree / params::opt;
+      }
+    }
+    synchronize_threads_in_block();
+
+    // Come back to the coefficient representation
+    for (int c = 0; c <= glwe_dimension; c++)
+      correction_inverse_fft_inplace<params>(
+          &subset_res_fft[c * params::degree / 2]);
+    synchronize_threads_in_block();
+    for (int c = 0; c <= glwe_dimension; c++)
+      NSMFFT_inverse<HalfDegree<params>>(
+          &subset_res_fft[c * params::degree / 2]);
+    synchronize_threads_in_block();
+    for (int c = 0; c <= glwe_dimension; c++)
+      add_to_torus<Torus, params>(&subset_res_fft[c * params::degree / 2],
+                                  &accumulator[c * params::degree]);
+    synchronize_threads_in_block();
+  }
+
+  auto block_lwe_out =
+      &lwe_out[blockIdx.x * (glwe_dimension * polynomial_size + 1)];
+  for (int c = 0; c < glwe_dimension; c++) {
+    sample_extract_mask<Torus, params>(&block_lwe_out[c * params::degree],
+                                       &accumulator[c * params::degree]);
+    synchronize_threads_in_block();
+  }
+  sample_extract_body<Torus, params>(
+      &block_lwe_out[(glwe_dimension - 1) * params::degree],
+      &accumulator[glwe_dimension * params::degree]);
+}
+
+/*
+ * Host wrapper of device_bootstrap_multi_bit
+ *
+ * The inputs are first modulus switched by the integer pre-pass into a
+ * temporary buffer, then one block per sample runs the multi-bit blind
+ * rotation with its scratch in shared memory when it fits in
+ * max_shared_memory, in global memory otherwise. The scratch grows with
+ * 2^grouping_factor - 1, so a grouping factor of 3 usually runs from
+ * global memory.
+ */
+template <typename Torus, class params>
+__host__ void host_bootstrap_multi_bit(
+    void *v_stream,
+    Torus *lwe_out,
+    Torus *lut_vector,
+    uint32_t *lut_vector_indexes,
+    Torus *lwe_in,
+    double2 *bootstrapping_key,
+    uint32_t input_lwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t base_log,
+    uint32_t l_gadget,
+    uint32_t grouping_factor,
+    uint32_t num_samples,
+    uint32_t lwe_idx,
+    uint32_t max_shared_memory,
+    uint32_t glwe_dimension = 1) {
+
+  auto stream = static_cast<cudaStream_t *>(v_stream);
+
+  uint16_t *lwe_in_switched;
+  checkCudaErrors(cudaMalloc((void **)&lwe_in_switched,
+                             (size_t)num_samples * (input_lwe_dimension + 1) *
+                                 sizeof(uint16_t)));
+  host_modulus_switch_lwe_ciphertext_vector<Torus>(
+      v_stream, lwe_in_switched, lwe_in, input_lwe_dimension,
+      polynomial_size, num_samples);
+
+  size_t memory_size = get_buffer_size_multi_bit<Torus>(
+      glwe_dimension, polynomial_size, grouping_factor);
+
+  dim3 grid(num_samples, 1, 1);
+  dim3 thds(polynomial_size / params::opt, 1, 1);
+
+  char *d_mem = nullptr;
+  if (max_shared_memory < memory_size) {
+    checkCudaErrors(cudaMalloc((void **)&d_mem, memory_size * num_samples));
+    device_bootstrap_multi_bit<Torus, params, NOSM>
+        <<<grid, thds, 0, *stream>>>(
+            lwe_out, lut_vector, lut_vector_indexes, lwe_in_switched,
+            bootstrapping_key, d_mem, input_lwe_dimension, glwe_dimension,
+            polynomial_size, base_log, l_gadget, grouping_factor, lwe_idx,
+            memory_size);
+  } else {
+    checkCudaErrors(cudaFuncSetAttribute(
+        device_bootstrap_multi_bit<Torus, params, FULLSM>,
+        cudaFuncAttributeMaxDynamicSharedMemorySize, memory_size));
+    checkCudaErrors(cudaFuncSetCacheConfig(
+        device_bootstrap_multi_bit<Torus, params, FULLSM>,
+        cudaFuncCachePreferShared));
+    device_bootstrap_multi_bit<Torus, params, FULLSM>
+        <<<grid, thds, memory_size, *stream>>>(
+            lwe_out, lut_vector, lut_vector_indexes, lwe_in_switched,
+            bootstrapping_key, d_mem, input_lwe_dimension, glwe_dimension,
+            polynomial_size, base_log, l_gadget, grouping_factor, lwe_idx, 0);
+  }
+  checkCudaErrors(cudaGetLastError());
+
+  cudaStreamSynchronize(*stream);
+  cudaFree(d_mem);
+  cudaFree(lwe_in_switched);
+}
+
+#endif // CNCRT_MULTI_BIT_PBS_H
@@ -2,6 +2,7 @@
 #define CNCRT_BSK_H
 
 #include "bootstrap.h"
+#include "bootstrap_multi_bit.cuh"
 #include "polynomial/parameters.cuh"
 #include "polynomial/polynomial.cuh"
 #include <atomic>
@@ -153,6 +154,58 @@ void cuda_convert_lwe_bootstrap_key_64(void *dest, void *src, void *v_stream,
                                            glwe_dim, l_gadget, polynomial_size);
 }
 
+/// Number of GGSWs of a multi-bit bootstrapping key: the mask elements are
+/// grouped by grouping_factor, the last group possibly smaller, and each
+/// group has one GGSW per non-empty subset of its elements
+inline uint32_t get_multi_bit_ggsw_count(uint32_t input_lwe_dim,
+                                         uint32_t grouping_factor) {
+  uint32_t full_groups = input_lwe_dim / grouping_factor;
+  uint32_t last_group_size = input_lwe_dim % grouping_factor;
+  return full_groups * ((1u << grouping_factor) - 1) +
+         ((1u << last_group_size) - 1);
+}
+
+/* Convert a multi-bit bootstrapping key of 32 bits to the Fourier domain
+ *
+ * src holds get_multi_bit_ggsw_count(input_lwe_dim, grouping_factor) GGSWs
+ * with the layout of the GGSWs of a regular bootstrapping key: for each
+ * group of grouping_factor mask elements, the last group possibly smaller,
+ * one GGSW per non-empty subset b of the group, b = 1 .. 2^g - 1 with the
+ * bit i of b selecting the element i, encrypting
+ * prod_{i in b} s_i * prod_{i not in b} (1 - s_i). Each GGSW is converted as
+ * by cuda_convert_lwe_bootstrap_key_32, the layout read by
+ * cuda_bootstrap_multi_bit_lwe_ciphertext_vector_32 and by
+ * cpu_convert_lwe_multi_bit_bootstrap_key_32 on the host. With
+ * grouping_factor = 1 this is the regular key. Nothing is done for
+ * grouping factors outside of [1, MAX_GROUPING_FACTOR].
+ */
+void cuda_convert_lwe_multi_bit_bootstrap_key_32(
+    void *dest, void *src, void *v_stream, uint32_t gpu_index,
+    uint32_t input_lwe_dim, uint32_t glwe_dim, uint32_t l_gadget,
+    uint32_t polynomial_size, uint32_t grouping_factor) {
+  if (grouping_factor == 0 || grouping_factor > MAX_GROUPING_FACTOR)
+    return;
+  cuda_convert_lwe_bootstrap_key<uint32_t, int32_t>(
+      (double2 *)dest, (int32_t *)src, v_stream, gpu_index,
+      get_multi_bit_ggsw_count(input_lwe_dim, grouping_factor), glwe_dim,
+      l_gadget, polynomial_size);
+}
+
+/* Convert a multi-bit bootstrapping key of 64 bits to the Fourier domain
+ *
+ * See cuda_convert_lwe_multi_bit_bootstrap_key_32
+ */
+void cuda_convert_lwe_multi_bit_bootstrap_key_64(
+    void *dest, void *src, void *v_stream, uint32_t gpu_index,
+    uint32_t input_lwe_dim, uint32_t glwe_dim, uint32_t l_gadget,
+    uint32_t polynomial_size, uint32_t grouping_factor) {
+  if (grouping_factor == 0 || grouping_factor > MAX_GROUPING_FACTOR)
+    return;
+  cuda_convert_lwe_bootstrap_key<uint64_t, int64_t>(
+      (double2 *)dest, (int64_t *)src, v_stream, gpu_index,
+      get_multi_bit_ggsw_count(input_lwe_dim, grouping_factor), glwe_dim,
+      l_gadget, polynomial_size);
+}
 
 // We need these lines so the compiler knows how to specialize these functions
 template __device__ uint64_t*
@@ -3,6 +3,7 @@
 
 #include "types/int128.cuh"
 #include <limits>
+#include <type_traits>
 
 template <typename Torus>
 __device__ inline Torus typecast_double_to_torus(double x) {
@@ -40,4 +41,66 @@ __device__ __forceinline__ T rescale_torus_element(T element,
                (double)log_shift);
 }
 
+/// Integer counterpart of rescale_torus_element for a power of two modulus:
+/// round(element * 2^log_modulus / 2^(8 * sizeof(T))) mod 2^log_modulus,
+/// with one extra bit kept before the last shift for the rounding
+template <typename T>
+__device__ __forceinline__ T modulus_switch(T element, uint32_t log_modulus) {
+  T res = (element >> (sizeof(T) * 8 - log_modulus - 1)) + 1;
+  res >>= 1;
+  return res & (((T)1 << log_modulus) - 1);
+}
+
+/*
+ * Pre-pass of the bootstraps: integer modulus switch of a batch of LWE
+ * ciphertexts to [0, 2N[ into 16 bits elements, one thread per element, the
+ * input of the bootstrap kernels instantiated with InputTorus = uint16_t.
+ * With lut_count > 1 the elements are switched to multiples of lut_count
+ * instead, as the many-LUT bootstrap needs: log_modulus - log_lut_count bits
+ * are kept and shifted back up by log_lut_count.
+ */
+template <typename Torus>
+__global__ void device_modulus_switch_lwe_ciphertext_vector(
+    uint16_t *lwe_out, Torus *lwe_in, uint64_t size, uint32_t log_modulus,
+    uint32_t log_lut_count) {
+  uint64_t i = (uint64_t)blockIdx.x * blockDim.x + threadIdx.x;
+  if (i < size)
+    lwe_out[i] = (uint16_t)(modulus_switch(lwe_in[i],
+                                           log_modulus - log_lut_count)
+                            << log_lut_count);
+}
+
+/// Enqueues device_modulus_switch_lwe_ciphertext_vector on the stream for
+/// num_samples ciphertexts of lwe_dimension + 1 elements, lwe_out being a
+/// device buffer of as many 16 bits elements
+template <typename Torus>
+__host__ void host_modulus_switch_lwe_ciphertext_vector(
+    void *v_stream, uint16_t *lwe_out, Torus *lwe_in, uint32_t lwe_dimension,
+    uint32_t polynomial_size, uint32_t num_samples, uint32_t lut_count = 1) {
+  auto stream = static_cast<cudaStream_t *>(v_stream);
+  uint64_t size = (uint64_t)num_samples * (lwe_dimension + 1);
+  uint32_t log_modulus = __builtin_ctz(2 * polynomial_size);
+  uint32_t log_lut_count = __builtin_ctz(lut_count);
+  int threads = 256;
+  int blocks = (size + threads - 1) / threads;
+  device_modulus_switch_lwe_ciphertext_vector<Torus>
+      <<<blocks, threads, 0, *stream>>>(lwe_out, lwe_in, size, log_modulus,
+                                        log_lut_count);
+  checkCudaErrors(cudaGetLastError());
+}
+
+/// Monomial degree in [0, 2N[ of an input LWE element, log_shift being 2N:
+/// compact uint16_t inputs, written by the pre-pass or by
+/// cuda_keyswitch_modulus_switched_lwe_ciphertext_vector_*, already are,
+/// while input elements of the Torus type go through the same integer
+/// modulus switch as the pre-pass
+template <typename Torus, typename InputTorus>
+__device__ __forceinline__ Torus rescale_input_element(InputTorus element,
+                                                       uint32_t log_shift) {
+  if constexpr (std::is_same<InputTorus, uint16_t>::value)
+    return (Torus)element;
+  else
+    return modulus_switch(element, __ffs(log_shift) - 1);
+}
+
 #endif // CNCRT_TORUS_H
\ No newline at end of file
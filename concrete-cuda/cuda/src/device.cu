@@ -20,6 +20,68 @@ int cuda_destroy_stream(void *v_stream, uint32_t gpu_index) {
   return 0;
 }
 
+/// Waits for all the work enqueued on the stream
+int cuda_synchronize_stream(void *v_stream, uint32_t gpu_index) {
+  cudaSetDevice(gpu_index);
+  auto stream = static_cast<cudaStream_t *>(v_stream);
+  cudaStreamSynchronize(*stream);
+  return 0;
+}
+
+/// Unsafe function to create a CUDA event, must check first that GPU exists.
+/// Timing is disabled to keep recording and waiting cheap
+void *cuda_create_event(uint32_t gpu_index) {
+  cudaSetDevice(gpu_index);
+  cudaEvent_t *event = new cudaEvent_t;
+  cudaEventCreateWithFlags(event, cudaEventDisableTiming);
+  return event;
+}
+
+/// Unsafe function to destroy a CUDA event, must check first the GPU exists
+int cuda_destroy_event(void *v_event, uint32_t gpu_index) {
+  cudaSetDevice(gpu_index);
+  auto event = static_cast<cudaEvent_t *>(v_event);
+  cudaEventDestroy(*event);
+  delete event;
+  return 0;
+}
+
+/// Records in the event all the work enqueued so far on the stream
+int cuda_record_event(void *v_event, void *v_stream, uint32_t gpu_index) {
+  cudaSetDevice(gpu_index);
+  auto event = static_cast<cudaEvent_t *>(v_event);
+  auto stream = static_cast<cudaStream_t *>(v_stream);
+  checkCudaErrors(cudaEventRecord(*event, *stream));
+  return 0;
+}
+
+/// Checks whether the work recorded in the event is done, without blocking
+/// 1: done
+/// 0: still running
+int cuda_query_event(void *v_event, uint32_t gpu_index) {
+  cudaSetDevice(gpu_index);
+  auto event = static_cast<cudaEvent_t *>(v_event);
+  return cudaEventQuery(*event) == cudaSuccess ? 1 : 0;
+}
+
+/// Blocks the host until the work recorded in the event is done
+int cuda_synchronize_event(void *v_event, uint32_t gpu_index) {
+  cudaSetDevice(gpu_index);
+  auto event = static_cast<cudaEvent_t *>(v_event);
+  checkCudaErrors(cudaEventSynchronize(*event));
+  return 0;
+}
+
+/// Makes the work enqueued afterwards on the stream wait for the work
+/// recorded in the event, without blocking the host
+int cuda_stream_wait_event(void *v_stream, void *v_event, uint32_t gpu_index) {
+  cudaSetDevice(gpu_index);
+  auto stream = static_cast<cudaStream_t *>(v_stream);
+  auto event = static_cast<cudaEvent_t *>(v_event);
+  checkCudaErrors(cudaStreamWaitEvent(*stream, *event, 0));
+  return 0;
+}
+
 /// Unsafe function that will try to allocate even if gpu_index is invalid
 /// or if there's not enough memory. A safe wrapper around it must call
 /// cuda_check_valid_malloc() first
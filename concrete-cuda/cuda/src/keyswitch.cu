@@ -52,4 +52,99 @@ void cuda_keyswitch_lwe_ciphertext_vector_64(void *v_stream, void *lwe_out, void
             num_samples);
 }
 
+/* Enqueue the keyswitch of a batch of input LWE ciphertexts for 32 bits on
+ * the stream, without waiting for it
+ *
+ * Same arguments as cuda_keyswitch_lwe_ciphertext_vector_32. Nothing is
+ * launched on the default stream and the function returns as soon as the
+ * kernel is enqueued, so that the keyswitch can overlap copies or kernels
+ * on other streams. Completion is observed with cuda_synchronize_stream or
+ * with an event recorded on v_stream (cuda_record_event).
+ */
+void cuda_keyswitch_lwe_ciphertext_vector_async_32(void *v_stream, void *lwe_out, void *lwe_in,
+                        void *ksk,
+                        uint32_t lwe_dimension_before,
+                        uint32_t lwe_dimension_after,
+                        uint32_t base_log, uint32_t l_gadget,
+                        uint32_t num_samples) {
+    cuda_keyswitch_lwe_ciphertext_vector_async(
+            v_stream, static_cast<uint32_t *>(lwe_out), static_cast<uint32_t *>(lwe_in),
+            static_cast<uint32_t*>(ksk),
+            lwe_dimension_before, lwe_dimension_after,
+            base_log, l_gadget,
+            num_samples);
+}
+
+/* Enqueue the keyswitch of a batch of input LWE ciphertexts for 64 bits on
+ * the stream, without waiting for it
+ *
+ * See cuda_keyswitch_lwe_ciphertext_vector_async_32
+ */
+void cuda_keyswitch_lwe_ciphertext_vector_async_64(void *v_stream, void *lwe_out, void *lwe_in,
+                        void *ksk,
+                        uint32_t lwe_dimension_before,
+                        uint32_t lwe_dimension_after,
+                        uint32_t base_log, uint32_t l_gadget,
+                        uint32_t num_samples) {
+    cuda_keyswitch_lwe_ciphertext_vector_async(
+            v_stream, static_cast<uint64_t *>(lwe_out), static_cast<uint64_t *> (lwe_in),
+            static_cast<uint64_t*>(ksk),
+            lwe_dimension_before, lwe_dimension_after,
+            base_log, l_gadget,
+            num_samples);
+}
 
+/* Perform keyswitch on a batch of input LWE ciphertexts for 32 bits, and
+ * modulus switch the result to the input domain of the bootstrap
+ *
+ *  - lwe_out: output batch of num_samples keyswitched ciphertexts, each
+ * element being an uint16_t in [0, 2 * polynomial_size[
+ *  - polynomial_size: size of the GLWE polynomials of the bootstrap that
+ * follows (N), the output is switched to the modulus 2N
+ *
+ * The other arguments are those of cuda_keyswitch_lwe_ciphertext_vector_32.
+ * The output is meant for
+ * cuda_bootstrap_amortized_modulus_switched_lwe_ciphertext_vector_32: it is
+ * 2 (resp. 4 for 64 bits) times smaller than a regular LWE batch and the
+ * bootstrap does not need to rescale it anymore.
+ */
+void cuda_keyswitch_modulus_switched_lwe_ciphertext_vector_32(void *v_stream, void *lwe_out, void *lwe_in,
+                        void *ksk,
+                        uint32_t lwe_dimension_before,
+                        uint32_t lwe_dimension_after,
+                        uint32_t base_log, uint32_t l_gadget,
+                        uint32_t polynomial_size,
+                        uint32_t num_samples) {
+    cuda_keyswitch_lwe_ciphertext_vector_async(
+            v_stream, static_cast<uint16_t *>(lwe_out), static_cast<uint32_t *>(lwe_in),
+            static_cast<uint32_t*>(ksk),
+            lwe_dimension_before, lwe_dimension_after,
+            base_log, l_gadget,
+            num_samples, log2(polynomial_size) + 1);
+
+    auto stream = static_cast<cudaStream_t *>(v_stream);
+    cudaStreamSynchronize(*stream);
+}
+
+/* Perform keyswitch on a batch of input LWE ciphertexts for 64 bits, and
+ * modulus switch the result to the input domain of the bootstrap
+ *
+ * See cuda_keyswitch_modulus_switched_lwe_ciphertext_vector_32
+ */
+void cuda_keyswitch_modulus_switched_lwe_ciphertext_vector_64(void *v_stream, void *lwe_out, void *lwe_in,
+                        void *ksk,
+                        uint32_t lwe_dimension_before,
+                        uint32_t lwe_dimension_after,
+                        uint32_t base_log, uint32_t l_gadget,
+                        uint32_t polynomial_size,
+                        uint32_t num_samples) {
+    cuda_keyswitch_lwe_ciphertext_vector_async(
+            v_stream, static_cast<uint16_t *>(lwe_out), static_cast<uint64_t *>(lwe_in),
+            static_cast<uint64_t*>(ksk),
+            lwe_dimension_before, lwe_dimension_after,
+            base_log, l_gadget,
+            num_samples, log2(polynomial_size) + 1);
+
+    auto stream = static_cast<cudaStream_t *>(v_stream);
+    cudaStreamSynchronize(*stream);
+}
@@ -5,6 +5,7 @@
 #include "crypto/torus.cuh"
 #include "polynomial/polynomial.cuh"
 #include <thread>
+#include <type_traits>
 #include <vector>
 
 template <typename Torus>
@@ -41,15 +42,18 @@ __device__ Torus decompose_one(Torus &state, Torus  mod_b_mask,
  * with j in [1,l] We obtain a GLWE encryption of Delta.m (with Delta the
  * scaling factor) under key s2 instead of s1, with an increased noise
  *
+ * When OutputTorus differs from Torus, the output is modulus switched to
+ * [0, 2^log_modulus[ when it is written, see modulus_switch
  */
-template <typename Torus>
-__global__ void keyswitch(Torus *lwe_out, Torus *lwe_in,
+template <typename Torus, typename OutputTorus = Torus>
+__global__ void keyswitch(OutputTorus *lwe_out, Torus *lwe_in,
                           Torus *ksk,
                           uint32_t lwe_dimension_before,
                           uint32_t lwe_dimension_after,
                           uint32_t base_log,
                           uint32_t l_gadget,
-                          int lwe_lower, int lwe_upper, int cutoff) {
+                          int lwe_lower, int lwe_upper, int cutoff,
+                          uint32_t log_modulus = 0) {
   int tid = threadIdx.x;
 
   extern __shared__ char sharedmem[];
@@ -106,19 +110,29 @@ __global__ void keyswitch(Torus *lwe_out, Torus *lwe_in,
 
   for (int k = 0; k < lwe_part_per_thd; k++) {
     int idx = tid + k * blockDim.x;
-    block_lwe_out[idx] = local_lwe_out[idx];
+    if constexpr (std::is_same<Torus, OutputTorus>::value)
+      block_lwe_out[idx] = local_lwe_out[idx];
+    else
+      block_lwe_out[idx] =
+          (OutputTorus)modulus_switch(local_lwe_out[idx], log_modulus);
   }
 }
 
 /// assume lwe_in in the gpu
-template <typename Torus>
-__host__ void cuda_keyswitch_lwe_ciphertext_vector(void *v_stream, Torus *lwe_out, Torus *lwe_in,
+/// Only enqueues work on the stream: the kernel writes every output word, so
+/// no memset of lwe_out is needed, and the caller synchronizes through the
+/// stream or an event
+/// With OutputTorus = uint16_t the output is modulus switched to
+/// [0, 2^log_modulus[
+template <typename Torus, typename OutputTorus = Torus>
+__host__ void cuda_keyswitch_lwe_ciphertext_vector_async(void *v_stream, OutputTorus *lwe_out, Torus *lwe_in,
                                    Torus *ksk,
                                    uint32_t lwe_dimension_before,
                                    uint32_t lwe_dimension_after,
                                    uint32_t base_log,
                                    uint32_t l_gadget,
-                                   uint32_t num_samples) {
+                                   uint32_t num_samples,
+                                   uint32_t log_modulus = 0) {
 
   constexpr int ideal_threads = 128;
 
@@ -136,25 +150,36 @@ __host__ void cuda_keyswitch_lwe_ciphertext_vector(void *v_stream, Torus *lwe_ou
     lwe_upper = (int)ceil((double)lwe_dim / (double)ideal_threads);
   }
 
-  int lwe_size_after =
-      (lwe_dimension_after + 1) * num_samples;
-
   int shared_mem =
       sizeof(Torus) * (lwe_dimension_after + 1);
 
-  cudaMemset(lwe_out, 0, sizeof(Torus) * lwe_size_after);
-
   dim3 grid(num_samples, 1, 1);
   dim3 threads(ideal_threads, 1, 1);
 
-  cudaFuncSetAttribute(keyswitch<Torus>,
+  cudaFuncSetAttribute(keyswitch<Torus, OutputTorus>,
                        cudaFuncAttributeMaxDynamicSharedMemorySize, shared_mem);
 
   auto stream = static_cast<cudaStream_t *>(v_stream);
-  keyswitch<<<grid, threads, shared_mem, *stream>>>(
+  keyswitch<Torus, OutputTorus><<<grid, threads, shared_mem, *stream>>>(
       lwe_out, lwe_in, ksk, lwe_dimension_before, lwe_dimension_after, base_log,
-      l_gadget, lwe_lower, lwe_upper, cutoff);
+      l_gadget, lwe_lower, lwe_upper, cutoff, log_modulus);
+}
 
+/// assume lwe_in in the gpu
+template <typename Torus>
+__host__ void cuda_keyswitch_lwe_ciphertext_vector(void *v_stream, Torus *lwe_out, Torus *lwe_in,
+                                   Torus *ksk,
+                                   uint32_t lwe_dimension_before,
+                                   uint32_t lwe_dimension_after,
+                                   uint32_t base_log,
+                                   uint32_t l_gadget,
+                                   uint32_t num_samples) {
+
+  cuda_keyswitch_lwe_ciphertext_vector_async(
+      v_stream, lwe_out, lwe_in, ksk, lwe_dimension_before, lwe_dimension_after,
+      base_log, l_gadget, num_samples);
+
+  auto stream = static_cast<cudaStream_t *>(v_stream);
   cudaStreamSynchronize(*stream);
 
 }
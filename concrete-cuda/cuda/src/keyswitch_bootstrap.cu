@@ -0,0 +1,171 @@
+#include "bootstrap_amortized.cuh"
+#include "keyswitch.cuh"
+
+#include <cstdint>
+
+/*
+ * Keyswitch followed by the amortized bootstrap of a batch, with the
+ * keyswitched ciphertexts in a buffer owned by the call
+ *
+ * The keyswitch kernel writes its output modulus switched to [0, 2N[ in 16
+ * bits words, 2 (resp. 4) times smaller than the 32 (resp. 64) bits batch,
+ * and the bootstrap kernel, instantiated for that input type, reads it
+ * right after on the same stream, the batch being small enough to mostly
+ * stay in L2. The only synchronization is the one of the bootstrap, at the
+ * end.
+ */
+template <typename Torus, class params>
+__host__ void host_keyswitch_bootstrap_amortized(
+    void *v_stream, Torus *lwe_out, Torus *lut_vector,
+    uint32_t *lut_vector_indexes, Torus *lwe_in, Torus *ksk,
+    double2 *bootstrapping_key, uint32_t input_lwe_dimension,
+    uint32_t lwe_dimension, uint32_t polynomial_size, uint32_t ks_base_log,
+    uint32_t ks_l_gadget, uint32_t pbs_base_log, uint32_t pbs_l_gadget,
+    uint32_t num_samples, uint32_t num_lut_vectors, uint32_t lwe_idx,
+    uint32_t max_shared_memory) {
+  uint16_t *lwe_switched;
+  checkCudaErrors(cudaMalloc((void **)&lwe_switched,
+                             sizeof(uint16_t) * num_samples *
+                                 (lwe_dimension + 1)));
+
+  cuda_keyswitch_lwe_ciphertext_vector_async(
+      v_stream, lwe_switched, lwe_in, ksk, input_lwe_dimension, lwe_dimension,
+      ks_base_log, ks_l_gadget, num_samples, params::log2_degree + 1);
+
+  host_bootstrap_amortized<Torus, params, uint16_t>(
+      v_stream, lwe_out, lut_vector, lut_vector_indexes, lwe_switched,
+      bootstrapping_key, lwe_dimension, polynomial_size, pbs_base_log,
+      pbs_l_gadget, num_samples, num_lut_vectors, lwe_idx, max_shared_memory);
+
+  cudaFree(lwe_switched);
+}
+
+template <typename Torus>
+void keyswitch_bootstrap_amortized(
+    void *v_stream, void *lwe_out, void *lut_vector, void *lut_vector_indexes,
+    void *lwe_in, void *ksk, void *bootstrapping_key,
+    uint32_t input_lwe_dimension, uint32_t lwe_dimension,
+    uint32_t polynomial_size, uint32_t ks_base_log, uint32_t ks_l_gadget,
+    uint32_t pbs_base_log, uint32_t pbs_l_gadget, uint32_t num_samples,
+    uint32_t num_lut_vectors, uint32_t lwe_idx, uint32_t max_shared_memory) {
+
+  switch (polynomial_size) {
+  case 512:
+    host_keyswitch_bootstrap_amortized<Torus, Degree<512>>(
+        v_stream, (Torus *)lwe_out, (Torus *)lut_vector,
+        (uint32_t *)lut_vector_indexes, (Torus *)lwe_in, (Torus *)ksk,
+        (double2 *)bootstrapping_key, input_lwe_dimension, lwe_dimension,
+        polynomial_size, ks_base_log, ks_l_gadget, pbs_base_log, pbs_l_gadget,
+        num_samples, num_lut_vectors, lwe_idx, max_shared_memory);
+    break;
+  case 1024:
+    host_keyswitch_bootstrap_amortized<Torus, Degree<1024>>(
+        v_stream, (Torus *)lwe_out, (Torus *)lut_vector,
+        (uint32_t *)lut_vector_indexes, (Torus *)lwe_in, (Torus *)ksk,
+        (double2 *)bootstrapping_key, input_lwe_dimension, lwe_dimension,
+        polynomial_size, ks_base_log, ks_l_gadget, pbs_base_log, pbs_l_gadget,
+        num_samples, num_lut_vectors, lwe_idx, max_shared_memory);
+    break;
+  case 2048:
+    host_keyswitch_bootstrap_amortized<Torus, Degree<2048>>(
+        v_stream, (Torus *)lwe_out, (Torus *)lut_vector,
+        (uint32_t *)lut_vector_indexes, (Torus *)lwe_in, (Torus *)ksk,
+        (double2 *)bootstrapping_key, input_lwe_dimension, lwe_dimension,
+        polynomial_size, ks_base_log, ks_l_gadget, pbs_base_log, pbs_l_gadget,
+        num_samples, num_lut_vectors, lwe_idx, max_shared_memory);
+    break;
+  case 4096:
+    host_keyswitch_bootstrap_amortized<Torus, Degree<4096>>(
+        v_stream, (Torus *)lwe_out, (Torus *)lut_vector,
+        (uint32_t *)lut_vector_indexes, (Torus *)lwe_in, (Torus *)ksk,
+        (double2 *)bootstrapping_key, input_lwe_dimension, lwe_dimension,
+        polynomial_size, ks_base_log, ks_l_gadget, pbs_base_log, pbs_l_gadget,
+        num_samples, num_lut_vectors, lwe_idx, max_shared_memory);
+    break;
+  case 8192:
+    host_keyswitch_bootstrap_amortized<Torus, Degree<8192>>(
+        v_stream, (Torus *)lwe_out, (Torus *)lut_vector,
+        (uint32_t *)lut_vector_indexes, (Torus *)lwe_in, (Torus *)ksk,
+        (double2 *)bootstrapping_key, input_lwe_dimension, lwe_dimension,
+        polynomial_size, ks_base_log, ks_l_gadget, pbs_base_log, pbs_l_gadget,
+        num_samples, num_lut_vectors, lwe_idx, max_shared_memory);
+    break;
+  default:
+    break;
+  }
+}
+
+/* Perform the keyswitch followed by the amortized bootstrap on a batch of
+ * input LWE ciphertexts for 32 bits
+ *
+ *  - lwe_in: num_samples LWE ciphertexts of dimension input_lwe_dimension,
+ *    keyswitched to lwe_dimension with ksk, ks_base_log and ks_l_gadget as
+ *    in cuda_keyswitch_lwe_ciphertext_vector_32
+ *  - the keyswitched ciphertexts are bootstrapped with bootstrapping_key,
+ *    pbs_base_log and pbs_l_gadget, the test vectors and lwe_out being the
+ *    ones of cuda_bootstrap_amortized_lwe_ciphertext_vector_32
+ *
+ * This replaces the pair cuda_keyswitch_lwe_ciphertext_vector_32 and
+ * cuda_bootstrap_amortized_lwe_ciphertext_vector_32: the intermediate batch
+ * is allocated and released by the call, in the modulus switched format of
+ * cuda_keyswitch_modulus_switched_lwe_ciphertext_vector_32, and the stream
+ * is synchronized once instead of twice. The host reference is
+ * cpu_keyswitch_bootstrap_amortized_lwe_ciphertext_vector_32. Nothing is
+ * done for unsupported polynomial sizes.
+ */
+void cuda_keyswitch_bootstrap_amortized_lwe_ciphertext_vector_32(
+    void *v_stream,
+    void *lwe_out,
+    void *lut_vector,
+    void *lut_vector_indexes,
+    void *lwe_in,
+    void *ksk,
+    void *bootstrapping_key,
+    uint32_t input_lwe_dimension,
+    uint32_t lwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t ks_base_log,
+    uint32_t ks_l_gadget,
+    uint32_t pbs_base_log,
+    uint32_t pbs_l_gadget,
+    uint32_t num_samples,
+    uint32_t num_lut_vectors,
+    uint32_t lwe_idx,
+    uint32_t max_shared_memory) {
+  keyswitch_bootstrap_amortized<uint32_t>(
+      v_stream, lwe_out, lut_vector, lut_vector_indexes, lwe_in, ksk,
+      bootstrapping_key, input_lwe_dimension, lwe_dimension, polynomial_size,
+      ks_base_log, ks_l_gadget, pbs_base_log, pbs_l_gadget, num_samples,
+      num_lut_vectors, lwe_idx, max_shared_memory);
+}
+
+/* Perform the keyswitch followed by the amortized bootstrap on a batch of
+ * input LWE ciphertexts for 64 bits
+ *
+ * See cuda_keyswitch_bootstrap_amortized_lwe_ciphertext_vector_32
+ */
+void cuda_keyswitch_bootstrap_amortized_lwe_ciphertext_vector_64(
+    void *v_stream,
+    void *lwe_out,
+    void *lut_vector,
+    void *lut_vector_indexes,
+    void *lwe_in,
+    void *ksk,
+    void *bootstrapping_key,
+    uint32_t input_lwe_dimension,
+    uint32_t lwe_dimension,
+    uint32_t polynomial_size,
+    uint32_t ks_base_log,
+    uint32_t ks_l_gadget,
+    uint32_t pbs_base_log,
+    uint32_t pbs_l_gadget,
+    uint32_t num_samples,
+    uint32_t num_lut_vectors,
+    uint32_t lwe_idx,
+    uint32_t max_shared_memory) {
+  keyswitch_bootstrap_amortized<uint64_t>(
+      v_stream, lwe_out, lut_vector, lut_vector_indexes, lwe_in, ksk,
+      bootstrapping_key, input_lwe_dimension, lwe_dimension, polynomial_size,
+      ks_base_log, ks_l_gadget, pbs_base_log, pbs_l_gadget, num_samples,
+      num_lut_vectors, lwe_idx, max_shared_memory);
+}
@@ -0,0 +1,143 @@
+#include "bootstrap_dispatch.h"
+#include <cassert>
+#include <cstdio>
+
+// A V100: 80 SMs of 2048 threads, 32 blocks, 96 KB of shared memory and 32
+// double precision units
+PbsDeviceProperties v100(void) {
+  PbsDeviceProperties device;
+  device.sm_count = 80;
+  device.max_threads_per_sm = 2048;
+  device.max_blocks_per_sm = 32;
+  device.shared_memory_per_sm = 96 * 1024;
+  device.fp64_units_per_sm = 32;
+  device.scratch_memory = (uint64_t)8 << 30;
+  return device;
+}
+
+// Shared memory sizes are the ones of the kernels
+void shared_memory_test(void) {
+  assert(get_pbs_threads_per_block(512) == 128);
+  assert(get_pbs_threads_per_block(1024) == 256);
+  assert(get_pbs_threads_per_block(2048) == 256);
+  assert(get_pbs_threads_per_block(8192) == 256);
+  assert(get_low_latency_pbs_shared_memory(8, 1024) == 2048 + 8192 + 8192);
+  assert(get_amortized_pbs_partial_shared_memory(1024) == 8192);
+  assert(get_amortized_pbs_shared_memory(8, 1, 1024, 0) == 0);
+  assert(get_amortized_pbs_shared_memory(8, 1, 1024, 8192) == 8192);
+  uint32_t full = get_amortized_pbs_full_shared_memory(8, 1, 1024);
+  assert(get_amortized_pbs_shared_memory(8, 1, 1024, full) == full);
+}
+
+// Small batches go to the low latency kernel and large ones to the
+// amortized kernel
+void variant_test(void) {
+  auto device = v100();
+  uint32_t shm = 48 * 1024;
+  PbsPlan small = plan_bootstrap(device, 8, 600, 1, 1024, 3, 1, shm);
+  assert(small.variant == PBS_LOW_LATENCY);
+  assert(small.chunk_size == 1);
+  PbsPlan large = plan_bootstrap(device, 8, 600, 1, 1024, 3, 10000, shm);
+  assert(large.variant == PBS_AMORTIZED);
+  assert(large.chunk_size == 10000);
+
+  // The low latency kernel only supports k = 1 and needs shared memory
+  assert(plan_bootstrap(device, 8, 600, 2, 1024, 3, 1, shm).variant ==
+         PBS_AMORTIZED);
+  assert(plan_bootstrap(device, 8, 600, 1, 1024, 3, 1, 1024).variant ==
+         PBS_AMORTIZED);
+}
+
+// The low latency launches never exceed the cooperative residency
+void low_latency_chunk_test(void) {
+  auto device = v100();
+  uint32_t shm = 48 * 1024;
+  for (uint32_t l_gadget : {1u, 3u, 7u}) {
+    uint32_t max_samples =
+        get_low_latency_pbs_max_samples(device, 8, 1, 1024, l_gadget, shm);
+    assert(max_samples > 0);
+    for (uint32_t num_samples = 1; num_samples < 4 * max_samples;
+         num_samples += 7) {
+      PbsPlan plan = plan_bootstrap(device, 8, 600, 1, 1024, l_gadget,
+                                    num_samples, shm);
+      if (plan.variant == PBS_LOW_LATENCY)
+        assert(plan.chunk_size <= max_samples &&
+               plan.chunk_size <= num_samples);
+    }
+  }
+}
+
+// Low latency batches are split in the fewest launches that fit, of
+// balanced sizes
+void low_latency_split_test(void) {
+  PbsChunks chunks = plan_low_latency_pbs_chunks(480, 1, 3, 80);
+  assert(chunks.num_chunks == 1 && chunks.chunk_size == 80);
+  chunks = plan_low_latency_pbs_chunks(480, 1, 3, 81);
+  assert(chunks.num_chunks == 2 && chunks.chunk_size == 41);
+  chunks = plan_low_latency_pbs_chunks(480, 1, 3, 0);
+  assert(chunks.num_chunks == 0);
+  chunks = plan_low_latency_pbs_chunks(5, 1, 3, 10);
+  assert(chunks.num_chunks == 0);
+  for (uint32_t resident_blocks : {6u, 100u, 1280u})
+    for (uint32_t num_samples = 1; num_samples < 1000; num_samples += 11) {
+      chunks = plan_low_latency_pbs_chunks(resident_blocks, 1, 3, num_samples);
+      uint32_t max_samples = resident_blocks / 6;
+      assert(chunks.chunk_size <= max_samples);
+      assert(chunks.num_chunks == (num_samples + max_samples - 1) / max_samples);
+      assert(chunks.num_chunks * chunks.chunk_size >= num_samples);
+      assert((chunks.num_chunks - 1) * chunks.chunk_size < num_samples);
+    }
+}
+
+// Without shared memory the amortized batch is split in whole waves whose
+// scratch fits
+void amortized_chunk_test(void) {
+  auto device = v100();
+  uint32_t full = get_amortized_pbs_full_shared_memory(8, 1, 2048);
+  uint32_t residency = get_amortized_pbs_residency(device, 8, 1, 2048, 0);
+  device.scratch_memory = (uint64_t)full * (3 * residency + 5);
+  PbsPlan plan = plan_bootstrap(device, 8, 600, 1, 2048, 3, 100000, 0);
+  assert(plan.variant == PBS_AMORTIZED);
+  assert(plan.chunk_size == 3 * residency);
+  assert((uint64_t)plan.chunk_size * full <= device.scratch_memory);
+
+  // With its buffers in shared memory it takes the whole batch
+  full = get_amortized_pbs_full_shared_memory(8, 1, 1024);
+  plan = plan_bootstrap(device, 8, 600, 1, 1024, 3, 100000, full);
+  assert(plan.variant == PBS_AMORTIZED && plan.chunk_size == 100000);
+}
+
+// The estimates grow with the batch
+void monotonic_test(void) {
+  auto device = v100();
+  uint32_t shm = 48 * 1024;
+  uint32_t residency = get_amortized_pbs_residency(device, 8, 1, 1024, shm);
+  uint32_t max_samples =
+      get_low_latency_pbs_max_samples(device, 8, 1, 1024, 3, shm);
+  double amortized = 0, low_latency = 0, best = 0;
+  for (uint32_t num_samples = 1; num_samples < 5000; num_samples += 13) {
+    double a = estimate_amortized_pbs_cycles(device, residency, 600, 1, 1024,
+                                             3, num_samples, num_samples);
+    double b = estimate_low_latency_pbs_cycles(device, 600, 1, 1024, 3,
+                                               num_samples, max_samples);
+    double c =
+        plan_bootstrap(device, 8, 600, 1, 1024, 3, num_samples, shm)
+            .estimated_cycles;
+    assert(a >= amortized && b >= low_latency && c >= best);
+    assert(c <= a && c <= b);
+    amortized = a;
+    low_latency = b;
+    best = c;
+  }
+}
+
+int main(void) {
+  shared_memory_test();
+  variant_test();
+  low_latency_chunk_test();
+  low_latency_split_test();
+  amortized_chunk_test();
+  monotonic_test();
+  printf("test_bootstrap_dispatch: OK\n");
+  return 0;
+}
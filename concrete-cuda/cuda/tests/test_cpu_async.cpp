@@ -0,0 +1,123 @@
+#include "device.h"
+#include "keyswitch.h"
+#include "keyswitch.hpp"
+#include "utils/host_stream.hpp"
+#include <atomic>
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+
+#include "utils.h"
+
+// Copy then keyswitch on the same stream, observed through an event
+void keyswitch_async_test_64(void) {
+  uint32_t lwe_dimension_before = 630, lwe_dimension_after = 513;
+  uint32_t base_log = 3, l_gadget = 5, num_samples = 20;
+  auto ksk = random_torus_vector<uint64_t>((size_t)lwe_dimension_before *
+                                           l_gadget * (lwe_dimension_after + 1));
+  auto lwe_in =
+      random_torus_vector<uint64_t>(num_samples * (lwe_dimension_before + 1));
+  std::vector<uint64_t> staged(lwe_in.size());
+  std::vector<uint64_t> lwe_out(num_samples * (lwe_dimension_after + 1));
+  std::vector<uint64_t> expected(lwe_out.size());
+  cpu_keyswitch_lwe_ciphertext_vector_64(
+      nullptr, expected.data(), lwe_in.data(), ksk.data(), lwe_dimension_before,
+      lwe_dimension_after, base_log, l_gadget, num_samples);
+
+  void *stream = cpu_create_stream();
+  void *event = cpu_create_event();
+  assert(cpu_query_event(event) == 1);
+  assert(cpu_memcpy_async(staged.data(), lwe_in.data(),
+                          lwe_in.size() * sizeof(uint64_t), stream) == 0);
+  cpu_keyswitch_lwe_ciphertext_vector_async_64(
+      stream, lwe_out.data(), staged.data(), ksk.data(), lwe_dimension_before,
+      lwe_dimension_after, base_log, l_gadget, num_samples);
+  cpu_record_event(event, stream);
+  cpu_synchronize_event(event);
+  assert(cpu_query_event(event) == 1);
+  assert(lwe_out == expected);
+
+  // Same on the 32 bits entry point, observed through the stream
+  std::vector<uint32_t> ksk_32(ksk.begin(), ksk.end());
+  std::vector<uint32_t> lwe_in_32(lwe_in.begin(), lwe_in.end());
+  std::vector<uint32_t> lwe_out_32(lwe_out.size()), expected_32(lwe_out.size());
+  cpu_keyswitch_lwe_ciphertext_vector_32(
+      nullptr, expected_32.data(), lwe_in_32.data(), ksk_32.data(),
+      lwe_dimension_before, lwe_dimension_after, base_log, l_gadget,
+      num_samples);
+  cpu_keyswitch_lwe_ciphertext_vector_async_32(
+      stream, lwe_out_32.data(), lwe_in_32.data(), ksk_32.data(),
+      lwe_dimension_before, lwe_dimension_after, base_log, l_gadget,
+      num_samples);
+  cpu_synchronize_stream(stream);
+  assert(lwe_out_32 == expected_32);
+
+  cpu_destroy_event(event);
+  cpu_destroy_stream(stream);
+}
+
+// Work on stream B waiting for an event of stream A does not start before
+// the work of A is done, and the caller is never blocked meanwhile
+void stream_wait_event_test(void) {
+  std::atomic<bool> release(false);
+  uint64_t source = 42, copy = 0;
+  void *stream_a = cpu_create_stream();
+  void *stream_b = cpu_create_stream();
+  void *event_a = cpu_create_event();
+  void *event_b = cpu_create_event();
+
+  static_cast<HostStream *>(stream_a)->enqueue([&] {
+    while (!release)
+      std::this_thread::yield();
+  });
+  cpu_record_event(event_a, stream_a);
+  cpu_stream_wait_event(stream_b, event_a);
+  cpu_memcpy_async(&copy, &source, sizeof(source), stream_b);
+  cpu_record_event(event_b, stream_b);
+
+  assert(cpu_query_event(event_a) == 0);
+  assert(cpu_query_event(event_b) == 0);
+  assert(copy == 0);
+  release = true;
+  cpu_synchronize_event(event_b);
+  assert(cpu_query_event(event_a) == 1);
+  assert(copy == 42);
+
+  cpu_destroy_event(event_a);
+  cpu_destroy_event(event_b);
+  cpu_destroy_stream(stream_a);
+  cpu_destroy_stream(stream_b);
+}
+
+// An event may be destroyed while a wait for it is still queued on another
+// stream
+void destroy_waited_event_test(void) {
+  std::atomic<bool> release(false);
+  uint64_t source = 7, copy = 0;
+  void *stream_a = cpu_create_stream();
+  void *stream_b = cpu_create_stream();
+  void *event = cpu_create_event();
+
+  cpu_record_event(event, stream_a);
+  cpu_synchronize_stream(stream_a);
+  static_cast<HostStream *>(stream_b)->enqueue([&] {
+    while (!release)
+      std::this_thread::yield();
+  });
+  cpu_stream_wait_event(stream_b, event);
+  cpu_memcpy_async(&copy, &source, sizeof(source), stream_b);
+  cpu_destroy_event(event);
+  release = true;
+  cpu_synchronize_stream(stream_b);
+  assert(copy == 7);
+
+  cpu_destroy_stream(stream_a);
+  cpu_destroy_stream(stream_b);
+}
+
+int main(void) {
+  keyswitch_async_test_64();
+  stream_wait_event_test();
+  destroy_waited_event_test();
+  return EXIT_SUCCESS;
+}
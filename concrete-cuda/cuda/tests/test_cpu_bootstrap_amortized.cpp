@@ -0,0 +1,173 @@
+#include "bootstrap.h"
+#include "bootstrap_amortized.hpp"
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#include "utils.h"
+
+// The inverse FFT undoes the forward one, at every SIMD level
+void fft_roundtrip_test(void) {
+  for (uint32_t polynomial_size : {512u, 1024u, 4096u}) {
+    auto &fft = NegacyclicFFT::get(polynomial_size);
+    uint32_t fft_size = polynomial_size / 2;
+    std::vector<double2> input(fft_size);
+    for (auto &c : input)
+      c = {(double)(int64_t)get_test_rng()() / std::ldexp(1., 63),
+           (double)(int64_t)get_test_rng()() / std::ldexp(1., 63)};
+    std::vector<double2> reference = input;
+    fft.forward(reference.data(), SCALAR);
+    for (int level = SCALAR; level <= get_simd_level(); level++) {
+      std::vector<double2> A = input;
+      fft.forward(A.data(), (SimdLevel)level);
+      for (uint32_t j = 0; j < fft_size; j++) {
+        assert(std::fabs(A[j].x - reference[j].x) < 1e-9);
+        assert(std::fabs(A[j].y - reference[j].y) < 1e-9);
+      }
+      fft.inverse(A.data(), (SimdLevel)level);
+      for (uint32_t j = 0; j < fft_size; j++) {
+        assert(std::fabs(A[j].x - input[j].x) < 1e-12);
+        assert(std::fabs(A[j].y - input[j].y) < 1e-12);
+      }
+    }
+  }
+}
+
+// The product of a decomposed polynomial with a key polynomial converted as
+// the bootstrapping key is the negacyclic product, up to the FFT precision
+// and to the normalization of the key by the maximum of Torus instead of
+// 2^32 or 2^64, which scales the unreduced product
+template <typename Torus, typename STorus>
+void fft_negacyclic_product_test(Torus tolerance) {
+  uint32_t polynomial_size = 1024, fft_size = polynomial_size / 2;
+  auto &fft = NegacyclicFFT::get(polynomial_size);
+  std::vector<int16_t> digits(polynomial_size);
+  std::vector<Torus> digits_torus(polynomial_size);
+  for (uint32_t j = 0; j < polynomial_size; j++) {
+    digits[j] = (int16_t)(get_test_rng()() % 128) - 64;
+    digits_torus[j] = (Torus)(int64_t)digits[j];
+  }
+  auto key = random_torus_vector<Torus>(polynomial_size);
+
+  std::vector<double2> key_fft(fft_size);
+  cpu_convert_lwe_bootstrap_key<Torus, STorus>(
+      key_fft.data(), (STorus *)key.data(), 1, 0, 1, polynomial_size);
+  std::vector<Torus> expected(polynomial_size, 0);
+  add_negacyclic_product(expected.data(), digits_torus.data(), key.data(),
+                         polynomial_size);
+
+  for (int level = SCALAR; level <= get_simd_level(); level++) {
+    std::vector<double2> digits_fft(fft_size), product(fft_size, {0., 0.});
+    real_to_complex_compressed(digits_fft.data(), digits.data(),
+                               polynomial_size);
+    fft.forward(digits_fft.data(), (SimdLevel)level);
+    polynomial_product_accumulate_in_fourier_domain(
+        product.data(), digits_fft.data(), key_fft.data(), fft_size,
+        (SimdLevel)level);
+    fft.inverse(product.data(), (SimdLevel)level);
+    std::vector<Torus> result(polynomial_size, 0);
+    add_to_torus(product.data(), result.data(), polynomial_size);
+    for (uint32_t j = 0; j < polynomial_size; j++) {
+      Torus diff = result[j] - expected[j];
+      assert(diff <= tolerance || (Torus)-diff <= tolerance);
+    }
+  }
+}
+
+uint64_t identity(uint64_t m) { return m; }
+uint64_t affine(uint64_t m) { return (3 * m + 1) % (1 << MESSAGE_BITS); }
+
+// The bootstrap evaluates the test vector selected for each ciphertext
+template <typename Torus>
+void bootstrap_amortized_test(
+    void (*convert)(void *, void *, void *, uint32_t, uint32_t, uint32_t,
+                    uint32_t, uint32_t),
+    void (*bootstrap)(void *, void *, void *, void *, void *, void *, uint32_t,
+                      uint32_t, uint32_t, uint32_t, uint32_t, uint32_t,
+                      uint32_t, uint32_t),
+    uint32_t base_log, uint32_t l_gadget, double log_std) {
+  uint32_t input_lwe_dimension = 400, polynomial_size = 1024;
+  uint32_t num_samples = 24, num_lut_vectors = 2, lwe_idx = 3;
+  auto lwe_key = generate_lwe_secret_key<Torus>(input_lwe_dimension);
+  auto glwe_key = generate_lwe_secret_key<Torus>(polynomial_size);
+  auto bsk = generate_lwe_bootstrap_key<Torus>(
+      lwe_key, glwe_key, 1, polynomial_size, base_log, l_gadget, log_std);
+  std::vector<double2> fourier_bsk(bsk.size() / 2);
+  convert(fourier_bsk.data(), bsk.data(), nullptr, 0, input_lwe_dimension, 1,
+          l_gadget, polynomial_size);
+
+  std::vector<Torus> lut_vector(num_lut_vectors * 2 * polynomial_size);
+  fill_test_vector(lut_vector.data(), polynomial_size, identity);
+  fill_test_vector(&lut_vector[2 * polynomial_size], polynomial_size, affine);
+  std::vector<uint32_t> lut_vector_indexes(lwe_idx + num_samples, 0);
+  std::vector<Torus> lwe_in(num_samples * (input_lwe_dimension + 1));
+  std::vector<uint64_t> messages(num_samples);
+  for (uint32_t s = 0; s < num_samples; s++) {
+    lut_vector_indexes[lwe_idx + s] = s % num_lut_vectors;
+    messages[s] = get_test_rng()() % (1 << MESSAGE_BITS);
+    encrypt_lwe<Torus>(&lwe_in[s * (input_lwe_dimension + 1)], lwe_key,
+                       encode<Torus>(messages[s]), log_std);
+  }
+
+  std::vector<Torus> lwe_out(num_samples * (polynomial_size + 1));
+  bootstrap(nullptr, lwe_out.data(), lut_vector.data(),
+            lut_vector_indexes.data(), lwe_in.data(), fourier_bsk.data(),
+            input_lwe_dimension, polynomial_size, base_log, l_gadget,
+            num_samples, num_lut_vectors, lwe_idx, 0);
+  for (uint32_t s = 0; s < num_samples; s++) {
+    uint64_t expected = s % num_lut_vectors ? affine(messages[s]) : messages[s];
+    Torus plaintext =
+        decrypt_lwe(&lwe_out[s * (polynomial_size + 1)], glwe_key);
+    assert(decode(plaintext) == expected);
+  }
+}
+
+// Bootstrapping ciphertexts switched beforehand to [0, 2N[ gives the same
+// result as switching them inside the bootstrap
+void bootstrap_amortized_modulus_switched_test(void) {
+  uint32_t input_lwe_dimension = 100, polynomial_size = 512;
+  uint32_t base_log = 6, l_gadget = 3, num_samples = 8;
+  auto bsk = random_torus_vector<uint32_t>(
+      (size_t)input_lwe_dimension * l_gadget * 4 * polynomial_size);
+  std::vector<double2> fourier_bsk(bsk.size() / 2);
+  cpu_convert_lwe_bootstrap_key_32(fourier_bsk.data(), bsk.data(), nullptr, 0,
+                                   input_lwe_dimension, 1, l_gadget,
+                                   polynomial_size);
+  auto lut_vector = random_torus_vector<uint32_t>(2 * polynomial_size);
+  std::vector<uint32_t> lut_vector_indexes(num_samples, 0);
+  auto lwe_in =
+      random_torus_vector<uint32_t>(num_samples * (input_lwe_dimension + 1));
+  std::vector<uint16_t> lwe_in_switched(lwe_in.size());
+  for (size_t k = 0; k < lwe_in.size(); k++)
+    lwe_in_switched[k] =
+        modulus_switch(lwe_in[k], __builtin_ctz(2 * polynomial_size));
+
+  std::vector<uint32_t> lwe_out(num_samples * (polynomial_size + 1));
+  std::vector<uint32_t> lwe_out_switched(lwe_out.size());
+  cpu_bootstrap_amortized_lwe_ciphertext_vector_32(
+      nullptr, lwe_out.data(), lut_vector.data(), lut_vector_indexes.data(),
+      lwe_in.data(), fourier_bsk.data(), input_lwe_dimension, polynomial_size,
+      base_log, l_gadget, num_samples, 1, 0, 0);
+  cpu_bootstrap_amortized_modulus_switched_lwe_ciphertext_vector_32(
+      nullptr, lwe_out_switched.data(), lut_vector.data(),
+      lut_vector_indexes.data(), lwe_in_switched.data(), fourier_bsk.data(),
+      input_lwe_dimension, polynomial_size, base_log, l_gadget, num_samples, 1,
+      0, 0);
+  assert(lwe_out == lwe_out_switched);
+}
+
+int main(void) {
+  fft_roundtrip_test();
+  fft_negacyclic_product_test<uint32_t, int32_t>(1 << 12);
+  fft_negacyclic_product_test<uint64_t, int64_t>((uint64_t)1 << 26);
+  bootstrap_amortized_test<uint32_t>(
+      cpu_convert_lwe_bootstrap_key_32,
+      cpu_bootstrap_amortized_lwe_ciphertext_vector_32, 6, 3, -25);
+  bootstrap_amortized_test<uint64_t>(
+      cpu_convert_lwe_bootstrap_key_64,
+      cpu_bootstrap_amortized_lwe_ciphertext_vector_64, 7, 3, -40);
+  bootstrap_amortized_modulus_switched_test();
+  printf("test_cpu_bootstrap_amortized: OK\n");
+  return 0;
+}
@@ -0,0 +1,105 @@
+#include "bootstrap.h"
+#include "bootstrap_amortized.hpp"
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+
+#include "utils.h"
+
+// The batched FFT transforms each polynomial as forward does
+void forward_batch_test(void) {
+  for (uint32_t polynomial_size : {512u, 2048u}) {
+    auto &fft = NegacyclicFFT::get(polynomial_size);
+    uint32_t fft_size = polynomial_size / 2, count = 6;
+    std::vector<double2> input(count * fft_size);
+    for (auto &c : input)
+      c = {(double)(int16_t)get_test_rng()(), (double)(int16_t)get_test_rng()()};
+    for (int level = SCALAR; level <= get_simd_level(); level++) {
+      std::vector<double2> expected = input, batch = input;
+      for (uint32_t p = 0; p < count; p++)
+        fft.forward(&expected[p * fft_size], (SimdLevel)level);
+      fft.forward_batch(batch.data(), count, (SimdLevel)level);
+      for (size_t j = 0; j < batch.size(); j++)
+        assert(batch[j].x == expected[j].x && batch[j].y == expected[j].y);
+    }
+  }
+}
+
+// The fused vector-matrix product is the sum of the products in the order
+// of add_external_product, bit for bit
+void vector_matrix_product_test(void) {
+  uint32_t num_rows = 6, num_columns = 3, size = 258;
+  auto random_complex = [] {
+    return double2{(double)(int64_t)get_test_rng()() / std::ldexp(1., 40),
+                   (double)(int64_t)get_test_rng()() / std::ldexp(1., 40)};
+  };
+  std::vector<double2> vector(num_rows * size), matrix(num_rows * num_columns *
+                                                       size);
+  for (auto &c : vector)
+    c = random_complex();
+  for (auto &c : matrix)
+    c = random_complex();
+  for (int level = SCALAR; level <= get_simd_level(); level++) {
+    std::vector<double2> expected(num_columns * size, {0., 0.});
+    for (uint32_t r = 0; r < num_rows; r++)
+      for (uint32_t c = 0; c < num_columns; c++)
+        polynomial_product_accumulate_in_fourier_domain(
+            &expected[c * size], &vector[r * size],
+            &matrix[(r * num_columns + c) * size], size, (SimdLevel)level);
+    std::vector<double2> result(num_columns * size);
+    polynomial_vector_matrix_product_in_fourier_domain(
+        result.data(), vector.data(), matrix.data(), num_rows, num_columns,
+        size, (SimdLevel)level);
+    for (size_t j = 0; j < result.size(); j++)
+      assert(result[j].x == expected[j].x && result[j].y == expected[j].y);
+  }
+}
+
+// The bootstrap with batched FFTs gives the results of the amortized
+// bootstrap, for any GLWE dimension
+template <typename Torus>
+void bootstrap_batched_fft_test(uint32_t glwe_dimension, uint32_t base_log,
+                                uint32_t l_gadget) {
+  uint32_t input_lwe_dimension = 100, polynomial_size = 1024;
+  uint32_t num_samples = 5;
+  size_t glwe_size = (glwe_dimension + 1) * polynomial_size;
+  auto bsk = random_torus_vector<Torus>((size_t)input_lwe_dimension *
+                                        l_gadget * glwe_size *
+                                        (glwe_dimension + 1));
+  std::vector<double2> fourier_bsk(bsk.size() / 2);
+  cpu_convert_lwe_bootstrap_key<Torus, typename std::make_signed<Torus>::type>(
+      fourier_bsk.data(),
+      (typename std::make_signed<Torus>::type *)bsk.data(),
+      input_lwe_dimension, glwe_dimension, l_gadget, polynomial_size);
+  auto lut_vector = random_torus_vector<Torus>(glwe_size);
+  std::vector<uint32_t> lut_vector_indexes(num_samples, 0);
+  auto lwe_in =
+      random_torus_vector<Torus>(num_samples * (input_lwe_dimension + 1));
+
+  size_t lwe_size = glwe_dimension * polynomial_size + 1;
+  for (int level = SCALAR; level <= get_simd_level(); level++) {
+    std::vector<Torus> expected(num_samples * lwe_size);
+    std::vector<Torus> lwe_out(num_samples * lwe_size);
+    cpu_bootstrap_amortized_lwe_ciphertext_vector<Torus>(
+        expected.data(), lut_vector.data(), lut_vector_indexes.data(),
+        lwe_in.data(), fourier_bsk.data(), input_lwe_dimension,
+        polynomial_size, base_log, l_gadget, num_samples, 0, glwe_dimension,
+        ThreadPool::global(), (SimdLevel)level);
+    cpu_bootstrap_amortized_lwe_ciphertext_vector<Torus>(
+        lwe_out.data(), lut_vector.data(), lut_vector_indexes.data(),
+        lwe_in.data(), fourier_bsk.data(), input_lwe_dimension,
+        polynomial_size, base_log, l_gadget, num_samples, 0, glwe_dimension,
+        ThreadPool::global(), (SimdLevel)level, true);
+    assert(lwe_out == expected);
+  }
+}
+
+int main(void) {
+  forward_batch_test();
+  vector_matrix_product_test();
+  bootstrap_batched_fft_test<uint32_t>(1, 6, 3);
+  bootstrap_batched_fft_test<uint64_t>(1, 7, 3);
+  bootstrap_batched_fft_test<uint64_t>(2, 7, 2);
+  printf("test_cpu_bootstrap_batched_fft: OK\n");
+  return 0;
+}
@@ -0,0 +1,138 @@
+#include "bootstrap.h"
+#include "bootstrap_amortized.hpp"
+#include "bootstrap_multi_bit.hpp"
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+
+#include "utils.h"
+
+uint64_t triple(uint64_t m) { return (3 * m) % (1 << MESSAGE_BITS); }
+
+// With glwe_dimension = 1 the bootstrap is the one of the cuda ABI
+void bootstrap_glwe_dimension_one_test(void) {
+  uint32_t input_lwe_dimension = 100, polynomial_size = 512;
+  uint32_t base_log = 6, l_gadget = 3, num_samples = 8;
+  auto bsk = random_torus_vector<uint64_t>(
+      (size_t)input_lwe_dimension * l_gadget * 4 * polynomial_size);
+  std::vector<double2> fourier_bsk(bsk.size() / 2);
+  cpu_convert_lwe_bootstrap_key_64(fourier_bsk.data(), bsk.data(), nullptr, 0,
+                                   input_lwe_dimension, 1, l_gadget,
+                                   polynomial_size);
+  auto lut_vector = random_torus_vector<uint64_t>(2 * polynomial_size);
+  std::vector<uint32_t> lut_vector_indexes(num_samples, 0);
+  auto lwe_in =
+      random_torus_vector<uint64_t>(num_samples * (input_lwe_dimension + 1));
+
+  std::vector<uint64_t> lwe_out(num_samples * (polynomial_size + 1));
+  std::vector<uint64_t> lwe_out_generic(lwe_out.size());
+  cpu_bootstrap_amortized_lwe_ciphertext_vector_64(
+      nullptr, lwe_out.data(), lut_vector.data(), lut_vector_indexes.data(),
+      lwe_in.data(), fourier_bsk.data(), input_lwe_dimension, polynomial_size,
+      base_log, l_gadget, num_samples, 1, 0, 0);
+  cpu_bootstrap_amortized_lwe_ciphertext_vector_with_glwe_dimension_64(
+      nullptr, lwe_out_generic.data(), lut_vector.data(),
+      lut_vector_indexes.data(), lwe_in.data(), fourier_bsk.data(),
+      input_lwe_dimension, 1, polynomial_size, base_log, l_gadget, num_samples,
+      1, 0, 0);
+  assert(lwe_out == lwe_out_generic);
+}
+
+// The output decrypts under the GLWE key seen as an LWE key of dimension
+// k * N, with the engine under test and with the multi-bit one
+template <typename Torus>
+void bootstrap_glwe_dimension_test(
+    void (*convert)(void *, void *, void *, uint32_t, uint32_t, uint32_t,
+                    uint32_t, uint32_t),
+    void (*bootstrap)(void *, void *, void *, void *, void *, void *, uint32_t,
+                      uint32_t, uint32_t, uint32_t, uint32_t, uint32_t,
+                      uint32_t, uint32_t, uint32_t),
+    uint32_t glwe_dimension, uint32_t polynomial_size, uint32_t base_log,
+    uint32_t l_gadget, double log_std) {
+  uint32_t input_lwe_dimension = 400, num_samples = 16;
+  uint32_t glwe_size = (glwe_dimension + 1) * polynomial_size;
+  uint32_t lwe_dimension_out = glwe_dimension * polynomial_size;
+  auto lwe_key = generate_lwe_secret_key<Torus>(input_lwe_dimension);
+  auto glwe_key = generate_lwe_secret_key<Torus>(lwe_dimension_out);
+  auto bsk = generate_lwe_bootstrap_key<Torus>(lwe_key, glwe_key,
+                                               glwe_dimension, polynomial_size,
+                                               base_log, l_gadget, log_std);
+  std::vector<double2> fourier_bsk(bsk.size() / 2);
+  convert(fourier_bsk.data(), bsk.data(), nullptr, 0, input_lwe_dimension,
+          glwe_dimension, l_gadget, polynomial_size);
+
+  // One test vector per ciphertext, as the low latency engines read them,
+  // the others being sent to the first one by the indexes
+  std::vector<Torus> lut_vector(num_samples * glwe_size);
+  for (uint32_t s = 0; s < num_samples; s++)
+    fill_test_vector(&lut_vector[s * glwe_size], polynomial_size, triple,
+                     glwe_dimension);
+  std::vector<uint32_t> lut_vector_indexes(num_samples, 0);
+  std::vector<Torus> lwe_in(num_samples * (input_lwe_dimension + 1));
+  std::vector<uint64_t> messages(num_samples);
+  for (uint32_t s = 0; s < num_samples; s++) {
+    messages[s] = get_test_rng()() % (1 << MESSAGE_BITS);
+    encrypt_lwe<Torus>(&lwe_in[s * (input_lwe_dimension + 1)], lwe_key,
+                       encode<Torus>(messages[s]), log_std);
+  }
+
+  std::vector<Torus> lwe_out(num_samples * (lwe_dimension_out + 1));
+  bootstrap(nullptr, lwe_out.data(), lut_vector.data(),
+            lut_vector_indexes.data(), lwe_in.data(), fourier_bsk.data(),
+            input_lwe_dimension, glwe_dimension, polynomial_size, base_log,
+            l_gadget, num_samples, 1, 0, 0);
+  for (uint32_t s = 0; s < num_samples; s++) {
+    Torus plaintext =
+        decrypt_lwe(&lwe_out[s * (lwe_dimension_out + 1)], glwe_key);
+    assert(decode(plaintext) == triple(messages[s]));
+  }
+
+  // Multi-bit blind rotation with pairs of mask elements
+  uint32_t grouping_factor = 2;
+  auto multi_bit_bsk = generate_lwe_multi_bit_bootstrap_key<Torus>(
+      lwe_key, glwe_key, glwe_dimension, polynomial_size, base_log, l_gadget,
+      grouping_factor, log_std);
+  std::vector<double2> fourier_multi_bit_bsk(multi_bit_bsk.size() / 2);
+  cpu_convert_lwe_bootstrap_key<Torus, std::make_signed_t<Torus>>(
+      fourier_multi_bit_bsk.data(),
+      (std::make_signed_t<Torus> *)multi_bit_bsk.data(),
+      get_multi_bit_ggsw_count(input_lwe_dimension, grouping_factor),
+      glwe_dimension, l_gadget, polynomial_size);
+  std::fill(lwe_out.begin(), lwe_out.end(), 0);
+  cpu_bootstrap_multi_bit_lwe_ciphertext_vector<Torus>(
+      lwe_out.data(), lut_vector.data(), lut_vector_indexes.data(),
+      lwe_in.data(), fourier_multi_bit_bsk.data(), input_lwe_dimension,
+      polynomial_size, base_log, l_gadget, grouping_factor, num_samples, 0,
+      glwe_dimension);
+  for (uint32_t s = 0; s < num_samples; s++) {
+    Torus plaintext =
+        decrypt_lwe(&lwe_out[s * (lwe_dimension_out + 1)], glwe_key);
+    assert(decode(plaintext) == triple(messages[s]));
+  }
+}
+
+int main(void) {
+  bootstrap_glwe_dimension_one_test();
+  bootstrap_glwe_dimension_test<uint64_t>(
+      cpu_convert_lwe_bootstrap_key_64,
+      cpu_bootstrap_amortized_lwe_ciphertext_vector_with_glwe_dimension_64, 2,
+      512, 7, 3, -40);
+  bootstrap_glwe_dimension_test<uint64_t>(
+      cpu_convert_lwe_bootstrap_key_64,
+      cpu_bootstrap_amortized_lwe_ciphertext_vector_with_glwe_dimension_64, 3,
+      512, 7, 3, -40);
+  bootstrap_glwe_dimension_test<uint32_t>(
+      cpu_convert_lwe_bootstrap_key_32,
+      cpu_bootstrap_amortized_lwe_ciphertext_vector_with_glwe_dimension_32, 2,
+      512, 6, 3, -25);
+  bootstrap_glwe_dimension_test<uint64_t>(
+      cpu_convert_lwe_bootstrap_key_64,
+      cpu_bootstrap_low_latency_lwe_ciphertext_vector_with_glwe_dimension_64,
+      2, 512, 7, 3, -40);
+  bootstrap_glwe_dimension_test<uint32_t>(
+      cpu_convert_lwe_bootstrap_key_32,
+      cpu_bootstrap_low_latency_lwe_ciphertext_vector_with_glwe_dimension_32,
+      3, 512, 6, 3, -25);
+  printf("test_cpu_bootstrap_glwe_dimension: OK\n");
+  return 0;
+}
@@ -0,0 +1,106 @@
+#include "bootstrap.h"
+#include "bootstrap_amortized.hpp"
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+
+#include "utils.h"
+
+uint64_t successor(uint64_t m) { return (m + 1) % (1 << MESSAGE_BITS); }
+
+// The GLWE accumulators decrypt to the rotated test vector, and extracting
+// their constant coefficient gives the regular bootstrap output. In the
+// Fourier domain, they come back to the same accumulators up to the
+// rounding of the FFT, which loses the low bits of 64 bits coefficients.
+template <typename Torus>
+void bootstrap_glwe_output_test(
+    void (*convert)(void *, void *, void *, uint32_t, uint32_t, uint32_t,
+                    uint32_t, uint32_t),
+    void (*bootstrap)(void *, void *, void *, void *, void *, void *, uint32_t,
+                      uint32_t, uint32_t, uint32_t, uint32_t, uint32_t,
+                      uint32_t, uint32_t, uint32_t),
+    void (*bootstrap_glwe_output)(void *, void *, void *, void *, void *,
+                                  void *, uint32_t, uint32_t, uint32_t,
+                                  uint32_t, uint32_t, uint32_t, uint32_t,
+                                  uint32_t, uint32_t, uint32_t),
+    uint32_t glwe_dimension, uint32_t base_log, uint32_t l_gadget,
+    double log_std, Torus fourier_tolerance) {
+  uint32_t input_lwe_dimension = 400, polynomial_size = 512, num_samples = 8;
+  uint32_t glwe_size = (glwe_dimension + 1) * polynomial_size;
+  uint32_t lwe_dimension_out = glwe_dimension * polynomial_size;
+  auto lwe_key = generate_lwe_secret_key<Torus>(input_lwe_dimension);
+  auto glwe_key = generate_lwe_secret_key<Torus>(lwe_dimension_out);
+  auto bsk = generate_lwe_bootstrap_key<Torus>(lwe_key, glwe_key,
+                                               glwe_dimension, polynomial_size,
+                                               base_log, l_gadget, log_std);
+  std::vector<double2> fourier_bsk(bsk.size() / 2);
+  convert(fourier_bsk.data(), bsk.data(), nullptr, 0, input_lwe_dimension,
+          glwe_dimension, l_gadget, polynomial_size);
+
+  std::vector<Torus> lut_vector(glwe_size);
+  fill_test_vector(lut_vector.data(), polynomial_size, successor,
+                   glwe_dimension);
+  std::vector<uint32_t> lut_vector_indexes(num_samples, 0);
+  std::vector<Torus> lwe_in(num_samples * (input_lwe_dimension + 1));
+  std::vector<uint64_t> messages(num_samples);
+  for (uint32_t s = 0; s < num_samples; s++) {
+    messages[s] = get_test_rng()() % (1 << MESSAGE_BITS);
+    encrypt_lwe<Torus>(&lwe_in[s * (input_lwe_dimension + 1)], lwe_key,
+                       encode<Torus>(messages[s]), log_std);
+  }
+
+  std::vector<Torus> glwe_out(num_samples * glwe_size);
+  bootstrap_glwe_output(nullptr, glwe_out.data(), lut_vector.data(),
+                        lut_vector_indexes.data(), lwe_in.data(),
+                        fourier_bsk.data(), input_lwe_dimension,
+                        glwe_dimension, polynomial_size, base_log, l_gadget,
+                        num_samples, 1, 0, 0, 0);
+  std::vector<Torus> lwe_out(num_samples * (lwe_dimension_out + 1));
+  bootstrap(nullptr, lwe_out.data(), lut_vector.data(),
+            lut_vector_indexes.data(), lwe_in.data(), fourier_bsk.data(),
+            input_lwe_dimension, glwe_dimension, polynomial_size, base_log,
+            l_gadget, num_samples, 1, 0, 0);
+  std::vector<Torus> lwe_extracted(lwe_dimension_out + 1);
+  for (uint32_t s = 0; s < num_samples; s++) {
+    auto plaintext = decrypt_glwe(&glwe_out[s * glwe_size], glwe_key,
+                                  glwe_dimension, polynomial_size);
+    assert(decode(plaintext[0]) == successor(messages[s]));
+    sample_extract(lwe_extracted.data(), &glwe_out[s * glwe_size],
+                   glwe_dimension, polynomial_size);
+    assert(std::equal(lwe_extracted.begin(), lwe_extracted.end(),
+                      &lwe_out[s * (lwe_dimension_out + 1)]));
+  }
+
+  std::vector<double2> glwe_out_fourier(num_samples * glwe_size / 2);
+  bootstrap_glwe_output(nullptr, glwe_out_fourier.data(), lut_vector.data(),
+                        lut_vector_indexes.data(), lwe_in.data(),
+                        fourier_bsk.data(), input_lwe_dimension,
+                        glwe_dimension, polynomial_size, base_log, l_gadget,
+                        num_samples, 1, 0, 1, 0);
+  auto &fft = NegacyclicFFT::get(polynomial_size);
+  for (uint32_t p = 0; p < num_samples * (glwe_dimension + 1); p++) {
+    double2 *polynomial = &glwe_out_fourier[p * polynomial_size / 2];
+    fft.inverse(polynomial);
+    std::vector<Torus> coefficients(polynomial_size, 0);
+    add_to_torus(polynomial, coefficients.data(), polynomial_size);
+    for (uint32_t j = 0; j < polynomial_size; j++) {
+      Torus diff = coefficients[j] - glwe_out[p * polynomial_size + j];
+      assert(diff <= fourier_tolerance || (Torus)-diff <= fourier_tolerance);
+    }
+  }
+}
+
+int main(void) {
+  bootstrap_glwe_output_test<uint32_t>(
+      cpu_convert_lwe_bootstrap_key_32,
+      cpu_bootstrap_amortized_lwe_ciphertext_vector_with_glwe_dimension_32,
+      cpu_bootstrap_amortized_glwe_output_lwe_ciphertext_vector_32, 2, 6, 3,
+      -25, 1);
+  bootstrap_glwe_output_test<uint64_t>(
+      cpu_convert_lwe_bootstrap_key_64,
+      cpu_bootstrap_amortized_lwe_ciphertext_vector_with_glwe_dimension_64,
+      cpu_bootstrap_amortized_glwe_output_lwe_ciphertext_vector_64, 1, 7, 3,
+      -40, (uint64_t)1 << 14);
+  printf("test_cpu_bootstrap_glwe_output: OK\n");
+  return 0;
+}
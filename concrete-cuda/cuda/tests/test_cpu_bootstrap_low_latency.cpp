@@ -0,0 +1,260 @@
+#include "bootstrap.h"
+#include "bootstrap_low_latency.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <thread>
+
+#include "utils.h"
+
+// Every thread sees the writes of all the others done before each barrier
+void spin_barrier_test(void) {
+  uint32_t num_threads = 4, num_rounds = 200;
+  ThreadPool pool(num_threads);
+  SpinBarrier barrier(num_threads);
+  std::vector<uint32_t> values(num_threads, 0);
+  std::atomic<bool> failed{false};
+  pool.parallel_for(0, num_threads, [&](uint32_t thread) {
+    for (uint32_t round = 1; round <= num_rounds; round++) {
+      values[thread] = round;
+      barrier.arrive_and_wait();
+      for (uint32_t other = 0; other < num_threads; other++)
+        if (values[other] != round)
+          failed = true;
+      barrier.arrive_and_wait();
+    }
+  });
+  assert(!failed);
+}
+
+uint64_t identity(uint64_t m) { return m; }
+uint64_t square(uint64_t m) { return m * m % (1 << MESSAGE_BITS); }
+
+// Splitting each ciphertext over any number of threads gives the results of
+// the amortized bootstrap, test vector s being used for ciphertext s
+template <typename Torus>
+void bootstrap_low_latency_test(uint32_t glwe_dimension, uint32_t base_log,
+                                uint32_t l_gadget, double log_std) {
+  uint32_t input_lwe_dimension = 200, polynomial_size = 512;
+  uint32_t num_samples = 3;
+  size_t glwe_size = (glwe_dimension + 1) * polynomial_size;
+  auto lwe_key = generate_lwe_secret_key<Torus>(input_lwe_dimension);
+  auto glwe_key =
+      generate_lwe_secret_key<Torus>(glwe_dimension * polynomial_size);
+  auto bsk = generate_lwe_bootstrap_key<Torus>(lwe_key, glwe_key,
+                                               glwe_dimension, polynomial_size,
+                                               base_log, l_gadget, log_std);
+  std::vector<double2> fourier_bsk(bsk.size() / 2);
+  cpu_convert_lwe_bootstrap_key<Torus, typename std::make_signed<Torus>::type>(
+      fourier_bsk.data(),
+      (typename std::make_signed<Torus>::type *)bsk.data(),
+      input_lwe_dimension, glwe_dimension, l_gadget, polynomial_size);
+
+  std::vector<Torus> lut_vector(num_samples * glwe_size);
+  std::vector<uint32_t> lut_vector_indexes(num_samples);
+  std::vector<Torus> lwe_in(num_samples * (input_lwe_dimension + 1));
+  std::vector<uint64_t> messages(num_samples);
+  for (uint32_t s = 0; s < num_samples; s++) {
+    fill_test_vector(&lut_vector[s * glwe_size], polynomial_size,
+                     s % 2 ? square : identity,
+                     glwe_dimension);
+    lut_vector_indexes[s] = s;
+    messages[s] = get_test_rng()() % (1 << MESSAGE_BITS);
+    encrypt_lwe<Torus>(&lwe_in[s * (input_lwe_dimension + 1)], lwe_key,
+                       encode<Torus>(messages[s]), log_std);
+  }
+
+  size_t lwe_size = glwe_dimension * polynomial_size + 1;
+  std::vector<Torus> expected(num_samples * lwe_size);
+  cpu_bootstrap_amortized_lwe_ciphertext_vector<Torus>(
+      expected.data(), lut_vector.data(), lut_vector_indexes.data(),
+      lwe_in.data(), fourier_bsk.data(), input_lwe_dimension, polynomial_size,
+      base_log, l_gadget, num_samples, 0, glwe_dimension);
+  for (uint32_t s = 0; s < num_samples; s++) {
+    uint64_t message = s % 2 ? square(messages[s]) : messages[s];
+    assert(decode(decrypt_lwe(&expected[s * lwe_size], glwe_key)) == message);
+  }
+
+  for (uint32_t num_threads : {1u, 2u, 3u, 8u}) {
+    ThreadPool pool(num_threads);
+    std::vector<Torus> lwe_out(num_samples * lwe_size);
+    cpu_bootstrap_low_latency_lwe_ciphertext_vector<Torus>(
+        lwe_out.data(), lut_vector.data(), lwe_in.data(), fourier_bsk.data(),
+        input_lwe_dimension, polynomial_size, base_log, l_gadget, num_samples,
+        glwe_dimension, pool);
+    assert(lwe_out == expected);
+
+    // From a task of the pool, the ciphertexts are not split
+    std::fill(lwe_out.begin(), lwe_out.end(), 0);
+    pool.parallel_for(0, 2, [&](uint32_t task) {
+      if (task == 0)
+        cpu_bootstrap_low_latency_lwe_ciphertext_vector<Torus>(
+            lwe_out.data(), lut_vector.data(), lwe_in.data(),
+            fourier_bsk.data(), input_lwe_dimension, polynomial_size,
+            base_log, l_gadget, num_samples, glwe_dimension, pool);
+    });
+    assert(lwe_out == expected);
+  }
+}
+
+// The C entry points use the global pool
+template <typename Torus>
+void bootstrap_low_latency_entry_point_test(
+    void (*bootstrap)(void *, void *, void *, void *, void *, void *, uint32_t,
+                      uint32_t, uint32_t, uint32_t, uint32_t, uint32_t,
+                      uint32_t, uint32_t),
+    uint32_t base_log, uint32_t l_gadget, double log_std) {
+  uint32_t input_lwe_dimension = 100, polynomial_size = 1024, num_samples = 2;
+  auto lwe_key = generate_lwe_secret_key<Torus>(input_lwe_dimension);
+  auto glwe_key = generate_lwe_secret_key<Torus>(polynomial_size);
+  auto bsk = generate_lwe_bootstrap_key<Torus>(
+      lwe_key, glwe_key, 1, polynomial_size, base_log, l_gadget, log_std);
+  std::vector<double2> fourier_bsk(bsk.size() / 2);
+  cpu_convert_lwe_bootstrap_key<Torus, typename std::make_signed<Torus>::type>(
+      fourier_bsk.data(),
+      (typename std::make_signed<Torus>::type *)bsk.data(),
+      input_lwe_dimension, 1, l_gadget, polynomial_size);
+
+  std::vector<Torus> lut_vector(num_samples * 2 * polynomial_size);
+  fill_test_vector(lut_vector.data(), polynomial_size, square);
+  fill_test_vector(&lut_vector[2 * polynomial_size], polynomial_size, square);
+  std::vector<Torus> lwe_in(num_samples * (input_lwe_dimension + 1));
+  std::vector<uint64_t> messages(num_samples);
+  for (uint32_t s = 0; s < num_samples; s++) {
+    messages[s] = get_test_rng()() % (1 << MESSAGE_BITS);
+    encrypt_lwe<Torus>(&lwe_in[s * (input_lwe_dimension + 1)], lwe_key,
+                       encode<Torus>(messages[s]), log_std);
+  }
+  std::vector<Torus> lwe_out(num_samples * (polynomial_size + 1));
+  bootstrap(nullptr, lwe_out.data(), lut_vector.data(), nullptr, lwe_in.data(),
+            fourier_bsk.data(), input_lwe_dimension, polynomial_size,
+            base_log, l_gadget, num_samples, num_samples, 0, 0);
+  for (uint32_t s = 0; s < num_samples; s++)
+    assert(decode(decrypt_lwe(&lwe_out[s * (polynomial_size + 1)],
+                              glwe_key)) == square(messages[s]));
+}
+
+// Memory backend counting its allocations
+struct CountingMemory {
+  static inline uint32_t allocations = 0, releases = 0;
+  static inline size_t allocated_bytes = 0;
+  static void *allocate(size_t bytes) {
+    allocations++;
+    allocated_bytes = bytes;
+    return HostMemory::allocate(bytes);
+  }
+  static void release(void *ptr) {
+    releases++;
+    HostMemory::release(ptr);
+  }
+};
+
+// A context allocates its join buffers once, for launches of chunk_size
+// ciphertexts, and only accepts the parameters it was created for. Its
+// scratch is only reallocated to grow
+void context_test(void) {
+  {
+    LowLatencyPbsContext<CountingMemory> context(8, 1024, 3, 10, 2);
+    assert(CountingMemory::allocations == 1);
+    assert(context.get_join_buffer_bytes() == 3 * 10 * 512 * 16);
+    assert(CountingMemory::allocated_bytes >=
+           3 * context.get_join_buffer_bytes());
+    assert((char *)context.body_join_buffer() ==
+           (char *)context.mask_join_buffer() +
+               2 * context.get_join_buffer_bytes());
+    assert(context.chunk_size() == 10);
+    assert(context.glwe_dimension() == 2);
+    void *scratch = context.scratch(1000);
+    assert(CountingMemory::allocations == 2);
+    assert(context.scratch(500) == scratch);
+    context.scratch(2000);
+    assert(CountingMemory::allocations == 3 && CountingMemory::releases == 1);
+    assert(context.is_compatible(8, 1024, 3));
+    assert(!context.is_compatible(4, 1024, 3));
+    assert(!context.is_compatible(8, 2048, 3));
+    assert(!context.is_compatible(8, 1024, 2));
+  }
+  assert(CountingMemory::allocations == 3 && CountingMemory::releases == 3);
+}
+
+// Bootstrapping with a context gives the results of the bootstrap without,
+// call after call, and a context created for other parameters is rejected
+template <typename Torus>
+void bootstrap_low_latency_with_context_test(
+    void *(*create)(uint32_t, uint32_t, uint32_t, uint32_t),
+    void (*bootstrap)(void *, void *, void *, void *, void *, void *, uint32_t,
+                      uint32_t, uint32_t, uint32_t, uint32_t, uint32_t,
+                      uint32_t, uint32_t),
+    void (*bootstrap_with_context)(void *, void *, void *, void *, void *,
+                                   void *, uint32_t, uint32_t, uint32_t,
+                                   uint32_t, uint32_t),
+    uint32_t base_log, uint32_t l_gadget) {
+  uint32_t input_lwe_dimension = 50, polynomial_size = 512, num_samples = 2;
+  auto bsk = random_torus_vector<Torus>((size_t)input_lwe_dimension *
+                                        l_gadget * 4 * polynomial_size);
+  std::vector<double2> fourier_bsk(bsk.size() / 2);
+  cpu_convert_lwe_bootstrap_key<Torus, typename std::make_signed<Torus>::type>(
+      fourier_bsk.data(),
+      (typename std::make_signed<Torus>::type *)bsk.data(),
+      input_lwe_dimension, 1, l_gadget, polynomial_size);
+  auto lut_vector = random_torus_vector<Torus>(num_samples * 2 * polynomial_size);
+  std::vector<Torus> expected(num_samples * (polynomial_size + 1));
+  std::vector<Torus> lwe_out(expected.size());
+
+  void *context = create(0, polynomial_size, l_gadget, num_samples);
+  assert(context != nullptr);
+  for (uint32_t call = 0; call < 3; call++) {
+    auto lwe_in = random_torus_vector<Torus>(num_samples *
+                                             (input_lwe_dimension + 1));
+    bootstrap(nullptr, expected.data(), lut_vector.data(), nullptr,
+              lwe_in.data(), fourier_bsk.data(), input_lwe_dimension,
+              polynomial_size, base_log, l_gadget, num_samples, num_samples, 0,
+              0);
+    bootstrap_with_context(nullptr, context, lwe_out.data(), lut_vector.data(),
+                           lwe_in.data(), fourier_bsk.data(),
+                           input_lwe_dimension, polynomial_size, base_log,
+                           l_gadget, num_samples);
+    assert(lwe_out == expected);
+  }
+
+  std::fill(lwe_out.begin(), lwe_out.end(), 0);
+  auto lwe_in =
+      random_torus_vector<Torus>(num_samples * (input_lwe_dimension + 1));
+  bootstrap_with_context(nullptr, context, lwe_out.data(), lut_vector.data(),
+                         lwe_in.data(), fourier_bsk.data(),
+                         input_lwe_dimension, polynomial_size, base_log,
+                         l_gadget - 1, num_samples);
+  assert(std::all_of(lwe_out.begin(), lwe_out.end(),
+                     [](Torus x) { return x == 0; }));
+  assert(cpu_destroy_bootstrap_low_latency_context(context, 0) == 0);
+  assert(create(0, 100, l_gadget, num_samples) == nullptr);
+  // The null context of a failed creation is rejected as well
+  bootstrap_with_context(nullptr, nullptr, lwe_out.data(), lut_vector.data(),
+                         lwe_in.data(), fourier_bsk.data(),
+                         input_lwe_dimension, polynomial_size, base_log,
+                         l_gadget, num_samples);
+  assert(std::all_of(lwe_out.begin(), lwe_out.end(),
+                     [](Torus x) { return x == 0; }));
+}
+
+int main(void) {
+  spin_barrier_test();
+  bootstrap_low_latency_test<uint32_t>(1, 6, 3, -25);
+  bootstrap_low_latency_test<uint64_t>(1, 7, 3, -40);
+  bootstrap_low_latency_test<uint64_t>(2, 7, 3, -40);
+  bootstrap_low_latency_entry_point_test<uint32_t>(
+      cpu_bootstrap_low_latency_lwe_ciphertext_vector_32, 6, 3, -25);
+  bootstrap_low_latency_entry_point_test<uint64_t>(
+      cpu_bootstrap_low_latency_lwe_ciphertext_vector_64, 7, 3, -40);
+  context_test();
+  bootstrap_low_latency_with_context_test<uint32_t>(
+      cpu_create_bootstrap_low_latency_context_32,
+      cpu_bootstrap_low_latency_lwe_ciphertext_vector_32,
+      cpu_bootstrap_low_latency_with_context_lwe_ciphertext_vector_32, 6, 3);
+  bootstrap_low_latency_with_context_test<uint64_t>(
+      cpu_create_bootstrap_low_latency_context_64,
+      cpu_bootstrap_low_latency_lwe_ciphertext_vector_64,
+      cpu_bootstrap_low_latency_with_context_lwe_ciphertext_vector_64, 7, 3);
+  printf("test_cpu_bootstrap_low_latency: OK\n");
+  return 0;
+}
@@ -0,0 +1,101 @@
+#include "bootstrap.h"
+#include "bootstrap_amortized.hpp"
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+
+#include "utils.h"
+
+uint64_t identity(uint64_t m) { return m; }
+uint64_t square(uint64_t m) { return (m * m) % (1 << MESSAGE_BITS); }
+uint64_t is_odd(uint64_t m) { return m & 1; }
+uint64_t negation(uint64_t m) {
+  return ((1 << MESSAGE_BITS) - m) % (1 << MESSAGE_BITS);
+}
+
+// With a single test vector the many-LUT bootstrap is the regular one
+void bootstrap_many_lut_single_test(void) {
+  uint32_t input_lwe_dimension = 100, polynomial_size = 512;
+  uint32_t base_log = 6, l_gadget = 3, num_samples = 8;
+  auto bsk = random_torus_vector<uint64_t>(
+      (size_t)input_lwe_dimension * l_gadget * 4 * polynomial_size);
+  std::vector<double2> fourier_bsk(bsk.size() / 2);
+  cpu_convert_lwe_bootstrap_key_64(fourier_bsk.data(), bsk.data(), nullptr, 0,
+                                   input_lwe_dimension, 1, l_gadget,
+                                   polynomial_size);
+  auto lut_vector = random_torus_vector<uint64_t>(2 * polynomial_size);
+  std::vector<uint32_t> lut_vector_indexes(num_samples, 0);
+  auto lwe_in =
+      random_torus_vector<uint64_t>(num_samples * (input_lwe_dimension + 1));
+
+  std::vector<uint64_t> lwe_out(num_samples * (polynomial_size + 1));
+  std::vector<uint64_t> lwe_out_many_lut(lwe_out.size());
+  cpu_bootstrap_amortized_lwe_ciphertext_vector_64(
+      nullptr, lwe_out.data(), lut_vector.data(), lut_vector_indexes.data(),
+      lwe_in.data(), fourier_bsk.data(), input_lwe_dimension, polynomial_size,
+      base_log, l_gadget, num_samples, 1, 0, 0);
+  cpu_bootstrap_amortized_many_lut_lwe_ciphertext_vector_64(
+      nullptr, lwe_out_many_lut.data(), lut_vector.data(),
+      lut_vector_indexes.data(), lwe_in.data(), fourier_bsk.data(),
+      input_lwe_dimension, 1, polynomial_size, base_log, l_gadget, num_samples,
+      1, 0, 1, 0);
+  assert(lwe_out == lwe_out_many_lut);
+}
+
+// Each output decrypts to its function of the input, under the GLWE key
+// seen as an LWE key of dimension k * N
+void bootstrap_many_lut_test(uint32_t glwe_dimension,
+                             uint32_t polynomial_size) {
+  uint32_t input_lwe_dimension = 400;
+  uint32_t base_log = 7, l_gadget = 3, num_samples = 12, lut_count = 4;
+  uint64_t (*functions[4])(uint64_t) = {identity, square, is_odd, negation};
+  uint32_t glwe_size = (glwe_dimension + 1) * polynomial_size;
+  uint32_t lwe_dimension_out = glwe_dimension * polynomial_size;
+  auto lwe_key = generate_lwe_secret_key<uint64_t>(input_lwe_dimension);
+  auto glwe_key = generate_lwe_secret_key<uint64_t>(lwe_dimension_out);
+  auto bsk = generate_lwe_bootstrap_key<uint64_t>(
+      lwe_key, glwe_key, glwe_dimension, polynomial_size, base_log, l_gadget,
+      -40);
+  std::vector<double2> fourier_bsk(bsk.size() / 2);
+  cpu_convert_lwe_bootstrap_key_64(fourier_bsk.data(), bsk.data(), nullptr, 0,
+                                   input_lwe_dimension, glwe_dimension,
+                                   l_gadget, polynomial_size);
+
+  std::vector<uint64_t> luts(lut_count * glwe_size);
+  for (uint32_t i = 0; i < lut_count; i++)
+    fill_test_vector(&luts[i * glwe_size], polynomial_size, functions[i],
+                     glwe_dimension);
+  std::vector<uint64_t> lut_vector(glwe_size);
+  cpu_pack_many_lut_test_vector_64(lut_vector.data(), luts.data(), lut_count,
+                                   glwe_dimension, polynomial_size);
+  std::vector<uint32_t> lut_vector_indexes(num_samples, 0);
+
+  std::vector<uint64_t> lwe_in(num_samples * (input_lwe_dimension + 1));
+  std::vector<uint64_t> messages(num_samples);
+  for (uint32_t s = 0; s < num_samples; s++) {
+    messages[s] = s % (1 << MESSAGE_BITS);
+    encrypt_lwe<uint64_t>(&lwe_in[s * (input_lwe_dimension + 1)], lwe_key,
+                          encode<uint64_t>(messages[s]), -40);
+  }
+
+  std::vector<uint64_t> lwe_out(num_samples * lut_count *
+                                (lwe_dimension_out + 1));
+  cpu_bootstrap_amortized_many_lut_lwe_ciphertext_vector_64(
+      nullptr, lwe_out.data(), lut_vector.data(), lut_vector_indexes.data(),
+      lwe_in.data(), fourier_bsk.data(), input_lwe_dimension, glwe_dimension,
+      polynomial_size, base_log, l_gadget, num_samples, 1, 0, lut_count, 0);
+  for (uint32_t s = 0; s < num_samples; s++)
+    for (uint32_t i = 0; i < lut_count; i++) {
+      uint64_t plaintext = decrypt_lwe(
+          &lwe_out[(s * lut_count + i) * (lwe_dimension_out + 1)], glwe_key);
+      assert(decode(plaintext) == functions[i](messages[s]));
+    }
+}
+
+int main(void) {
+  bootstrap_many_lut_single_test();
+  bootstrap_many_lut_test(1, 2048);
+  bootstrap_many_lut_test(2, 1024);
+  printf("test_cpu_bootstrap_many_lut: OK\n");
+  return 0;
+}
@@ -0,0 +1,112 @@
+#include "bootstrap.h"
+#include "bootstrap_multi_bit.hpp"
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#include "utils.h"
+
+// The transform of X^e used to scale the products of a group is the forward
+// FFT of the monomial
+void fft_monomial_test(void) {
+  uint32_t polynomial_size = 1024, fft_size = polynomial_size / 2;
+  auto &fft = NegacyclicFFT::get(polynomial_size);
+  for (uint32_t degree : {0u, 1u, 2u, 777u, 1024u, 1500u, 2047u}) {
+    std::vector<double> monomial(polynomial_size, 0.);
+    double sign = degree < polynomial_size ? 1. : -1.;
+    monomial[degree % polynomial_size] = sign;
+    std::vector<double2> monomial_fft(fft_size);
+    real_to_complex_compressed(monomial_fft.data(), monomial.data(),
+                               polynomial_size);
+    fft.forward(monomial_fft.data());
+    for (uint32_t j = 0; j < fft_size; j++) {
+      double2 expected = fft.monomial(j, degree);
+      assert(std::fabs(monomial_fft[j].x - expected.x) < 1e-12);
+      assert(std::fabs(monomial_fft[j].y - expected.y) < 1e-12);
+    }
+  }
+}
+
+uint64_t double_plus_three(uint64_t m) {
+  return (2 * m + 3) % (1 << MESSAGE_BITS);
+}
+
+// The multi-bit bootstrap evaluates the test vector for every grouping
+// factor, with an LWE dimension that leaves a smaller last group
+template <typename Torus>
+void bootstrap_multi_bit_test(
+    void (*convert)(void *, void *, void *, uint32_t, uint32_t, uint32_t,
+                    uint32_t, uint32_t, uint32_t),
+    void (*bootstrap)(void *, void *, void *, void *, void *, void *, uint32_t,
+                      uint32_t, uint32_t, uint32_t, uint32_t, uint32_t,
+                      uint32_t, uint32_t, uint32_t),
+    uint32_t grouping_factor, uint32_t base_log, uint32_t l_gadget,
+    double log_std) {
+  uint32_t input_lwe_dimension = 401, polynomial_size = 1024;
+  uint32_t num_samples = 8, lwe_idx = 1;
+  auto lwe_key = generate_lwe_secret_key<Torus>(input_lwe_dimension);
+  auto glwe_key = generate_lwe_secret_key<Torus>(polynomial_size);
+  auto bsk = generate_lwe_multi_bit_bootstrap_key<Torus>(
+      lwe_key, glwe_key, 1, polynomial_size, base_log, l_gadget,
+      grouping_factor, log_std);
+  assert(bsk.size() ==
+         (size_t)get_multi_bit_ggsw_count(input_lwe_dimension,
+                                          grouping_factor) *
+             l_gadget * 4 * polynomial_size);
+  std::vector<double2> fourier_bsk(bsk.size() / 2);
+  convert(fourier_bsk.data(), bsk.data(), nullptr, 0, input_lwe_dimension, 1,
+          l_gadget, polynomial_size, grouping_factor);
+
+  std::vector<Torus> lut_vector(2 * polynomial_size);
+  fill_test_vector(lut_vector.data(), polynomial_size, double_plus_three);
+  std::vector<uint32_t> lut_vector_indexes(lwe_idx + num_samples, 0);
+  std::vector<Torus> lwe_in(num_samples * (input_lwe_dimension + 1));
+  std::vector<uint64_t> messages(num_samples);
+  for (uint32_t s = 0; s < num_samples; s++) {
+    messages[s] = get_test_rng()() % (1 << MESSAGE_BITS);
+    encrypt_lwe<Torus>(&lwe_in[s * (input_lwe_dimension + 1)], lwe_key,
+                       encode<Torus>(messages[s]), log_std);
+  }
+
+  std::vector<Torus> lwe_out(num_samples * (polynomial_size + 1));
+  bootstrap(nullptr, lwe_out.data(), lut_vector.data(),
+            lut_vector_indexes.data(), lwe_in.data(), fourier_bsk.data(),
+            input_lwe_dimension, polynomial_size, base_log, l_gadget,
+            grouping_factor, num_samples, 1, lwe_idx, 0);
+  for (uint32_t s = 0; s < num_samples; s++) {
+    Torus plaintext =
+        decrypt_lwe(&lwe_out[s * (polynomial_size + 1)], glwe_key);
+    assert(decode(plaintext) == double_plus_three(messages[s]));
+  }
+}
+
+// Grouping factors the bootstrap rejects leave the converted key untouched
+// instead of dividing by zero or writing a layout it cannot read
+void convert_invalid_grouping_factor_test() {
+  uint32_t input_lwe_dimension = 4, polynomial_size = 512, l_gadget = 1;
+  std::vector<uint64_t> bsk(4 * polynomial_size * l_gadget, 1);
+  std::vector<double2> fourier_bsk(bsk.size(), double2{7., 7.});
+  for (uint32_t grouping_factor : {0u, MAX_GROUPING_FACTOR + 1}) {
+    cpu_convert_lwe_multi_bit_bootstrap_key_64(
+        fourier_bsk.data(), bsk.data(), nullptr, 0, input_lwe_dimension, 1,
+        l_gadget, polynomial_size, grouping_factor);
+    for (auto &value : fourier_bsk)
+      assert(value.x == 7. && value.y == 7.);
+  }
+}
+
+int main(void) {
+  fft_monomial_test();
+  convert_invalid_grouping_factor_test();
+  for (uint32_t grouping_factor = 1; grouping_factor <= 3; grouping_factor++)
+    bootstrap_multi_bit_test<uint64_t>(
+        cpu_convert_lwe_multi_bit_bootstrap_key_64,
+        cpu_bootstrap_multi_bit_lwe_ciphertext_vector_64, grouping_factor, 7,
+        3, -40);
+  bootstrap_multi_bit_test<uint32_t>(
+      cpu_convert_lwe_multi_bit_bootstrap_key_32,
+      cpu_bootstrap_multi_bit_lwe_ciphertext_vector_32, 2, 6, 3, -25);
+  printf("test_cpu_bootstrap_multi_bit: OK\n");
+  return 0;
+}
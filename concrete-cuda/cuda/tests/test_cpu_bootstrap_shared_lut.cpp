@@ -0,0 +1,114 @@
+#include "bootstrap.h"
+#include "bootstrap_amortized.hpp"
+#include <cassert>
+#include <cstdio>
+
+#include "utils.h"
+
+// Bootstrapping with a shared test vector gives the results of the
+// bootstrap with every index at 0
+template <typename Torus>
+void bootstrap_shared_lut_test(
+    void (*bootstrap)(void *, void *, void *, void *, void *, void *, uint32_t,
+                      uint32_t, uint32_t, uint32_t, uint32_t, uint32_t,
+                      uint32_t, uint32_t),
+    void (*bootstrap_shared_lut)(void *, void *, void *, void *, void *,
+                                 uint32_t, uint32_t, uint32_t, uint32_t,
+                                 uint32_t, uint32_t),
+    void (*bootstrap_glwe_output)(void *, void *, void *, void *, void *,
+                                  void *, uint32_t, uint32_t, uint32_t,
+                                  uint32_t, uint32_t, uint32_t, uint32_t,
+                                  uint32_t, uint32_t, uint32_t),
+    uint32_t base_log, uint32_t l_gadget) {
+  uint32_t input_lwe_dimension = 100, polynomial_size = 512;
+  uint32_t num_samples = 9, lwe_idx = 4;
+  auto bsk = random_torus_vector<Torus>((size_t)input_lwe_dimension *
+                                        l_gadget * 4 * polynomial_size);
+  std::vector<double2> fourier_bsk(bsk.size() / 2);
+  cpu_convert_lwe_bootstrap_key<Torus, typename std::make_signed<Torus>::type>(
+      fourier_bsk.data(),
+      (typename std::make_signed<Torus>::type *)bsk.data(),
+      input_lwe_dimension, 1, l_gadget, polynomial_size);
+  auto lut_vector = random_torus_vector<Torus>(2 * polynomial_size);
+  std::vector<uint32_t> lut_vector_indexes(lwe_idx + num_samples, 0);
+  auto lwe_in =
+      random_torus_vector<Torus>(num_samples * (input_lwe_dimension + 1));
+
+  std::vector<Torus> expected(num_samples * (polynomial_size + 1));
+  std::vector<Torus> lwe_out(expected.size());
+  bootstrap(nullptr, expected.data(), lut_vector.data(),
+            lut_vector_indexes.data(), lwe_in.data(), fourier_bsk.data(),
+            input_lwe_dimension, polynomial_size, base_log, l_gadget,
+            num_samples, 1, lwe_idx, 0);
+  bootstrap_shared_lut(nullptr, lwe_out.data(), lut_vector.data(),
+                       lwe_in.data(), fourier_bsk.data(), input_lwe_dimension,
+                       polynomial_size, base_log, l_gadget, num_samples, 0);
+  assert(lwe_out == expected);
+
+  // The other engines take a null index array for the same mode
+  std::fill(lwe_out.begin(), lwe_out.end(), 0);
+  bootstrap(nullptr, lwe_out.data(), lut_vector.data(), nullptr,
+            lwe_in.data(), fourier_bsk.data(), input_lwe_dimension,
+            polynomial_size, base_log, l_gadget, num_samples, 1, lwe_idx, 0);
+  assert(lwe_out == expected);
+
+  std::vector<Torus> glwe_expected(num_samples * 2 * polynomial_size);
+  std::vector<Torus> glwe_out(glwe_expected.size());
+  bootstrap_glwe_output(nullptr, glwe_expected.data(), lut_vector.data(),
+                        lut_vector_indexes.data(), lwe_in.data(),
+                        fourier_bsk.data(), input_lwe_dimension, 1,
+                        polynomial_size, base_log, l_gadget, num_samples, 1,
+                        lwe_idx, 0, 0);
+  bootstrap_glwe_output(nullptr, glwe_out.data(), lut_vector.data(), nullptr,
+                        lwe_in.data(), fourier_bsk.data(), input_lwe_dimension,
+                        1, polynomial_size, base_log, l_gadget, num_samples, 1,
+                        lwe_idx, 0, 0);
+  assert(glwe_out == glwe_expected);
+}
+
+// The fused keyswitch and bootstrap shares the test vector as well
+void keyswitch_bootstrap_shared_lut_test(void) {
+  uint32_t input_lwe_dimension = 300, lwe_dimension = 100;
+  uint32_t polynomial_size = 512, ks_base_log = 3, ks_l_gadget = 5;
+  uint32_t pbs_base_log = 7, pbs_l_gadget = 3, num_samples = 6;
+  auto ksk = random_torus_vector<uint64_t>(
+      (size_t)input_lwe_dimension * ks_l_gadget * (lwe_dimension + 1));
+  auto bsk = random_torus_vector<uint64_t>((size_t)lwe_dimension *
+                                           pbs_l_gadget * 4 * polynomial_size);
+  std::vector<double2> fourier_bsk(bsk.size() / 2);
+  cpu_convert_lwe_bootstrap_key_64(fourier_bsk.data(), bsk.data(), nullptr, 0,
+                                   lwe_dimension, 1, pbs_l_gadget,
+                                   polynomial_size);
+  auto lut_vector = random_torus_vector<uint64_t>(2 * polynomial_size);
+  std::vector<uint32_t> lut_vector_indexes(num_samples, 0);
+  auto lwe_in = random_torus_vector<uint64_t>(num_samples *
+                                              (input_lwe_dimension + 1));
+
+  std::vector<uint64_t> expected(num_samples * (polynomial_size + 1));
+  std::vector<uint64_t> lwe_out(expected.size());
+  cpu_keyswitch_bootstrap_amortized_lwe_ciphertext_vector_64(
+      nullptr, expected.data(), lut_vector.data(), lut_vector_indexes.data(),
+      lwe_in.data(), ksk.data(), fourier_bsk.data(), input_lwe_dimension,
+      lwe_dimension, polynomial_size, ks_base_log, ks_l_gadget, pbs_base_log,
+      pbs_l_gadget, num_samples, 1, 0, 0);
+  cpu_keyswitch_bootstrap_amortized_lwe_ciphertext_vector_64(
+      nullptr, lwe_out.data(), lut_vector.data(), nullptr, lwe_in.data(),
+      ksk.data(), fourier_bsk.data(), input_lwe_dimension, lwe_dimension,
+      polynomial_size, ks_base_log, ks_l_gadget, pbs_base_log, pbs_l_gadget,
+      num_samples, 1, 0, 0);
+  assert(lwe_out == expected);
+}
+
+int main(void) {
+  bootstrap_shared_lut_test<uint32_t>(
+      cpu_bootstrap_amortized_lwe_ciphertext_vector_32,
+      cpu_bootstrap_amortized_shared_lut_lwe_ciphertext_vector_32,
+      cpu_bootstrap_amortized_glwe_output_lwe_ciphertext_vector_32, 6, 3);
+  bootstrap_shared_lut_test<uint64_t>(
+      cpu_bootstrap_amortized_lwe_ciphertext_vector_64,
+      cpu_bootstrap_amortized_shared_lut_lwe_ciphertext_vector_64,
+      cpu_bootstrap_amortized_glwe_output_lwe_ciphertext_vector_64, 7, 3);
+  keyswitch_bootstrap_shared_lut_test();
+  printf("test_cpu_bootstrap_shared_lut: OK\n");
+  return 0;
+}
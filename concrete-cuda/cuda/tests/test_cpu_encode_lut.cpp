@@ -0,0 +1,166 @@
+#include "bootstrap.h"
+#include "bootstrap_amortized.hpp"
+#include "bootstrap_lut.h"
+#include <cassert>
+#include <cstdio>
+
+#include "utils.h"
+
+// Expansion of one table coefficient by coefficient, as done by the
+// encode_and_expand_lut of the concrete-core-ffi tests
+template <typename Torus>
+void reference_expand_lut(Torus *body, const uint64_t *lut, uint32_t lut_size,
+                          uint32_t message_bits, uint32_t polynomial_size) {
+  uint32_t mega_case_size = polynomial_size / lut_size;
+  uint32_t shift = sizeof(Torus) * 8 - message_bits - 1;
+  for (uint32_t j = 0; j < mega_case_size / 2; j++)
+    body[j] = (Torus)lut[0] << shift;
+  for (uint32_t i = 1; i < lut_size; i++)
+    for (uint32_t j = 0; j < mega_case_size; j++)
+      body[mega_case_size * (i - 1) + mega_case_size / 2 + j] =
+          (Torus)lut[i] << shift;
+  for (uint32_t j = (lut_size - 1) * mega_case_size + mega_case_size / 2;
+       j < polynomial_size; j++)
+    body[j] = -((Torus)lut[0] << shift);
+}
+
+// Every test vector is the reference expansion of its table behind zero
+// masks, for any table size and GLWE dimension, and the 16 entries tables
+// give the test vectors of fill_test_vector
+template <typename Torus>
+void encode_lut_vector_test(
+    uint32_t (*encode_lut_vector)(void *, void *, void *, uint32_t, uint32_t,
+                                  uint32_t, uint32_t, uint32_t, uint32_t)) {
+  uint32_t num_luts = 5;
+  for (uint32_t polynomial_size : {512u, 2048u})
+    for (uint32_t glwe_dimension : {1u, 2u})
+      for (uint32_t lut_size : {2u, 4u, 16u, 64u}) {
+        uint32_t message_bits = 0;
+        while ((1u << message_bits) < lut_size)
+          message_bits++;
+        size_t glwe_size = (size_t)(glwe_dimension + 1) * polynomial_size;
+        std::vector<uint64_t> luts((size_t)num_luts * lut_size);
+        for (auto &entry : luts)
+          entry = get_test_rng()() % lut_size;
+        std::vector<Torus> lut_vector(num_luts * glwe_size, 1);
+        std::vector<uint32_t> indexes(num_luts, 1000);
+        uint32_t num_lut_vectors = encode_lut_vector(
+            lut_vector.data(), indexes.data(), luts.data(), lut_size,
+            num_luts, message_bits, glwe_dimension, polynomial_size, 0);
+        assert(num_lut_vectors == num_luts);
+
+        std::vector<Torus> expected(glwe_size, 0);
+        for (uint32_t t = 0; t < num_luts; t++) {
+          assert(indexes[t] == t);
+          reference_expand_lut(&expected[glwe_dimension * polynomial_size],
+                               &luts[t * lut_size], lut_size, message_bits,
+                               polynomial_size);
+          assert(std::equal(expected.begin(), expected.end(),
+                            &lut_vector[t * glwe_size]));
+        }
+      }
+
+  uint32_t polynomial_size = 1024, lut_size = 1 << MESSAGE_BITS;
+  std::vector<uint64_t> luts(lut_size);
+  for (uint32_t m = 0; m < lut_size; m++)
+    luts[m] = (3 * m + 1) % lut_size;
+  std::vector<Torus> lut_vector(2 * polynomial_size);
+  std::vector<Torus> expected(2 * polynomial_size);
+  encode_lut_vector(lut_vector.data(), nullptr, luts.data(), lut_size, 1,
+                    MESSAGE_BITS, 1, polynomial_size, 0);
+  fill_test_vector(expected.data(), polynomial_size,
+                   [](uint64_t m) { return (3 * m + 1) % (1 << MESSAGE_BITS); });
+  assert(lut_vector == expected);
+
+  // Tables that do not split the polynomial in mega cases of 2 or more
+  assert(encode_lut_vector(lut_vector.data(), nullptr, luts.data(), 3, 1,
+                           MESSAGE_BITS, 1, polynomial_size, 0) == 0);
+  assert(encode_lut_vector(lut_vector.data(), nullptr, luts.data(),
+                           polynomial_size, 1, MESSAGE_BITS, 1,
+                           polynomial_size, 0) == 0);
+  // Messages leaving no room for the padding bit
+  uint32_t max_message_bits = sizeof(Torus) * 8 - 2;
+  assert(encode_lut_vector(lut_vector.data(), nullptr, luts.data(), lut_size,
+                           1, max_message_bits, 1, polynomial_size, 0) == 1);
+  for (uint32_t message_bits : {max_message_bits + 1, max_message_bits + 2})
+    assert(encode_lut_vector(lut_vector.data(), nullptr, luts.data(),
+                             lut_size, 1, message_bits, 1, polynomial_size,
+                             0) == 0);
+}
+
+// Equal tables share the test vector of their first occurrence, and the
+// bootstrap with the deduplicated lut_vector and its indexes evaluates the
+// table of each ciphertext
+template <typename Torus>
+void encode_lut_vector_deduplicate_test(
+    uint32_t (*encode_lut_vector)(void *, void *, void *, uint32_t, uint32_t,
+                                  uint32_t, uint32_t, uint32_t, uint32_t),
+    void (*bootstrap)(void *, void *, void *, void *, void *, void *, uint32_t,
+                      uint32_t, uint32_t, uint32_t, uint32_t, uint32_t,
+                      uint32_t, uint32_t),
+    uint32_t base_log, uint32_t l_gadget, double log_std) {
+  uint32_t input_lwe_dimension = 400, polynomial_size = 1024;
+  uint32_t num_samples = 12, lut_size = 1 << MESSAGE_BITS;
+  // Tables of the sample s: one of 3 affine functions, so that most of
+  // the batch repeats a table
+  std::vector<uint64_t> luts((size_t)num_samples * lut_size);
+  for (uint32_t s = 0; s < num_samples; s++)
+    for (uint32_t m = 0; m < lut_size; m++)
+      luts[s * lut_size + m] = ((2 * (s % 3) + 1) * m + s % 3) % lut_size;
+
+  std::vector<Torus> lut_vector(num_samples * 2 * polynomial_size);
+  std::vector<uint32_t> indexes(num_samples);
+  uint32_t num_lut_vectors = encode_lut_vector(
+      lut_vector.data(), indexes.data(), luts.data(), lut_size, num_samples,
+      MESSAGE_BITS, 1, polynomial_size, 1);
+  assert(num_lut_vectors == 3);
+  for (uint32_t s = 0; s < num_samples; s++)
+    assert(indexes[s] == s % 3);
+  std::vector<Torus> full(num_samples * 2 * polynomial_size);
+  encode_lut_vector(full.data(), nullptr, luts.data(), lut_size, num_samples,
+                    MESSAGE_BITS, 1, polynomial_size, 0);
+  assert(std::equal(lut_vector.begin(),
+                    lut_vector.begin() + 3 * 2 * polynomial_size,
+                    full.begin()));
+
+  auto lwe_key = generate_lwe_secret_key<Torus>(input_lwe_dimension);
+  auto glwe_key = generate_lwe_secret_key<Torus>(polynomial_size);
+  auto bsk = generate_lwe_bootstrap_key<Torus>(
+      lwe_key, glwe_key, 1, polynomial_size, base_log, l_gadget, log_std);
+  std::vector<double2> fourier_bsk(bsk.size() / 2);
+  cpu_convert_lwe_bootstrap_key<Torus, typename std::make_signed<Torus>::type>(
+      fourier_bsk.data(),
+      (typename std::make_signed<Torus>::type *)bsk.data(),
+      input_lwe_dimension, 1, l_gadget, polynomial_size);
+  std::vector<Torus> lwe_in(num_samples * (input_lwe_dimension + 1));
+  std::vector<uint64_t> messages(num_samples);
+  for (uint32_t s = 0; s < num_samples; s++) {
+    messages[s] = get_test_rng()() % lut_size;
+    encrypt_lwe<Torus>(&lwe_in[s * (input_lwe_dimension + 1)], lwe_key,
+                       encode<Torus>(messages[s]), log_std);
+  }
+
+  std::vector<Torus> lwe_out(num_samples * (polynomial_size + 1));
+  bootstrap(nullptr, lwe_out.data(), lut_vector.data(), indexes.data(),
+            lwe_in.data(), fourier_bsk.data(), input_lwe_dimension,
+            polynomial_size, base_log, l_gadget, num_samples, num_lut_vectors,
+            0, 0);
+  for (uint32_t s = 0; s < num_samples; s++) {
+    Torus plaintext =
+        decrypt_lwe(&lwe_out[s * (polynomial_size + 1)], glwe_key);
+    assert(decode(plaintext) == luts[s * lut_size + messages[s]]);
+  }
+}
+
+int main(void) {
+  encode_lut_vector_test<uint32_t>(cpu_encode_and_expand_lut_vector_32);
+  encode_lut_vector_test<uint64_t>(cpu_encode_and_expand_lut_vector_64);
+  encode_lut_vector_deduplicate_test<uint32_t>(
+      cpu_encode_and_expand_lut_vector_32,
+      cpu_bootstrap_amortized_lwe_ciphertext_vector_32, 6, 3, -25);
+  encode_lut_vector_deduplicate_test<uint64_t>(
+      cpu_encode_and_expand_lut_vector_64,
+      cpu_bootstrap_amortized_lwe_ciphertext_vector_64, 7, 3, -40);
+  printf("test_cpu_encode_lut: OK\n");
+  return 0;
+}
@@ -0,0 +1,150 @@
+#include "keyswitch.h"
+#include "keyswitch.hpp"
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+
+#include "utils.h"
+
+// Literal transcription of the keyswitch kernel of src/keyswitch.cuh for a
+// single block, used as the bit-exactness reference
+template <typename Torus>
+void reference_keyswitch(Torus *lwe_out, const Torus *lwe_in, const Torus *ksk,
+                         uint32_t lwe_dimension_before,
+                         uint32_t lwe_dimension_after, uint32_t base_log,
+                         uint32_t l_gadget) {
+  for (uint32_t idx = 0; idx < lwe_dimension_after; idx++)
+    lwe_out[idx] = 0;
+  lwe_out[lwe_dimension_after] = lwe_in[lwe_dimension_before];
+  for (uint32_t i = 0; i < lwe_dimension_before; i++) {
+    Torus a_i = round_to_closest_multiple(lwe_in[i], base_log, l_gadget);
+    Torus state = a_i >> (sizeof(Torus) * 8 - base_log * l_gadget);
+    Torus mod_b_mask = (1ll << base_log) - 1ll;
+    for (uint32_t j = 0; j < l_gadget; j++) {
+      auto ksk_block = get_ith_block(ksk, i, l_gadget - j - 1,
+                                     lwe_dimension_after, l_gadget);
+      Torus decomposed = decompose_one<Torus>(state, mod_b_mask, base_log);
+      for (uint32_t idx = 0; idx < lwe_dimension_after + 1; idx++)
+        lwe_out[idx] -= (Torus)ksk_block[idx] * decomposed;
+    }
+  }
+}
+
+template <typename Torus>
+void keyswitch_bit_exactness_test(uint32_t lwe_dimension_before,
+                                  uint32_t lwe_dimension_after,
+                                  uint32_t base_log, uint32_t l_gadget,
+                                  uint32_t num_samples) {
+  auto ksk = random_torus_vector<Torus>((size_t)lwe_dimension_before *
+                                        l_gadget * (lwe_dimension_after + 1));
+  auto lwe_in =
+      random_torus_vector<Torus>((size_t)num_samples * (lwe_dimension_before + 1));
+  std::vector<Torus> expected((size_t)num_samples * (lwe_dimension_after + 1));
+  for (uint32_t s = 0; s < num_samples; s++)
+    reference_keyswitch<Torus>(&expected[s * (lwe_dimension_after + 1)],
+                               &lwe_in[s * (lwe_dimension_before + 1)],
+                               ksk.data(), lwe_dimension_before,
+                               lwe_dimension_after, base_log, l_gadget);
+
+  for (int level = SCALAR; level <= get_simd_level(); level++) {
+    std::vector<Torus> lwe_out(expected.size(), 1);
+    cpu_keyswitch_lwe_ciphertext_vector<Torus>(
+        lwe_out.data(), lwe_in.data(), ksk.data(), lwe_dimension_before,
+        lwe_dimension_after, base_log, l_gadget, num_samples,
+        ThreadPool::global(), (SimdLevel)level);
+    assert(lwe_out == expected);
+  }
+}
+
+template <typename Torus>
+void keyswitch_tiled_bit_exactness_test(uint32_t lwe_dimension_before,
+                                        uint32_t lwe_dimension_after,
+                                        uint32_t base_log, uint32_t l_gadget,
+                                        uint32_t num_samples,
+                                        KeyswitchTiling tiling) {
+  auto ksk = random_torus_vector<Torus>((size_t)lwe_dimension_before *
+                                        l_gadget * (lwe_dimension_after + 1));
+  auto lwe_in =
+      random_torus_vector<Torus>((size_t)num_samples * (lwe_dimension_before + 1));
+  std::vector<Torus> expected((size_t)num_samples * (lwe_dimension_after + 1));
+  std::vector<Torus> lwe_out(expected.size(), 1);
+  cpu_keyswitch_lwe_ciphertext_vector<Torus>(
+      expected.data(), lwe_in.data(), ksk.data(), lwe_dimension_before,
+      lwe_dimension_after, base_log, l_gadget, num_samples);
+
+  cpu_keyswitch_tiled_lwe_ciphertext_vector<Torus>(
+      lwe_out.data(), lwe_in.data(), ksk.data(), lwe_dimension_before,
+      lwe_dimension_after, base_log, l_gadget, num_samples, tiling);
+  assert(lwe_out == expected);
+
+  std::fill(lwe_out.begin(), lwe_out.end(), 1);
+  cpu_keyswitch_tiled_lwe_ciphertext_vector<Torus>(
+      lwe_out.data(), lwe_in.data(), ksk.data(), lwe_dimension_before,
+      lwe_dimension_after, base_log, l_gadget, num_samples);
+  assert(lwe_out == expected);
+}
+
+void keyswitch_decrypt_test_64(void) {
+  uint32_t lwe_dimension_before = 1024, lwe_dimension_after = 600;
+  uint32_t base_log = 3, l_gadget = 5, num_samples = 16;
+  auto key_before = generate_lwe_secret_key<uint64_t>(lwe_dimension_before);
+  auto key_after = generate_lwe_secret_key<uint64_t>(lwe_dimension_after);
+  auto ksk = generate_lwe_keyswitch_key<uint64_t>(key_before, key_after,
+                                                  base_log, l_gadget, -40);
+
+  std::vector<uint64_t> lwe_in(num_samples * (lwe_dimension_before + 1));
+  std::vector<uint64_t> lwe_out(num_samples * (lwe_dimension_after + 1));
+  for (uint32_t s = 0; s < num_samples; s++)
+    encrypt_lwe<uint64_t>(&lwe_in[s * (lwe_dimension_before + 1)], key_before,
+                          encode<uint64_t>(s % (1 << MESSAGE_BITS)), -30);
+
+  cpu_keyswitch_lwe_ciphertext_vector_64(nullptr, lwe_out.data(), lwe_in.data(),
+                                         ksk.data(), lwe_dimension_before,
+                                         lwe_dimension_after, base_log,
+                                         l_gadget, num_samples);
+
+  for (uint32_t s = 0; s < num_samples; s++) {
+    uint64_t decrypted = decode<uint64_t>(decrypt_lwe<uint64_t>(
+        &lwe_out[s * (lwe_dimension_after + 1)], key_after));
+    assert(decrypted == s % (1 << MESSAGE_BITS));
+  }
+}
+
+void keyswitch_decrypt_test_32(void) {
+  uint32_t lwe_dimension_before = 1024, lwe_dimension_after = 600;
+  uint32_t base_log = 3, l_gadget = 5, num_samples = 16;
+  auto key_before = generate_lwe_secret_key<uint32_t>(lwe_dimension_before);
+  auto key_after = generate_lwe_secret_key<uint32_t>(lwe_dimension_after);
+  auto ksk = generate_lwe_keyswitch_key<uint32_t>(key_before, key_after,
+                                                  base_log, l_gadget, -25);
+
+  std::vector<uint32_t> lwe_in(num_samples * (lwe_dimension_before + 1));
+  std::vector<uint32_t> lwe_out(num_samples * (lwe_dimension_after + 1));
+  for (uint32_t s = 0; s < num_samples; s++)
+    encrypt_lwe<uint32_t>(&lwe_in[s * (lwe_dimension_before + 1)], key_before,
+                          encode<uint32_t>(s % (1 << MESSAGE_BITS)), -25);
+
+  cpu_keyswitch_lwe_ciphertext_vector_32(nullptr, lwe_out.data(), lwe_in.data(),
+                                         ksk.data(), lwe_dimension_before,
+                                         lwe_dimension_after, base_log,
+                                         l_gadget, num_samples);
+
+  for (uint32_t s = 0; s < num_samples; s++) {
+    uint32_t decrypted = decode<uint32_t>(decrypt_lwe<uint32_t>(
+        &lwe_out[s * (lwe_dimension_after + 1)], key_after));
+    assert(decrypted == s % (1 << MESSAGE_BITS));
+  }
+}
+
+int main(void) {
+  printf("Using SIMD level %d\n", get_simd_level());
+  keyswitch_bit_exactness_test<uint64_t>(630, 513, 2, 7, 33);
+  keyswitch_bit_exactness_test<uint32_t>(630, 513, 4, 3, 33);
+  keyswitch_bit_exactness_test<uint64_t>(1024, 600, 3, 5, 1);
+  keyswitch_tiled_bit_exactness_test<uint64_t>(630, 513, 2, 7, 33, {7, 3});
+  keyswitch_tiled_bit_exactness_test<uint32_t>(630, 513, 4, 3, 33, {630, 1});
+  keyswitch_tiled_bit_exactness_test<uint64_t>(100, 40, 3, 5, 5, {1, 8});
+  keyswitch_decrypt_test_64();
+  keyswitch_decrypt_test_32();
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,141 @@
+#include "bootstrap.h"
+#include "keyswitch.h"
+#include "keyswitch_bootstrap.hpp"
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+
+#include "utils.h"
+
+uint64_t negation(uint64_t m) { return (-m) % (1 << MESSAGE_BITS); }
+
+// A gate: ciphertexts under the GLWE key are keyswitched to the LWE key and
+// bootstrapped back under the GLWE key, with the same result as the
+// keyswitch followed by the bootstrap
+template <typename Torus>
+void keyswitch_bootstrap_test(
+    void (*keyswitch)(void *, void *, void *, void *, uint32_t, uint32_t,
+                      uint32_t, uint32_t, uint32_t),
+    void (*convert)(void *, void *, void *, uint32_t, uint32_t, uint32_t,
+                    uint32_t, uint32_t),
+    void (*bootstrap)(void *, void *, void *, void *, void *, void *, uint32_t,
+                      uint32_t, uint32_t, uint32_t, uint32_t, uint32_t,
+                      uint32_t, uint32_t),
+    void (*keyswitch_bootstrap)(void *, void *, void *, void *, void *, void *,
+                                void *, uint32_t, uint32_t, uint32_t,
+                                uint32_t, uint32_t, uint32_t, uint32_t,
+                                uint32_t, uint32_t, uint32_t, uint32_t),
+    uint32_t ks_base_log, uint32_t ks_l_gadget, uint32_t pbs_base_log,
+    uint32_t pbs_l_gadget, double log_std) {
+  uint32_t lwe_dimension = 400, polynomial_size = 1024, num_samples = 12;
+  auto lwe_key = generate_lwe_secret_key<Torus>(lwe_dimension);
+  auto glwe_key = generate_lwe_secret_key<Torus>(polynomial_size);
+  auto ksk = generate_lwe_keyswitch_key<Torus>(glwe_key, lwe_key, ks_base_log,
+                                               ks_l_gadget, log_std);
+  auto bsk = generate_lwe_bootstrap_key<Torus>(lwe_key, glwe_key, 1,
+                                               polynomial_size, pbs_base_log,
+                                               pbs_l_gadget, log_std);
+  std::vector<double2> fourier_bsk(bsk.size() / 2);
+  convert(fourier_bsk.data(), bsk.data(), nullptr, 0, lwe_dimension, 1,
+          pbs_l_gadget, polynomial_size);
+
+  std::vector<Torus> lut_vector(2 * polynomial_size);
+  fill_test_vector(lut_vector.data(), polynomial_size, negation);
+  std::vector<uint32_t> lut_vector_indexes(num_samples, 0);
+  std::vector<Torus> lwe_in(num_samples * (polynomial_size + 1));
+  std::vector<uint64_t> messages(num_samples);
+  for (uint32_t s = 0; s < num_samples; s++) {
+    messages[s] = get_test_rng()() % (1 << MESSAGE_BITS);
+    encrypt_lwe<Torus>(&lwe_in[s * (polynomial_size + 1)], glwe_key,
+                       encode<Torus>(messages[s]), log_std);
+  }
+
+  std::vector<Torus> lwe_out(num_samples * (polynomial_size + 1));
+  keyswitch_bootstrap(nullptr, lwe_out.data(), lut_vector.data(),
+                      lut_vector_indexes.data(), lwe_in.data(), ksk.data(),
+                      fourier_bsk.data(), polynomial_size, lwe_dimension,
+                      polynomial_size, ks_base_log, ks_l_gadget, pbs_base_log,
+                      pbs_l_gadget, num_samples, 1, 0, 0);
+  for (uint32_t s = 0; s < num_samples; s++) {
+    Torus plaintext =
+        decrypt_lwe(&lwe_out[s * (polynomial_size + 1)], glwe_key);
+    assert(decode(plaintext) == negation(messages[s]));
+  }
+
+  std::vector<Torus> lwe_keyswitched(num_samples * (lwe_dimension + 1));
+  std::vector<Torus> expected(lwe_out.size());
+  keyswitch(nullptr, lwe_keyswitched.data(), lwe_in.data(), ksk.data(),
+            polynomial_size, lwe_dimension, ks_base_log, ks_l_gadget,
+            num_samples);
+  bootstrap(nullptr, expected.data(), lut_vector.data(),
+            lut_vector_indexes.data(), lwe_keyswitched.data(),
+            fourier_bsk.data(), lwe_dimension, polynomial_size, pbs_base_log,
+            pbs_l_gadget, num_samples, 1, 0, 0);
+  assert(lwe_out == expected);
+}
+
+// Groups of several ciphertexts, keyswitched together, and changes of the
+// dimensions between calls give the results of the separate keyswitch and
+// bootstrap
+void keyswitch_bootstrap_dimensions_test(void) {
+  uint32_t input_lwe_dimension = 300, polynomial_size = 512, l_gadget = 2;
+  uint32_t num_samples = 6;
+  auto lut_vector = random_torus_vector<uint32_t>(2 * polynomial_size);
+  std::vector<uint32_t> lut_vector_indexes(num_samples, 0);
+  auto lwe_in =
+      random_torus_vector<uint32_t>(num_samples * (input_lwe_dimension + 1));
+  for (uint32_t lwe_dimension : {100u, 200u, 100u}) {
+    auto ksk = random_torus_vector<uint32_t>(
+        (size_t)input_lwe_dimension * l_gadget * (lwe_dimension + 1));
+    auto bsk = random_torus_vector<uint32_t>((size_t)lwe_dimension * l_gadget *
+                                             4 * polynomial_size);
+    std::vector<double2> fourier_bsk(bsk.size() / 2);
+    cpu_convert_lwe_bootstrap_key_32(fourier_bsk.data(), bsk.data(), nullptr,
+                                     0, lwe_dimension, 1, l_gadget,
+                                     polynomial_size);
+
+    std::vector<uint32_t> lwe_keyswitched(num_samples * (lwe_dimension + 1));
+    std::vector<uint32_t> expected(num_samples * (polynomial_size + 1));
+    cpu_keyswitch_lwe_ciphertext_vector_32(
+        nullptr, lwe_keyswitched.data(), lwe_in.data(), ksk.data(),
+        input_lwe_dimension, lwe_dimension, 8, l_gadget, num_samples);
+    cpu_bootstrap_amortized_lwe_ciphertext_vector_32(
+        nullptr, expected.data(), lut_vector.data(), lut_vector_indexes.data(),
+        lwe_keyswitched.data(), fourier_bsk.data(), lwe_dimension,
+        polynomial_size, 8, l_gadget, num_samples, 1, 0, 0);
+
+    std::vector<uint32_t> lwe_out(expected.size());
+    cpu_keyswitch_bootstrap_amortized_lwe_ciphertext_vector_32(
+        nullptr, lwe_out.data(), lut_vector.data(), lut_vector_indexes.data(),
+        lwe_in.data(), ksk.data(), fourier_bsk.data(), input_lwe_dimension,
+        lwe_dimension, polynomial_size, 8, l_gadget, 8, l_gadget, num_samples,
+        1, 0, 0);
+    assert(lwe_out == expected);
+
+    // Groups of 2 ciphertexts on a pool of 3 threads
+    ThreadPool pool(3);
+    std::fill(lwe_out.begin(), lwe_out.end(), 0);
+    cpu_keyswitch_bootstrap_amortized_lwe_ciphertext_vector<uint32_t>(
+        lwe_out.data(), lut_vector.data(), lut_vector_indexes.data(),
+        lwe_in.data(), ksk.data(), fourier_bsk.data(), input_lwe_dimension,
+        lwe_dimension, polynomial_size, 8, l_gadget, 8, l_gadget, num_samples,
+        0, 1, pool);
+    assert(lwe_out == expected);
+  }
+}
+
+int main(void) {
+  keyswitch_bootstrap_test<uint32_t>(
+      cpu_keyswitch_lwe_ciphertext_vector_32, cpu_convert_lwe_bootstrap_key_32,
+      cpu_bootstrap_amortized_lwe_ciphertext_vector_32,
+      cpu_keyswitch_bootstrap_amortized_lwe_ciphertext_vector_32, 3, 7, 6, 3,
+      -25);
+  keyswitch_bootstrap_test<uint64_t>(
+      cpu_keyswitch_lwe_ciphertext_vector_64, cpu_convert_lwe_bootstrap_key_64,
+      cpu_bootstrap_amortized_lwe_ciphertext_vector_64,
+      cpu_keyswitch_bootstrap_amortized_lwe_ciphertext_vector_64, 4, 5, 7, 3,
+      -40);
+  keyswitch_bootstrap_dimensions_test();
+  printf("test_cpu_keyswitch_bootstrap: OK\n");
+  return 0;
+}
@@ -0,0 +1,98 @@
+#include "keyswitch.h"
+#include "keyswitch_coefficient_major.hpp"
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+
+#include "utils.h"
+
+template <typename Torus>
+void lwe_batch_conversion_test(uint32_t lwe_dimension, uint32_t num_samples) {
+  auto lwe = random_torus_vector<Torus>((size_t)num_samples * (lwe_dimension + 1));
+  std::vector<Torus> transposed(lwe.size());
+  std::vector<Torus> back(lwe.size());
+  cpu_lwe_batch_to_coefficient_major(transposed.data(), lwe.data(),
+                                     lwe_dimension, num_samples);
+  for (uint32_t s = 0; s < num_samples; s++)
+    for (uint32_t k = 0; k <= lwe_dimension; k++)
+      assert(transposed[(size_t)k * num_samples + s] ==
+             lwe[(size_t)s * (lwe_dimension + 1) + k]);
+  cpu_lwe_batch_from_coefficient_major(back.data(), transposed.data(),
+                                       lwe_dimension, num_samples);
+  assert(back == lwe);
+}
+
+// The coefficient-major keyswitch is the transposition of the sample-major
+// one, bit for bit, at every SIMD level
+template <typename Torus>
+void keyswitch_coefficient_major_bit_exactness_test(
+    uint32_t lwe_dimension_before, uint32_t lwe_dimension_after,
+    uint32_t base_log, uint32_t l_gadget, uint32_t num_samples) {
+  auto ksk = random_torus_vector<Torus>((size_t)lwe_dimension_before *
+                                        l_gadget * (lwe_dimension_after + 1));
+  auto lwe_in =
+      random_torus_vector<Torus>((size_t)num_samples * (lwe_dimension_before + 1));
+  std::vector<Torus> expected((size_t)num_samples * (lwe_dimension_after + 1));
+  cpu_keyswitch_lwe_ciphertext_vector<Torus>(
+      expected.data(), lwe_in.data(), ksk.data(), lwe_dimension_before,
+      lwe_dimension_after, base_log, l_gadget, num_samples);
+
+  std::vector<Torus> lwe_in_cm(lwe_in.size());
+  cpu_lwe_batch_to_coefficient_major(lwe_in_cm.data(), lwe_in.data(),
+                                     lwe_dimension_before, num_samples);
+  for (int level = SCALAR; level <= get_simd_level(); level++) {
+    std::vector<Torus> lwe_out_cm(expected.size(), 1);
+    std::vector<Torus> lwe_out(expected.size());
+    cpu_keyswitch_coefficient_major_lwe_ciphertext_vector<Torus>(
+        lwe_out_cm.data(), lwe_in_cm.data(), ksk.data(), lwe_dimension_before,
+        lwe_dimension_after, base_log, l_gadget, num_samples,
+        ThreadPool::global(), (SimdLevel)level);
+    cpu_lwe_batch_from_coefficient_major(lwe_out.data(), lwe_out_cm.data(),
+                                         lwe_dimension_after, num_samples);
+    assert(lwe_out == expected);
+  }
+}
+
+void keyswitch_coefficient_major_decrypt_test_64(void) {
+  uint32_t lwe_dimension_before = 1024, lwe_dimension_after = 600;
+  uint32_t base_log = 3, l_gadget = 5, num_samples = 40;
+  auto key_before = generate_lwe_secret_key<uint64_t>(lwe_dimension_before);
+  auto key_after = generate_lwe_secret_key<uint64_t>(lwe_dimension_after);
+  auto ksk = generate_lwe_keyswitch_key<uint64_t>(key_before, key_after,
+                                                  base_log, l_gadget, -40);
+
+  std::vector<uint64_t> lwe_in(num_samples * (lwe_dimension_before + 1));
+  std::vector<uint64_t> lwe_in_cm(lwe_in.size());
+  std::vector<uint64_t> lwe_out_cm(num_samples * (lwe_dimension_after + 1));
+  std::vector<uint64_t> lwe_out(lwe_out_cm.size());
+  for (uint32_t s = 0; s < num_samples; s++)
+    encrypt_lwe<uint64_t>(&lwe_in[s * (lwe_dimension_before + 1)], key_before,
+                          encode<uint64_t>(s % (1 << MESSAGE_BITS)), -30);
+
+  cpu_convert_lwe_batch_to_coefficient_major_64(
+      lwe_in_cm.data(), lwe_in.data(), lwe_dimension_before, num_samples);
+  cpu_keyswitch_coefficient_major_lwe_ciphertext_vector_64(
+      nullptr, lwe_out_cm.data(), lwe_in_cm.data(), ksk.data(),
+      lwe_dimension_before, lwe_dimension_after, base_log, l_gadget,
+      num_samples);
+  cpu_convert_lwe_batch_from_coefficient_major_64(
+      lwe_out.data(), lwe_out_cm.data(), lwe_dimension_after, num_samples);
+
+  for (uint32_t s = 0; s < num_samples; s++) {
+    uint64_t decrypted = decode<uint64_t>(decrypt_lwe<uint64_t>(
+        &lwe_out[s * (lwe_dimension_after + 1)], key_after));
+    assert(decrypted == s % (1 << MESSAGE_BITS));
+  }
+}
+
+int main(void) {
+  lwe_batch_conversion_test<uint64_t>(630, 33);
+  lwe_batch_conversion_test<uint32_t>(31, 100);
+  lwe_batch_conversion_test<uint64_t>(10, 1);
+  keyswitch_coefficient_major_bit_exactness_test<uint64_t>(630, 513, 2, 7, 33);
+  keyswitch_coefficient_major_bit_exactness_test<uint32_t>(630, 513, 4, 3, 33);
+  keyswitch_coefficient_major_bit_exactness_test<uint64_t>(100, 40, 3, 5, 16);
+  keyswitch_coefficient_major_bit_exactness_test<uint32_t>(70, 41, 3, 5, 5);
+  keyswitch_coefficient_major_decrypt_test_64();
+  return EXIT_SUCCESS;
+}
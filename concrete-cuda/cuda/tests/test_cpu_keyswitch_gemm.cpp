@@ -0,0 +1,87 @@
+#include "keyswitch.h"
+#include "keyswitch_gemm.hpp"
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+
+#include "utils.h"
+
+// Straightforward digits x KSK product, used as the reference
+template <typename Torus>
+void reference_keyswitch_gemm(Torus *lwe_out, const Torus *lwe_in,
+                              const Torus *ksk, uint32_t lwe_dimension_before,
+                              uint32_t lwe_dimension_after, uint32_t base_log,
+                              uint32_t l_gadget) {
+  GadgetMatrixSingle<Torus> gadget(base_log, l_gadget);
+  for (uint32_t idx = 0; idx < lwe_dimension_after; idx++)
+    lwe_out[idx] = 0;
+  lwe_out[lwe_dimension_after] = lwe_in[lwe_dimension_before];
+  for (uint32_t i = 0; i < lwe_dimension_before; i++) {
+    Torus a_i = round_to_closest_multiple(lwe_in[i], base_log, l_gadget);
+    for (uint32_t level = 0; level < l_gadget; level++) {
+      Torus digit = gadget.decompose_one_level_single(a_i, level);
+      const Torus *row = &ksk[(i * l_gadget + level) * (lwe_dimension_after + 1)];
+      for (uint32_t idx = 0; idx < lwe_dimension_after + 1; idx++)
+        lwe_out[idx] -= row[idx] * digit;
+    }
+  }
+}
+
+template <typename Torus>
+void keyswitch_gemm_test(uint32_t lwe_dimension_before,
+                         uint32_t lwe_dimension_after, uint32_t base_log,
+                         uint32_t l_gadget, uint32_t num_samples) {
+  auto ksk = random_torus_vector<Torus>((size_t)lwe_dimension_before *
+                                        l_gadget * (lwe_dimension_after + 1));
+  auto lwe_in =
+      random_torus_vector<Torus>((size_t)num_samples * (lwe_dimension_before + 1));
+  std::vector<Torus> expected((size_t)num_samples * (lwe_dimension_after + 1));
+  for (uint32_t s = 0; s < num_samples; s++)
+    reference_keyswitch_gemm<Torus>(&expected[s * (lwe_dimension_after + 1)],
+                                    &lwe_in[s * (lwe_dimension_before + 1)],
+                                    ksk.data(), lwe_dimension_before,
+                                    lwe_dimension_after, base_log, l_gadget);
+
+  for (int level = SCALAR; level <= get_simd_level(); level++) {
+    std::vector<Torus> lwe_out(expected.size(), 1);
+    cpu_keyswitch_gemm_lwe_ciphertext_vector<Torus>(
+        lwe_out.data(), lwe_in.data(), ksk.data(), lwe_dimension_before,
+        lwe_dimension_after, base_log, l_gadget, num_samples,
+        ThreadPool::global(), (SimdLevel)level);
+    assert(lwe_out == expected);
+  }
+}
+
+void keyswitch_gemm_decrypt_test_64(void) {
+  uint32_t lwe_dimension_before = 1024, lwe_dimension_after = 600;
+  uint32_t base_log = 3, l_gadget = 5, num_samples = 37;
+  auto key_before = generate_lwe_secret_key<uint64_t>(lwe_dimension_before);
+  auto key_after = generate_lwe_secret_key<uint64_t>(lwe_dimension_after);
+  auto ksk = generate_lwe_keyswitch_key<uint64_t>(key_before, key_after,
+                                                  base_log, l_gadget, -40);
+
+  std::vector<uint64_t> lwe_in(num_samples * (lwe_dimension_before + 1));
+  std::vector<uint64_t> lwe_out(num_samples * (lwe_dimension_after + 1));
+  for (uint32_t s = 0; s < num_samples; s++)
+    encrypt_lwe<uint64_t>(&lwe_in[s * (lwe_dimension_before + 1)], key_before,
+                          encode<uint64_t>(s % (1 << MESSAGE_BITS)), -30);
+
+  cpu_keyswitch_gemm_lwe_ciphertext_vector_64(
+      nullptr, lwe_out.data(), lwe_in.data(), ksk.data(), lwe_dimension_before,
+      lwe_dimension_after, base_log, l_gadget, num_samples);
+
+  for (uint32_t s = 0; s < num_samples; s++) {
+    uint64_t decrypted = decode<uint64_t>(decrypt_lwe<uint64_t>(
+        &lwe_out[s * (lwe_dimension_after + 1)], key_after));
+    assert(decrypted == s % (1 << MESSAGE_BITS));
+  }
+}
+
+int main(void) {
+  keyswitch_gemm_test<uint64_t>(630, 513, 2, 7, 33);
+  keyswitch_gemm_test<uint64_t>(300, 47, 12, 3, 9);
+  keyswitch_gemm_test<uint64_t>(200, 31, 20, 2, 4);
+  keyswitch_gemm_test<uint32_t>(630, 513, 4, 3, 33);
+  keyswitch_gemm_decrypt_test_64();
+  return EXIT_SUCCESS;
+}
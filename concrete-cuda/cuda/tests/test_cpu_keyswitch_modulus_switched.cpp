@@ -0,0 +1,106 @@
+#include "crypto/torus.hpp"
+#include "keyswitch.h"
+#include "keyswitch.hpp"
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+
+#include "utils.h"
+
+// The integer modulus switch is the rescaling of the bootstrap reduced
+// modulo 2N. On 64 bits the conversion to double of the rescaling may round
+// elements right below a rounding boundary onto it, so the boundaries are
+// checked against the exact rounding instead.
+template <typename Torus> void modulus_switch_test(void) {
+  for (uint32_t log_modulus = 10; log_modulus <= 15; log_modulus++) {
+    Torus modulus_mask = ((Torus)1 << log_modulus) - 1;
+    Torus half_step = (Torus)1 << (sizeof(Torus) * 8 - log_modulus - 1);
+    for (int k = 0; k < 10000; k++) {
+      Torus element = random_torus<Torus>();
+      Torus expected =
+          rescale_torus_element(element, 1 << log_modulus) & modulus_mask;
+      assert(modulus_switch(element, log_modulus) == expected);
+    }
+    assert(modulus_switch<Torus>(0, log_modulus) == 0);
+    assert(modulus_switch<Torus>(half_step - 1, log_modulus) == 0);
+    assert(modulus_switch<Torus>(half_step, log_modulus) == 1);
+    assert(modulus_switch<Torus>(3 * half_step - 1, log_modulus) == 1);
+    assert(modulus_switch<Torus>(3 * half_step, log_modulus) == 2);
+    assert(modulus_switch<Torus>(-half_step - 1, log_modulus) == modulus_mask);
+    assert(modulus_switch<Torus>(-half_step, log_modulus) == 0);
+    assert(modulus_switch<Torus>(-1, log_modulus) == 0);
+  }
+}
+
+// The fused engine outputs the modulus switch of the regular keyswitch
+template <typename Torus>
+void keyswitch_modulus_switched_test(
+    void (*keyswitch)(void *, void *, void *, void *, uint32_t, uint32_t,
+                      uint32_t, uint32_t, uint32_t),
+    void (*keyswitch_modulus_switched)(void *, void *, void *, void *,
+                                       uint32_t, uint32_t, uint32_t, uint32_t,
+                                       uint32_t, uint32_t)) {
+  uint32_t lwe_dimension_before = 1024, lwe_dimension_after = 600;
+  uint32_t base_log = 3, l_gadget = 5, polynomial_size = 2048;
+  uint32_t log_modulus = 12;
+  auto ksk = random_torus_vector<Torus>((size_t)lwe_dimension_before *
+                                        l_gadget * (lwe_dimension_after + 1));
+  for (uint32_t num_samples : {1u, 37u, 300u}) {
+    auto lwe_in =
+        random_torus_vector<Torus>(num_samples * (lwe_dimension_before + 1));
+    std::vector<Torus> lwe_out(num_samples * (lwe_dimension_after + 1));
+    std::vector<uint16_t> lwe_out_switched(lwe_out.size());
+    keyswitch(nullptr, lwe_out.data(), lwe_in.data(), ksk.data(),
+              lwe_dimension_before, lwe_dimension_after, base_log, l_gadget,
+              num_samples);
+    keyswitch_modulus_switched(nullptr, lwe_out_switched.data(), lwe_in.data(),
+                               ksk.data(), lwe_dimension_before,
+                               lwe_dimension_after, base_log, l_gadget,
+                               polynomial_size, num_samples);
+    for (size_t k = 0; k < lwe_out.size(); k++)
+      assert(lwe_out_switched[k] == modulus_switch(lwe_out[k], log_modulus));
+  }
+}
+
+// The compact output still decrypts to the message, in Z_2N
+void keyswitch_modulus_switched_decrypt_test(void) {
+  uint32_t lwe_dimension_before = 1024, lwe_dimension_after = 600;
+  uint32_t base_log = 3, l_gadget = 5, polynomial_size = 2048;
+  uint32_t log_modulus = 12, num_samples = 64;
+  auto key_before = generate_lwe_secret_key<uint64_t>(lwe_dimension_before);
+  auto key_after = generate_lwe_secret_key<uint64_t>(lwe_dimension_after);
+  auto ksk = generate_lwe_keyswitch_key<uint64_t>(key_before, key_after,
+                                                  base_log, l_gadget, -40);
+  std::vector<uint64_t> lwe_in(num_samples * (lwe_dimension_before + 1));
+  std::vector<uint64_t> messages(num_samples);
+  for (uint32_t s = 0; s < num_samples; s++) {
+    messages[s] = s % (1 << MESSAGE_BITS);
+    encrypt_lwe<uint64_t>(&lwe_in[s * (lwe_dimension_before + 1)], key_before,
+                          encode<uint64_t>(messages[s]), -40);
+  }
+  std::vector<uint16_t> lwe_out(num_samples * (lwe_dimension_after + 1));
+  cpu_keyswitch_modulus_switched_lwe_ciphertext_vector_64(
+      nullptr, lwe_out.data(), lwe_in.data(), ksk.data(), lwe_dimension_before,
+      lwe_dimension_after, base_log, l_gadget, polynomial_size, num_samples);
+
+  for (uint32_t s = 0; s < num_samples; s++) {
+    const uint16_t *block = &lwe_out[s * (lwe_dimension_after + 1)];
+    uint64_t phase = block[lwe_dimension_after];
+    for (uint32_t i = 0; i < lwe_dimension_after; i++)
+      phase -= block[i] * key_after[i];
+    assert(decode<uint64_t>(phase << (64 - log_modulus)) == messages[s]);
+  }
+}
+
+int main(void) {
+  modulus_switch_test<uint32_t>();
+  modulus_switch_test<uint64_t>();
+  keyswitch_modulus_switched_test<uint32_t>(
+      cpu_keyswitch_lwe_ciphertext_vector_32,
+      cpu_keyswitch_modulus_switched_lwe_ciphertext_vector_32);
+  keyswitch_modulus_switched_test<uint64_t>(
+      cpu_keyswitch_lwe_ciphertext_vector_64,
+      cpu_keyswitch_modulus_switched_lwe_ciphertext_vector_64);
+  keyswitch_modulus_switched_decrypt_test();
+  return EXIT_SUCCESS;
+}
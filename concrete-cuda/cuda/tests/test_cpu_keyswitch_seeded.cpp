@@ -0,0 +1,155 @@
+#include "keyswitch.h"
+#include "keyswitch.hpp"
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "utils.h"
+
+// FIPS-197 appendix C.1 vector
+void aes_known_answer_test(bool use_aesni) {
+  uint8_t key[16], plaintext[16], ciphertext[16];
+  const uint8_t expected[16] = {0x69, 0xc4, 0xe0, 0xd8, 0x6a, 0x7b,
+                                0x04, 0x30, 0xd8, 0xcd, 0xb7, 0x80,
+                                0x70, 0xb4, 0xc5, 0x5a};
+  for (int i = 0; i < 16; i++) {
+    key[i] = i;
+    plaintext[i] = (i << 4) | i;
+  }
+  AesCtr128 aes(key, use_aesni);
+  aes.encrypt_block(ciphertext, plaintext);
+  assert(memcmp(ciphertext, expected, 16) == 0);
+}
+
+// Any window of the keystream matches the same words read from the start,
+// and both AES implementations agree
+template <typename Word> void aes_keystream_test(void) {
+  uint8_t seed[16];
+  for (int i = 0; i < 16; i++)
+    seed[i] = 3 * i + 1;
+  AesCtr128 software(seed, false);
+  std::vector<Word> full(300);
+  software.fill_keystream(full.data(), 0, full.size());
+
+  AesCtr128 aes(seed);
+  uint64_t windows[][2] = {{0, 300}, {1, 5}, {3, 130}, {7, 1}, {64, 200}};
+  for (auto &window : windows) {
+    std::vector<Word> part(window[1]);
+    aes.fill_keystream(part.data(), window[0], window[1]);
+    for (uint64_t k = 0; k < window[1]; k++)
+      assert(part[k] == full[window[0] + k]);
+  }
+
+  // As in concrete-csprng, the words are read from the second byte of the
+  // keystream
+  uint8_t stream[48], counter[16];
+  for (uint8_t block = 0; block < 3; block++) {
+    memset(counter, 0, 16);
+    counter[0] = block;
+    software.encrypt_block(&stream[16 * block], counter);
+  }
+  for (uint64_t w = 0; (w + 1) * sizeof(Word) < sizeof(stream); w++) {
+    Word expected;
+    memcpy(&expected, &stream[1 + w * sizeof(Word)], sizeof(Word));
+    assert(full[w] == expected);
+  }
+}
+
+/// Seeded KSK: returns the bodies, the masks being the keystream of the seed
+template <typename Torus>
+std::vector<Torus> generate_seeded_lwe_keyswitch_key(
+    const std::vector<Torus> &key_before, const std::vector<Torus> &key_after,
+    const uint8_t seed[16], uint32_t base_log, uint32_t l_gadget,
+    double log_std) {
+  AesCtr128 aes(seed);
+  uint32_t lwe_dimension_after = key_after.size();
+  std::vector<Torus> mask(lwe_dimension_after);
+  std::vector<Torus> bodies(key_before.size() * l_gadget);
+  for (size_t i = 0; i < key_before.size(); i++) {
+    for (uint32_t j = 0; j < l_gadget; j++) {
+      size_t row = i * l_gadget + j;
+      aes.fill_keystream(mask.data(), row * lwe_dimension_after,
+                         lwe_dimension_after);
+      Torus body = (key_before[i] << (sizeof(Torus) * 8 - (j + 1) * base_log)) +
+                   gaussian_torus_noise<Torus>(log_std);
+      for (uint32_t k = 0; k < lwe_dimension_after; k++)
+        body += mask[k] * key_after[k];
+      bodies[row] = body;
+    }
+  }
+  return bodies;
+}
+
+template <typename Torus>
+void keyswitch_seeded_bit_exactness_test(uint32_t lwe_dimension_before,
+                                         uint32_t lwe_dimension_after,
+                                         uint32_t base_log, uint32_t l_gadget,
+                                         uint32_t num_samples) {
+  uint8_t seed[16];
+  for (auto &byte : seed)
+    byte = get_test_rng()();
+  auto bodies = random_torus_vector<Torus>((size_t)lwe_dimension_before * l_gadget);
+  auto lwe_in =
+      random_torus_vector<Torus>((size_t)num_samples * (lwe_dimension_before + 1));
+
+  std::vector<Torus> ksk((size_t)lwe_dimension_before * l_gadget *
+                         (lwe_dimension_after + 1));
+  cpu_expand_seeded_lwe_keyswitch_key<Torus>(ksk.data(), bodies.data(), seed,
+                                             lwe_dimension_before,
+                                             lwe_dimension_after, l_gadget);
+  for (size_t row = 0; row < bodies.size(); row++)
+    assert(ksk[row * (lwe_dimension_after + 1) + lwe_dimension_after] ==
+           bodies[row]);
+
+  std::vector<Torus> expected((size_t)num_samples * (lwe_dimension_after + 1));
+  std::vector<Torus> lwe_out(expected.size(), 1);
+  cpu_keyswitch_lwe_ciphertext_vector<Torus>(
+      expected.data(), lwe_in.data(), ksk.data(), lwe_dimension_before,
+      lwe_dimension_after, base_log, l_gadget, num_samples);
+  cpu_keyswitch_seeded_lwe_ciphertext_vector<Torus>(
+      lwe_out.data(), lwe_in.data(), bodies.data(), seed, lwe_dimension_before,
+      lwe_dimension_after, base_log, l_gadget, num_samples);
+  assert(lwe_out == expected);
+}
+
+void keyswitch_seeded_decrypt_test_64(void) {
+  uint32_t lwe_dimension_before = 1024, lwe_dimension_after = 600;
+  uint32_t base_log = 3, l_gadget = 5, num_samples = 16;
+  uint8_t seed[16] = {0x5e, 0xed};
+  auto key_before = generate_lwe_secret_key<uint64_t>(lwe_dimension_before);
+  auto key_after = generate_lwe_secret_key<uint64_t>(lwe_dimension_after);
+  auto bodies = generate_seeded_lwe_keyswitch_key<uint64_t>(
+      key_before, key_after, seed, base_log, l_gadget, -40);
+
+  std::vector<uint64_t> lwe_in(num_samples * (lwe_dimension_before + 1));
+  std::vector<uint64_t> lwe_out(num_samples * (lwe_dimension_after + 1));
+  for (uint32_t s = 0; s < num_samples; s++)
+    encrypt_lwe<uint64_t>(&lwe_in[s * (lwe_dimension_before + 1)], key_before,
+                          encode<uint64_t>(s % (1 << MESSAGE_BITS)), -30);
+
+  cpu_keyswitch_seeded_lwe_ciphertext_vector_64(
+      nullptr, lwe_out.data(), lwe_in.data(), bodies.data(), seed,
+      lwe_dimension_before, lwe_dimension_after, base_log, l_gadget,
+      num_samples);
+
+  for (uint32_t s = 0; s < num_samples; s++) {
+    uint64_t decrypted = decode<uint64_t>(decrypt_lwe<uint64_t>(
+        &lwe_out[s * (lwe_dimension_after + 1)], key_after));
+    assert(decrypted == s % (1 << MESSAGE_BITS));
+  }
+}
+
+int main(void) {
+  printf("AES-NI %s\n", AesCtr128::has_aesni() ? "available" : "unavailable");
+  aes_known_answer_test(false);
+  if (AesCtr128::has_aesni())
+    aes_known_answer_test(true);
+  aes_keystream_test<uint64_t>();
+  aes_keystream_test<uint32_t>();
+  keyswitch_seeded_bit_exactness_test<uint64_t>(630, 513, 2, 7, 33);
+  keyswitch_seeded_bit_exactness_test<uint32_t>(630, 513, 4, 3, 33);
+  keyswitch_seeded_bit_exactness_test<uint64_t>(100, 41, 3, 5, 1);
+  keyswitch_seeded_decrypt_test_64();
+  return EXIT_SUCCESS;
+}
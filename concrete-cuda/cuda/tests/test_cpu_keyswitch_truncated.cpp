@@ -0,0 +1,117 @@
+#include "keyswitch.h"
+#include "keyswitch.hpp"
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#include "utils.h"
+
+// The widening kernels compute the same bits as the 64 bits kernel applied
+// to the widened KSK
+void widened_kernel_test(void) {
+  uint32_t size = 601;
+  auto ksk = random_torus_vector<uint32_t>(size);
+  auto initial = random_torus_vector<uint64_t>(size);
+  std::vector<uint64_t> widened(size);
+  for (uint32_t k = 0; k < size; k++)
+    widened[k] = (uint64_t)ksk[k] << 32;
+  uint64_t scales[] = {1, 3, (uint64_t)-4, (uint64_t)-1};
+
+  for (auto scale : scales) {
+    std::vector<uint64_t> expected = initial;
+    sub_scaled_vector_scalar(expected.data(), widened.data(), scale, size);
+    for (int level = SCALAR; level <= get_simd_level(); level++) {
+      std::vector<uint64_t> out = initial;
+      sub_scaled_vector(out.data(), ksk.data(), scale, size, (SimdLevel)level);
+      assert(out == expected);
+    }
+  }
+}
+
+// The truncated keyswitch is the keyswitch with the widened KSK, and its
+// difference with the full keyswitch has the estimated variance
+void keyswitch_truncated_noise_test(void) {
+  uint32_t lwe_dimension_before = 1024, lwe_dimension_after = 600;
+  uint32_t base_log = 3, l_gadget = 5, num_samples = 256;
+  auto key_before = generate_lwe_secret_key<uint64_t>(lwe_dimension_before);
+  auto key_after = generate_lwe_secret_key<uint64_t>(lwe_dimension_after);
+  auto ksk = generate_lwe_keyswitch_key<uint64_t>(key_before, key_after,
+                                                  base_log, l_gadget, -40);
+  std::vector<uint32_t> truncated_ksk(ksk.size());
+  cpu_truncate_lwe_keyswitch_key_64(truncated_ksk.data(), ksk.data(),
+                                    lwe_dimension_before, lwe_dimension_after,
+                                    l_gadget);
+  std::vector<uint64_t> widened_ksk(ksk.size());
+  for (size_t k = 0; k < ksk.size(); k++)
+    widened_ksk[k] = (uint64_t)truncated_ksk[k] << 32;
+
+  auto lwe_in =
+      random_torus_vector<uint64_t>(num_samples * (lwe_dimension_before + 1));
+  std::vector<uint64_t> lwe_out(num_samples * (lwe_dimension_after + 1));
+  std::vector<uint64_t> expected(lwe_out.size());
+  std::vector<uint64_t> full(lwe_out.size());
+  cpu_keyswitch_truncated_lwe_ciphertext_vector_64(
+      nullptr, lwe_out.data(), lwe_in.data(), truncated_ksk.data(),
+      lwe_dimension_before, lwe_dimension_after, base_log, l_gadget,
+      num_samples);
+  cpu_keyswitch_lwe_ciphertext_vector<uint64_t>(
+      expected.data(), lwe_in.data(), widened_ksk.data(), lwe_dimension_before,
+      lwe_dimension_after, base_log, l_gadget, num_samples);
+  assert(lwe_out == expected);
+
+  cpu_keyswitch_lwe_ciphertext_vector<uint64_t>(
+      full.data(), lwe_in.data(), ksk.data(), lwe_dimension_before,
+      lwe_dimension_after, base_log, l_gadget, num_samples);
+  double variance = 0;
+  for (uint32_t s = 0; s < num_samples; s++) {
+    uint64_t error =
+        decrypt_lwe<uint64_t>(&lwe_out[s * (lwe_dimension_after + 1)],
+                              key_after) -
+        decrypt_lwe<uint64_t>(&full[s * (lwe_dimension_after + 1)], key_after);
+    double torus_error = std::ldexp((double)(int64_t)error, -64);
+    variance += torus_error * torus_error / num_samples;
+  }
+  double estimate = cpu_truncated_keyswitch_key_noise_variance_64(
+      lwe_dimension_before, lwe_dimension_after, base_log, l_gadget);
+  printf("Truncation noise: measured 2^%.2f, estimated 2^%.2f\n",
+         std::log2(std::sqrt(variance)), std::log2(std::sqrt(estimate)));
+  assert(variance > 0.7 * estimate && variance < 1.4 * estimate);
+}
+
+void keyswitch_truncated_decrypt_test(void) {
+  uint32_t lwe_dimension_before = 1024, lwe_dimension_after = 600;
+  uint32_t base_log = 3, l_gadget = 5, num_samples = 16;
+  auto key_before = generate_lwe_secret_key<uint64_t>(lwe_dimension_before);
+  auto key_after = generate_lwe_secret_key<uint64_t>(lwe_dimension_after);
+  auto ksk = generate_lwe_keyswitch_key<uint64_t>(key_before, key_after,
+                                                  base_log, l_gadget, -30);
+  std::vector<uint32_t> truncated_ksk(ksk.size());
+  cpu_truncate_lwe_keyswitch_key_64(truncated_ksk.data(), ksk.data(),
+                                    lwe_dimension_before, lwe_dimension_after,
+                                    l_gadget);
+
+  std::vector<uint64_t> lwe_in(num_samples * (lwe_dimension_before + 1));
+  std::vector<uint64_t> lwe_out(num_samples * (lwe_dimension_after + 1));
+  for (uint32_t s = 0; s < num_samples; s++)
+    encrypt_lwe<uint64_t>(&lwe_in[s * (lwe_dimension_before + 1)], key_before,
+                          encode<uint64_t>(s % (1 << MESSAGE_BITS)), -30);
+
+  cpu_keyswitch_truncated_lwe_ciphertext_vector_64(
+      nullptr, lwe_out.data(), lwe_in.data(), truncated_ksk.data(),
+      lwe_dimension_before, lwe_dimension_after, base_log, l_gadget,
+      num_samples);
+
+  for (uint32_t s = 0; s < num_samples; s++) {
+    uint64_t decrypted = decode<uint64_t>(decrypt_lwe<uint64_t>(
+        &lwe_out[s * (lwe_dimension_after + 1)], key_after));
+    assert(decrypted == s % (1 << MESSAGE_BITS));
+  }
+}
+
+int main(void) {
+  widened_kernel_test();
+  keyswitch_truncated_noise_test();
+  keyswitch_truncated_decrypt_test();
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,107 @@
+#include "bootstrap.h"
+#include "bootstrap_amortized.hpp"
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+
+#include "utils.h"
+
+// The vectorized modulus switch is the rescaling of the bootstrap modulo
+// 2N, bit for bit on 32 bits. On 64 bits the rescaling converts the element
+// to double first, which may round elements lying less than 2^11 below a
+// rounding boundary onto it: the mismatches must be such elements, for
+// which the integer switch gives the exact rounding.
+template <typename Torus> void modulus_switch_vector_test(void) {
+  uint32_t size = 1000;
+  for (uint32_t log_modulus = 10; log_modulus <= 15; log_modulus++) {
+    auto input = random_torus_vector<Torus>(size);
+    Torus half_step = (Torus)1 << (sizeof(Torus) * 8 - log_modulus - 1);
+    // Elements on and around the rounding boundaries
+    for (uint32_t i = 0; i < 60; i++)
+      input[i] = (2 * (Torus)i + 1) * half_step + (Torus)i % 3 - 1;
+    Torus modulus_mask = ((Torus)1 << log_modulus) - 1;
+
+    for (int level = SCALAR; level <= get_simd_level(); level++) {
+      // Every size up to a few vectors exercises the scalar tails
+      for (uint32_t length : {0u, 1u, 7u, 15u, 17u, 33u, size}) {
+        std::vector<uint16_t> output(length);
+        modulus_switch_vector(output.data(), input.data(), length, log_modulus,
+                              (SimdLevel)level);
+        for (uint32_t i = 0; i < length; i++) {
+          assert(output[i] == modulus_switch(input[i], log_modulus));
+          Torus rescaled =
+              rescale_torus_element(input[i], 1 << log_modulus) & modulus_mask;
+          Torus distance = half_step - (input[i] & (2 * half_step - 1));
+          assert(output[i] == rescaled ||
+                 (sizeof(Torus) == 8 && distance <= (Torus)1 << 11));
+        }
+      }
+    }
+  }
+}
+
+// The bootstrap gives the same result whether it switches its input itself
+// or takes the switched batch
+template <typename Torus>
+void bootstrap_modulus_switched_test(
+    void (*modulus_switch_batch)(void *, void *, void *, uint32_t, uint32_t,
+                                 uint32_t),
+    void (*convert)(void *, void *, void *, uint32_t, uint32_t, uint32_t,
+                    uint32_t, uint32_t),
+    void (*bootstrap)(void *, void *, void *, void *, void *, void *, uint32_t,
+                      uint32_t, uint32_t, uint32_t, uint32_t, uint32_t,
+                      uint32_t, uint32_t),
+    void (*bootstrap_modulus_switched)(void *, void *, void *, void *, void *,
+                                       void *, uint32_t, uint32_t, uint32_t,
+                                       uint32_t, uint32_t, uint32_t, uint32_t,
+                                       uint32_t)) {
+  uint32_t input_lwe_dimension = 100, polynomial_size = 1024;
+  uint32_t base_log = 6, l_gadget = 3, num_samples = 7;
+  auto bsk = random_torus_vector<Torus>((size_t)input_lwe_dimension *
+                                        l_gadget * 4 * polynomial_size);
+  std::vector<double2> fourier_bsk(bsk.size() / 2);
+  convert(fourier_bsk.data(), bsk.data(), nullptr, 0, input_lwe_dimension, 1,
+          l_gadget, polynomial_size);
+  auto lut_vector = random_torus_vector<Torus>(2 * polynomial_size);
+  std::vector<uint32_t> lut_vector_indexes(num_samples, 0);
+  auto lwe_in =
+      random_torus_vector<Torus>(num_samples * (input_lwe_dimension + 1));
+
+  std::vector<uint16_t> lwe_in_switched(lwe_in.size());
+  modulus_switch_batch(nullptr, lwe_in_switched.data(), lwe_in.data(),
+                       input_lwe_dimension, polynomial_size, num_samples);
+  for (size_t k = 0; k < lwe_in.size(); k++)
+    assert(lwe_in_switched[k] ==
+           modulus_switch(lwe_in[k],
+                          get_bootstrap_log_modulus(polynomial_size)));
+
+  std::vector<Torus> lwe_out(num_samples * (polynomial_size + 1));
+  std::vector<Torus> lwe_out_switched(lwe_out.size());
+  bootstrap(nullptr, lwe_out.data(), lut_vector.data(),
+            lut_vector_indexes.data(), lwe_in.data(), fourier_bsk.data(),
+            input_lwe_dimension, polynomial_size, base_log, l_gadget,
+            num_samples, 1, 0, 0);
+  bootstrap_modulus_switched(
+      nullptr, lwe_out_switched.data(), lut_vector.data(),
+      lut_vector_indexes.data(), lwe_in_switched.data(), fourier_bsk.data(),
+      input_lwe_dimension, polynomial_size, base_log, l_gadget, num_samples, 1,
+      0, 0);
+  assert(lwe_out == lwe_out_switched);
+}
+
+int main(void) {
+  modulus_switch_vector_test<uint32_t>();
+  modulus_switch_vector_test<uint64_t>();
+  bootstrap_modulus_switched_test<uint32_t>(
+      cpu_modulus_switch_lwe_ciphertext_vector_32,
+      cpu_convert_lwe_bootstrap_key_32,
+      cpu_bootstrap_amortized_lwe_ciphertext_vector_32,
+      cpu_bootstrap_amortized_modulus_switched_lwe_ciphertext_vector_32);
+  bootstrap_modulus_switched_test<uint64_t>(
+      cpu_modulus_switch_lwe_ciphertext_vector_64,
+      cpu_convert_lwe_bootstrap_key_64,
+      cpu_bootstrap_amortized_lwe_ciphertext_vector_64,
+      cpu_bootstrap_amortized_modulus_switched_lwe_ciphertext_vector_64);
+  printf("test_cpu_modulus_switch: OK\n");
+  return 0;
+}
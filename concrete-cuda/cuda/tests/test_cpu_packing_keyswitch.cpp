@@ -0,0 +1,115 @@
+#include "keyswitch.h"
+#include "packing_keyswitch.hpp"
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+
+#include "utils.h"
+
+// Transcription of LwePackingKeyswitchKey::packing_keyswitch in
+// concrete-core: keyswitch each LWE to a GLWE, multiply it by X^c and sum
+template <typename Torus>
+void reference_packing_keyswitch(Torus *glwe_out, const Torus *lwe_in,
+                                 const Torus *pksk, uint32_t lwe_dimension_in,
+                                 uint32_t glwe_dimension,
+                                 uint32_t polynomial_size, uint32_t base_log,
+                                 uint32_t l_gadget, uint32_t num_lwes) {
+  size_t glwe_size = (size_t)(glwe_dimension + 1) * polynomial_size;
+  std::vector<Torus> buffer(glwe_size), rotated(polynomial_size);
+  Torus mod_b_mask = (1ll << base_log) - 1ll;
+  for (size_t k = 0; k < glwe_size; k++)
+    glwe_out[k] = 0;
+  for (uint32_t c = 0; c < num_lwes; c++) {
+    const Torus *lwe = &lwe_in[(size_t)c * (lwe_dimension_in + 1)];
+    std::fill(buffer.begin(), buffer.end(), 0);
+    buffer[glwe_dimension * polynomial_size] = lwe[lwe_dimension_in];
+    for (uint32_t i = 0; i < lwe_dimension_in; i++) {
+      Torus a_i = round_to_closest_multiple(lwe[i], base_log, l_gadget);
+      Torus state = a_i >> (sizeof(Torus) * 8 - base_log * l_gadget);
+      for (uint32_t j = 0; j < l_gadget; j++) {
+        Torus decomposed = decompose_one<Torus>(state, mod_b_mask, base_log);
+        const Torus *block = get_ith_packing_block(
+            pksk, i, l_gadget - j - 1, glwe_dimension, polynomial_size,
+            l_gadget);
+        for (size_t k = 0; k < glwe_size; k++)
+          buffer[k] -= block[k] * decomposed;
+      }
+    }
+    for (uint32_t p = 0; p <= glwe_dimension; p++) {
+      multiply_by_monomial_negacyclic(rotated.data(),
+                                      &buffer[p * polynomial_size], c,
+                                      polynomial_size);
+      for (uint32_t m = 0; m < polynomial_size; m++)
+        glwe_out[p * polynomial_size + m] += rotated[m];
+    }
+  }
+}
+
+template <typename Torus>
+void packing_keyswitch_bit_exactness_test(uint32_t lwe_dimension_in,
+                                          uint32_t glwe_dimension,
+                                          uint32_t polynomial_size,
+                                          uint32_t base_log, uint32_t l_gadget,
+                                          uint32_t num_lwes) {
+  size_t glwe_size = (size_t)(glwe_dimension + 1) * polynomial_size;
+  auto pksk =
+      random_torus_vector<Torus>((size_t)lwe_dimension_in * l_gadget * glwe_size);
+  auto lwe_in =
+      random_torus_vector<Torus>((size_t)num_lwes * (lwe_dimension_in + 1));
+  std::vector<Torus> expected(glwe_size);
+  reference_packing_keyswitch(expected.data(), lwe_in.data(), pksk.data(),
+                              lwe_dimension_in, glwe_dimension,
+                              polynomial_size, base_log, l_gadget, num_lwes);
+
+  for (int level = SCALAR; level <= get_simd_level(); level++) {
+    // A small cache forces several PKSK tiles
+    std::vector<Torus> glwe_out(glwe_size, 1);
+    cpu_packing_keyswitch_lwe_ciphertext_vector<Torus>(
+        glwe_out.data(), lwe_in.data(), pksk.data(), lwe_dimension_in,
+        glwe_dimension, polynomial_size, base_log, l_gadget, num_lwes,
+        ThreadPool::global(), (SimdLevel)level, 1 << 16);
+    assert(glwe_out == expected);
+  }
+}
+
+void packing_keyswitch_decrypt_test_64(void) {
+  uint32_t lwe_dimension_in = 200, glwe_dimension = 2, polynomial_size = 256;
+  uint32_t base_log = 4, l_gadget = 4, num_lwes = 200;
+  auto lwe_key = generate_lwe_secret_key<uint64_t>(lwe_dimension_in);
+  auto glwe_key =
+      generate_lwe_secret_key<uint64_t>(glwe_dimension * polynomial_size);
+  auto pksk = generate_lwe_packing_keyswitch_key<uint64_t>(
+      lwe_key, glwe_key, glwe_dimension, polynomial_size, base_log, l_gadget,
+      -40);
+
+  std::vector<uint64_t> lwe_in(num_lwes * (lwe_dimension_in + 1));
+  for (uint32_t c = 0; c < num_lwes; c++)
+    encrypt_lwe<uint64_t>(&lwe_in[c * (lwe_dimension_in + 1)], lwe_key,
+                          encode<uint64_t>(c % (1 << MESSAGE_BITS)), -30);
+  std::vector<uint64_t> glwe_out((glwe_dimension + 1) * polynomial_size);
+  cpu_packing_keyswitch_lwe_ciphertext_vector_64(
+      nullptr, glwe_out.data(), lwe_in.data(), pksk.data(), lwe_dimension_in,
+      glwe_dimension, polynomial_size, base_log, l_gadget, num_lwes);
+
+  auto plaintext = decrypt_glwe<uint64_t>(glwe_out.data(), glwe_key,
+                                          glwe_dimension, polynomial_size);
+  for (uint32_t m = 0; m < polynomial_size; m++)
+    assert(decode<uint64_t>(plaintext[m]) ==
+           (m < num_lwes ? m % (1 << MESSAGE_BITS) : 0));
+
+  // More ciphertexts than coefficients are rejected, the output is untouched
+  std::vector<uint64_t> untouched(glwe_out);
+  std::vector<uint64_t> too_many((polynomial_size + 1) * (lwe_dimension_in + 1));
+  cpu_packing_keyswitch_lwe_ciphertext_vector_64(
+      nullptr, glwe_out.data(), too_many.data(), pksk.data(), lwe_dimension_in,
+      glwe_dimension, polynomial_size, base_log, l_gadget, polynomial_size + 1);
+  assert(glwe_out == untouched);
+}
+
+int main(void) {
+  packing_keyswitch_bit_exactness_test<uint64_t>(100, 1, 512, 3, 5, 512);
+  packing_keyswitch_bit_exactness_test<uint32_t>(100, 2, 256, 4, 3, 77);
+  packing_keyswitch_bit_exactness_test<uint64_t>(37, 1, 128, 2, 7, 1);
+  packing_keyswitch_decrypt_test_64();
+  return EXIT_SUCCESS;
+}
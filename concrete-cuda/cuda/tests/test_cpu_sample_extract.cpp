@@ -0,0 +1,94 @@
+#include "bootstrap.h"
+#include "sample_extract.hpp"
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+
+#include "utils.h"
+
+// The vectorized reversal matches the scalar one for any size, including
+// the tails shorter than a vector
+template <typename Torus> void reverse_vector_test(void) {
+  auto input = random_torus_vector<Torus>(70);
+  for (uint32_t size = 0; size <= input.size(); size++) {
+    for (bool negate : {false, true}) {
+      std::vector<Torus> expected(size);
+      for (uint32_t i = 0; i < size; i++)
+        expected[i] = negate ? -input[size - 1 - i] : input[size - 1 - i];
+      for (int level = SCALAR; level <= get_simd_level(); level++) {
+        std::vector<Torus> output(size);
+        reverse_vector(output.data(), input.data(), size, negate,
+                       (SimdLevel)level);
+        assert(output == expected);
+      }
+    }
+  }
+}
+
+// Every requested coefficient of every GLWE ciphertext is extracted to an
+// LWE ciphertext decrypting to it under the GLWE key
+template <typename Torus>
+void extract_lwe_samples_test(
+    void (*extract)(void *, void *, void *, void *, uint32_t, uint32_t,
+                    uint32_t, uint32_t),
+    uint32_t glwe_dimension, double log_std) {
+  uint32_t polynomial_size = 512, num_glwes = 5;
+  std::vector<uint32_t> nths = {0, 1, 7, 100, 256, 511};
+  uint32_t num_nths = nths.size();
+  uint32_t glwe_size = (glwe_dimension + 1) * polynomial_size;
+  uint32_t lwe_size = glwe_dimension * polynomial_size + 1;
+  auto glwe_key =
+      generate_lwe_secret_key<Torus>(glwe_dimension * polynomial_size);
+
+  std::vector<Torus> glwe_in(num_glwes * glwe_size);
+  std::vector<uint64_t> messages(num_glwes * polynomial_size);
+  std::vector<Torus> plaintext(polynomial_size);
+  for (uint32_t g = 0; g < num_glwes; g++) {
+    for (uint32_t j = 0; j < polynomial_size; j++) {
+      messages[g * polynomial_size + j] =
+          get_test_rng()() % (1 << MESSAGE_BITS);
+      plaintext[j] = encode<Torus>(messages[g * polynomial_size + j]);
+    }
+    encrypt_glwe(&glwe_in[g * glwe_size], glwe_key, plaintext.data(),
+                 glwe_dimension, polynomial_size, log_std);
+  }
+
+  std::vector<Torus> lwe_out(num_glwes * num_nths * lwe_size);
+  extract(nullptr, lwe_out.data(), glwe_in.data(), nths.data(), num_nths,
+          glwe_dimension, polynomial_size, num_glwes);
+  for (uint32_t g = 0; g < num_glwes; g++) {
+    for (uint32_t i = 0; i < num_nths; i++) {
+      Torus decrypted =
+          decrypt_lwe(&lwe_out[(g * num_nths + i) * lwe_size], glwe_key);
+      assert(decode(decrypted) == messages[g * polynomial_size + nths[i]]);
+    }
+  }
+}
+
+// A coefficient out of the polynomials leaves the output untouched
+void extract_lwe_samples_out_of_range_test(void) {
+  uint32_t glwe_dimension = 1, polynomial_size = 512, num_glwes = 2;
+  std::vector<uint32_t> nths = {3, polynomial_size};
+  auto glwe_in = random_torus_vector<uint64_t>(
+      num_glwes * (glwe_dimension + 1) * polynomial_size);
+  std::vector<uint64_t> lwe_out(num_glwes * nths.size() *
+                                    (glwe_dimension * polynomial_size + 1),
+                                42);
+  cpu_extract_lwe_samples_from_glwe_ciphertext_vector_64(
+      nullptr, lwe_out.data(), glwe_in.data(), nths.data(), nths.size(),
+      glwe_dimension, polynomial_size, num_glwes);
+  for (auto element : lwe_out)
+    assert(element == 42);
+}
+
+int main(void) {
+  reverse_vector_test<uint32_t>();
+  reverse_vector_test<uint64_t>();
+  extract_lwe_samples_test<uint32_t>(
+      cpu_extract_lwe_samples_from_glwe_ciphertext_vector_32, 1, -25);
+  extract_lwe_samples_test<uint64_t>(
+      cpu_extract_lwe_samples_from_glwe_ciphertext_vector_64, 2, -40);
+  extract_lwe_samples_out_of_range_test();
+  printf("test_cpu_sample_extract: OK\n");
+  return 0;
+}
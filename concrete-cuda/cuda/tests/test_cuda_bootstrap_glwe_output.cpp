@@ -0,0 +1,146 @@
+#include "bootstrap.h"
+#include "bootstrap_amortized.hpp"
+#include "device.h"
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+
+#include "utils.h"
+
+uint64_t successor(uint64_t m) { return (m + 1) % (1 << MESSAGE_BITS); }
+
+template <typename T> T *copy_to_gpu(std::vector<T> &host, uint32_t gpu_index) {
+  uint64_t size = host.size() * sizeof(T);
+  T *device = (T *)cuda_malloc(size, gpu_index);
+  cuda_memcpy_to_gpu(device, host.data(), size, gpu_index);
+  return device;
+}
+
+// The device accumulators decrypt to the rotated test vector and match the
+// ones of the CPU engine up to the rounding of the two FFTs, which loses the
+// low bits of 64 bits coefficients. The Fourier outputs come back to the
+// device coefficients with the inverse FFT of the CPU engine, their layouts
+// being the same.
+template <typename Torus>
+void bootstrap_glwe_output_test(
+    void (*convert)(void *, void *, void *, uint32_t, uint32_t, uint32_t,
+                    uint32_t, uint32_t),
+    void (*cpu_convert)(void *, void *, void *, uint32_t, uint32_t, uint32_t,
+                        uint32_t, uint32_t),
+    void (*bootstrap_glwe_output)(void *, void *, void *, void *, void *,
+                                  void *, uint32_t, uint32_t, uint32_t,
+                                  uint32_t, uint32_t, uint32_t, uint32_t,
+                                  uint32_t, uint32_t, uint32_t),
+    void (*cpu_bootstrap_glwe_output)(void *, void *, void *, void *, void *,
+                                      void *, uint32_t, uint32_t, uint32_t,
+                                      uint32_t, uint32_t, uint32_t, uint32_t,
+                                      uint32_t, uint32_t, uint32_t),
+    uint32_t glwe_dimension, uint32_t base_log, uint32_t l_gadget,
+    double log_std, Torus tolerance) {
+  uint32_t gpu_index = 0;
+  void *v_stream = cuda_create_stream(gpu_index);
+  uint32_t max_shared_memory = cuda_get_max_shared_memory(gpu_index);
+  uint32_t input_lwe_dimension = 400, polynomial_size = 512, num_samples = 8;
+  uint32_t glwe_size = (glwe_dimension + 1) * polynomial_size;
+  uint32_t lwe_dimension_out = glwe_dimension * polynomial_size;
+  auto lwe_key = generate_lwe_secret_key<Torus>(input_lwe_dimension);
+  auto glwe_key = generate_lwe_secret_key<Torus>(lwe_dimension_out);
+  auto bsk = generate_lwe_bootstrap_key<Torus>(lwe_key, glwe_key,
+                                               glwe_dimension, polynomial_size,
+                                               base_log, l_gadget, log_std);
+  std::vector<double2> fourier_bsk(bsk.size() / 2);
+  cpu_convert(fourier_bsk.data(), bsk.data(), nullptr, 0, input_lwe_dimension,
+              glwe_dimension, l_gadget, polynomial_size);
+  double2 *d_fourier_bsk =
+      (double2 *)cuda_malloc(fourier_bsk.size() * sizeof(double2), gpu_index);
+  convert(d_fourier_bsk, bsk.data(), v_stream, gpu_index, input_lwe_dimension,
+          glwe_dimension, l_gadget, polynomial_size);
+
+  std::vector<Torus> lut_vector(glwe_size);
+  fill_test_vector(lut_vector.data(), polynomial_size, successor,
+                   glwe_dimension);
+  std::vector<uint32_t> lut_vector_indexes(num_samples, 0);
+  std::vector<Torus> lwe_in(num_samples * (input_lwe_dimension + 1));
+  std::vector<uint64_t> messages(num_samples);
+  for (uint32_t s = 0; s < num_samples; s++) {
+    messages[s] = get_test_rng()() % (1 << MESSAGE_BITS);
+    encrypt_lwe<Torus>(&lwe_in[s * (input_lwe_dimension + 1)], lwe_key,
+                       encode<Torus>(messages[s]), log_std);
+  }
+  Torus *d_lut_vector = copy_to_gpu(lut_vector, gpu_index);
+  uint32_t *d_lut_vector_indexes = copy_to_gpu(lut_vector_indexes, gpu_index);
+  Torus *d_lwe_in = copy_to_gpu(lwe_in, gpu_index);
+  uint64_t glwe_out_size = num_samples * glwe_size * sizeof(Torus);
+  uint64_t fourier_out_size = num_samples * glwe_size / 2 * sizeof(double2);
+  Torus *d_glwe_out = (Torus *)cuda_malloc(glwe_out_size, gpu_index);
+  double2 *d_glwe_out_fourier =
+      (double2 *)cuda_malloc(fourier_out_size, gpu_index);
+
+  bootstrap_glwe_output(v_stream, d_glwe_out, d_lut_vector,
+                        d_lut_vector_indexes, d_lwe_in, d_fourier_bsk,
+                        input_lwe_dimension, glwe_dimension, polynomial_size,
+                        base_log, l_gadget, num_samples, 1, 0, 0,
+                        max_shared_memory);
+  bootstrap_glwe_output(v_stream, d_glwe_out_fourier, d_lut_vector,
+                        d_lut_vector_indexes, d_lwe_in, d_fourier_bsk,
+                        input_lwe_dimension, glwe_dimension, polynomial_size,
+                        base_log, l_gadget, num_samples, 1, 0, 1,
+                        max_shared_memory);
+  cuda_synchronize_stream(v_stream, gpu_index);
+  std::vector<Torus> glwe_out(num_samples * glwe_size);
+  std::vector<double2> glwe_out_fourier(num_samples * glwe_size / 2);
+  cuda_memcpy_to_cpu(glwe_out.data(), d_glwe_out, glwe_out_size, gpu_index);
+  cuda_memcpy_to_cpu(glwe_out_fourier.data(), d_glwe_out_fourier,
+                     fourier_out_size, gpu_index);
+
+  std::vector<Torus> cpu_glwe_out(num_samples * glwe_size);
+  cpu_bootstrap_glwe_output(nullptr, cpu_glwe_out.data(), lut_vector.data(),
+                            lut_vector_indexes.data(), lwe_in.data(),
+                            fourier_bsk.data(), input_lwe_dimension,
+                            glwe_dimension, polynomial_size, base_log,
+                            l_gadget, num_samples, 1, 0, 0, 0);
+  for (uint32_t s = 0; s < num_samples; s++) {
+    auto plaintext = decrypt_glwe(&glwe_out[s * glwe_size], glwe_key,
+                                  glwe_dimension, polynomial_size);
+    assert(decode(plaintext[0]) == successor(messages[s]));
+  }
+  for (size_t i = 0; i < glwe_out.size(); i++) {
+    Torus diff = glwe_out[i] - cpu_glwe_out[i];
+    assert(diff <= tolerance || (Torus)-diff <= tolerance);
+  }
+
+  auto &fft = NegacyclicFFT::get(polynomial_size);
+  for (uint32_t p = 0; p < num_samples * (glwe_dimension + 1); p++) {
+    double2 *polynomial = &glwe_out_fourier[p * polynomial_size / 2];
+    fft.inverse(polynomial);
+    std::vector<Torus> coefficients(polynomial_size, 0);
+    add_to_torus(polynomial, coefficients.data(), polynomial_size);
+    for (uint32_t j = 0; j < polynomial_size; j++) {
+      Torus diff = coefficients[j] - glwe_out[p * polynomial_size + j];
+      assert(diff <= tolerance || (Torus)-diff <= tolerance);
+    }
+  }
+
+  cuda_drop(d_fourier_bsk, gpu_index);
+  cuda_drop(d_lut_vector, gpu_index);
+  cuda_drop(d_lut_vector_indexes, gpu_index);
+  cuda_drop(d_lwe_in, gpu_index);
+  cuda_drop(d_glwe_out, gpu_index);
+  cuda_drop(d_glwe_out_fourier, gpu_index);
+  cuda_destroy_stream(v_stream, gpu_index);
+}
+
+int main(void) {
+  bootstrap_glwe_output_test<uint32_t>(
+      cuda_convert_lwe_bootstrap_key_32, cpu_convert_lwe_bootstrap_key_32,
+      cuda_bootstrap_amortized_glwe_output_lwe_ciphertext_vector_32,
+      cpu_bootstrap_amortized_glwe_output_lwe_ciphertext_vector_32, 2, 6, 3,
+      -25, 1);
+  bootstrap_glwe_output_test<uint64_t>(
+      cuda_convert_lwe_bootstrap_key_64, cpu_convert_lwe_bootstrap_key_64,
+      cuda_bootstrap_amortized_glwe_output_lwe_ciphertext_vector_64,
+      cpu_bootstrap_amortized_glwe_output_lwe_ciphertext_vector_64, 1, 7, 3,
+      -40, (uint64_t)1 << 14);
+  printf("test_cuda_bootstrap_glwe_output: OK\n");
+  return 0;
+}
@@ -0,0 +1,6 @@
+#include "utils.h"
+
+std::mt19937_64 &get_test_rng() {
+  static std::mt19937_64 rng(0x5eed);
+  return rng;
+}
@@ -0,0 +1,252 @@
+#ifndef CNCRT_TEST_UTILS
+#define CNCRT_TEST_UTILS
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// Small LWE toolbox to generate keys and ciphertexts for the tests, it is
+// not meant to be secure
+
+const int MESSAGE_BITS = 4;
+
+std::mt19937_64 &get_test_rng();
+
+template <typename Torus> Torus random_torus() {
+  return (Torus)get_test_rng()();
+}
+
+template <typename Torus> std::vector<Torus> random_torus_vector(size_t size) {
+  std::vector<Torus> result(size);
+  for (auto &element : result)
+    element = random_torus<Torus>();
+  return result;
+}
+
+/// Binary secret key of the given dimension
+template <typename Torus>
+std::vector<Torus> generate_lwe_secret_key(uint32_t lwe_dimension) {
+  std::vector<Torus> key(lwe_dimension);
+  for (auto &element : key)
+    element = get_test_rng()() & 1;
+  return key;
+}
+
+/// Gaussian noise of standard deviation 2^log_std on the torus
+template <typename Torus> Torus gaussian_torus_noise(double log_std) {
+  std::normal_distribution<double> normal(0., 1.);
+  double noise = normal(get_test_rng()) * std::ldexp(1., sizeof(Torus) * 8) *
+                 std::ldexp(1., log_std);
+  return (Torus)(int64_t)noise;
+}
+
+template <typename Torus>
+void encrypt_lwe(Torus *lwe_out, const std::vector<Torus> &key, Torus plaintext,
+                 double log_std) {
+  Torus body = plaintext + gaussian_torus_noise<Torus>(log_std);
+  for (size_t i = 0; i < key.size(); i++) {
+    lwe_out[i] = random_torus<Torus>();
+    body += lwe_out[i] * key[i];
+  }
+  lwe_out[key.size()] = body;
+}
+
+template <typename Torus>
+Torus decrypt_lwe(const Torus *lwe_in, const std::vector<Torus> &key) {
+  Torus body = lwe_in[key.size()];
+  for (size_t i = 0; i < key.size(); i++)
+    body -= lwe_in[i] * key[i];
+  return body;
+}
+
+/// Encodes a message of MESSAGE_BITS bits with one bit of padding
+template <typename Torus> Torus encode(uint64_t message) {
+  return (Torus)message << (sizeof(Torus) * 8 - MESSAGE_BITS - 1);
+}
+
+/// Rounds a decrypted plaintext to the closest message
+template <typename Torus> uint64_t decode(Torus plaintext) {
+  int shift = sizeof(Torus) * 8 - MESSAGE_BITS - 1;
+  Torus rounding = (Torus)1 << (shift - 1);
+  return ((Torus)(plaintext + rounding) >> shift) % (1 << (MESSAGE_BITS + 1));
+}
+
+/// Keyswitch key in the layout expected by the keyswitch engines: for each
+/// input key element i and each level j, an LWE encryption under key_after of
+/// key_before[i] * q / B^(j+1)
+template <typename Torus>
+std::vector<Torus> generate_lwe_keyswitch_key(
+    const std::vector<Torus> &key_before, const std::vector<Torus> &key_after,
+    uint32_t base_log, uint32_t l_gadget, double log_std) {
+  uint32_t lwe_size_after = key_after.size() + 1;
+  std::vector<Torus> ksk(key_before.size() * l_gadget * lwe_size_after);
+  for (size_t i = 0; i < key_before.size(); i++) {
+    for (uint32_t j = 0; j < l_gadget; j++) {
+      Torus message = key_before[i]
+                      << (sizeof(Torus) * 8 - (j + 1) * base_log);
+      encrypt_lwe<Torus>(&ksk[(i * l_gadget + j) * lwe_size_after], key_after,
+                         message, log_std);
+    }
+  }
+  return ksk;
+}
+
+/// Naive negacyclic product result += a * b modulo X^N + 1, with a binary
+/// or small b
+template <typename Torus>
+void add_negacyclic_product(Torus *result, const Torus *a, const Torus *b,
+                            uint32_t polynomial_size) {
+  for (uint32_t j = 0; j < polynomial_size; j++) {
+    if (b[j] == 0)
+      continue;
+    for (uint32_t m = 0; m < polynomial_size; m++) {
+      Torus product = a[m] * b[j];
+      if (m + j < polynomial_size)
+        result[m + j] += product;
+      else
+        result[m + j - polynomial_size] -= product;
+    }
+  }
+}
+
+/// GLWE encryption of the plaintext polynomial under the glwe_dimension
+/// binary polynomials of key, laid out as the masks then the body
+template <typename Torus>
+void encrypt_glwe(Torus *glwe_out, const std::vector<Torus> &key,
+                  const Torus *plaintext, uint32_t glwe_dimension,
+                  uint32_t polynomial_size, double log_std) {
+  Torus *body = &glwe_out[glwe_dimension * polynomial_size];
+  for (uint32_t m = 0; m < polynomial_size; m++)
+    body[m] = plaintext[m] + gaussian_torus_noise<Torus>(log_std);
+  for (uint32_t p = 0; p < glwe_dimension; p++) {
+    Torus *mask = &glwe_out[p * polynomial_size];
+    for (uint32_t m = 0; m < polynomial_size; m++)
+      mask[m] = random_torus<Torus>();
+    add_negacyclic_product(body, mask, &key[p * polynomial_size],
+                           polynomial_size);
+  }
+}
+
+template <typename Torus>
+std::vector<Torus> decrypt_glwe(const Torus *glwe_in,
+                                const std::vector<Torus> &key,
+                                uint32_t glwe_dimension,
+                                uint32_t polynomial_size) {
+  std::vector<Torus> phase(polynomial_size, 0);
+  for (uint32_t p = 0; p < glwe_dimension; p++)
+    add_negacyclic_product(phase.data(), &glwe_in[p * polynomial_size],
+                           &key[p * polynomial_size], polynomial_size);
+  std::vector<Torus> plaintext(polynomial_size);
+  for (uint32_t m = 0; m < polynomial_size; m++)
+    plaintext[m] = glwe_in[glwe_dimension * polynomial_size + m] - phase[m];
+  return plaintext;
+}
+
+/// Packing keyswitch key in the layout expected by the packing keyswitch:
+/// for each input key element i and each level j, a GLWE encryption of the
+/// constant polynomial key_in[i] * q / B^(j+1)
+template <typename Torus>
+std::vector<Torus> generate_lwe_packing_keyswitch_key(
+    const std::vector<Torus> &key_in, const std::vector<Torus> &glwe_key,
+    uint32_t glwe_dimension, uint32_t polynomial_size, uint32_t base_log,
+    uint32_t l_gadget, double log_std) {
+  size_t glwe_size = (size_t)(glwe_dimension + 1) * polynomial_size;
+  std::vector<Torus> pksk(key_in.size() * l_gadget * glwe_size);
+  std::vector<Torus> message(polynomial_size, 0);
+  for (size_t i = 0; i < key_in.size(); i++) {
+    for (uint32_t j = 0; j < l_gadget; j++) {
+      message[0] = key_in[i] << (sizeof(Torus) * 8 - (j + 1) * base_log);
+      encrypt_glwe<Torus>(&pksk[(i * l_gadget + j) * glwe_size], glwe_key,
+                          message.data(), glwe_dimension, polynomial_size,
+                          log_std);
+    }
+  }
+  return pksk;
+}
+
+// GGSW encryption of value in the standard domain: for each level, k + 1
+// GLWE encryptions of 0 where the row r gets value times q / B^(level + 1)
+// added to the constant coefficient of its polynomial r
+template <typename Torus>
+void encrypt_ggsw(Torus *ggsw_out, const std::vector<Torus> &glwe_key,
+                  Torus value, uint32_t glwe_dimension,
+                  uint32_t polynomial_size, uint32_t base_log,
+                  uint32_t l_gadget, double log_std) {
+  size_t glwe_size = (size_t)(glwe_dimension + 1) * polynomial_size;
+  std::vector<Torus> zero(polynomial_size, 0);
+  for (uint32_t j = 0; j < l_gadget; j++) {
+    Torus gadget_value = value << (sizeof(Torus) * 8 - (j + 1) * base_log);
+    for (uint32_t r = 0; r <= glwe_dimension; r++) {
+      Torus *row = &ggsw_out[(j * (glwe_dimension + 1) + r) * glwe_size];
+      encrypt_glwe<Torus>(row, glwe_key, zero.data(), glwe_dimension,
+                          polynomial_size, log_std);
+      row[r * polynomial_size] += gadget_value;
+    }
+  }
+}
+
+// Bootstrapping key in the standard domain, as expected by the
+// convert_lwe_bootstrap_key functions: a GGSW of each bit of lwe_key
+template <typename Torus>
+std::vector<Torus> generate_lwe_bootstrap_key(
+    const std::vector<Torus> &lwe_key, const std::vector<Torus> &glwe_key,
+    uint32_t glwe_dimension, uint32_t polynomial_size, uint32_t base_log,
+    uint32_t l_gadget, double log_std) {
+  size_t ggsw_size = (size_t)l_gadget * (glwe_dimension + 1) *
+                     (glwe_dimension + 1) * polynomial_size;
+  std::vector<Torus> bsk(lwe_key.size() * ggsw_size);
+  for (size_t i = 0; i < lwe_key.size(); i++)
+    encrypt_ggsw<Torus>(&bsk[i * ggsw_size], glwe_key, lwe_key[i],
+                        glwe_dimension, polynomial_size, base_log, l_gadget,
+                        log_std);
+  return bsk;
+}
+
+// Multi-bit bootstrapping key in the standard domain, as expected by the
+// convert_lwe_multi_bit_bootstrap_key functions: for each group of
+// grouping_factor bits of lwe_key and each non-empty subset b of the group,
+// a GGSW of the product of the bits in b and of one minus the others
+template <typename Torus>
+std::vector<Torus> generate_lwe_multi_bit_bootstrap_key(
+    const std::vector<Torus> &lwe_key, const std::vector<Torus> &glwe_key,
+    uint32_t glwe_dimension, uint32_t polynomial_size, uint32_t base_log,
+    uint32_t l_gadget, uint32_t grouping_factor, double log_std) {
+  size_t ggsw_size = (size_t)l_gadget * (glwe_dimension + 1) *
+                     (glwe_dimension + 1) * polynomial_size;
+  std::vector<Torus> bsk;
+  for (size_t start = 0; start < lwe_key.size(); start += grouping_factor) {
+    size_t group_size = std::min<size_t>(grouping_factor, lwe_key.size() - start);
+    for (uint32_t b = 1; b < (1u << group_size); b++) {
+      Torus value = 1;
+      for (size_t i = 0; i < group_size; i++)
+        value *= (b >> i) & 1 ? lwe_key[start + i] : 1 - lwe_key[start + i];
+      bsk.resize(bsk.size() + ggsw_size);
+      encrypt_ggsw<Torus>(&bsk[bsk.size() - ggsw_size], glwe_key, value,
+                          glwe_dimension, polynomial_size, base_log, l_gadget,
+                          log_std);
+    }
+  }
+  return bsk;
+}
+
+// Test vector of f on the messages of MESSAGE_BITS bits, shifted by half a
+// box so that the noise on either side of a message maps to it, the top half
+// box wrapping negacyclically to -f(0). The glwe_dimension mask polynomials
+// come first and are zero.
+template <typename Torus>
+void fill_test_vector(Torus *lut, uint32_t polynomial_size,
+                      uint64_t (*f)(uint64_t), uint32_t glwe_dimension = 1) {
+  uint32_t box_size = polynomial_size >> MESSAGE_BITS;
+  Torus *body = &lut[glwe_dimension * polynomial_size];
+  for (uint32_t j = 0; j < glwe_dimension * polynomial_size; j++)
+    lut[j] = 0;
+  for (uint32_t j = 0; j < polynomial_size; j++) {
+    uint64_t message = (j + box_size / 2) / box_size;
+    body[j] = message < (1u << MESSAGE_BITS) ? encode<Torus>(f(message))
+                                             : -encode<Torus>(f(0));
+  }
+}
+
+#endif // CNCRT_TEST_UTILS
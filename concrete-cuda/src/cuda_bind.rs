@@ -7,6 +7,21 @@ extern "C" {
 
     pub fn cuda_destroy_stream(v_stream: *mut c_void, gpu_index: u32) -> i32;
 
+    pub fn cuda_synchronize_stream(v_stream: *mut c_void, gpu_index: u32) -> i32;
+
+    pub fn cuda_create_event(gpu_index: u32) -> *mut c_void;
+
+    pub fn cuda_destroy_event(v_event: *mut c_void, gpu_index: u32) -> i32;
+
+    pub fn cuda_record_event(v_event: *mut c_void, v_stream: *mut c_void, gpu_index: u32) -> i32;
+
+    pub fn cuda_query_event(v_event: *mut c_void, gpu_index: u32) -> i32;
+
+    pub fn cuda_synchronize_event(v_event: *mut c_void, gpu_index: u32) -> i32;
+
+    pub fn cuda_stream_wait_event(v_stream: *mut c_void, v_event: *mut c_void, gpu_index: u32)
+        -> i32;
+
     pub fn cuda_malloc(size: u64, gpu_index: u32) -> *mut c_void;
 
     pub fn cuda_check_valid_malloc(size: u64, gpu_index: u32) -> i32;
@@ -93,6 +108,274 @@ extern "C" {
         max_shared_memory: u32,
     );
 
+    pub fn cuda_bootstrap_amortized_modulus_switched_lwe_ciphertext_vector_32(
+        v_stream: *mut c_void,
+        lwe_out: *mut c_void,
+        test_vector: *const c_void,
+        test_vector_indexes: *const c_void,
+        lwe_in: *const c_void,
+        bootstrapping_key: *const c_void,
+        input_lwe_dimension: u32,
+        polynomial_size: u32,
+        base_log: u32,
+        level: u32,
+        num_samples: u32,
+        num_test_vectors: u32,
+        lwe_idx: u32,
+        max_shared_memory: u32,
+    );
+
+    pub fn cuda_bootstrap_amortized_modulus_switched_lwe_ciphertext_vector_64(
+        v_stream: *mut c_void,
+        lwe_out: *mut c_void,
+        test_vector: *const c_void,
+        test_vector_indexes: *const c_void,
+        lwe_in: *const c_void,
+        bootstrapping_key: *const c_void,
+        input_lwe_dimension: u32,
+        polynomial_size: u32,
+        base_log: u32,
+        level: u32,
+        num_samples: u32,
+        num_test_vectors: u32,
+        lwe_idx: u32,
+        max_shared_memory: u32,
+    );
+
+    pub fn cuda_bootstrap_amortized_lwe_ciphertext_vector_with_glwe_dimension_32(
+        v_stream: *mut c_void,
+        lwe_out: *mut c_void,
+        test_vector: *const c_void,
+        test_vector_indexes: *const c_void,
+        lwe_in: *const c_void,
+        bootstrapping_key: *const c_void,
+        input_lwe_dimension: u32,
+        glwe_dimension: u32,
+        polynomial_size: u32,
+        base_log: u32,
+        level: u32,
+        num_samples: u32,
+        num_test_vectors: u32,
+        lwe_idx: u32,
+        max_shared_memory: u32,
+    );
+
+    pub fn cuda_bootstrap_amortized_lwe_ciphertext_vector_with_glwe_dimension_64(
+        v_stream: *mut c_void,
+        lwe_out: *mut c_void,
+        test_vector: *const c_void,
+        test_vector_indexes: *const c_void,
+        lwe_in: *const c_void,
+        bootstrapping_key: *const c_void,
+        input_lwe_dimension: u32,
+        glwe_dimension: u32,
+        polynomial_size: u32,
+        base_log: u32,
+        level: u32,
+        num_samples: u32,
+        num_test_vectors: u32,
+        lwe_idx: u32,
+        max_shared_memory: u32,
+    );
+
+    pub fn cuda_bootstrap_amortized_shared_lut_lwe_ciphertext_vector_32(
+        v_stream: *mut c_void,
+        lwe_out: *mut c_void,
+        test_vector: *const c_void,
+        lwe_in: *const c_void,
+        bootstrapping_key: *const c_void,
+        input_lwe_dimension: u32,
+        polynomial_size: u32,
+        base_log: u32,
+        level: u32,
+        num_samples: u32,
+        max_shared_memory: u32,
+    );
+
+    pub fn cuda_bootstrap_amortized_shared_lut_lwe_ciphertext_vector_64(
+        v_stream: *mut c_void,
+        lwe_out: *mut c_void,
+        test_vector: *const c_void,
+        lwe_in: *const c_void,
+        bootstrapping_key: *const c_void,
+        input_lwe_dimension: u32,
+        polynomial_size: u32,
+        base_log: u32,
+        level: u32,
+        num_samples: u32,
+        max_shared_memory: u32,
+    );
+
+    pub fn cuda_bootstrap_amortized_batched_fft_lwe_ciphertext_vector_32(
+        v_stream: *mut c_void,
+        lwe_out: *mut c_void,
+        test_vector: *const c_void,
+        test_vector_indexes: *const c_void,
+        lwe_in: *const c_void,
+        bootstrapping_key: *const c_void,
+        input_lwe_dimension: u32,
+        polynomial_size: u32,
+        base_log: u32,
+        level: u32,
+        num_samples: u32,
+        num_test_vectors: u32,
+        lwe_idx: u32,
+        max_shared_memory: u32,
+    );
+
+    pub fn cuda_bootstrap_amortized_batched_fft_lwe_ciphertext_vector_64(
+        v_stream: *mut c_void,
+        lwe_out: *mut c_void,
+        test_vector: *const c_void,
+        test_vector_indexes: *const c_void,
+        lwe_in: *const c_void,
+        bootstrapping_key: *const c_void,
+        input_lwe_dimension: u32,
+        polynomial_size: u32,
+        base_log: u32,
+        level: u32,
+        num_samples: u32,
+        num_test_vectors: u32,
+        lwe_idx: u32,
+        max_shared_memory: u32,
+    );
+
+    pub fn cuda_bootstrap_amortized_many_lut_lwe_ciphertext_vector_32(
+        v_stream: *mut c_void,
+        lwe_out: *mut c_void,
+        test_vector: *const c_void,
+        test_vector_indexes: *const c_void,
+        lwe_in: *const c_void,
+        bootstrapping_key: *const c_void,
+        input_lwe_dimension: u32,
+        glwe_dimension: u32,
+        polynomial_size: u32,
+        base_log: u32,
+        level: u32,
+        num_samples: u32,
+        num_test_vectors: u32,
+        lwe_idx: u32,
+        lut_count: u32,
+        max_shared_memory: u32,
+    );
+
+    pub fn cuda_bootstrap_amortized_many_lut_lwe_ciphertext_vector_64(
+        v_stream: *mut c_void,
+        lwe_out: *mut c_void,
+        test_vector: *const c_void,
+        test_vector_indexes: *const c_void,
+        lwe_in: *const c_void,
+        bootstrapping_key: *const c_void,
+        input_lwe_dimension: u32,
+        glwe_dimension: u32,
+        polynomial_size: u32,
+        base_log: u32,
+        level: u32,
+        num_samples: u32,
+        num_test_vectors: u32,
+        lwe_idx: u32,
+        lut_count: u32,
+        max_shared_memory: u32,
+    );
+
+    pub fn cuda_bootstrap_amortized_glwe_output_lwe_ciphertext_vector_32(
+        v_stream: *mut c_void,
+        glwe_out: *mut c_void,
+        test_vector: *const c_void,
+        test_vector_indexes: *const c_void,
+        lwe_in: *const c_void,
+        bootstrapping_key: *const c_void,
+        input_lwe_dimension: u32,
+        glwe_dimension: u32,
+        polynomial_size: u32,
+        base_log: u32,
+        level: u32,
+        num_samples: u32,
+        num_test_vectors: u32,
+        lwe_idx: u32,
+        fourier_output: u32,
+        max_shared_memory: u32,
+    );
+
+    pub fn cuda_bootstrap_amortized_glwe_output_lwe_ciphertext_vector_64(
+        v_stream: *mut c_void,
+        glwe_out: *mut c_void,
+        test_vector: *const c_void,
+        test_vector_indexes: *const c_void,
+        lwe_in: *const c_void,
+        bootstrapping_key: *const c_void,
+        input_lwe_dimension: u32,
+        glwe_dimension: u32,
+        polynomial_size: u32,
+        base_log: u32,
+        level: u32,
+        num_samples: u32,
+        num_test_vectors: u32,
+        lwe_idx: u32,
+        fourier_output: u32,
+        max_shared_memory: u32,
+    );
+
+    pub fn cuda_convert_lwe_multi_bit_bootstrap_key_32(
+        dest: *mut c_void,
+        src: *mut c_void,
+        v_stream: *const c_void,
+        gpu_index: u32,
+        input_lwe_dim: u32,
+        glwe_dim: u32,
+        l_gadget: u32,
+        polynomial_size: u32,
+        grouping_factor: u32,
+    );
+
+    pub fn cuda_convert_lwe_multi_bit_bootstrap_key_64(
+        dest: *mut c_void,
+        src: *mut c_void,
+        v_stream: *const c_void,
+        gpu_index: u32,
+        input_lwe_dim: u32,
+        glwe_dim: u32,
+        l_gadget: u32,
+        polynomial_size: u32,
+        grouping_factor: u32,
+    );
+
+    pub fn cuda_bootstrap_multi_bit_lwe_ciphertext_vector_32(
+        v_stream: *mut c_void,
+        lwe_out: *mut c_void,
+        test_vector: *const c_void,
+        test_vector_indexes: *const c_void,
+        lwe_in: *const c_void,
+        bootstrapping_key: *const c_void,
+        input_lwe_dimension: u32,
+        polynomial_size: u32,
+        base_log: u32,
+        level: u32,
+        grouping_factor: u32,
+        num_samples: u32,
+        num_test_vectors: u32,
+        lwe_idx: u32,
+        max_shared_memory: u32,
+    );
+
+    pub fn cuda_bootstrap_multi_bit_lwe_ciphertext_vector_64(
+        v_stream: *mut c_void,
+        lwe_out: *mut c_void,
+        test_vector: *const c_void,
+        test_vector_indexes: *const c_void,
+        lwe_in: *const c_void,
+        bootstrapping_key: *const c_void,
+        input_lwe_dimension: u32,
+        polynomial_size: u32,
+        base_log: u32,
+        level: u32,
+        grouping_factor: u32,
+        num_samples: u32,
+        num_test_vectors: u32,
+        lwe_idx: u32,
+        max_shared_memory: u32,
+    );
+
     pub fn cuda_bootstrap_low_latency_lwe_ciphertext_vector_32(
         v_stream: *mut c_void,
         lwe_out: *mut c_void,
@@ -127,6 +410,190 @@ extern "C" {
         max_shared_memory: u32,
     );
 
+    pub fn cuda_bootstrap_low_latency_shared_lut_lwe_ciphertext_vector_32(
+        v_stream: *mut c_void,
+        lwe_out: *mut c_void,
+        test_vector: *const c_void,
+        lwe_in: *const c_void,
+        bootstrapping_key: *const c_void,
+        input_lwe_dimension: u32,
+        polynomial_size: u32,
+        base_log: u32,
+        level: u32,
+        num_samples: u32,
+        max_shared_memory: u32,
+    );
+
+    pub fn cuda_bootstrap_low_latency_shared_lut_lwe_ciphertext_vector_64(
+        v_stream: *mut c_void,
+        lwe_out: *mut c_void,
+        test_vector: *const c_void,
+        lwe_in: *const c_void,
+        bootstrapping_key: *const c_void,
+        input_lwe_dimension: u32,
+        polynomial_size: u32,
+        base_log: u32,
+        level: u32,
+        num_samples: u32,
+        max_shared_memory: u32,
+    );
+
+    pub fn cuda_bootstrap_low_latency_lwe_ciphertext_vector_with_glwe_dimension_32(
+        v_stream: *mut c_void,
+        lwe_out: *mut c_void,
+        lut_vector: *const c_void,
+        lut_vector_indexes: *const c_void,
+        lwe_in: *const c_void,
+        bootstrapping_key: *const c_void,
+        input_lwe_dimension: u32,
+        glwe_dimension: u32,
+        polynomial_size: u32,
+        base_log: u32,
+        level: u32,
+        num_samples: u32,
+        num_lut_vectors: u32,
+        lwe_idx: u32,
+        max_shared_memory: u32,
+    );
+
+    pub fn cuda_bootstrap_low_latency_lwe_ciphertext_vector_with_glwe_dimension_64(
+        v_stream: *mut c_void,
+        lwe_out: *mut c_void,
+        lut_vector: *const c_void,
+        lut_vector_indexes: *const c_void,
+        lwe_in: *const c_void,
+        bootstrapping_key: *const c_void,
+        input_lwe_dimension: u32,
+        glwe_dimension: u32,
+        polynomial_size: u32,
+        base_log: u32,
+        level: u32,
+        num_samples: u32,
+        num_lut_vectors: u32,
+        lwe_idx: u32,
+        max_shared_memory: u32,
+    );
+
+    pub fn cuda_create_bootstrap_low_latency_context_32(
+        gpu_index: u32,
+        polynomial_size: u32,
+        level: u32,
+        max_num_samples: u32,
+    ) -> *mut c_void;
+
+    pub fn cuda_create_bootstrap_low_latency_context_64(
+        gpu_index: u32,
+        polynomial_size: u32,
+        level: u32,
+        max_num_samples: u32,
+    ) -> *mut c_void;
+
+    pub fn cuda_bootstrap_low_latency_with_context_lwe_ciphertext_vector_32(
+        v_stream: *mut c_void,
+        context: *mut c_void,
+        lwe_out: *mut c_void,
+        lut_vector: *const c_void,
+        lwe_in: *const c_void,
+        bootstrapping_key: *const c_void,
+        input_lwe_dimension: u32,
+        polynomial_size: u32,
+        base_log: u32,
+        level: u32,
+        num_samples: u32,
+    );
+
+    pub fn cuda_bootstrap_low_latency_with_context_lwe_ciphertext_vector_64(
+        v_stream: *mut c_void,
+        context: *mut c_void,
+        lwe_out: *mut c_void,
+        lut_vector: *const c_void,
+        lwe_in: *const c_void,
+        bootstrapping_key: *const c_void,
+        input_lwe_dimension: u32,
+        polynomial_size: u32,
+        base_log: u32,
+        level: u32,
+        num_samples: u32,
+    );
+
+    pub fn cuda_destroy_bootstrap_low_latency_context(context: *mut c_void, gpu_index: u32) -> i32;
+
+    pub fn cuda_bootstrap_auto_lwe_ciphertext_vector_32(
+        v_stream: *mut c_void,
+        lwe_out: *mut c_void,
+        lut_vector: *const c_void,
+        lut_vector_indexes: *const c_void,
+        lwe_in: *const c_void,
+        bootstrapping_key: *const c_void,
+        input_lwe_dimension: u32,
+        polynomial_size: u32,
+        base_log: u32,
+        level: u32,
+        num_samples: u32,
+        num_lut_vectors: u32,
+        lwe_idx: u32,
+        max_shared_memory: u32,
+    );
+
+    pub fn cuda_bootstrap_auto_lwe_ciphertext_vector_64(
+        v_stream: *mut c_void,
+        lwe_out: *mut c_void,
+        lut_vector: *const c_void,
+        lut_vector_indexes: *const c_void,
+        lwe_in: *const c_void,
+        bootstrapping_key: *const c_void,
+        input_lwe_dimension: u32,
+        polynomial_size: u32,
+        base_log: u32,
+        level: u32,
+        num_samples: u32,
+        num_lut_vectors: u32,
+        lwe_idx: u32,
+        max_shared_memory: u32,
+    );
+
+    pub fn cuda_keyswitch_bootstrap_amortized_lwe_ciphertext_vector_32(
+        v_stream: *mut c_void,
+        lwe_out: *mut c_void,
+        lut_vector: *const c_void,
+        lut_vector_indexes: *const c_void,
+        lwe_in: *const c_void,
+        ksk: *const c_void,
+        bootstrapping_key: *const c_void,
+        input_lwe_dimension: u32,
+        lwe_dimension: u32,
+        polynomial_size: u32,
+        ks_base_log: u32,
+        ks_level: u32,
+        pbs_base_log: u32,
+        pbs_level: u32,
+        num_samples: u32,
+        num_lut_vectors: u32,
+        lwe_idx: u32,
+        max_shared_memory: u32,
+    );
+
+    pub fn cuda_keyswitch_bootstrap_amortized_lwe_ciphertext_vector_64(
+        v_stream: *mut c_void,
+        lwe_out: *mut c_void,
+        lut_vector: *const c_void,
+        lut_vector_indexes: *const c_void,
+        lwe_in: *const c_void,
+        ksk: *const c_void,
+        bootstrapping_key: *const c_void,
+        input_lwe_dimension: u32,
+        lwe_dimension: u32,
+        polynomial_size: u32,
+        ks_base_log: u32,
+        ks_level: u32,
+        pbs_base_log: u32,
+        pbs_level: u32,
+        num_samples: u32,
+        num_lut_vectors: u32,
+        lwe_idx: u32,
+        max_shared_memory: u32,
+    );
+
     pub fn cuda_keyswitch_lwe_ciphertext_vector_32(
         v_stream: *const c_void,
         lwe_out: *mut c_void,
@@ -151,6 +618,56 @@ extern "C" {
         num_samples: u32,
     );
 
+    pub fn cuda_keyswitch_lwe_ciphertext_vector_async_32(
+        v_stream: *const c_void,
+        lwe_out: *mut c_void,
+        lwe_in: *const c_void,
+        keyswitch_key: *const c_void,
+        input_lwe_dimension: u32,
+        output_lwe_dimension: u32,
+        base_log: u32,
+        l_gadget: u32,
+        num_samples: u32,
+    );
+
+    pub fn cuda_keyswitch_lwe_ciphertext_vector_async_64(
+        v_stream: *const c_void,
+        lwe_out: *mut c_void,
+        lwe_in: *const c_void,
+        keyswitch_key: *const c_void,
+        input_lwe_dimension: u32,
+        output_lwe_dimension: u32,
+        base_log: u32,
+        l_gadget: u32,
+        num_samples: u32,
+    );
+
+    pub fn cuda_keyswitch_modulus_switched_lwe_ciphertext_vector_32(
+        v_stream: *const c_void,
+        lwe_out: *mut c_void,
+        lwe_in: *const c_void,
+        keyswitch_key: *const c_void,
+        input_lwe_dimension: u32,
+        output_lwe_dimension: u32,
+        base_log: u32,
+        l_gadget: u32,
+        polynomial_size: u32,
+        num_samples: u32,
+    );
+
+    pub fn cuda_keyswitch_modulus_switched_lwe_ciphertext_vector_64(
+        v_stream: *const c_void,
+        lwe_out: *mut c_void,
+        lwe_in: *const c_void,
+        keyswitch_key: *const c_void,
+        input_lwe_dimension: u32,
+        output_lwe_dimension: u32,
+        base_log: u32,
+        l_gadget: u32,
+        polynomial_size: u32,
+        num_samples: u32,
+    );
+
     pub fn cuda_cmux_tree_32(
         v_stream: *const c_void,
         glwe_out: *mut c_void,